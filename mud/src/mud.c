@@ -24,6 +24,12 @@
  *   v1.3   22-Apr-2003  [D. Arseneau] Add MUD_openInOut
  *          25-Nov-2009  [D. Arseneau] Handle larger size_t
  *          04-May-2016  [D. Arseneau] Edits for C++ use
+ *          18-Oct-2026                Add MUD_readHeaders (header-only reads)
+ *          18-Oct-2026                Grow encode buffers geometrically; buffer
+ *                                     the output of MUD_writeGrpStart .. End
+ *          18-Oct-2026                Buffer only from MUD_writeGrpStartBuffered
+ *          18-Oct-2026  [D. Arseneau] MUD_decode fails on a section that does
+ *                                     not decode (event data past its end)
  */
 
 
@@ -37,6 +43,15 @@
 
 /* #define DEBUG 1 */  /* un-comment for debug */ 
 
+#define OUT_FLUSH	1048576	/* bytes of output held by a group being written */
+
+static void* read_sec _ANSI_ARGS_(( FILE* fin, MUD_IO_OPT io_opt, BOOL hdrsOnly ));
+static void* read_skipped _ANSI_ARGS_(( FILE* fin, int pos, UINT32 size ));
+static BOOL grow_buf _ANSI_ARGS_(( BUF* pBuf, unsigned int need ));
+static MUD_SEC_GRP* out_root _ANSI_ARGS_(( MUD_SEC_GRP* pMUD_grp ));
+static BOOL out_flush _ANSI_ARGS_(( FILE* fout, MUD_SEC_GRP* pMUD_root ));
+static BOOL grp_start _ANSI_ARGS_(( FILE* fout, MUD_SEC_GRP* pMUD_parentGrp, MUD_SEC_GRP* pMUD_grp, int numMems, BOOL buffered ));
+
 FILE*
 MUD_openInput( char* inFile )
 {
@@ -96,6 +111,27 @@ MUD_free( void* pMUD )
 }
 
 
+/*
+ *  grow_buf() - make room for need bytes in all, at least doubling, so
+ *  that encoding many sections in turn does not realloc for each
+ */
+static BOOL
+grow_buf( BUF* pBuf, unsigned int need )
+{
+    caddr_t buf;
+    unsigned int alloc;
+
+    if( pBuf->buf != NULL && need <= pBuf->alloc ) return( TRUE );
+
+    alloc = _max( need, 2*pBuf->alloc );
+    alloc = _max( alloc, 256 );
+    if( ( buf = (caddr_t)realloc( pBuf->buf, alloc ) ) == NULL ) return( FALSE );
+    pBuf->buf = buf;
+    pBuf->alloc = alloc;
+    return( TRUE );
+}
+
+
 BOOL
 MUD_encode( BUF* pBuf, void* pMUD, MUD_IO_OPT io_opt )
 {
@@ -107,16 +143,7 @@ MUD_encode( BUF* pBuf, void* pMUD, MUD_IO_OPT io_opt )
     MUD_show( pMUD, MUD_ONE );
 #endif /* DEBUG */
 
-    if( pBuf->buf == NULL )
-    {
-	pBuf->buf = (char*)zalloc( MUD_size( pMUD ) );
-    }
-    else
-    {
-	pBuf->buf = (char*)realloc( pBuf->buf, pBuf->size + MUD_size( pMUD ) );
-    }
-
-    if( pBuf->buf == NULL ) return( FALSE );
+    if( !grow_buf( pBuf, pBuf->size + MUD_size( pMUD ) ) ) return( FALSE );
 
 #ifdef DEBUG
 	printf( "MUD_encode:  buf.size = %d\n", pBuf->size + MUD_size( pMUD ) );
@@ -176,9 +203,14 @@ MUD_decode( BUF* pBuf )
 #endif /* DEBUG */
 
     /*	  
-     *  Decode the section-specific part
+     *  Decode the section-specific part; the buffer is that of the
+     *  section alone (read_sec), which the procs check their data against
      */	  
-    (*pMUD->core.proc)( MUD_DECODE, pBuf, (void*)pMUD );
+    if( (*pMUD->core.proc)( MUD_DECODE, pBuf, (void*)pMUD ) == 0 )
+    {
+	MUD_free( pMUD );
+	return( NULL );
+    }
 
 #ifdef DEBUG
     printf( "MUD_decode: done\n" );
@@ -298,6 +330,34 @@ MUD_write( FILE* fout, void* pMUD, MUD_IO_OPT io_opt )
 }
 
 
+/*
+ *  out_root() - the outermost group of a group being written
+ */
+static MUD_SEC_GRP*
+out_root( MUD_SEC_GRP* pMUD_grp )
+{
+    while( pMUD_grp->pParent != NULL ) pMUD_grp = pMUD_grp->pParent;
+    return( pMUD_grp );
+}
+
+
+/*
+ *  out_flush() - write out the output held by the outermost group
+ */
+static BOOL
+out_flush( FILE* fout, MUD_SEC_GRP* pMUD_root )
+{
+    BUF* pOut = pMUD_root->pOut;
+
+    if( pOut->size == 0 ) return( TRUE );
+    if( fseek( fout, pMUD_root->outPos, 0 ) != 0 ||
+	fwrite( pOut->buf, pOut->size, 1, fout ) != 1 ) return( FALSE );
+    pMUD_root->outPos += pOut->size;
+    pOut->pos = pOut->size = 0;
+    return( TRUE );
+}
+
+
 /*	  
  *  MUD_writeGrpStart() - use for writes of unassembled groups
  *  
@@ -307,23 +367,81 @@ MUD_write( FILE* fout, void* pMUD, MUD_IO_OPT io_opt )
  *	      or further blocks of MUD_writeGrpStart()-MUD_writeGrpEnd() ]
  *	MUD_writeGrpEnd()
  *	MUD_writeEnd()
+ *
+ *  Each member is written to fout as it is given, so the caller may
+ *  write to fout in between.
  */
 BOOL
 MUD_writeGrpStart( FILE* fout, MUD_SEC_GRP* pMUD_parentGrp, 
 		   MUD_SEC_GRP* pMUD_grp, int numMems )
 {
+    return( grp_start( fout, pMUD_parentGrp, pMUD_grp, numMems, FALSE ) );
+}
+
+
+/*
+ *  MUD_writeGrpStartBuffered() - as MUD_writeGrpStart(), for the
+ *  outermost group, but holding the output in one buffer, reused for
+ *  every member, with room left for the headers of the groups, which are
+ *  filled in at their MUD_writeGrpEnd().  It goes to the file in one
+ *  write whenever it reaches OUT_FLUSH bytes, and at the end of the
+ *  outermost group; nothing else may write to fout in between.  Groups
+ *  within it are started with MUD_writeGrpStart(), and are held too.
+ */
+BOOL
+MUD_writeGrpStartBuffered( FILE* fout, MUD_SEC_GRP* pMUD_grp, int numMems )
+{
+    return( grp_start( fout, NULL, pMUD_grp, numMems, TRUE ) );
+}
+
+
+static BOOL
+grp_start( FILE* fout, MUD_SEC_GRP* pMUD_parentGrp, MUD_SEC_GRP* pMUD_grp,
+	   int numMems, BOOL buffered )
+{
+    MUD_SEC_GRP* pMUD_root;
+    BUF* pOut;
+
     pMUD_grp->pParent = pMUD_parentGrp;
 
-    pMUD_grp->pos = ftell( fout );
     pMUD_grp->memSize = 0;
     MUD_INDEX_proc( MUD_FREE, NULL, pMUD_grp->pMemIndex );
     MUD_free( pMUD_grp->pMem );
+    pMUD_grp->pMemIndex = NULL;
+    pMUD_grp->pLastIndex = NULL;
+    pMUD_grp->pMem = NULL;
 
     pMUD_grp->num = numMems;
     pMUD_grp->core.size = MUD_getSize( (MUD_SEC*)pMUD_grp );
-    fseek( fout, pMUD_grp->core.size, 1 );
     pMUD_grp->num = 0;
 
+    pMUD_root = out_root( pMUD_grp );
+    if( pMUD_root == pMUD_grp && !buffered && pMUD_root->pOut != NULL )
+    {
+	_free( pMUD_root->pOut->buf );
+	free( pMUD_root->pOut );
+	pMUD_root->pOut = NULL;
+    }
+    else if( pMUD_root == pMUD_grp && buffered )
+    {
+	if( pMUD_root->pOut == NULL &&
+	    ( pMUD_root->pOut = (BUF*)zalloc( sizeof( BUF ) ) ) == NULL ) return( FALSE );
+	pMUD_root->pOut->pos = pMUD_root->pOut->size = 0;
+	pMUD_root->outPos = ftell( fout );
+    }
+    if( ( pOut = pMUD_root->pOut ) == NULL )
+    {
+	pMUD_grp->pos = ftell( fout );
+	fseek( fout, pMUD_grp->core.size, 1 );
+	return( TRUE );
+    }
+
+    pMUD_grp->pos = pMUD_root->outPos + pOut->size;
+    if( !grow_buf( pOut, pOut->size + pMUD_grp->core.size ) ) return( FALSE );
+    bzero( &pOut->buf[pOut->size], pMUD_grp->core.size );
+    pOut->size += pMUD_grp->core.size;
+    pOut->pos = pOut->size;
+
     return( TRUE );
 }
 
@@ -333,7 +451,12 @@ addIndex( MUD_SEC_GRP* pMUD_grp, void* pMUD )
 {
     MUD_INDEX** ppMUD_index;
 
-    for( ppMUD_index = &pMUD_grp->pMemIndex; 
+    /*
+     *  Start from the entry added last, so that adding many members one
+     *  by one is not quadratic
+     */
+    for( ppMUD_index = ( pMUD_grp->pLastIndex != NULL ) ?
+		&pMUD_grp->pLastIndex->pNext : &pMUD_grp->pMemIndex; 
 	 *ppMUD_index != NULL; 
 	 ppMUD_index = &(*ppMUD_index)->pNext ) ;
 
@@ -341,6 +464,7 @@ addIndex( MUD_SEC_GRP* pMUD_grp, void* pMUD )
     (*ppMUD_index)->offset = pMUD_grp->memSize;
     (*ppMUD_index)->secID = MUD_secID( pMUD );
     (*ppMUD_index)->instanceID = MUD_instanceID( pMUD );
+    pMUD_grp->pLastIndex = *ppMUD_index;
 }
 
 
@@ -350,12 +474,24 @@ addIndex( MUD_SEC_GRP* pMUD_grp, void* pMUD )
 BOOL
 MUD_writeGrpMem( FILE* fout, MUD_SEC_GRP* pMUD_grp, void* pMUD )
 {
+    MUD_SEC_GRP* pMUD_root;
+
     ((MUD_SEC*)pMUD)->core.size = MUD_getSize( pMUD );
 
     addIndex( pMUD_grp, pMUD );
     pMUD_grp->num++;
     pMUD_grp->memSize += MUD_totSize( pMUD );
 
+    pMUD_root = out_root( pMUD_grp );
+    if( pMUD_root->pOut != NULL )
+    {
+	if( !MUD_encode( pMUD_root->pOut, pMUD,
+			 ( MUD_secID( pMUD ) == MUD_SEC_GRP_ID ) ? MUD_GRP : MUD_ONE ) )
+	    return( FALSE );
+	if( pMUD_root->pOut->size >= OUT_FLUSH ) return( out_flush( fout, pMUD_root ) );
+	return( TRUE );
+    }
+
     if( MUD_secID( pMUD ) == MUD_SEC_GRP_ID )
     {
 	if( !MUD_write( fout, pMUD, MUD_GRP ) ) return( FALSE );
@@ -375,13 +511,50 @@ MUD_writeGrpMem( FILE* fout, MUD_SEC_GRP* pMUD_grp, void* pMUD )
 BOOL
 MUD_writeGrpEnd( FILE* fout, MUD_SEC_GRP* pMUD_grp )
 {
+    MUD_SEC_GRP* pMUD_root;
+    BUF* pOut;
+    BUF buf;
     int pos;
+    BOOL status;
 
-    pos = ftell( fout );
+    pMUD_root = out_root( pMUD_grp );
+    if( ( pOut = pMUD_root->pOut ) == NULL )
+    {
+	pos = ftell( fout );
 
-    fseek( fout, pMUD_grp->pos, 0 );
-    if( !MUD_write( fout, pMUD_grp, MUD_ONE ) ) return( FALSE );
-    fseek( fout, pos, 0 );
+	fseek( fout, pMUD_grp->pos, 0 );
+	if( !MUD_write( fout, pMUD_grp, MUD_ONE ) ) return( FALSE );
+	fseek( fout, pos, 0 );
+    }
+    else
+    {
+	/*
+	 *  Fill in the header, where it is held, or else in the file
+	 */
+	bzero( &buf, sizeof( BUF ) );
+	status = MUD_encode( &buf, pMUD_grp, MUD_ONE );
+	pos = pMUD_grp->pos - pMUD_root->outPos;
+	if( status && pos >= 0 )
+	{
+	    bcopy( buf.buf, &pOut->buf[pos], _min( buf.size, pOut->size - pos ) );
+	}
+	else if( status )
+	{
+	    status = ( fseek( fout, pMUD_grp->pos, 0 ) == 0 &&
+		       fwrite( buf.buf, buf.size, 1, fout ) == 1 );
+	}
+	_free( buf.buf );
+
+	if( pMUD_grp == pMUD_root )
+	{
+	    status = out_flush( fout, pMUD_root ) && status;
+	    fseek( fout, pMUD_root->outPos, 0 );
+	    _free( pOut->buf );
+	    free( pOut );
+	    pMUD_root->pOut = NULL;
+	}
+	if( !status ) return( FALSE );
+    }
 
     if( pMUD_grp->pParent != NULL )
     {
@@ -403,14 +576,100 @@ MUD_readFile( FILE* fin )
 }
 
 
+/*
+ *  MUD_readHeaders() - like MUD_readFile, but the bulk data sections
+ *  (histogram data, arrays, event blocks) are skipped over.  They still
+ *  appear in the tree, with their sizes and counts, but with no data
+ *  (pData == NULL).  Used for cataloguing, where only descriptions and
+ *  headers are wanted.
+ */
+void*
+MUD_readHeaders( FILE* fin )
+{
+    rewind( fin );
+
+    return( read_sec( fin, MUD_ALL, TRUE ) );
+}
+
+
 void*
 MUD_read( FILE* fin, MUD_IO_OPT io_opt )
+{
+    return( read_sec( fin, io_opt, FALSE ) );
+}
+
+
+/*
+ *  read_skipped() - make a bulk data section from its core and leading
+ *  counts, leaving the file positioned after the section.
+ */
+static void*
+read_skipped( FILE* fin, int pos, UINT32 size )
+{
+    BUF buf;
+    char head[8*sizeof(UINT32)];
+    MUD_SEC mud;
+    MUD_SEC* pMUD;
+    size_t n;
+
+    n = _min( (size_t)size, sizeof( head ) );
+    if( fread( head, n, 1, fin ) == 0 ) return( NULL );
+
+    bzero( &buf, sizeof( BUF ) );
+    buf.buf = head;
+    MUD_CORE_proc( MUD_DECODE, &buf, &mud );
+
+    pMUD = (MUD_SEC*)MUD_new( mud.core.secID, mud.core.instanceID );
+    if( pMUD == NULL ) return( NULL );
+    MUD_assignCore( &mud, pMUD );
+
+    switch( mud.core.secID )
+    {
+	case MUD_SEC_GEN_HIST_DAT_ID:
+	    if( n >= 4*sizeof(UINT32) )
+	    {
+		decode_4( (&buf), &((MUD_SEC_GEN_HIST_DAT*)pMUD)->nBytes );
+	    }
+	    break;
+	case MUD_SEC_GEN_ARRAY_ID:
+	    if( n >= 8*sizeof(UINT32) )
+	    {
+		decode_4( (&buf), &((MUD_SEC_GEN_ARRAY*)pMUD)->num );
+		decode_4( (&buf), &((MUD_SEC_GEN_ARRAY*)pMUD)->elemSize );
+		decode_4( (&buf), &((MUD_SEC_GEN_ARRAY*)pMUD)->type );
+		decode_4( (&buf), &((MUD_SEC_GEN_ARRAY*)pMUD)->hasTime );
+		decode_4( (&buf), &((MUD_SEC_GEN_ARRAY*)pMUD)->nBytes );
+	    }
+	    break;
+	case MUD_SEC_GEN_EVENT_ID:
+	    if( n >= 7*sizeof(UINT32) )
+	    {
+		decode_4( (&buf), &((MUD_SEC_GEN_EVENT*)pMUD)->nEvents );
+		decode_4( (&buf), &((MUD_SEC_GEN_EVENT*)pMUD)->nBlocks );
+		decode_4( (&buf), &((MUD_SEC_GEN_EVENT*)pMUD)->fsPerTick );
+		decode_4( (&buf), &((MUD_SEC_GEN_EVENT*)pMUD)->nBytes );
+	    }
+	    break;
+    }
+
+    if( fseek( fin, pos + size, 0 ) == EOF )
+    {
+	MUD_free( pMUD );
+	return( NULL );
+    }
+    return( pMUD );
+}
+
+
+static void*
+read_sec( FILE* fin, MUD_IO_OPT io_opt, BOOL hdrsOnly )
 {
     BUF buf;
     MUD_SEC* pMUD_new;
     MUD_SEC* pMUD_next;
     int i;
     UINT32 size;
+    UINT32 secID = 0;
     int pos;
 
 #ifdef DEBUG
@@ -423,6 +682,11 @@ MUD_read( FILE* fin, MUD_IO_OPT io_opt )
     if( ( pos = ftell( fin ) ) == EOF ) return( NULL );
     if( fread( &size, 4, 1, fin ) == 0 ) return( NULL );
     bdecode_4( &size, &size );    /* byte ordering !!! */
+    if( hdrsOnly )
+    {
+	if( fread( &secID, 4, 1, fin ) == 0 ) return( NULL );
+	bdecode_4( &secID, &secID );
+    }
     if( fseek( fin, pos, 0 ) == EOF ) return( NULL );
 
 #ifdef DEBUG
@@ -431,6 +695,13 @@ MUD_read( FILE* fin, MUD_IO_OPT io_opt )
     printf( "          reading the section ...\n" );
 #endif /* DEBUG */
 
+    if( hdrsOnly && ( ( secID == MUD_SEC_GEN_HIST_DAT_ID ) ||
+		      ( secID == MUD_SEC_GEN_ARRAY_ID ) ||
+		      ( secID == MUD_SEC_GEN_EVENT_ID ) ) )
+    {
+	return( read_skipped( fin, pos, size ) );
+    }
+
     bzero( &buf, sizeof( BUF ) );
     buf.buf = (char*)zalloc( (size_t)size );
     if( fread( buf.buf, (size_t)size, 1, fin ) == 0 )
@@ -469,7 +740,7 @@ MUD_read( FILE* fin, MUD_IO_OPT io_opt )
 	 */	  
         for( i = 0; i < ((MUD_SEC_GRP*)pMUD_new)->num; i++ )
 	{
-	    pMUD_next = (MUD_SEC*)MUD_read( fin, MUD_GRP );
+	    pMUD_next = (MUD_SEC*)read_sec( fin, MUD_GRP, hdrsOnly );
 	    if( pMUD_next == NULL )
 	    {
 		return( pMUD_new );
@@ -497,7 +768,7 @@ MUD_read( FILE* fin, MUD_IO_OPT io_opt )
 	/*	  
 	 *  Read the next section
 	 */	  
-	pMUD_next = (MUD_SEC*)MUD_read( fin, io_opt );
+	pMUD_next = (MUD_SEC*)read_sec( fin, io_opt, hdrsOnly );
 	if( pMUD_next == NULL )
 	{
 	    return( pMUD_new );
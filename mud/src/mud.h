@@ -27,10 +27,42 @@
  * 14-Aug-2019   DJA  Use stdint.h, casts in printf
  * 01-Jun-2021   DJA  Add arm64 arch as little-endian
  * 26-Aug-2021   DJA  Declare caddr_t in all Win. 
+ * 18-Oct-2026        Add event-mode (list-mode) sections; MUD_API only on Win.
+ * 18-Oct-2026        Add alpha calibration (mud_calib.c).
+ * 18-Oct-2026   DJA  Add automatic t0 (mud_t0.c).
+ * 18-Oct-2026   DJA  Add histogram arithmetic (mud_hist.c).
+ * 18-Oct-2026        Add run similarity search (mud_similar.c).
+ * 18-Oct-2026        Add run catalog (mud_catalog.c); MUD_readHeaders.
+ * 18-Oct-2026        Add catalog queries (mud_catquery.c).
+ * 18-Oct-2026   DJA  Add full-text index (mud_textindex.c).
+ * 18-Oct-2026        Add temperature/field parsing (mud_quantity.c) and
+ *                    the catalog columns from it.
+ * 18-Oct-2026        Add cache of unpacked histograms (mud_histcache.c).
+ * 18-Oct-2026        Add cache of decoded runs (mud_runcache.c).
+ * 18-Oct-2026        Add shared-memory cache of decoded runs (mud_shmcache.c).
+ * 18-Oct-2026        Add content hashes of runs (mud_dedup.c).
+ * 18-Oct-2026        Add run index and MUD_openRun (mud_runindex.c).
+ * 18-Oct-2026        Add .npy/.npz export (mud_npy.c).
+ * 18-Oct-2026        Add Arrow IPC export (mud_arrow.c), and runs gathered for
+ *                    export (mud_export.c).
+ * 18-Oct-2026        Add text (.dat) export (mud_dat.c).
+ * 18-Oct-2026        Add MUD-C chunked files (mud_mudc.c).
+ * 18-Oct-2026        Add MUD_readRunFile, MUD_writeRunFile, MUD_mudcWriteRun.
+ * 18-Oct-2026   DJA  Add import from arrays and .npz files (mud_import.c).
+ * 18-Oct-2026        Add live writing with checkpoints in place (mud_live.c).
+ * 18-Oct-2026        Add writing from a background thread (mud_async.c).
+ * 18-Oct-2026        Buffer the output of MUD_writeGrpStart .. MUD_writeGrpEnd.
+ * 18-Oct-2026        Add sparse histograms (mud_sparse.c).
+ * 18-Oct-2026        Buffer only from MUD_writeGrpStartBuffered.
+ * 18-Oct-2026   DJA  Add MUD_catalogFindRunFiles.
  */
 
 
+#if defined(_WIN32) || defined(__CYGWIN__)
 #define MUD_API __declspec(dllexport)
+#else
+#define MUD_API
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -79,11 +111,14 @@ extern "C" {
 #define	MUD_SEC_GEN_SCALER_ID	    (MUD_FMT_GEN_ID|0x00000004)
 #define	MUD_SEC_GEN_IND_VAR_ID	    (MUD_FMT_GEN_ID|0x00000005)
 #define MUD_SEC_GEN_ARRAY_ID        (MUD_FMT_GEN_ID|0x00000007)
+#define MUD_SEC_GEN_EVENT_ID        (MUD_FMT_GEN_ID|0x00000008)
+#define MUD_SEC_GEN_LIVE_ID         (MUD_FMT_GEN_ID|0x00000009)
 
 #define	MUD_GRP_GEN_HIST_ID	    (MUD_FMT_GEN_ID|0x00000002)
 #define	MUD_GRP_GEN_SCALER_ID	    (MUD_FMT_GEN_ID|0x00000004)
 #define	MUD_GRP_GEN_IND_VAR_ID	    (MUD_FMT_GEN_ID|0x00000005)
 #define	MUD_GRP_GEN_IND_VAR_ARR_ID  (MUD_FMT_GEN_ID|0x00000006)
+#define	MUD_GRP_GEN_EVENT_ID	    (MUD_FMT_GEN_ID|0x00000008)
 /* 
  *  TRI_TD Format identifiers
  */
@@ -133,6 +168,8 @@ typedef int16_t			INT16;
 typedef uint16_t 		UINT16;
 typedef int32_t			INT32;
 typedef uint32_t		UINT32;
+typedef int64_t			INT64;
+typedef uint64_t		UINT64;
 typedef float			REAL32;
 typedef double			REAL64;
 #else /*no stdint.h */
@@ -148,6 +185,8 @@ typedef unsigned int		UINT32;
 typedef long			INT32;
 typedef unsigned long		UINT32;
 #endif /* __alpha || __linux || __MACH__ || __arm64 */
+typedef long long		INT64;
+typedef unsigned long long	UINT64;
 typedef float			REAL32;
 typedef double			REAL64;
 #endif /* _STDINT_H */
@@ -256,6 +295,7 @@ typedef struct {
     caddr_t buf;
     int     pos;
     unsigned int size;
+    unsigned int alloc;		/* bytes of buf, as grown by MUD_encode */
 } BUF;
 
 
@@ -288,6 +328,9 @@ typedef struct _MUD_SEC_GRP {
     MUD_SEC*	pMem;		/* pointer to list of group members */
     INT32	pos;
     struct _MUD_SEC_GRP* pParent;
+    BUF*	pOut;		/* output held, while the outermost group is written */
+    MUD_INDEX*	pLastIndex;	/* added by addIndex; the end is after it */
+    INT32	outPos;		/* file position of pOut */
 } MUD_SEC_GRP;
 
 
@@ -375,6 +418,452 @@ typedef struct {
 } MUD_SEC_GEN_ARRAY;
 
 
+/* Generic event-mode (list-mode) data; block delta-encoded (see mud_event.c) */
+typedef struct {
+    MUD_CORE	core;
+
+    UINT32	nEvents;	/* number of events in this section */
+    UINT32	nBlocks;	/* number of encoded blocks in pData */
+    UINT32	fsPerTick;	/* time stamp resolution (as for fsPerBin) */
+    UINT32	nBytes;		/* bytes in pData */
+    caddr_t	pData;		/* pointer to the encoded blocks */
+} MUD_SEC_GEN_EVENT;
+
+
+/* Generation of a file being written live (see mud_live.c) */
+typedef struct {
+    MUD_CORE	core;
+
+    UINT32	generation;	/* odd while a checkpoint is being written */
+} MUD_SEC_GEN_LIVE;
+
+
+/* Binning applied when histogramming events (MUD_SEC_GEN_EVENT_hist) */
+typedef struct {
+    UINT32	nHists;		/* detectors 0..nHists-1 get a histogram */
+    UINT32	nBins;		/* bins per histogram */
+    UINT32	ticksPerBin;	/* bin width, in event time ticks */
+    UINT32	t0;		/* time zero, in ticks */
+    UINT32	t0_bin;		/* bin in which t0 should fall */
+    UINT32	tMin;		/* events earlier than tMin (ticks) are cut */
+    UINT32	tMax;		/* events at or after tMax are cut; 0 = none */
+} MUD_EVENT_BINNING;
+
+
+/* Detector balance (alpha) of one histogram pair (see mud_calib.c) */
+#define MUD_ALPHA_MAX_PAIRS	4
+typedef struct {
+    char	label[8];	/* e.g. "F/B", "L/R+" */
+    UINT32	hist1;		/* forward-like histogram number */
+    UINT32	hist2;		/* backward-like histogram number */
+    REAL64	alpha;		/* baseline-matched alpha */
+    REAL64	alphaErr;
+    REAL64	ratio;		/* ratio of background-subtracted sums */
+} MUD_ALPHA_PAIR;
+
+/* Alpha calibration of one run; also the calibration cache record */
+typedef struct {
+    UINT32	runNumber;
+    UINT32	exptNumber;
+    char	apparatus[16];
+    UINT32	status;		/* 1 if solved, 0 if not */
+    UINT32	nPairs;
+    MUD_ALPHA_PAIR pair[MUD_ALPHA_MAX_PAIRS];
+} MUD_ALPHA;
+
+
+/* Automatic t0 of one histogram (see mud_t0.c); positions in bins */
+typedef struct {
+    UINT32	status;		/* 1 if found, 0 if not (empty histogram) */
+    UINT32	hasPeak;	/* 1 if there is a prompt peak */
+    UINT32	peakCounts;
+    REAL64	peak;		/* centre of the highest bin, interpolated */
+    REAL64	edge;		/* half-height point of the rising edge */
+    REAL64	t0;		/* peak if there is a prompt peak, else edge */
+} MUD_T0;
+
+/* Automatic t0 of the histograms of one run */
+typedef struct {
+    UINT32	runNumber;
+    UINT32	status;		/* 1 if read and every histogram found */
+    UINT32	patched;	/* 1 if the headers were rewritten */
+    UINT32	nHists;
+    MUD_T0*	hist;		/* nHists of them; see MUD_t0Free */
+} MUD_T0_RUN;
+
+
+/* Run signature for similarity search (see mud_similar.c) */
+#define MUD_SIM_HISTS	4		/* histograms in a signature */
+#define MUD_SIM_BINS	32		/* rebinned bins per histogram */
+#define MUD_SIM_DIM	( MUD_SIM_HISTS*MUD_SIM_BINS )
+typedef struct {
+    UINT32	runNumber;
+    UINT32	exptNumber;
+    TIME	timeBegin;
+    UINT32	nHists;
+    UINT32	nBins;
+    UINT32	fsPerBin;
+    char	apparatus[16];
+    char	sample[32];
+    UINT64	hash;		/* random-hyperplane hash of vec */
+    REAL32	vec[MUD_SIM_DIM];	/* unit-length shape vector */
+} MUD_SIM_SIG;
+
+typedef struct {
+    UINT32	num;
+    MUD_SIM_SIG* pSigs;
+    UINT32*	pPathOff;	/* offset of each run's path in pPaths */
+    char*	pPaths;
+    UINT32	nBands;		/* LSH bands of the hash */
+    UINT32*	pBucketStarts;	/* by band, start of each bucket in its rows */
+    UINT32*	pBucketRows;	/* by band, the rows by bucket */
+    void*	pBase;		/* the index file, mapped or read */
+    size_t	size;
+    int		mapped;
+} MUD_SIM_INDEX;
+
+typedef struct {
+    UINT32	row;		/* index in pSigs */
+    REAL32	score;		/* cosine similarity */
+} MUD_SIM_MATCH;
+
+
+/* Run catalog (see mud_catalog.c): one row per run file, kept by column */
+#define MUD_CAT_UINT32	1		/* column types */
+#define MUD_CAT_UINT64	2
+#define MUD_CAT_STRING	3		/* UINT32 string numbers */
+#define MUD_CAT_REAL64	4		/* NaN where there is no value */
+#define MUD_CAT_ZONE	1024		/* rows per zone-map block */
+
+#define MUD_CAT_PATH		0	/* columns */
+#define MUD_CAT_RUN		1
+#define MUD_CAT_EXPT		2
+#define MUD_CAT_FORMAT		3
+#define MUD_CAT_TIME_BEGIN	4
+#define MUD_CAT_TIME_END	5
+#define MUD_CAT_ELAPSED		6
+#define MUD_CAT_TITLE		7
+#define MUD_CAT_LAB		8
+#define MUD_CAT_AREA		9
+#define MUD_CAT_METHOD		10
+#define MUD_CAT_APPARATUS	11
+#define MUD_CAT_INSERT		12
+#define MUD_CAT_SAMPLE		13
+#define MUD_CAT_ORIENT		14
+#define MUD_CAT_DAS		15
+#define MUD_CAT_EXPERIMENTER	16
+#define MUD_CAT_TEMPERATURE	17
+#define MUD_CAT_FIELD		18
+#define MUD_CAT_NHISTS		19
+#define MUD_CAT_NBINS		20
+#define MUD_CAT_FS_PER_BIN	21
+#define MUD_CAT_EVENTS		22
+#define MUD_CAT_HIST_TITLES	23
+#define MUD_CAT_NSCALERS	24
+#define MUD_CAT_SCALERS		25
+#define MUD_CAT_NINDVARS	26
+#define MUD_CAT_INDVARS		27
+#define MUD_CAT_DEV		28	/* file fingerprint */
+#define MUD_CAT_INO		29
+#define MUD_CAT_SIZE		30
+#define MUD_CAT_MTIME		31	/* ns since 1970 */
+#define MUD_CAT_HEAD_HASH	32	/* 0 if not hashed */
+#define MUD_CAT_TEMP_K		33	/* temperature parsed, in K */
+#define MUD_CAT_TEMP_ERR	34
+#define MUD_CAT_TEMP_STATUS	35	/* MUD_QTY_ flags */
+#define MUD_CAT_FIELD_G		36	/* field parsed, in G */
+#define MUD_CAT_FIELD_ERR	37
+#define MUD_CAT_FIELD_STATUS	38
+#define MUD_CAT_NCOLS		39
+
+typedef struct {
+    UINT32	num;		/* rows */
+    UINT32	alloc;		/* rows allocated in each column */
+    void*	pCols[MUD_CAT_NCOLS];	/* UINT32, UINT64 or REAL64 arrays */
+    UINT32	nStrings;	/* interned strings; number 0 is "" */
+    UINT32	strAlloc;
+    UINT32*	pStrOff;	/* offset of each string in pStrings */
+    char*	pStrings;
+    UINT32	strBytes;
+    UINT32	strBytesAlloc;
+    UINT32*	pHash;		/* string number + 1 by hash; 0 = empty */
+    UINT32	hashSize;
+    UINT32	nZones;		/* blocks with zone maps; 0 = none built */
+    UINT64*	pZoneMin[MUD_CAT_NCOLS];	/* per block of MUD_CAT_ZONE rows */
+    UINT64*	pZoneMax[MUD_CAT_NCOLS];
+} MUD_CATALOG;
+
+
+/* Temperature and field strings parsed (see mud_quantity.c) */
+#define MUD_QTY_TEMPERATURE	1	/* kinds: in K */
+#define MUD_QTY_FIELD		2	/* in G */
+
+#define MUD_QTY_VALUE		0x01	/* status flags: a number found */
+#define MUD_QTY_ERROR		0x02	/* an uncertainty */
+#define MUD_QTY_UNIT		0x04	/* a unit, converted */
+#define MUD_QTY_BADUNIT		0x08	/* a word that is not a unit */
+#define MUD_QTY_EXTRA		0x10	/* other text ignored */
+
+
+/* Full-text index (see mud_textindex.c) of run descriptions and comments */
+typedef struct {
+    char*	term;
+    UINT32	nDocs;		/* documents containing the term */
+    UINT32	lastDoc;	/* last document in the postings */
+    UINT32	len;		/* bytes of postings */
+    UINT32	alloc;
+    UINT8*	pPost;		/* varint postings: doc delta, nPos, pos deltas */
+} MUD_TEXT_TERM;
+
+typedef struct {
+    UINT32	nDocs;		/* documents: one per run file */
+    UINT32	docAlloc;
+    char**	paths;
+    UINT64*	pSize;		/* size of each file when indexed */
+    UINT64*	pMtime;		/* and modification time, ns since 1970 */
+    UINT32	nTerms;
+    UINT32	termAlloc;
+    MUD_TEXT_TERM* pTerms;
+    UINT32*	pHash;		/* term number + 1 by hash; 0 = empty */
+    UINT32	hashSize;
+} MUD_TEXTINDEX;
+
+
+/* Cache (see mud_histcache.c) of unpacked histograms, as mapped */
+typedef struct {
+    UINT32	num;		/* histogram number */
+    UINT32	histType;
+    UINT32	nBytes;		/* header fields of the histogram */
+    UINT32	nBins;
+    UINT32	bytesPerBin;
+    UINT32	fsPerBin;
+    UINT32	t0_ps;
+    UINT32	t0_bin;
+    UINT32	goodBin1;
+    UINT32	goodBin2;
+    UINT32	bkgd1;
+    UINT32	bkgd2;
+    UINT32	nEvents;
+    UINT32	title;		/* offset of the title (shared-memory cache) */
+    UINT64	offset;		/* of the bins in the cache file */
+} MUD_HIST_CACHE_ENTRY;
+
+typedef struct {
+    UINT32	nHists;
+    MUD_HIST_CACHE_ENTRY* pEntries;
+    void*	pBase;		/* the cache file, mapped or read */
+    size_t	size;
+    int		mapped;
+} MUD_HIST_CACHE;
+
+
+/* A run in the cache of decoded runs (see mud_runcache.c) */
+typedef struct _MUD_CACHED_RUN {
+    struct _MUD_CACHED_RUN* pNext;	/* in the hash chain */
+    struct _MUD_CACHED_RUN* pNewer;	/* LRU list */
+    struct _MUD_CACHED_RUN* pOlder;
+    char*	path;
+    UINT64	dev;		/* fingerprint of the file when read */
+    UINT64	ino;
+    UINT64	size;
+    UINT64	mtime;
+    MUD_SEC_GRP* pMUD_fileGrp;
+    MUD_HIST_CACHE* pHistCache;
+    int		refs;		/* fds open on the run */
+    int		stale;		/* out of the cache, freed when not open */
+} MUD_CACHED_RUN;
+
+
+/* Shared-memory cache of decoded runs (see mud_shmcache.c) */
+#define MUD_SHM_PATH		0	/* strings of a run */
+#define MUD_SHM_TITLE		1
+#define MUD_SHM_LAB		2
+#define MUD_SHM_AREA		3
+#define MUD_SHM_METHOD		4
+#define MUD_SHM_APPARATUS	5
+#define MUD_SHM_INSERT		6
+#define MUD_SHM_SAMPLE		7
+#define MUD_SHM_ORIENT		8
+#define MUD_SHM_DAS		9
+#define MUD_SHM_EXPERIMENTER	10
+#define MUD_SHM_TEMPERATURE	11	/* TD only */
+#define MUD_SHM_FIELD		12
+#define MUD_SHM_SUBTITLE	13	/* I-MuSR only */
+#define MUD_SHM_COMMENT1	14
+#define MUD_SHM_COMMENT2	15
+#define MUD_SHM_COMMENT3	16
+#define MUD_SHM_NSTR		17
+
+/* A run in the segment; offsets are from the start of the run */
+typedef struct {
+    UINT32	size;		/* of the run, bins and all */
+    UINT32	slot;		/* in the table of the segment */
+    UINT64	print[4];	/* device, inode, size, mtime (ns) of the file */
+    UINT32	format;		/* MUD_FMT_..._ID */
+    UINT32	exptNumber;
+    UINT32	runNumber;
+    TIME	timeBegin;
+    TIME	timeEnd;
+    UINT32	elapsedSec;
+    UINT32	nHists;
+    UINT32	histOffset;	/* of nHists MUD_HIST_CACHE_ENTRY */
+    UINT32	str[MUD_SHM_NSTR];	/* offsets of the strings, 0 if none */
+} MUD_SHM_RUN;
+
+typedef struct {
+    char*	name;
+    void*	pBase;		/* the segment, mapped */
+    size_t	size;
+} MUD_SHM_CACHE;
+
+
+/* Index of runs by number (see mud_runindex.c), as mapped */
+typedef struct {
+    UINT32	exptNumber;
+    UINT32	runNumber;
+    TIME	timeBegin;
+    UINT32	pathOffset;	/* in pPaths */
+} MUD_RUNINDEX_ENTRY;
+
+typedef struct {
+    UINT32	nRuns;
+    MUD_RUNINDEX_ENTRY* pEntries;	/* by expt, run and timeBegin */
+    UINT32*	pByRun;		/* entries by run, timeBegin and expt */
+    char*	pPaths;
+    void*	pBase;		/* the index file, mapped or read */
+    size_t	size;
+    int		mapped;
+} MUD_RUNINDEX;
+
+
+/* Runs gathered for export (see mud_export.c) */
+#define MUD_EXP_FORMAT		0	/* values of a run */
+#define MUD_EXP_EXPT		1
+#define MUD_EXP_RUN		2
+#define MUD_EXP_TIME_BEGIN	3
+#define MUD_EXP_TIME_END	4
+#define MUD_EXP_ELAPSED		5
+#define MUD_EXP_NVALS		6
+
+#define MUD_EXP_HIST_TYPE	0	/* values of a histogram */
+#define MUD_EXP_NBINS		1
+#define MUD_EXP_FS_PER_BIN	2
+#define MUD_EXP_T0_PS		3
+#define MUD_EXP_T0_BIN		4
+#define MUD_EXP_GOOD_BIN1	5
+#define MUD_EXP_GOOD_BIN2	6
+#define MUD_EXP_BKGD1		7
+#define MUD_EXP_BKGD2		8
+#define MUD_EXP_NEVENTS		9
+#define MUD_EXP_NHISTVALS	10
+
+typedef struct {
+    UINT32	val[MUD_EXP_NVALS];
+    REAL64	tempK;		/* parsed; NaN if none */
+    REAL64	fieldG;
+    char*	str[MUD_SHM_NSTR];	/* by MUD_SHM_PATH ..; NULL if none */
+    UINT32	nHists;
+    UINT32	maxBins;	/* of its histograms */
+    UINT32*	pHistVals;	/* MUD_EXP_NHISTVALS per histogram */
+    char**	pHistTitles;
+} MUD_EXPORT_RUN;
+
+typedef struct {
+    int		nRuns;		/* that could be read */
+    MUD_EXPORT_RUN* pRuns;
+    UINT32	maxHists;	/* of all runs */
+    UINT32	maxBins;
+    int		nThreads;
+} MUD_EXPORT;
+
+/* Export to NumPy (see mud_npy.c) */
+#define MUD_NPZ_DEFLATE		1	/* deflate the arrays (needs zlib) */
+
+/* Import from arrays (see mud_import.c) */
+#define MUD_IMPORT_BPB_AUTO	-1	/* fewest bytes per bin that hold the counts */
+
+typedef struct {
+    MUD_EXPORT_RUN run;		/* headers, as exported; maxBins unused */
+    UINT32*	pCounts;	/* run.nHists rows of binStride */
+    UINT32	binStride;
+    int		nMeta;		/* other metadata, written as comments */
+    char**	pMetaNames;
+    char**	pMetaValues;
+    int		bytesPerBin;	/* 1, 2, 4, 0 (packed), MUD_BPB_SPARSE, or
+				   MUD_IMPORT_BPB_AUTO */
+} MUD_IMPORT_RUN;
+
+/* Live writing (see mud_live.c) */
+typedef struct {
+    FILE*	fio;
+    UINT32	generation;
+    long	genOffset;	/* of the generation, in the file */
+    long	descOffset;	/* of the run description; 0 if none */
+    int		nHists;
+    UINT32*	pNBins;		/* by histogram */
+    long*	pDatOffsets;	/* of the counts */
+    long*	pHdrOffsets;	/* of nEvents */
+    int		nScalers;
+    long*	pScalerOffsets;	/* of counts[0] */
+    UINT8*	pBuf;		/* the counts of a histogram, as written */
+} MUD_LIVE;
+
+/* Writing from a background thread (see mud_async.c) */
+#define MUD_ASYNC_FSYNC		1	/* sync each file before renaming it */
+#define MUD_ASYNC_LATEST	2	/* replace a snapshot waiting, if full */
+
+typedef struct _MUD_ASYNC MUD_ASYNC;
+
+/* Sparse histograms, of the nonzero bins only (see mud_sparse.c) */
+#define MUD_BPB_SPARSE		16	/* bytesPerBin of one */
+
+typedef struct {
+    UINT8*	pData;		/* as stored */
+    UINT32	nBytes;
+    UINT32	nBins;
+    int		bytesPerBin;
+    UINT32	pos;		/* in pData */
+    UINT32	bin;		/* next bin, or next pair if sparse */
+    UINT32	nPairs;		/* sparse */
+    int		idxSize;
+    int		valSize;
+    UINT32	runLeft;	/* bins left in the run (variable-bin) */
+    int		runSize;
+} MUD_SPARSE_ITER;
+
+/* MUD-C chunked files (see mud_mudc.c) */
+#define MUD_MUDC_DEFLATE	1	/* deflate the chunks (needs zlib) */
+#define MUD_MUDC_CHUNK_BINS	4096	/* bins to a chunk, by default */
+
+typedef struct {
+    UINT64	offset;		/* in the file */
+    UINT32	size;		/* bytes as stored */
+    UINT32	coding;
+    UINT32	crc;		/* CRC32C of the bytes stored */
+} MUD_MUDC_CHUNK;
+
+typedef struct {
+    UINT32	num;		/* of the histogram, from 1 */
+    UINT32	nBins;
+    UINT32	bytesPerBin;	/* in the MUD file */
+    UINT32	nChunks;
+    MUD_MUDC_CHUNK* pChunks;
+} MUD_MUDC_HIST;
+
+typedef struct {
+    FILE*	fin;
+    MUD_SEC_GRP* pMUD_fileGrp;	/* the run, without histogram data */
+    UINT32	chunkBins;
+    UINT32	nHists;
+    MUD_MUDC_HIST* pHists;
+    UINT8*	pBuf;		/* a chunk as stored */
+    UINT8*	pTmp;		/* inflated */
+    UINT32*	pChunk;		/* decoded */
+    int		cachedHist;	/* and chunk, in pChunk; 0 if none */
+    UINT32	cachedChunk;
+} MUD_MUDC;
+
+
 typedef struct {
     MUD_CORE	core;
     
@@ -503,11 +992,13 @@ BOOL MUD_writeEnd _ANSI_ARGS_(( FILE *fout ));
 BOOL MUD_writeFile _ANSI_ARGS_(( FILE *fout , void* pMUD_head ));
 BOOL MUD_write _ANSI_ARGS_(( FILE *fout , void* pMUD , MUD_IO_OPT io_opt ));
 BOOL MUD_writeGrpStart _ANSI_ARGS_(( FILE *fout , MUD_SEC_GRP *pMUD_parentGrp , MUD_SEC_GRP *pMUD_grp , int numMems ));
+BOOL MUD_writeGrpStartBuffered _ANSI_ARGS_(( FILE *fout , MUD_SEC_GRP *pMUD_grp , int numMems ));
 void addIndex _ANSI_ARGS_(( MUD_SEC_GRP *pMUD_grp , void* pMUD ));
 BOOL MUD_writeGrpMem _ANSI_ARGS_(( FILE *fout , MUD_SEC_GRP *pMUD_grp , void* pMUD ));
 BOOL MUD_writeGrpEnd _ANSI_ARGS_(( FILE *fout , MUD_SEC_GRP *pMUD_grp ));
 void* MUD_readFile _ANSI_ARGS_(( FILE *fin ));
 void* MUD_read _ANSI_ARGS_(( FILE *fin , MUD_IO_OPT io_opt ));
+void* MUD_readHeaders _ANSI_ARGS_(( FILE *fin ));
 UINT32 MUD_setSizes _ANSI_ARGS_(( void* pMUD ));
 MUD_SEC* MUD_peekCore _ANSI_ARGS_(( FILE *fin ));
 void* MUD_search _ANSI_ARGS_(( void* pMUD_head , ...));
@@ -559,6 +1050,187 @@ int MUD_SEC_GEN_IND_VAR_proc _ANSI_ARGS_(( MUD_OPT op , BUF *pBuf , MUD_SEC_GEN_
 int MUD_SEC_GEN_ARRAY_proc _ANSI_ARGS_(( MUD_OPT op, BUF *pBuf, MUD_SEC_GEN_ARRAY *pMUD ));
 int MUD_SEC_GEN_HIST_pack _ANSI_ARGS_(( int num , int inBinSize , void* inHist , int outBinSize , void* outHist ));
 int MUD_SEC_GEN_HIST_unpack _ANSI_ARGS_(( int num , int inBinSize , void* inHist , int outBinSize , void* outHist ));
+int MUD_SEC_GEN_HIST_unpackData _ANSI_ARGS_(( int num , int inBinSize , void* inHist , UINT32 inBytes , int outBinSize , void* outHist ));
+int MUD_SEC_GEN_EVENT_proc _ANSI_ARGS_(( MUD_OPT op, BUF *pBuf, MUD_SEC_GEN_EVENT *pMUD ));
+int MUD_SEC_GEN_LIVE_proc _ANSI_ARGS_(( MUD_OPT op, BUF *pBuf, MUD_SEC_GEN_LIVE *pMUD ));
+
+/* mud_event.c */
+MUD_API int MUD_SEC_GEN_EVENT_encode _ANSI_ARGS_(( MUD_SEC_GEN_EVENT* pMUD, UINT32 num, UINT16* pDet, UINT32* pTime ));
+MUD_API int MUD_SEC_GEN_EVENT_decode _ANSI_ARGS_(( MUD_SEC_GEN_EVENT* pMUD, UINT16* pDet, UINT32* pTime ));
+MUD_API MUD_SEC_GRP* MUD_SEC_GEN_EVENT_group _ANSI_ARGS_(( UINT32 num, UINT32 fsPerTick, UINT16* pDet, UINT32* pTime ));
+MUD_API int MUD_SEC_GEN_EVENT_hist _ANSI_ARGS_(( MUD_SEC* pMUD_list, MUD_EVENT_BINNING* pBin, UINT32* pHists, int nThreads ));
+
+/* mud_calib.c */
+MUD_API int MUD_alphaPairs _ANSI_ARGS_(( MUD_SEC_GRP* pMUD_histGrp, MUD_ALPHA_PAIR* pPairs, int max ));
+MUD_API int MUD_alphaSolve _ANSI_ARGS_(( MUD_SEC_GRP* pMUD_fileGrp, MUD_ALPHA* pAlpha ));
+MUD_API int MUD_alphaBatch _ANSI_ARGS_(( int num, char** filenames, MUD_ALPHA* pAlpha, int nThreads ));
+MUD_API int MUD_alphaCacheUpdate _ANSI_ARGS_(( char* cachename, int num, MUD_ALPHA* pAlpha ));
+MUD_API int MUD_alphaCacheLookup _ANSI_ARGS_(( char* cachename, UINT32 runNumber, char* apparatus, MUD_ALPHA* pAlpha ));
+
+/* mud_t0.c */
+MUD_API int MUD_findT0 _ANSI_ARGS_(( UINT32* pData, UINT32 nBins, MUD_T0* pT0 ));
+MUD_API int MUD_patchT0 _ANSI_ARGS_(( char* filename, int num, REAL64* pT0 ));
+MUD_API int MUD_t0Batch _ANSI_ARGS_(( int num, char** filenames, MUD_T0_RUN* pRuns, int patch, int nThreads ));
+MUD_API void MUD_t0Free _ANSI_ARGS_(( int num, MUD_T0_RUN* pRuns ));
+
+/* mud_hist.c */
+#define MUD_NORM_EVENTS	1
+#define MUD_NORM_TIME	2
+MUD_API int MUD_histGroupSum _ANSI_ARGS_(( int nIn, UINT32** ppIn, UINT32 nBins, int* pGroup, int nOut, UINT64* pSum, int nThreads ));
+MUD_API int MUD_histGroupMatrix _ANSI_ARGS_(( int nIn, UINT32** ppIn, UINT32 nBins, int nOut, REAL64* pMatrix, REAL64* pOut, REAL64* pErr, int nThreads ));
+MUD_API int MUD_histToReal _ANSI_ARGS_(( void* pIn, int binSize, UINT32 nBins, REAL64* pOut, REAL64* pErr ));
+MUD_API int MUD_histAdd _ANSI_ARGS_(( REAL64* pA, REAL64* pAErr, REAL64* pB, REAL64* pBErr, REAL64 factor, UINT32 nBins ));
+MUD_API int MUD_histScale _ANSI_ARGS_(( REAL64* p, REAL64* pErr, REAL64 factor, REAL64 factorErr, UINT32 nBins ));
+MUD_API int MUD_histNormalize _ANSI_ARGS_(( REAL64* p, REAL64* pErr, UINT32 nBins, REAL64 norm, int normType ));
+
+/* mud_similar.c */
+MUD_API int MUD_simSignature _ANSI_ARGS_(( MUD_SEC_GRP* pMUD_fileGrp, MUD_SIM_SIG* pSig ));
+MUD_API int MUD_simIndexBuild _ANSI_ARGS_(( int num, char** filenames, char* indexname, int nThreads ));
+MUD_API MUD_SIM_INDEX* MUD_simIndexLoad _ANSI_ARGS_(( char* indexname ));
+MUD_API void MUD_simIndexFree _ANSI_ARGS_(( MUD_SIM_INDEX* pIndex ));
+MUD_API int MUD_simFindRun _ANSI_ARGS_(( MUD_SIM_INDEX* pIndex, UINT32 runNumber, char* apparatus ));
+MUD_API int MUD_simQuery _ANSI_ARGS_(( MUD_SIM_INDEX* pIndex, MUD_SIM_SIG* pSig, char* apparatus, int skipRow, int useLsh, int k, MUD_SIM_MATCH* pMatches ));
+
+/* mud_catalog.c */
+MUD_API MUD_CATALOG* MUD_catalogNew _ANSI_ARGS_(( void ));
+MUD_API void MUD_catalogFree _ANSI_ARGS_(( MUD_CATALOG* pCat ));
+MUD_API char** MUD_catalogFindFiles _ANSI_ARGS_(( int nDirs, char** dirs, int* pNum ));
+MUD_API char** MUD_catalogFindRunFiles _ANSI_ARGS_(( int nDirs, char** dirs, int* pNum ));
+MUD_API void MUD_catalogFreeFiles _ANSI_ARGS_(( char** files, int num ));
+MUD_API int MUD_catalogAddFiles _ANSI_ARGS_(( MUD_CATALOG* pCat, int num, char** files, int nThreads ));
+MUD_API int MUD_catalogUpdate _ANSI_ARGS_(( MUD_CATALOG* pCat, int num, char** files, int hashHead, int nThreads ));
+MUD_API int MUD_catalogBuild _ANSI_ARGS_(( int nDirs, char** dirs, char* catname, int nThreads ));
+MUD_API int MUD_catalogRefresh _ANSI_ARGS_(( char* catname, int nDirs, char** dirs, int hashHead, int nThreads, int* pNumRead ));
+MUD_API int MUD_catalogWrite _ANSI_ARGS_(( MUD_CATALOG* pCat, char* catname ));
+MUD_API MUD_CATALOG* MUD_catalogRead _ANSI_ARGS_(( char* catname ));
+MUD_API int MUD_catalogColumn _ANSI_ARGS_(( char* name ));
+MUD_API char* MUD_catalogColumnName _ANSI_ARGS_(( int col ));
+MUD_API int MUD_catalogColumnType _ANSI_ARGS_(( int col ));
+MUD_API UINT64 MUD_catalogValue _ANSI_ARGS_(( MUD_CATALOG* pCat, int row, int col ));
+MUD_API REAL64 MUD_catalogReal _ANSI_ARGS_(( MUD_CATALOG* pCat, int row, int col ));
+MUD_API char* MUD_catalogString _ANSI_ARGS_(( MUD_CATALOG* pCat, int row, int col ));
+
+/* mud_catquery.c */
+MUD_API int MUD_catalogSelect _ANSI_ARGS_(( MUD_CATALOG* pCat, char* query, int** ppRows ));
+void MUD_catalogFreeZones _ANSI_ARGS_(( MUD_CATALOG* pCat ));
+
+/* mud_quantity.c */
+MUD_API int MUD_parseQuantity _ANSI_ARGS_(( char* s, int kind, REAL64* pValue, REAL64* pError ));
+
+/* mud_textindex.c */
+MUD_API MUD_TEXTINDEX* MUD_textIndexNew _ANSI_ARGS_(( void ));
+MUD_API void MUD_textIndexFree _ANSI_ARGS_(( MUD_TEXTINDEX* pIdx ));
+MUD_API int MUD_textIndexUpdate _ANSI_ARGS_(( MUD_TEXTINDEX* pIdx, int num, char** files, int nThreads ));
+MUD_API int MUD_textIndexWrite _ANSI_ARGS_(( MUD_TEXTINDEX* pIdx, char* idxname ));
+MUD_API MUD_TEXTINDEX* MUD_textIndexRead _ANSI_ARGS_(( char* idxname ));
+MUD_API int MUD_textIndexRefresh _ANSI_ARGS_(( char* idxname, int nDirs, char** dirs, int nThreads, int* pNumRead ));
+MUD_API int MUD_textSearch _ANSI_ARGS_(( MUD_TEXTINDEX* pIdx, char* query, int** ppDocs ));
+MUD_API char* MUD_textDocPath _ANSI_ARGS_(( MUD_TEXTINDEX* pIdx, int doc ));
+
+/* mud_histcache.c */
+MUD_API void MUD_setHistCacheDir _ANSI_ARGS_(( char* dir ));
+MUD_API char* MUD_getHistCacheDir _ANSI_ARGS_(( void ));
+MUD_API MUD_HIST_CACHE* MUD_histCacheOpen _ANSI_ARGS_(( char* filename, FILE* fin, MUD_SEC_GRP* pMUD_fileGrp ));
+MUD_API UINT32* MUD_histCacheData _ANSI_ARGS_(( MUD_HIST_CACHE* pCache, int num, MUD_HIST_CACHE_ENTRY** ppEntry ));
+MUD_API void MUD_histCacheClose _ANSI_ARGS_(( MUD_HIST_CACHE* pCache ));
+
+/* mud_runcache.c */
+MUD_API void MUD_setRunCacheSize _ANSI_ARGS_(( size_t bytes ));
+MUD_API size_t MUD_getRunCacheSize _ANSI_ARGS_(( void ));
+MUD_API void MUD_runCacheStats _ANSI_ARGS_(( UINT32* pNum, size_t* pBytes, UINT32* pHits, UINT32* pMisses ));
+MUD_API MUD_CACHED_RUN* MUD_runCacheGet _ANSI_ARGS_(( char* path ));
+MUD_API MUD_CACHED_RUN* MUD_runCachePut _ANSI_ARGS_(( char* path, FILE* fin, MUD_SEC_GRP* pMUD_fileGrp, MUD_HIST_CACHE* pHistCache ));
+MUD_API void MUD_runCacheRelease _ANSI_ARGS_(( MUD_CACHED_RUN* pRun ));
+MUD_API void MUD_runCacheFlush _ANSI_ARGS_(( void ));
+
+/* mud_shmcache.c */
+MUD_API MUD_SHM_CACHE* MUD_shmCacheOpen _ANSI_ARGS_(( char* name, size_t size ));
+MUD_API void MUD_shmCacheClose _ANSI_ARGS_(( MUD_SHM_CACHE* pShm ));
+MUD_API int MUD_shmCacheRemove _ANSI_ARGS_(( char* name ));
+MUD_API void MUD_shmCacheStats _ANSI_ARGS_(( MUD_SHM_CACHE* pShm, UINT32* pNum, size_t* pBytes, UINT64* pHits, UINT64* pMisses ));
+MUD_API MUD_SHM_RUN* MUD_shmGetRun _ANSI_ARGS_(( MUD_SHM_CACHE* pShm, char* path ));
+MUD_API MUD_SHM_RUN* MUD_shmPutRun _ANSI_ARGS_(( MUD_SHM_CACHE* pShm, char* path, FILE* fin, MUD_SEC_GRP* pMUD_fileGrp ));
+MUD_API MUD_SHM_RUN* MUD_shmOpenRun _ANSI_ARGS_(( MUD_SHM_CACHE* pShm, char* path ));
+MUD_API void MUD_shmReleaseRun _ANSI_ARGS_(( MUD_SHM_CACHE* pShm, MUD_SHM_RUN* pRun ));
+MUD_API char* MUD_shmRunString _ANSI_ARGS_(( MUD_SHM_RUN* pRun, int which ));
+MUD_API UINT32* MUD_shmRunHist _ANSI_ARGS_(( MUD_SHM_RUN* pRun, int num, MUD_HIST_CACHE_ENTRY** ppEntry ));
+MUD_API char* MUD_shmRunHistTitle _ANSI_ARGS_(( MUD_SHM_RUN* pRun, int num ));
+
+/* mud_dedup.c */
+MUD_API UINT32 MUD_crc32c _ANSI_ARGS_(( UINT32 crc, void* pData, size_t n ));
+MUD_API int MUD_runCanon _ANSI_ARGS_(( MUD_SEC_GRP* pMUD_fileGrp, char** ppBuf, size_t* pSize ));
+MUD_API int MUD_runHash _ANSI_ARGS_(( MUD_SEC_GRP* pMUD_fileGrp, UINT64* pHash ));
+MUD_API int MUD_dedupRuns _ANSI_ARGS_(( int num, char** files, int nThreads, UINT64* pHashes, int* pFirst ));
+
+/* mud_runindex.c */
+MUD_API int MUD_runIndexWrite _ANSI_ARGS_(( MUD_CATALOG* pCat, char* idxname ));
+MUD_API MUD_RUNINDEX* MUD_runIndexOpen _ANSI_ARGS_(( char* idxname ));
+MUD_API void MUD_runIndexClose _ANSI_ARGS_(( MUD_RUNINDEX* pIdx ));
+MUD_API MUD_RUNINDEX_ENTRY* MUD_runIndexFind _ANSI_ARGS_(( MUD_RUNINDEX* pIdx, UINT32 expt, UINT32 run, int year ));
+MUD_API char* MUD_runIndexPath _ANSI_ARGS_(( MUD_RUNINDEX* pIdx, MUD_RUNINDEX_ENTRY* pEntry ));
+MUD_API void MUD_setRunIndex _ANSI_ARGS_(( char* idxname ));
+MUD_API int MUD_openRun _ANSI_ARGS_(( UINT32 expt, UINT32 run, UINT32* pType ));
+
+/* mud_npy.c */
+MUD_API int MUD_writeNpz _ANSI_ARGS_(( char* filename, int num, char** files, int flags, int nThreads ));
+MUD_API int MUD_writeNpy _ANSI_ARGS_(( char* filename, int num, char** files, int nThreads ));
+
+/* mud_export.c */
+MUD_API MUD_EXPORT* MUD_exportOpen _ANSI_ARGS_(( int num, char** files, int nThreads ));
+MUD_API void MUD_exportClose _ANSI_ARGS_(( MUD_EXPORT* pExp ));
+MUD_API int MUD_exportBlock _ANSI_ARGS_(( MUD_EXPORT* pExp ));
+MUD_API void MUD_exportCounts _ANSI_ARGS_(( MUD_EXPORT* pExp, int first, int num, UINT32* pCounts ));
+MUD_API char* MUD_exportValName _ANSI_ARGS_(( int i ));
+MUD_API char* MUD_exportHistValName _ANSI_ARGS_(( int i ));
+MUD_API char* MUD_exportStrName _ANSI_ARGS_(( int i ));
+
+/* mud_arrow.c */
+MUD_API int MUD_writeArrow _ANSI_ARGS_(( char* filename, int num, char** files, int nThreads ));
+
+/* mud_dat.c */
+MUD_API int MUD_writeDat _ANSI_ARGS_(( int num, char** files, char* dir, int nThreads, char* pDone ));
+
+/* mud_mudc.c */
+MUD_API int MUD_mudcWrite _ANSI_ARGS_(( char* inFile, char* outFile, int chunkBins, int flags ));
+MUD_API int MUD_mudcWriteRun _ANSI_ARGS_(( void* pMUD_fileGrp, char* outFile, int chunkBins, int flags ));
+MUD_API int MUD_mudcToClassic _ANSI_ARGS_(( char* inFile, char* outFile ));
+MUD_API MUD_MUDC* MUD_mudcOpen _ANSI_ARGS_(( char* filename ));
+MUD_API void MUD_mudcClose _ANSI_ARGS_(( MUD_MUDC* pMudc ));
+MUD_API int MUD_mudcReadBins _ANSI_ARGS_(( MUD_MUDC* pMudc, int hist, UINT32 first, UINT32 num, UINT32* pCounts ));
+MUD_API void* MUD_mudcReadFile _ANSI_ARGS_(( char* filename ));
+MUD_API void* MUD_readRunFile _ANSI_ARGS_(( char* filename, int hdrsOnly ));
+MUD_API int MUD_writeRunFile _ANSI_ARGS_(( void* pMUD_fileGrp, char* outFile ));
+
+/* mud_import.c */
+MUD_API void* MUD_importBuild _ANSI_ARGS_(( MUD_IMPORT_RUN* pImp, int nThreads ));
+MUD_API int MUD_importRun _ANSI_ARGS_(( MUD_IMPORT_RUN* pImp, char* outFile, int nThreads ));
+MUD_API int MUD_importNpz _ANSI_ARGS_(( char* filename, char* dir, int bytesPerBin, int nThreads ));
+
+/* mud_live.c */
+MUD_API MUD_LIVE* MUD_liveOpen _ANSI_ARGS_(( char* filename, void* pMUD_fileGrp ));
+MUD_API int MUD_liveCheckpoint _ANSI_ARGS_(( MUD_LIVE* pLive, UINT32** ppCounts, UINT32* pScalers, UINT32 elapsedSec, UINT32 timeEnd ));
+MUD_API int MUD_liveClose _ANSI_ARGS_(( MUD_LIVE* pLive ));
+MUD_API void* MUD_liveReadFile _ANSI_ARGS_(( char* filename, UINT32* pGeneration ));
+
+/* mud_async.c */
+MUD_API MUD_ASYNC* MUD_asyncOpen _ANSI_ARGS_(( int flags, int nThreads ));
+MUD_API int MUD_asyncSubmit _ANSI_ARGS_(( MUD_ASYNC* pAsync, MUD_IMPORT_RUN* pImp, char* outFile, int wait ));
+MUD_API int MUD_asyncPending _ANSI_ARGS_(( MUD_ASYNC* pAsync ));
+MUD_API int MUD_asyncWait _ANSI_ARGS_(( MUD_ASYNC* pAsync ));
+MUD_API int MUD_asyncClose _ANSI_ARGS_(( MUD_ASYNC* pAsync ));
+
+/* mud_sparse.c */
+MUD_API int MUD_sparseSize _ANSI_ARGS_(( int num, int inBinSize, void* inHist ));
+MUD_API int MUD_sparsePack _ANSI_ARGS_(( int num, int inBinSize, void* inHist, void* outSparse ));
+MUD_API int MUD_sparseUnpack _ANSI_ARGS_(( int num, void* inSparse, UINT32 nBytes, int outBinSize, void* outHist ));
+MUD_API int MUD_sparseIterInit _ANSI_ARGS_(( MUD_SPARSE_ITER* pIter, UINT32 nBins, UINT32 bytesPerBin, void* pData, UINT32 nBytes ));
+MUD_API int MUD_sparseNext _ANSI_ARGS_(( MUD_SPARSE_ITER* pIter, UINT32* pBin, UINT32* pCount ));
+
+/* mud_thread.c */
+typedef void (*MUD_TASK_PROC) _ANSI_ARGS_(( int task, int thread, void* pArg ));
+MUD_API int MUD_numThreads _ANSI_ARGS_(( int nThreads ));
+int MUD_parallelFor _ANSI_ARGS_(( int nTasks, int nThreads, MUD_TASK_PROC proc, void* pArg ));
+void MUD_addHist32 _ANSI_ARGS_(( UINT32* pSum, UINT32* pAdd, int num ));
 
 /* mud_tri_ti.c */
 int MUD_SEC_TRI_TI_RUN_DESC_proc _ANSI_ARGS_(( MUD_OPT op , BUF *pBuf , MUD_SEC_TRI_TI_RUN_DESC *pMUD ));
@@ -594,6 +1266,8 @@ MUD_API int MUD_getDas _ANSI_ARGS_((int fd, char* das, int strdim));
 MUD_API int MUD_getExperimenter _ANSI_ARGS_((int fd, char* experimenter, int strdim));
 MUD_API int MUD_getTemperature _ANSI_ARGS_((int fd, char* temperature, int strdim));
 MUD_API int MUD_getField _ANSI_ARGS_((int fd, char* field, int strdim));
+MUD_API int MUD_getTemperatureValue _ANSI_ARGS_((int fd, REAL64* pTemp, REAL64* pTempErr));
+MUD_API int MUD_getFieldValue _ANSI_ARGS_((int fd, REAL64* pField, REAL64* pFieldErr));
 MUD_API int MUD_getSubtitle _ANSI_ARGS_((int fd, char* subtitle, int strdim));
 MUD_API int MUD_getComment1 _ANSI_ARGS_((int fd, char* comment1, int strdim));
 MUD_API int MUD_getComment2 _ANSI_ARGS_((int fd, char* comment2, int strdim));
@@ -678,6 +1352,16 @@ MUD_API int MUD_setHistpData _ANSI_ARGS_((int fd, int num, void* pData));
 MUD_API int MUD_setHistTimeData _ANSI_ARGS_((int fd, int num, UINT32* pTimeData));
 MUD_API int MUD_setHistpTimeData _ANSI_ARGS_((int fd, int num, UINT32* pTimeData));
 
+MUD_API int MUD_getEvents _ANSI_ARGS_((int fd, UINT32* pNum, UINT32* pFsPerTick));
+MUD_API int MUD_getEventData _ANSI_ARGS_((int fd, UINT16* pDet, UINT32* pTime));
+MUD_API int MUD_setEvents _ANSI_ARGS_((int fd, UINT32 num, UINT32 fsPerTick, UINT16* pDet, UINT32* pTime));
+MUD_API int MUD_setHistsFromEvents _ANSI_ARGS_((int fd, UINT32 type, MUD_EVENT_BINNING* pBin, UINT32 bytesPerBin));
+MUD_API int MUD_getAlpha _ANSI_ARGS_((int fd, MUD_ALPHA* pAlpha));
+MUD_API int MUD_getHistT0Auto _ANSI_ARGS_((int fd, int num, MUD_T0* pT0));
+MUD_API int MUD_getHistGroupData _ANSI_ARGS_((int fd, int* pGroup, int nOut, UINT64* pSum));
+MUD_API int MUD_getHistCachedData _ANSI_ARGS_((int fd, int num, UINT32** ppData));
+MUD_API int MUD_getHistNonzero _ANSI_ARGS_((int fd, int num, UINT32* pNum, UINT32* pBins, UINT32* pCounts));
+
 MUD_API int MUD_pack _ANSI_ARGS_((int num, int inBinSize, void* inArray, int outBinSize, void* outArray));
 MUD_API int MUD_unpack _ANSI_ARGS_((int num, int inBinSize, void* inArray, int outBinSize, void* outArray));
 
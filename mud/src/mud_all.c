@@ -20,6 +20,7 @@
  *   v1.10  17-Feb-1994  [T. Whidden] Groups with member index
  *   v1.2a  01-Mar-2000  DA  Proc for unknown sections
  *          25-Nov-2009  DA  Handle 8-byte time_t
+ *          18-Oct-2026      Free the output held by a group being written
  */
 
 #include <time.h>
@@ -116,6 +117,11 @@ MUD_SEC_GRP_proc( MUD_OPT op, BUF* pBuf, MUD_SEC_GRP* pMUD )
 	case MUD_FREE:
 	    MUD_INDEX_proc( MUD_FREE, NULL, pMUD->pMemIndex );
 	    MUD_free( pMUD->pMem );
+	    if( pMUD->pOut != NULL )
+	    {
+		_free( pMUD->pOut->buf );
+		free( pMUD->pOut );
+	    }
 	    break;
 	case MUD_DECODE:
 	    decode_4( pBuf, &pMUD->num );
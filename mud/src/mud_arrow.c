@@ -0,0 +1,824 @@
+/*
+ *  mud_arrow.c -- write the histograms and headers of runs as an Apache
+ *                 Arrow IPC file (Feather version 2)
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version
+ *
+ *  Description:
+ *    MUD_writeArrow() writes runs as a table with one row per run, in the
+ *    Arrow IPC file format (what pyarrow.feather, polars and DuckDB read
+ *    as Feather or .arrow files), with the columns
+ *
+ *      format .. elapsed_sec
+ *                    uint32, but time_begin and time_end as
+ *                    timestamp[s, UTC], from the run description
+ *      path, title .. comment3
+ *                    utf8, null if empty
+ *      temperature_k, field_g
+ *                    float64, parsed (see mud_quantity.c); null if there
+ *                    is no number
+ *      n_hists       uint32
+ *      hist_type .. n_events
+ *                    fixed_size_list<uint32>[histograms], from the
+ *                    histogram headers
+ *      hist_title    fixed_size_list<utf8>[histograms]
+ *      counts        fixed_size_list<fixed_size_list<uint32>[bins]>
+ *                    [histograms], zero past the end of shorter runs and
+ *                    histograms
+ *
+ *    where histograms and bins are the most of any run.  Runs that cannot
+ *    be read are left out.
+ *
+ *    The file is written without the Arrow libraries: the metadata are
+ *    flatbuffers, built here back to front as the flatbuffers library
+ *    does.  There is one record batch per block of runs (see
+ *    mud_export.c), whose counts are read in parallel and unpacked
+ *    straight into the buffer written out.  All buffers start on 64-byte
+ *    boundaries in the file, so that a reader mapping it takes the
+ *    columns in place.  Values are in the byte order of the machine,
+ *    which the schema records.
+ */
+
+#include "mud.h"
+
+#define AR_ALIGN	64		/* of messages and buffers in the file */
+#define AR_MAX_NODES	64
+#define AR_MAX_BUFS	( 3*AR_MAX_NODES )
+#define FB_MAX_FIELDS	8
+
+#define AR_V5		4		/* MetadataVersion */
+#define AR_SCHEMA	1		/* MessageHeader */
+#define AR_RECORD_BATCH	3
+#define AR_INT		2		/* Type */
+#define AR_FLOAT	3
+#define AR_UTF8		5
+#define AR_TIMESTAMP	10
+#define AR_FIXED_LIST	16
+
+/* A flatbuffer, built back to front; offsets are from the end */
+typedef struct {
+    UINT8*	buf;
+    size_t	cap;
+    size_t	head;		/* bytes used, at the end of buf */
+    size_t	minAlign;
+    size_t	slots[FB_MAX_FIELDS];	/* of the fields of the table begun */
+    size_t	objStart;
+    int		error;
+} FB;
+
+typedef struct {
+    INT64	length;
+    INT64	nulls;
+} AR_NODE;
+
+typedef struct {
+    void*	p;
+    size_t	len;
+} AR_BUF;
+
+/* The body of a record batch */
+typedef struct {
+    AR_NODE	nodes[AR_MAX_NODES];
+    int		nNodes;
+    AR_BUF	bufs[AR_MAX_BUFS];
+    int		nBufs;
+    void*	temps[AR_MAX_BUFS];	/* to free */
+    int		nTemps;
+    int		error;
+} AR_BATCH;
+
+typedef struct {
+    INT64	offset;
+    INT32	metaLength;
+    INT64	bodyLength;
+} AR_BLOCK;
+
+typedef struct {
+    FILE*	fout;
+    UINT64	pos;
+    int		error;
+    MUD_EXPORT*	pExp;
+    AR_BLOCK*	pBlocks;
+    int		nBlocks;
+} AR_FILE;
+
+static void put_16 _ANSI_ARGS_(( UINT8* b, UINT32 v ));
+static void put_32 _ANSI_ARGS_(( UINT8* b, UINT32 v ));
+static void put_64 _ANSI_ARGS_(( UINT8* b, UINT64 v ));
+static void fb_push _ANSI_ARGS_(( FB* pB, void* p, size_t n ));
+static void fb_prep _ANSI_ARGS_(( FB* pB, size_t size, size_t additional ));
+static void fb_int _ANSI_ARGS_(( FB* pB, UINT64 v, size_t size ));
+static void fb_offset _ANSI_ARGS_(( FB* pB, size_t off ));
+static size_t fb_string _ANSI_ARGS_(( FB* pB, char* s ));
+static size_t fb_offsets _ANSI_ARGS_(( FB* pB, size_t* offs, int n ));
+static void fb_start_structs _ANSI_ARGS_(( FB* pB, int n, size_t size ));
+static size_t fb_end_vector _ANSI_ARGS_(( FB* pB, int n ));
+static void fb_start_table _ANSI_ARGS_(( FB* pB ));
+static void fb_add_int _ANSI_ARGS_(( FB* pB, int field, UINT64 v, size_t size ));
+static void fb_add_offset _ANSI_ARGS_(( FB* pB, int field, size_t off ));
+static size_t fb_end_table _ANSI_ARGS_(( FB* pB ));
+static void fb_finish _ANSI_ARGS_(( FB* pB, size_t root ));
+static size_t type_int _ANSI_ARGS_(( FB* pB ));
+static size_t type_list _ANSI_ARGS_(( FB* pB, UINT32 size ));
+static size_t field _ANSI_ARGS_(( FB* pB, char* name, int type, size_t typeOff, size_t child ));
+static size_t scalar_field _ANSI_ARGS_(( FB* pB, char* name, int type ));
+static size_t schema _ANSI_ARGS_(( FB* pB, MUD_EXPORT* pExp ));
+static void out _ANSI_ARGS_(( AR_FILE* pF, void* p, size_t n ));
+static void pad_out _ANSI_ARGS_(( AR_FILE* pF, size_t n ));
+static void message _ANSI_ARGS_(( AR_FILE* pF, int type, size_t header, FB* pB, INT64 bodyLength, AR_BLOCK* pBlock ));
+static void* temp _ANSI_ARGS_(( AR_BATCH* pBt, size_t n ));
+static void add_node _ANSI_ARGS_(( AR_BATCH* pBt, INT64 length, INT64 nulls ));
+static void add_buf _ANSI_ARGS_(( AR_BATCH* pBt, void* p, size_t len ));
+static void col_values _ANSI_ARGS_(( AR_BATCH* pBt, void* p, INT64 n, size_t size ));
+static void col_reals _ANSI_ARGS_(( AR_BATCH* pBt, REAL64* p, INT64 n ));
+static void col_strings _ANSI_ARGS_(( AR_BATCH* pBt, char** strs, INT64 n ));
+static void write_batch _ANSI_ARGS_(( AR_FILE* pF, int first, int num, UINT32* pCounts ));
+
+
+/*
+ *  put_16() .. put_64() - little-endian, for the flatbuffers
+ */
+static void
+put_16( UINT8* b, UINT32 v )
+{
+    b[0] = (UINT8)v;
+    b[1] = (UINT8)( v >> 8 );
+}
+
+
+static void
+put_32( UINT8* b, UINT32 v )
+{
+    put_16( b, v & 0xFFFF );
+    put_16( b + 2, v >> 16 );
+}
+
+
+static void
+put_64( UINT8* b, UINT64 v )
+{
+    put_32( b, (UINT32)v );
+    put_32( b + 4, (UINT32)( v >> 32 ) );
+}
+
+
+/*
+ *  fb_push() - n bytes in front of what is built (p NULL for zeros)
+ */
+static void
+fb_push( FB* pB, void* p, size_t n )
+{
+    UINT8* buf;
+    size_t cap;
+
+    if( pB->head + n > pB->cap )
+    {
+	for( cap = _max( pB->cap, 1024 ); cap < pB->head + n; cap *= 2 ) ;
+	if( ( buf = (UINT8*)malloc( cap ) ) == NULL )
+	{
+	    pB->error = 1;
+	    return;
+	}
+	if( pB->head > 0 ) bcopy( pB->buf + pB->cap - pB->head, buf + cap - pB->head, pB->head );
+	_free( pB->buf );
+	pB->buf = buf;
+	pB->cap = cap;
+    }
+    pB->head += n;
+    if( p != NULL ) bcopy( p, pB->buf + pB->cap - pB->head, n );
+    else bzero( pB->buf + pB->cap - pB->head, n );
+}
+
+
+/*
+ *  fb_prep() - pad so that, after additional bytes more, what is built
+ *  is aligned to size
+ */
+static void
+fb_prep( FB* pB, size_t size, size_t additional )
+{
+    pB->minAlign = _max( pB->minAlign, size );
+    fb_push( pB, NULL, ( size - ( pB->head + additional ) % size ) % size );
+}
+
+
+static void
+fb_int( FB* pB, UINT64 v, size_t size )
+{
+    UINT8 b[8];
+
+    put_64( b, v );
+    fb_prep( pB, size, 0 );
+    fb_push( pB, b, size );
+}
+
+
+static void
+fb_offset( FB* pB, size_t off )
+{
+    fb_prep( pB, 4, 0 );
+    fb_int( pB, pB->head + 4 - off, 4 );
+}
+
+
+static size_t
+fb_string( FB* pB, char* s )
+{
+    size_t n = strlen( s );
+
+    fb_prep( pB, 4, n + 1 );
+    fb_push( pB, NULL, 1 );
+    fb_push( pB, s, n );
+    fb_int( pB, n, 4 );
+    return( pB->head );
+}
+
+
+static size_t
+fb_offsets( FB* pB, size_t* offs, int n )
+{
+    int i;
+
+    fb_prep( pB, 4, 4*n );
+    for( i = n - 1; i >= 0; i-- ) fb_offset( pB, offs[i] );
+    return( fb_end_vector( pB, n ) );
+}
+
+
+/*
+ *  fb_start_structs() - start a vector of n structs of size bytes (a
+ *  multiple of 8, their alignment); push them last first
+ */
+static void
+fb_start_structs( FB* pB, int n, size_t size )
+{
+    fb_prep( pB, 4, n*size );
+    fb_prep( pB, 8, n*size );
+}
+
+
+static size_t
+fb_end_vector( FB* pB, int n )
+{
+    fb_int( pB, (UINT64)n, 4 );
+    return( pB->head );
+}
+
+
+static void
+fb_start_table( FB* pB )
+{
+    bzero( pB->slots, sizeof( pB->slots ) );
+    pB->objStart = pB->head;
+}
+
+
+static void
+fb_add_int( FB* pB, int field, UINT64 v, size_t size )
+{
+    fb_int( pB, v, size );
+    pB->slots[field] = pB->head;
+}
+
+
+static void
+fb_add_offset( FB* pB, int field, size_t off )
+{
+    fb_offset( pB, off );
+    pB->slots[field] = pB->head;
+}
+
+
+/*
+ *  fb_end_table() - the vtable, in front of the table; returns the table
+ */
+static size_t
+fb_end_table( FB* pB )
+{
+    UINT8 b[4];
+    size_t table;
+    int i, n;
+
+    fb_int( pB, 0, 4 );
+    table = pB->head;
+    for( n = FB_MAX_FIELDS; n > 0 && pB->slots[n-1] == 0; n-- ) ;
+    for( i = n - 1; i >= 0; i-- )
+    {
+	fb_int( pB, ( pB->slots[i] > 0 ) ? table - pB->slots[i] : 0, 2 );
+    }
+    fb_int( pB, table - pB->objStart, 2 );
+    fb_int( pB, 2*( n + 2 ), 2 );
+    if( pB->error ) return( 0 );
+
+    put_32( b, (UINT32)( pB->head - table ) );
+    bcopy( b, pB->buf + pB->cap - table, 4 );
+    return( table );
+}
+
+
+static void
+fb_finish( FB* pB, size_t root )
+{
+    fb_prep( pB, pB->minAlign, 4 );
+    fb_offset( pB, root );
+}
+
+
+/*
+ *  Schema: Field { name, nullable, type_type, type, dictionary,
+ *  children, custom_metadata }
+ */
+static size_t
+type_int( FB* pB )
+{
+    fb_start_table( pB );
+    fb_add_int( pB, 0, 32, 4 );			/* bitWidth */
+    fb_add_int( pB, 1, 0, 1 );			/* is_signed */
+    return( fb_end_table( pB ) );
+}
+
+
+static size_t
+type_list( FB* pB, UINT32 size )
+{
+    fb_start_table( pB );
+    fb_add_int( pB, 0, size, 4 );		/* listSize */
+    return( fb_end_table( pB ) );
+}
+
+
+/*
+ *  field() - a field, with one child if child is not 0
+ */
+static size_t
+field( FB* pB, char* name, int type, size_t typeOff, size_t child )
+{
+    size_t nameOff, childOff;
+
+    nameOff = fb_string( pB, name );
+    childOff = fb_offsets( pB, &child, ( child > 0 ) ? 1 : 0 );
+    fb_start_table( pB );
+    fb_add_offset( pB, 0, nameOff );
+    fb_add_offset( pB, 3, typeOff );
+    fb_add_offset( pB, 5, childOff );
+    fb_add_int( pB, 1, 1, 1 );			/* nullable */
+    fb_add_int( pB, 2, type, 1 );
+    return( fb_end_table( pB ) );
+}
+
+
+static size_t
+scalar_field( FB* pB, char* name, int type )
+{
+    size_t typeOff, tzOff = 0;
+
+    if( type == AR_INT ) return( field( pB, name, type, type_int( pB ), 0 ) );
+    if( type == AR_TIMESTAMP ) tzOff = fb_string( pB, "UTC" );
+    fb_start_table( pB );
+    if( type == AR_FLOAT )
+    {
+	fb_add_int( pB, 0, 2, 2 );		/* precision DOUBLE */
+    }
+    else if( type == AR_TIMESTAMP )
+    {
+	fb_add_offset( pB, 1, tzOff );		/* timezone */
+	fb_add_int( pB, 0, 0, 2 );		/* unit SECOND */
+    }
+    typeOff = fb_end_table( pB );
+    return( field( pB, name, type, typeOff, 0 ) );
+}
+
+
+/*
+ *  schema() - the columns (see above)
+ */
+static size_t
+schema( FB* pB, MUD_EXPORT* pExp )
+{
+    size_t fields[MUD_EXP_NVALS + MUD_SHM_NSTR + MUD_EXP_NHISTVALS + 6];
+    size_t child, fieldsOff;
+    int i, n = 0;
+
+    for( i = 0; i < MUD_EXP_NVALS; i++ )
+    {
+	fields[n++] = scalar_field( pB, MUD_exportValName( i ),
+		( i == MUD_EXP_TIME_BEGIN || i == MUD_EXP_TIME_END ) ? AR_TIMESTAMP : AR_INT );
+    }
+    for( i = 0; i < MUD_SHM_NSTR; i++ )
+    {
+	fields[n++] = scalar_field( pB, MUD_exportStrName( i ), AR_UTF8 );
+    }
+    fields[n++] = scalar_field( pB, "temperature_k", AR_FLOAT );
+    fields[n++] = scalar_field( pB, "field_g", AR_FLOAT );
+    fields[n++] = scalar_field( pB, "n_hists", AR_INT );
+    for( i = 0; i < MUD_EXP_NHISTVALS; i++ )
+    {
+	child = scalar_field( pB, "item", AR_INT );
+	fields[n++] = field( pB, MUD_exportHistValName( i ), AR_FIXED_LIST,
+			     type_list( pB, pExp->maxHists ), child );
+    }
+    child = scalar_field( pB, "item", AR_UTF8 );
+    fields[n++] = field( pB, "hist_title", AR_FIXED_LIST, type_list( pB, pExp->maxHists ), child );
+    child = scalar_field( pB, "item", AR_INT );
+    child = field( pB, "item", AR_FIXED_LIST, type_list( pB, pExp->maxBins ), child );
+    fields[n++] = field( pB, "counts", AR_FIXED_LIST, type_list( pB, pExp->maxHists ), child );
+
+    fieldsOff = fb_offsets( pB, fields, n );
+    fb_start_table( pB );
+    fb_add_offset( pB, 1, fieldsOff );
+#ifdef MUD_BIG_ENDIAN
+    fb_add_int( pB, 0, 1, 2 );			/* endianness Big */
+#else
+    fb_add_int( pB, 0, 0, 2 );
+#endif /* MUD_BIG_ENDIAN */
+    return( fb_end_table( pB ) );
+}
+
+
+static void
+out( AR_FILE* pF, void* p, size_t n )
+{
+    if( n > 0 && fwrite( p, 1, n, pF->fout ) != n ) pF->error = 1;
+    pF->pos += n;
+}
+
+
+static void
+pad_out( AR_FILE* pF, size_t n )
+{
+    static UINT8 zeros[AR_ALIGN];
+
+    out( pF, zeros, n );
+}
+
+
+/*
+ *  message() - write a message (its header built in pB) but the body,
+ *  padded so that the body starts on AR_ALIGN; where it is goes into
+ *  *pBlock if not NULL
+ */
+static void
+message( AR_FILE* pF, int type, size_t header, FB* pB, INT64 bodyLength, AR_BLOCK* pBlock )
+{
+    UINT8 b[8];
+    size_t len;
+
+    fb_start_table( pB );
+    fb_add_int( pB, 3, (UINT64)bodyLength, 8 );
+    fb_add_offset( pB, 2, header );
+    fb_add_int( pB, 0, AR_V5, 2 );
+    fb_add_int( pB, 1, type, 1 );
+    fb_finish( pB, fb_end_table( pB ) );
+    if( pB->error )
+    {
+	pF->error = 1;
+	return;
+    }
+
+    len = pB->head + ( AR_ALIGN - ( pF->pos + 8 + pB->head ) % AR_ALIGN ) % AR_ALIGN;
+    if( pBlock != NULL )
+    {
+	pBlock->offset = (INT64)pF->pos;
+	pBlock->metaLength = (INT32)( 8 + len );
+	pBlock->bodyLength = bodyLength;
+    }
+    put_32( b, 0xFFFFFFFFU );
+    put_32( b + 4, (UINT32)len );
+    out( pF, b, 8 );
+    out( pF, pB->buf + pB->cap - pB->head, pB->head );
+    pad_out( pF, len - pB->head );
+}
+
+
+static void*
+temp( AR_BATCH* pBt, size_t n )
+{
+    void* p;
+
+    if( pBt->nTemps == AR_MAX_BUFS || ( p = zalloc( n + 1 ) ) == NULL )
+    {
+	pBt->error = 1;
+	return( NULL );
+    }
+    pBt->temps[pBt->nTemps++] = p;
+    return( p );
+}
+
+
+static void
+add_node( AR_BATCH* pBt, INT64 length, INT64 nulls )
+{
+    if( pBt->nNodes == AR_MAX_NODES )
+    {
+	pBt->error = 1;
+	return;
+    }
+    pBt->nodes[pBt->nNodes].length = length;
+    pBt->nodes[pBt->nNodes].nulls = nulls;
+    pBt->nNodes++;
+}
+
+
+static void
+add_buf( AR_BATCH* pBt, void* p, size_t len )
+{
+    if( pBt->nBufs == AR_MAX_BUFS )
+    {
+	pBt->error = 1;
+	return;
+    }
+    pBt->bufs[pBt->nBufs].p = p;
+    pBt->bufs[pBt->nBufs].len = ( p != NULL ) ? len : 0;
+    pBt->nBufs++;
+}
+
+
+/*
+ *  col_values() .. col_strings() - the node and buffers of a column of n
+ *  values: validity (empty if none are null), then the data
+ */
+static void
+col_values( AR_BATCH* pBt, void* p, INT64 n, size_t size )
+{
+    add_node( pBt, n, 0 );
+    add_buf( pBt, NULL, 0 );
+    add_buf( pBt, p, (size_t)n*size );
+}
+
+
+static void
+col_reals( AR_BATCH* pBt, REAL64* p, INT64 n )
+{
+    UINT8* pValid;
+    INT64 i, nulls = 0;
+
+    if( ( pValid = (UINT8*)temp( pBt, (size_t)( n + 7 )/8 ) ) == NULL ) return;
+    for( i = 0; i < n; i++ )
+    {
+	if( p[i] == p[i] ) pValid[i/8] |= (UINT8)( 1 << ( i % 8 ) );
+	else nulls++;
+    }
+    add_node( pBt, n, nulls );
+    add_buf( pBt, ( nulls > 0 ) ? pValid : NULL, (size_t)( n + 7 )/8 );
+    add_buf( pBt, p, (size_t)n*sizeof( REAL64 ) );
+}
+
+
+static void
+col_strings( AR_BATCH* pBt, char** strs, INT64 n )
+{
+    UINT8* pValid;
+    INT32* pOffsets;
+    char* pData;
+    size_t len = 0;
+    INT64 i, nulls = 0;
+
+    for( i = 0; i < n; i++ )
+    {
+	if( strs[i] != NULL ) len += strlen( strs[i] );
+    }
+    if( ( pValid = (UINT8*)temp( pBt, (size_t)( n + 7 )/8 ) ) == NULL ||
+	( pOffsets = (INT32*)temp( pBt, (size_t)( n + 1 )*sizeof( INT32 ) ) ) == NULL ||
+	( pData = (char*)temp( pBt, len ) ) == NULL ) return;
+    for( i = 0, len = 0; i < n; i++ )
+    {
+	pOffsets[i] = (INT32)len;
+	if( strs[i] == NULL )
+	{
+	    nulls++;
+	    continue;
+	}
+	pValid[i/8] |= (UINT8)( 1 << ( i % 8 ) );
+	bcopy( strs[i], pData + len, strlen( strs[i] ) );
+	len += strlen( strs[i] );
+    }
+    pOffsets[n] = (INT32)len;
+    add_node( pBt, n, nulls );
+    add_buf( pBt, ( nulls > 0 ) ? pValid : NULL, (size_t)( n + 7 )/8 );
+    add_buf( pBt, pOffsets, (size_t)( n + 1 )*sizeof( INT32 ) );
+    add_buf( pBt, pData, len );
+}
+
+
+/*
+ *  write_batch() - a record batch of runs first .. first + num - 1, with
+ *  their counts in pCounts
+ */
+static void
+write_batch( AR_FILE* pF, int first, int num, UINT32* pCounts )
+{
+    MUD_EXPORT* pExp = pF->pExp;
+    MUD_EXPORT_RUN* pRun;
+    AR_BATCH bt;
+    FB fb;
+    UINT8 b[16];
+    UINT32* vals;
+    INT64* times;
+    REAL64* reals;
+    char** strs;
+    size_t nodesOff, bufsOff, offset;
+    INT64 nHists = (INT64)num*pExp->maxHists;
+    int i, j, h, k;
+
+    bzero( &bt, sizeof( bt ) );
+    bzero( &fb, sizeof( fb ) );
+
+    for( k = 0; k < MUD_EXP_NVALS; k++ )
+    {
+	if( k == MUD_EXP_TIME_BEGIN || k == MUD_EXP_TIME_END )
+	{
+	    if( ( times = (INT64*)temp( &bt, num*sizeof( INT64 ) ) ) == NULL ) goto done;
+	    for( j = 0; j < num; j++ ) times[j] = pExp->pRuns[first + j].val[k];
+	    col_values( &bt, times, num, sizeof( INT64 ) );
+	}
+	else
+	{
+	    if( ( vals = (UINT32*)temp( &bt, num*sizeof( UINT32 ) ) ) == NULL ) goto done;
+	    for( j = 0; j < num; j++ ) vals[j] = pExp->pRuns[first + j].val[k];
+	    col_values( &bt, vals, num, sizeof( UINT32 ) );
+	}
+    }
+    for( k = 0; k < MUD_SHM_NSTR; k++ )
+    {
+	if( ( strs = (char**)temp( &bt, num*sizeof( char* ) ) ) == NULL ) goto done;
+	for( j = 0; j < num; j++ ) strs[j] = pExp->pRuns[first + j].str[k];
+	col_strings( &bt, strs, num );
+    }
+    for( k = 0; k < 2; k++ )
+    {
+	if( ( reals = (REAL64*)temp( &bt, num*sizeof( REAL64 ) ) ) == NULL ) goto done;
+	for( j = 0; j < num; j++ )
+	    reals[j] = ( k == 0 ) ? pExp->pRuns[first + j].tempK : pExp->pRuns[first + j].fieldG;
+	col_reals( &bt, reals, num );
+    }
+    if( ( vals = (UINT32*)temp( &bt, num*sizeof( UINT32 ) ) ) == NULL ) goto done;
+    for( j = 0; j < num; j++ ) vals[j] = pExp->pRuns[first + j].nHists;
+    col_values( &bt, vals, num, sizeof( UINT32 ) );
+
+    /*
+     *  Per histogram: the lists, then their items
+     */
+    for( k = 0; k < MUD_EXP_NHISTVALS; k++ )
+    {
+	if( ( vals = (UINT32*)temp( &bt, nHists*sizeof( UINT32 ) ) ) == NULL ) goto done;
+	for( j = 0; j < num; j++ )
+	{
+	    pRun = &pExp->pRuns[first + j];
+	    for( h = 0; h < (int)pRun->nHists; h++ )
+		vals[j*pExp->maxHists + h] = pRun->pHistVals[h*MUD_EXP_NHISTVALS + k];
+	}
+	add_node( &bt, num, 0 );
+	add_buf( &bt, NULL, 0 );
+	col_values( &bt, vals, nHists, sizeof( UINT32 ) );
+    }
+    if( ( strs = (char**)temp( &bt, nHists*sizeof( char* ) ) ) == NULL ) goto done;
+    for( j = 0; j < num; j++ )
+    {
+	pRun = &pExp->pRuns[first + j];
+	for( h = 0; h < (int)pRun->nHists; h++ )
+	    strs[j*pExp->maxHists + h] = pRun->pHistTitles[h];
+    }
+    add_node( &bt, num, 0 );
+    add_buf( &bt, NULL, 0 );
+    col_strings( &bt, strs, nHists );
+
+    add_node( &bt, num, 0 );
+    add_buf( &bt, NULL, 0 );
+    add_node( &bt, nHists, 0 );
+    add_buf( &bt, NULL, 0 );
+    col_values( &bt, pCounts, nHists*pExp->maxBins, sizeof( UINT32 ) );
+    if( bt.error ) goto done;
+
+    /*
+     *  RecordBatch { length, nodes, buffers }
+     */
+    fb_start_structs( &fb, bt.nBufs, 16 );
+    for( offset = 0, i = 0; i < bt.nBufs; i++ )
+	offset += ( bt.bufs[i].len + AR_ALIGN - 1 )/AR_ALIGN*AR_ALIGN;
+    for( i = bt.nBufs - 1; i >= 0; i-- )
+    {
+	offset -= ( bt.bufs[i].len + AR_ALIGN - 1 )/AR_ALIGN*AR_ALIGN;
+	put_64( b, offset );
+	put_64( b + 8, bt.bufs[i].len );
+	fb_push( &fb, b, 16 );
+    }
+    bufsOff = fb_end_vector( &fb, bt.nBufs );
+    fb_start_structs( &fb, bt.nNodes, 16 );
+    for( i = bt.nNodes - 1; i >= 0; i-- )
+    {
+	put_64( b, (UINT64)bt.nodes[i].length );
+	put_64( b + 8, (UINT64)bt.nodes[i].nulls );
+	fb_push( &fb, b, 16 );
+    }
+    nodesOff = fb_end_vector( &fb, bt.nNodes );
+    fb_start_table( &fb );
+    fb_add_int( &fb, 0, (UINT64)num, 8 );
+    fb_add_offset( &fb, 1, nodesOff );
+    fb_add_offset( &fb, 2, bufsOff );
+
+    for( offset = 0, i = 0; i < bt.nBufs; i++ )
+	offset += ( bt.bufs[i].len + AR_ALIGN - 1 )/AR_ALIGN*AR_ALIGN;
+    message( pF, AR_RECORD_BATCH, fb_end_table( &fb ), &fb, (INT64)offset,
+	     &pF->pBlocks[pF->nBlocks++] );
+    for( i = 0; i < bt.nBufs; i++ )
+    {
+	out( pF, bt.bufs[i].p, bt.bufs[i].len );
+	pad_out( pF, ( AR_ALIGN - bt.bufs[i].len % AR_ALIGN ) % AR_ALIGN );
+    }
+
+done:
+    if( bt.error ) pF->error = 1;
+    for( i = 0; i < bt.nTemps; i++ ) free( bt.temps[i] );
+    _free( fb.buf );
+}
+
+
+/*
+ *  MUD_writeArrow() - write runs into an Arrow IPC file (see above);
+ *  returns the number of runs written, or -1 if the file cannot be
+ *  written.
+ */
+int
+MUD_writeArrow( char* filename, int num, char** files, int nThreads )
+{
+    AR_FILE f;
+    FB fb;
+    UINT8 b[24];
+    UINT32* pCounts = NULL;
+    size_t runBytes, schemaOff, blocksOff;
+    int block, i, status = -1;
+
+    bzero( &f, sizeof( f ) );
+    bzero( &fb, sizeof( fb ) );
+    if( ( f.pExp = MUD_exportOpen( num, files, nThreads ) ) == NULL ) return( -1 );
+    runBytes = (size_t)f.pExp->maxHists*f.pExp->maxBins*sizeof( UINT32 );
+    block = MUD_exportBlock( f.pExp );
+    if( ( pCounts = (UINT32*)malloc( block*runBytes + 1 ) ) == NULL ||
+	( f.pBlocks = (AR_BLOCK*)zalloc( ( f.pExp->nRuns/block + 1 )*sizeof( AR_BLOCK ) ) ) == NULL ||
+	( f.fout = fopen( filename, "wb" ) ) == NULL ) goto done;
+
+    out( &f, "ARROW1\0\0", 8 );
+    message( &f, AR_SCHEMA, schema( &fb, f.pExp ), &fb, 0, NULL );
+
+    for( i = 0; i < f.pExp->nRuns && !f.error; i += block )
+    {
+	MUD_exportCounts( f.pExp, i, _min( block, f.pExp->nRuns - i ), pCounts );
+	write_batch( &f, i, _min( block, f.pExp->nRuns - i ), pCounts );
+    }
+
+    /*
+     *  End of stream, then Footer { version, schema, dictionaries,
+     *  recordBatches } and its length
+     */
+    put_32( b, 0xFFFFFFFFU );
+    put_32( b + 4, 0 );
+    out( &f, b, 8 );
+
+    _free( fb.buf );
+    bzero( &fb, sizeof( fb ) );
+    fb_start_structs( &fb, f.nBlocks, 24 );
+    for( i = f.nBlocks - 1; i >= 0; i-- )
+    {
+	bzero( b, sizeof( b ) );
+	put_64( b, (UINT64)f.pBlocks[i].offset );
+	put_32( b + 8, (UINT32)f.pBlocks[i].metaLength );
+	put_64( b + 16, (UINT64)f.pBlocks[i].bodyLength );
+	fb_push( &fb, b, 24 );
+    }
+    blocksOff = fb_end_vector( &fb, f.nBlocks );
+    schemaOff = schema( &fb, f.pExp );
+    fb_start_table( &fb );
+    fb_add_offset( &fb, 1, schemaOff );
+    fb_add_offset( &fb, 3, blocksOff );
+    fb_add_int( &fb, 0, AR_V5, 2 );
+    fb_finish( &fb, fb_end_table( &fb ) );
+    if( fb.error ) goto done;
+
+    out( &f, fb.buf + fb.cap - fb.head, fb.head );
+    put_32( b, (UINT32)fb.head );
+    out( &f, b, 4 );
+    out( &f, "ARROW1", 6 );
+    if( !f.error ) status = f.pExp->nRuns;
+
+done:
+    if( f.fout != NULL && fclose( f.fout ) != 0 ) status = -1;
+    if( f.fout != NULL && status < 0 ) remove( filename );
+    MUD_exportClose( f.pExp );
+    _free( f.pBlocks );
+    _free( pCounts );
+    _free( fb.buf );
+    return( status );
+}
@@ -0,0 +1,508 @@
+/*
+ *  mud_async.c -- write runs from a background thread, so that the
+ *                 acquisition hands over a snapshot and goes on
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version
+ *          18-Oct-2026      Sync every file written at close; keep the
+ *                           snapshot replaced if the new one cannot be
+ *                           copied
+ *
+ *  Description:
+ *    MUD_asyncSubmit() copies a snapshot of a run, as a MUD_IMPORT_RUN
+ *    (see mud_import.c), into one of two buffers and returns; a writer
+ *    thread, started by MUD_asyncOpen(), takes the buffers in turn, and
+ *    builds (packing the histograms, variable-bin too, as bytesPerBin
+ *    says), encodes and writes each run by way of a temporary file.  So
+ *    while one snapshot is written the next can be handed over; the
+ *    acquisition waits on neither the packing nor the disk.
+ *
+ *    When both buffers are taken, MUD_asyncSubmit() waits for one, or,
+ *    without wait, returns 0 at once for the caller to try later; with
+ *    MUD_ASYNC_LATEST the snapshot instead replaces the one waiting to
+ *    be written, which is dropped (for checkpoints, where only the
+ *    latest matters); the new snapshot is copied into a spare buffer
+ *    first, so if that fails the one waiting is still written.
+ *    MUD_asyncPending() tells how many buffers are taken.  With
+ *    MUD_ASYNC_FSYNC each file is synced to the disk before it is
+ *    renamed into place; without it, the files written are listed and
+ *    each is synced at MUD_asyncClose() (once, if it was written again
+ *    and again).
+ *
+ *    The count buffers are kept from one snapshot to the next, growing
+ *    as needed.  Without MUD_THREADS (see mud_thread.c) there is no
+ *    writer thread, and MUD_asyncSubmit() writes the run before it
+ *    returns.
+ */
+
+#include "mud.h"
+
+#ifdef MUD_THREADS
+#include <pthread.h>
+#endif /* MUD_THREADS */
+
+#ifdef _WIN32
+#include <io.h>
+#include <process.h>
+#define getpid _getpid
+#define fsync _commit
+#else
+#include <unistd.h>
+#endif /* _WIN32 */
+
+#define ASYNC_NBUFS	2
+
+typedef struct {
+    MUD_IMPORT_RUN imp;		/* the copy */
+    char*	outFile;
+    UINT32*	pCounts;	/* kept between snapshots */
+    size_t	countsMax;	/* UINT32s allocated */
+} ASYNC_BUF;
+
+struct _MUD_ASYNC {
+    int		flags;
+    int		nThreads;	/* for packing */
+    int		nFailed;	/* writes, since the last MUD_asyncWait */
+    char**	ppWritten;	/* files written, to sync at close */
+    int		nWritten;
+    int		maxWritten;
+    ASYNC_BUF	bufs[ASYNC_NBUFS];
+    ASYNC_BUF	spare;		/* for a snapshot replacing one */
+#ifdef MUD_THREADS
+    pthread_t	tid;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;	/* a buffer taken or freed */
+    int		head;		/* next to write */
+    int		nQueued;	/* buffers taken, including one being written */
+    int		stop;
+#endif /* MUD_THREADS */
+};
+
+static char* dup_str _ANSI_ARGS_(( char* s ));
+static void free_copy _ANSI_ARGS_(( ASYNC_BUF* pBuf ));
+static int sync_file _ANSI_ARGS_(( char* filename ));
+static int note_written _ANSI_ARGS_(( MUD_ASYNC* pAsync, char* outFile ));
+static int write_run _ANSI_ARGS_(( MUD_ASYNC* pAsync, MUD_IMPORT_RUN* pImp, char* outFile ));
+#ifdef MUD_THREADS
+static int copy_run _ANSI_ARGS_(( ASYNC_BUF* pBuf, MUD_IMPORT_RUN* pImp, char* outFile ));
+static void* writer _ANSI_ARGS_(( void* pA ));
+#endif /* MUD_THREADS */
+
+
+static char*
+dup_str( char* s )
+{
+    char* p;
+
+    if( s == NULL ) return( NULL );
+    if( ( p = (char*)malloc( strlen( s ) + 1 ) ) != NULL ) strcpy( p, s );
+    return( p );
+}
+
+
+#ifdef MUD_THREADS
+/*
+ *  copy_run() - a snapshot into a buffer; returns 1 on success, 0 if
+ *  out of memory
+ */
+static int
+copy_run( ASYNC_BUF* pBuf, MUD_IMPORT_RUN* pImp, char* outFile )
+{
+    MUD_EXPORT_RUN* pRun = &pBuf->imp.run;
+    size_t nCounts;
+    UINT32 i;
+    int j;
+    void* p;
+
+    nCounts = (size_t)pImp->run.nHists*pImp->binStride;
+    if( nCounts > pBuf->countsMax )
+    {
+	if( ( p = realloc( pBuf->pCounts, nCounts*sizeof( UINT32 ) ) ) == NULL ) return( 0 );
+	pBuf->pCounts = (UINT32*)p;
+	pBuf->countsMax = nCounts;
+    }
+    if( nCounts > 0 ) bcopy( pImp->pCounts, pBuf->pCounts, nCounts*sizeof( UINT32 ) );
+
+    bcopy( pImp, &pBuf->imp, sizeof( MUD_IMPORT_RUN ) );
+    pBuf->imp.pCounts = pBuf->pCounts;
+    for( i = 0; i < MUD_SHM_NSTR; i++ )
+    {
+	pRun->str[i] = dup_str( pImp->run.str[i] );
+    }
+    pRun->pHistVals = (UINT32*)zalloc( pRun->nHists*MUD_EXP_NHISTVALS*sizeof( UINT32 ) + 1 );
+    pRun->pHistTitles = (char**)zalloc( pRun->nHists*sizeof( char* ) + 1 );
+    pBuf->imp.pMetaNames = (char**)zalloc( pImp->nMeta*sizeof( char* ) + 1 );
+    pBuf->imp.pMetaValues = (char**)zalloc( pImp->nMeta*sizeof( char* ) + 1 );
+    pBuf->outFile = dup_str( outFile );
+    if( pRun->pHistVals == NULL || pRun->pHistTitles == NULL || pBuf->outFile == NULL ||
+	pBuf->imp.pMetaNames == NULL || pBuf->imp.pMetaValues == NULL )
+    {
+	free_copy( pBuf );
+	return( 0 );
+    }
+    if( pImp->run.pHistVals != NULL )
+	bcopy( pImp->run.pHistVals, pRun->pHistVals,
+	       pRun->nHists*MUD_EXP_NHISTVALS*sizeof( UINT32 ) );
+    for( i = 0; pImp->run.pHistTitles != NULL && i < pRun->nHists; i++ )
+    {
+	pRun->pHistTitles[i] = dup_str( pImp->run.pHistTitles[i] );
+    }
+    for( j = 0; j < pImp->nMeta; j++ )
+    {
+	pBuf->imp.pMetaNames[j] = dup_str( pImp->pMetaNames[j] );
+	pBuf->imp.pMetaValues[j] = dup_str( pImp->pMetaValues[j] );
+    }
+    return( 1 );
+}
+#endif /* MUD_THREADS */
+
+
+/*
+ *  free_copy() - the copy of a snapshot, but not its count buffer
+ */
+static void
+free_copy( ASYNC_BUF* pBuf )
+{
+    MUD_EXPORT_RUN* pRun = &pBuf->imp.run;
+    UINT32 i;
+    int j;
+
+    for( i = 0; i < MUD_SHM_NSTR; i++ )
+    {
+	_free( pRun->str[i] );
+    }
+    if( pRun->pHistTitles != NULL )
+    {
+	for( i = 0; i < pRun->nHists; i++ )
+	{
+	    _free( pRun->pHistTitles[i] );
+	}
+	free( pRun->pHistTitles );
+    }
+    _free( pRun->pHistVals );
+    for( j = 0; j < pBuf->imp.nMeta; j++ )
+    {
+	if( pBuf->imp.pMetaNames != NULL ) { _free( pBuf->imp.pMetaNames[j] ); }
+	if( pBuf->imp.pMetaValues != NULL ) { _free( pBuf->imp.pMetaValues[j] ); }
+    }
+    _free( pBuf->imp.pMetaNames );
+    _free( pBuf->imp.pMetaValues );
+    _free( pBuf->outFile );
+    bzero( &pBuf->imp, sizeof( MUD_IMPORT_RUN ) );
+}
+
+
+static int
+sync_file( char* filename )
+{
+    FILE* f;
+    int status;
+
+    if( ( f = fopen( filename, "r+b" ) ) == NULL ) return( 0 );
+    status = ( fsync( fileno( f ) ) == 0 );
+    fclose( f );
+    return( status );
+}
+
+
+/*
+ *  note_written() - list a file written, to be synced at close, unless it
+ *  is already; returns 0 if out of memory
+ */
+static int
+note_written( MUD_ASYNC* pAsync, char* outFile )
+{
+    void* p;
+    int i, max;
+
+    for( i = pAsync->nWritten - 1; i >= 0; i-- )
+    {
+	if( strcmp( pAsync->ppWritten[i], outFile ) == 0 ) return( 1 );
+    }
+    if( pAsync->nWritten == pAsync->maxWritten )
+    {
+	max = 2*pAsync->maxWritten + 16;
+	if( ( p = realloc( pAsync->ppWritten, max*sizeof( char* ) ) ) == NULL ) return( 0 );
+	pAsync->ppWritten = (char**)p;
+	pAsync->maxWritten = max;
+    }
+    if( ( pAsync->ppWritten[pAsync->nWritten] = dup_str( outFile ) ) == NULL ) return( 0 );
+    pAsync->nWritten++;
+    return( 1 );
+}
+
+
+/*
+ *  write_run() - build a run and write it as outFile, by way of a
+ *  temporary file; returns 1 on success, 0 on failure
+ */
+static int
+write_run( MUD_ASYNC* pAsync, MUD_IMPORT_RUN* pImp, char* outFile )
+{
+    MUD_SEC_GRP* pMUD_fileGrp;
+    FILE* fout;
+    char* tmpname;
+    int status = 0;
+
+    if( ( pMUD_fileGrp = (MUD_SEC_GRP*)MUD_importBuild( pImp, pAsync->nThreads ) ) == NULL )
+	return( 0 );
+    if( ( tmpname = (char*)malloc( strlen( outFile ) + 24 ) ) == NULL )
+    {
+	MUD_free( pMUD_fileGrp );
+	return( 0 );
+    }
+    sprintf( tmpname, "%s.%lu.tmp", outFile, (unsigned long)getpid() );
+
+    if( ( fout = MUD_openOutput( tmpname ) ) != NULL )
+    {
+	status = MUD_writeFile( fout, pMUD_fileGrp );
+	if( fflush( fout ) != 0 ) status = 0;
+	if( status && ( pAsync->flags & MUD_ASYNC_FSYNC ) &&
+	    fsync( fileno( fout ) ) != 0 ) status = 0;
+	if( fclose( fout ) != 0 ) status = 0;
+	if( status )
+	{
+#ifdef _WIN32
+	    remove( outFile );
+#endif /* _WIN32 */
+	    status = ( rename( tmpname, outFile ) == 0 );
+	}
+	if( !status ) remove( tmpname );
+    }
+    free( tmpname );
+    MUD_free( pMUD_fileGrp );
+
+    if( status && !( pAsync->flags & MUD_ASYNC_FSYNC ) )
+	status = note_written( pAsync, outFile );
+    return( status );
+}
+
+
+#ifdef MUD_THREADS
+static void*
+writer( void* pA )
+{
+    MUD_ASYNC* pAsync = (MUD_ASYNC*)pA;
+    ASYNC_BUF* pBuf;
+    int status;
+
+    pthread_mutex_lock( &pAsync->lock );
+    for( ;; )
+    {
+	while( pAsync->nQueued == 0 && !pAsync->stop )
+	{
+	    pthread_cond_wait( &pAsync->cond, &pAsync->lock );
+	}
+	if( pAsync->nQueued == 0 ) break;
+	pBuf = &pAsync->bufs[pAsync->head];
+	pthread_mutex_unlock( &pAsync->lock );
+
+	status = write_run( pAsync, &pBuf->imp, pBuf->outFile );
+
+	pthread_mutex_lock( &pAsync->lock );
+	free_copy( pBuf );
+	if( !status ) pAsync->nFailed++;
+	pAsync->head = ( pAsync->head + 1 ) % ASYNC_NBUFS;
+	pAsync->nQueued--;
+	pthread_cond_broadcast( &pAsync->cond );
+    }
+    pthread_mutex_unlock( &pAsync->lock );
+    return( NULL );
+}
+#endif /* MUD_THREADS */
+
+
+/*
+ *  MUD_asyncOpen() - start a writer; flags are MUD_ASYNC_FSYNC and
+ *  MUD_ASYNC_LATEST (see above), and nThreads the threads that pack
+ *  the histograms (as for MUD_parallelFor).  Returns NULL on failure.
+ */
+MUD_ASYNC*
+MUD_asyncOpen( int flags, int nThreads )
+{
+    MUD_ASYNC* pAsync;
+
+    if( ( pAsync = (MUD_ASYNC*)zalloc( sizeof( MUD_ASYNC ) ) ) == NULL ) return( NULL );
+    pAsync->flags = flags;
+    pAsync->nThreads = nThreads;
+#ifdef MUD_THREADS
+    pthread_mutex_init( &pAsync->lock, NULL );
+    pthread_cond_init( &pAsync->cond, NULL );
+    if( pthread_create( &pAsync->tid, NULL, writer, pAsync ) != 0 )
+    {
+	pthread_cond_destroy( &pAsync->cond );
+	pthread_mutex_destroy( &pAsync->lock );
+	free( pAsync );
+	return( NULL );
+    }
+#endif /* MUD_THREADS */
+    return( pAsync );
+}
+
+
+/*
+ *  MUD_asyncSubmit() - hand over a snapshot of a run, to be written as
+ *  outFile; pImp may be changed or freed as soon as this returns.
+ *  Returns 1 if it was taken, 2 if it was taken in place of one waiting
+ *  (MUD_ASYNC_LATEST), 0 if both buffers are taken and wait is 0, or -1
+ *  if out of memory.  Failures to write are told by MUD_asyncWait().
+ */
+int
+MUD_asyncSubmit( MUD_ASYNC* pAsync, MUD_IMPORT_RUN* pImp, char* outFile, int wait )
+{
+#ifdef MUD_THREADS
+    ASYNC_BUF* pBuf;
+    ASYNC_BUF swap;
+    int status = 1;
+
+    if( pAsync == NULL || pImp == NULL || outFile == NULL ) return( -1 );
+
+    pthread_mutex_lock( &pAsync->lock );
+    while( pAsync->nQueued == ASYNC_NBUFS )
+    {
+	if( pAsync->flags & MUD_ASYNC_LATEST ) break;
+	if( !wait )
+	{
+	    pthread_mutex_unlock( &pAsync->lock );
+	    return( 0 );
+	}
+	pthread_cond_wait( &pAsync->cond, &pAsync->lock );
+    }
+
+    /*
+     *  The last buffer taken is waiting (the writer has the head), so
+     *  it can be replaced, once the snapshot is copied (to the spare,
+     *  which then trades places with it)
+     */
+    if( pAsync->nQueued == ASYNC_NBUFS )
+    {
+	if( !copy_run( &pAsync->spare, pImp, outFile ) )
+	{
+	    pthread_mutex_unlock( &pAsync->lock );
+	    return( -1 );
+	}
+	pBuf = &pAsync->bufs[( pAsync->head + ASYNC_NBUFS - 1 ) % ASYNC_NBUFS];
+	swap = *pBuf;
+	*pBuf = pAsync->spare;
+	pAsync->spare = swap;
+	free_copy( &pAsync->spare );
+	status = 2;
+    }
+    else
+    {
+	pBuf = &pAsync->bufs[( pAsync->head + pAsync->nQueued ) % ASYNC_NBUFS];
+	if( !copy_run( pBuf, pImp, outFile ) )
+	{
+	    pthread_mutex_unlock( &pAsync->lock );
+	    return( -1 );
+	}
+	pAsync->nQueued++;
+    }
+    pthread_cond_broadcast( &pAsync->cond );
+    pthread_mutex_unlock( &pAsync->lock );
+    return( status );
+#else
+    if( pAsync == NULL || pImp == NULL || outFile == NULL ) return( -1 );
+    if( !write_run( pAsync, pImp, outFile ) ) pAsync->nFailed++;
+    return( 1 );
+#endif /* MUD_THREADS */
+}
+
+
+/*
+ *  MUD_asyncPending() - the number of buffers taken (0 .. 2), counting
+ *  the one being written; at 2 the next submission waits, is turned
+ *  down, or replaces one.
+ */
+int
+MUD_asyncPending( MUD_ASYNC* pAsync )
+{
+#ifdef MUD_THREADS
+    int n;
+
+    pthread_mutex_lock( &pAsync->lock );
+    n = pAsync->nQueued;
+    pthread_mutex_unlock( &pAsync->lock );
+    return( n );
+#else
+    return( 0 );
+#endif /* MUD_THREADS */
+}
+
+
+/*
+ *  MUD_asyncWait() - wait until all snapshots handed over are written;
+ *  returns 1 if all since the last wait were written, else 0.
+ */
+int
+MUD_asyncWait( MUD_ASYNC* pAsync )
+{
+    int status;
+
+    if( pAsync == NULL ) return( 0 );
+#ifdef MUD_THREADS
+    pthread_mutex_lock( &pAsync->lock );
+    while( pAsync->nQueued > 0 )
+    {
+	pthread_cond_wait( &pAsync->cond, &pAsync->lock );
+    }
+#endif /* MUD_THREADS */
+    status = ( pAsync->nFailed == 0 );
+    pAsync->nFailed = 0;
+#ifdef MUD_THREADS
+    pthread_mutex_unlock( &pAsync->lock );
+#endif /* MUD_THREADS */
+    return( status );
+}
+
+
+/*
+ *  MUD_asyncClose() - write what is left, sync each file written
+ *  (unless each was, with MUD_ASYNC_FSYNC) and stop the writer; returns
+ *  as MUD_asyncWait(), and 0 if a file could not be synced.
+ */
+int
+MUD_asyncClose( MUD_ASYNC* pAsync )
+{
+    int status, i;
+
+    if( pAsync == NULL ) return( 0 );
+    status = MUD_asyncWait( pAsync );
+#ifdef MUD_THREADS
+    pthread_mutex_lock( &pAsync->lock );
+    pAsync->stop = 1;
+    pthread_cond_broadcast( &pAsync->cond );
+    pthread_mutex_unlock( &pAsync->lock );
+    pthread_join( pAsync->tid, NULL );
+    pthread_cond_destroy( &pAsync->cond );
+    pthread_mutex_destroy( &pAsync->lock );
+#endif /* MUD_THREADS */
+
+    for( i = 0; i < pAsync->nWritten; i++ )
+    {
+	if( !sync_file( pAsync->ppWritten[i] ) ) status = 0;
+	free( pAsync->ppWritten[i] );
+    }
+    _free( pAsync->ppWritten );
+    for( i = 0; i < ASYNC_NBUFS; i++ )
+    {
+	free_copy( &pAsync->bufs[i] );
+	_free( pAsync->bufs[i].pCounts );
+    }
+    free_copy( &pAsync->spare );
+    _free( pAsync->spare.pCounts );
+    free( pAsync );
+    return( status );
+}
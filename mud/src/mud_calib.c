@@ -0,0 +1,635 @@
+/*
+ *  mud_calib.c -- detector balance (alpha) calibration from
+ *                 transverse-field runs, and the calibration cache
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026  DJA Initial version
+ *          18-Oct-2026  DJA Check the record count of a cache against its size
+ *
+ *  Description:
+ *    In a transverse-field run the muon polarization precesses, so the
+ *    true asymmetry A(t) = (F - alpha*B)/(F + alpha*B) of a forward/
+ *    backward pair averages to zero over the good bins.  alpha is found
+ *    by starting from the ratio of background-subtracted sums, SF/SB,
+ *    and then adjusting it until the error-weighted mean of A(t) (the
+ *    asymmetry baseline) is zero:  alpha' = alpha*(1+A0)/(1-A0).
+ *
+ *    Histogram pairs are identified by their titles: a "forward-like"
+ *    name (F, Forw, Forward, Front, L, Left, U, Up, Top) matched with the
+ *    corresponding "backward-like" name (B, Back, ...) followed by the
+ *    same suffix, ignoring case and blanks.  So "F+"/"B+", "Forw"/"Back"
+ *    and "L1"/"R1" are pairs.
+ *
+ *    The calibration cache is a small binary file of MUD_ALPHA records
+ *    sorted by (run number, apparatus), so a lookup is a binary search
+ *    reading a handful of records:
+ *
+ *      char    magic[8]      "MUDALPHA"
+ *      UINT32  version       1
+ *      UINT32  num           number of records
+ *      num x record          ALPHA_REC_SIZE bytes each
+ *
+ *    Integers are little-endian and doubles are in the same format as
+ *    in MUD files (bencode_4, bencode_double).
+ */
+
+#include <math.h>
+#include "mud.h"
+
+#define ALPHA_CACHE_MAGIC	"MUDALPHA"
+#define ALPHA_CACHE_VERSION	1
+#define ALPHA_HDR_SIZE		16
+#define ALPHA_PAIR_SIZE		( 8 + 2*4 + 3*8 )
+#define ALPHA_REC_SIZE		( 4*4 + 16 + MUD_ALPHA_MAX_PAIRS*ALPHA_PAIR_SIZE )
+#define ALPHA_MAX_ITER		20
+
+/*
+ *  Forward-like and backward-like title prefixes; longer names first
+ *  so that "Forw" is not taken as "F" + "orw".
+ */
+static char* pairNames[][3] = {
+    { "forward", "backward", "F/B" },
+    { "forw",	 "back",     "F/B" },
+    { "front",	 "back",     "F/B" },
+    { "f",	 "b",	     "F/B" },
+    { "left",	 "right",    "L/R" },
+    { "l",	 "r",	     "L/R" },
+    { "up",	 "down",     "U/D" },
+    { "top",	 "bottom",   "U/D" },
+    { "u",	 "d",	     "U/D" },
+};
+#define N_PAIR_NAMES ( sizeof( pairNames )/sizeof( pairNames[0] ) )
+
+typedef struct {
+    char**	filenames;
+    MUD_ALPHA*	pAlpha;
+} ALPHA_BATCH;
+
+static void norm_title _ANSI_ARGS_(( char* title, char* out, int len ));
+static UINT32* get_hist _ANSI_ARGS_(( MUD_SEC_GRP* pMUD_histGrp, UINT32 num, MUD_SEC_GEN_HIST_HDR** ppHdr ));
+static int solve_pair _ANSI_ARGS_(( MUD_SEC_GRP* pMUD_histGrp, MUD_ALPHA_PAIR* pPair ));
+static void alpha_task _ANSI_ARGS_(( int task, int thread, void* pArg ));
+static int key_cmp _ANSI_ARGS_(( UINT32 run1, char* app1, UINT32 run2, char* app2 ));
+static int alpha_cmp _ANSI_ARGS_(( const void* p1, const void* p2 ));
+static void encode_rec _ANSI_ARGS_(( char* b, MUD_ALPHA* pAlpha ));
+static void decode_rec _ANSI_ARGS_(( char* b, MUD_ALPHA* pAlpha ));
+static FILE* open_cache _ANSI_ARGS_(( char* cachename, UINT32* pNum ));
+
+
+/*
+ *  Lower-case copy of a title without blanks
+ */
+static void
+norm_title( char* title, char* out, int len )
+{
+    int i = 0;
+
+    if( title != NULL )
+    {
+	for( ; *title != '\0' && i < len - 1; title++ )
+	{
+	    if( *title == ' ' || *title == '\t' ) continue;
+	    out[i++] = ( *title >= 'A' && *title <= 'Z' ) ? *title - 'A' + 'a' : *title;
+	}
+    }
+    out[i] = '\0';
+}
+
+
+/*
+ *  MUD_alphaPairs() - find the forward/backward-like histogram pairs
+ *  of a histogram group by their titles.  Returns the number of pairs
+ *  put in pPairs (at most max); only label, hist1 and hist2 are set.
+ */
+int
+MUD_alphaPairs( MUD_SEC_GRP* pMUD_histGrp, MUD_ALPHA_PAIR* pPairs, int max )
+{
+    MUD_SEC_GEN_HIST_HDR* pHdr1;
+    MUD_SEC_GEN_HIST_HDR* pHdr2;
+    char t1[64], t2[64], want[64];
+    int nHists, nPairs;
+    int i, j, k;
+    size_t len;
+
+    nHists = pMUD_histGrp->num/2;
+    nPairs = 0;
+
+    for( i = 1; i <= nHists && nPairs < max; i++ )
+    {
+	pHdr1 = (MUD_SEC_GEN_HIST_HDR*)MUD_search( pMUD_histGrp->pMem,
+			     MUD_SEC_GEN_HIST_HDR_ID, (UINT32)i, (UINT32)0 );
+	if( pHdr1 == NULL ) continue;
+	norm_title( pHdr1->title, t1, sizeof( t1 ) );
+
+	for( k = 0; k < N_PAIR_NAMES; k++ )
+	{
+	    len = strlen( pairNames[k][0] );
+	    if( strncmp( t1, pairNames[k][0], len ) != 0 ) continue;
+	    if( strlen( pairNames[k][1] ) + strlen( &t1[len] ) >= sizeof( want ) ) continue;
+	    strcpy( want, pairNames[k][1] );
+	    strcat( want, &t1[len] );
+
+	    for( j = 1; j <= nHists; j++ )
+	    {
+		if( j == i ) continue;
+		pHdr2 = (MUD_SEC_GEN_HIST_HDR*)MUD_search( pMUD_histGrp->pMem,
+				     MUD_SEC_GEN_HIST_HDR_ID, (UINT32)j, (UINT32)0 );
+		if( pHdr2 == NULL ) continue;
+		norm_title( pHdr2->title, t2, sizeof( t2 ) );
+		if( strcmp( t2, want ) == 0 ) break;
+	    }
+	    if( j > nHists ) continue;
+
+	    bzero( &pPairs[nPairs], sizeof( MUD_ALPHA_PAIR ) );
+	    strncpy( pPairs[nPairs].label, pairNames[k][2], sizeof( pPairs[nPairs].label ) - 1 );
+	    strncat( pPairs[nPairs].label, &t1[len],
+		     sizeof( pPairs[nPairs].label ) - 1 - strlen( pPairs[nPairs].label ) );
+	    pPairs[nPairs].hist1 = i;
+	    pPairs[nPairs].hist2 = j;
+	    nPairs++;
+	    break;
+	}
+    }
+
+    return( nPairs );
+}
+
+
+/*
+ *  Unpacked copy (4 bytes per bin) of histogram num; free() it after use.
+ */
+static UINT32*
+get_hist( MUD_SEC_GRP* pMUD_histGrp, UINT32 num, MUD_SEC_GEN_HIST_HDR** ppHdr )
+{
+    MUD_SEC_GEN_HIST_DAT* pDat;
+    UINT32* pData;
+
+    *ppHdr = (MUD_SEC_GEN_HIST_HDR*)MUD_search( pMUD_histGrp->pMem,
+			  MUD_SEC_GEN_HIST_HDR_ID, num, (UINT32)0 );
+    pDat = (MUD_SEC_GEN_HIST_DAT*)MUD_search( pMUD_histGrp->pMem,
+			  MUD_SEC_GEN_HIST_DAT_ID, num, (UINT32)0 );
+    if( *ppHdr == NULL || pDat == NULL || pDat->pData == NULL ||
+	(*ppHdr)->nBins == 0 ) return( NULL );
+
+    pData = (UINT32*)zalloc( (*ppHdr)->nBins*sizeof( UINT32 ) );
+    if( pData == NULL ) return( NULL );
+
+    MUD_SEC_GEN_HIST_unpackData( (*ppHdr)->nBins, (*ppHdr)->bytesPerBin, pDat->pData, pDat->nBytes,
+			     4, pData );
+    return( pData );
+}
+
+
+static int
+solve_pair( MUD_SEC_GRP* pMUD_histGrp, MUD_ALPHA_PAIR* pPair )
+{
+    MUD_SEC_GEN_HIST_HDR* pHdr[2];
+    UINT32* pData[2];
+    REAL64 bkgd[2], bkgdVar[2], sum[2], sumVar[2];
+    REAL64 alpha, f, b, d, a, w, sw, swa, a0;
+    UINT32 lo, hi, i;
+    int h, iter;
+    int status = 0;
+
+    pData[0] = get_hist( pMUD_histGrp, pPair->hist1, &pHdr[0] );
+    pData[1] = get_hist( pMUD_histGrp, pPair->hist2, &pHdr[1] );
+    if( pData[0] == NULL || pData[1] == NULL ) goto done;
+
+    /*
+     *  Common good range; without good bins use everything after t0
+     */
+    lo = _max( pHdr[0]->goodBin1, pHdr[1]->goodBin1 );
+    hi = _min( pHdr[0]->goodBin2, pHdr[1]->goodBin2 );
+    hi = _min( hi, _min( pHdr[0]->nBins, pHdr[1]->nBins ) - 1 );
+    if( hi <= lo )
+    {
+	lo = _max( pHdr[0]->t0_bin, pHdr[1]->t0_bin ) + 1;
+	hi = _min( pHdr[0]->nBins, pHdr[1]->nBins ) - 1;
+	if( hi <= lo ) goto done;
+    }
+
+    for( h = 0; h < 2; h++ )
+    {
+	bkgd[h] = bkgdVar[h] = 0.0;
+	if( pHdr[h]->bkgd2 > pHdr[h]->bkgd1 && pHdr[h]->bkgd2 < pHdr[h]->nBins )
+	{
+	    for( i = pHdr[h]->bkgd1; i <= pHdr[h]->bkgd2; i++ ) bkgd[h] += pData[h][i];
+	    bkgd[h] /= ( pHdr[h]->bkgd2 - pHdr[h]->bkgd1 + 1 );
+	    bkgdVar[h] = bkgd[h]/( pHdr[h]->bkgd2 - pHdr[h]->bkgd1 + 1 );
+	}
+
+	sum[h] = sumVar[h] = 0.0;
+	for( i = lo; i <= hi; i++ ) sum[h] += pData[h][i];
+	sumVar[h] = sum[h] + (REAL64)( hi - lo + 1 )*( hi - lo + 1 )*bkgdVar[h];
+	sum[h] -= ( hi - lo + 1 )*bkgd[h];
+    }
+    if( sum[0] <= 0.0 || sum[1] <= 0.0 ) goto done;
+
+    pPair->ratio = sum[0]/sum[1];
+    pPair->alpha = pPair->ratio;
+    pPair->alphaErr = pPair->ratio*sqrt( sumVar[0]/( sum[0]*sum[0] ) +
+					 sumVar[1]/( sum[1]*sum[1] ) );
+    status = 1;
+
+    /*
+     *  Match the asymmetry baseline: weighted mean of A(t) = 0, with
+     *  var(A) = 4 alpha^2 ( b^2 var(f) + f^2 var(b) )/( f + alpha b )^4
+     */
+    alpha = pPair->ratio;
+    for( iter = 0; iter < ALPHA_MAX_ITER; iter++ )
+    {
+	sw = swa = 0.0;
+	for( i = lo; i <= hi; i++ )
+	{
+	    f = pData[0][i] - bkgd[0];
+	    b = pData[1][i] - bkgd[1];
+	    d = f + alpha*b;
+	    if( d <= 0.0 || pData[0][i] == 0 || pData[1][i] == 0 ) continue;
+	    a = ( f - alpha*b )/d;
+	    w = 4.0*alpha*alpha*( b*b*( pData[0][i] + bkgdVar[0] ) +
+				  f*f*( pData[1][i] + bkgdVar[1] ) )/( d*d*d*d );
+	    if( w <= 0.0 ) continue;
+	    w = 1.0/w;
+	    sw += w;
+	    swa += w*a;
+	}
+	if( sw <= 0.0 ) break;
+
+	a0 = swa/sw;
+	if( a0 <= -1.0 || a0 >= 1.0 ) break;
+	alpha *= ( 1.0 + a0 )/( 1.0 - a0 );
+	pPair->alpha = alpha;
+	pPair->alphaErr = 2.0*alpha/( ( 1.0 - a0*a0 )*sqrt( sw ) );
+	if( fabs( a0 ) < 1.0e-10 ) break;
+    }
+
+done:
+    _free( pData[0] );
+    _free( pData[1] );
+    return( status );
+}
+
+
+/*
+ *  MUD_alphaSolve() - alpha of every histogram pair of a file (as read
+ *  by MUD_readFile).  Returns 1 if at least one pair was solved.
+ */
+int
+MUD_alphaSolve( MUD_SEC_GRP* pMUD_fileGrp, MUD_ALPHA* pAlpha )
+{
+    MUD_SEC_GEN_RUN_DESC* pDesc;
+    MUD_SEC_TRI_TI_RUN_DESC* pIdesc;
+    MUD_SEC_GRP* pMUD_histGrp;
+    MUD_ALPHA_PAIR pairs[MUD_ALPHA_MAX_PAIRS];
+    char* apparatus = NULL;
+    int nPairs, i;
+
+    bzero( pAlpha, sizeof( MUD_ALPHA ) );
+    if( pMUD_fileGrp == NULL ) return( 0 );
+
+    pDesc = (MUD_SEC_GEN_RUN_DESC*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_GEN_RUN_DESC_ID, (UINT32)1, (UINT32)0 );
+    pIdesc = (MUD_SEC_TRI_TI_RUN_DESC*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_TRI_TI_RUN_DESC_ID, (UINT32)1, (UINT32)0 );
+    if( pDesc != NULL )
+    {
+	pAlpha->runNumber = pDesc->runNumber;
+	pAlpha->exptNumber = pDesc->exptNumber;
+	apparatus = pDesc->apparatus;
+    }
+    else if( pIdesc != NULL )
+    {
+	pAlpha->runNumber = pIdesc->runNumber;
+	pAlpha->exptNumber = pIdesc->exptNumber;
+	apparatus = pIdesc->apparatus;
+    }
+    if( apparatus != NULL )
+	strncpy( pAlpha->apparatus, apparatus, sizeof( pAlpha->apparatus ) - 1 );
+
+    pMUD_histGrp = (MUD_SEC_GRP*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_GRP_ID, MUD_GRP_TRI_TD_HIST_ID, (UINT32)0 );
+    if( pMUD_histGrp == NULL )
+	pMUD_histGrp = (MUD_SEC_GRP*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_GRP_ID, MUD_GRP_TRI_TI_HIST_ID, (UINT32)0 );
+    if( pMUD_histGrp == NULL ) return( 0 );
+
+    nPairs = MUD_alphaPairs( pMUD_histGrp, pairs, MUD_ALPHA_MAX_PAIRS );
+    for( i = 0; i < nPairs; i++ )
+    {
+	if( solve_pair( pMUD_histGrp, &pairs[i] ) )
+	    pAlpha->pair[pAlpha->nPairs++] = pairs[i];
+    }
+
+    pAlpha->status = ( pAlpha->nPairs > 0 );
+    return( pAlpha->status );
+}
+
+
+static void
+alpha_task( int task, int thread, void* pArg )
+{
+    ALPHA_BATCH* pB = (ALPHA_BATCH*)pArg;
+    MUD_SEC_GRP* pMUD_fileGrp;
+    FILE* fin;
+
+    bzero( &pB->pAlpha[task], sizeof( MUD_ALPHA ) );
+    if( ( fin = MUD_openInput( pB->filenames[task] ) ) == NULL ) return;
+
+    pMUD_fileGrp = (MUD_SEC_GRP*)MUD_readFile( fin );
+    fclose( fin );
+    if( pMUD_fileGrp == NULL ) return;
+
+    MUD_alphaSolve( pMUD_fileGrp, &pB->pAlpha[task] );
+    MUD_free( pMUD_fileGrp );
+}
+
+
+/*
+ *  MUD_alphaBatch() - solve alpha for num calibration runs, reading
+ *  the files on nThreads threads (0 for the default; see MUD_numThreads).
+ *  pAlpha[i] gets the result for filenames[i], with status 0 if the file
+ *  could not be read or had no usable pair.  Returns the number solved.
+ */
+int
+MUD_alphaBatch( int num, char** filenames, MUD_ALPHA* pAlpha, int nThreads )
+{
+    ALPHA_BATCH batch;
+    int i, nSolved;
+
+    batch.filenames = filenames;
+    batch.pAlpha = pAlpha;
+    MUD_parallelFor( num, nThreads, alpha_task, &batch );
+
+    for( i = 0, nSolved = 0; i < num; i++ )
+    {
+	if( pAlpha[i].status ) nSolved++;
+    }
+    return( nSolved );
+}
+
+
+/*
+ *  Cache keys: run number, then apparatus ignoring case
+ */
+static int
+key_cmp( UINT32 run1, char* app1, UINT32 run2, char* app2 )
+{
+    int i, c1, c2;
+
+    if( run1 != run2 ) return( ( run1 < run2 ) ? -1 : 1 );
+    for( i = 0; i < 16; i++ )
+    {
+	c1 = ( app1[i] >= 'a' && app1[i] <= 'z' ) ? app1[i] - 'a' + 'A' : app1[i];
+	c2 = ( app2[i] >= 'a' && app2[i] <= 'z' ) ? app2[i] - 'a' + 'A' : app2[i];
+	if( c1 != c2 ) return( c1 - c2 );
+	if( c1 == '\0' ) break;
+    }
+    return( 0 );
+}
+
+
+static int
+alpha_cmp( const void* p1, const void* p2 )
+{
+    MUD_ALPHA* pA1 = (MUD_ALPHA*)p1;
+    MUD_ALPHA* pA2 = (MUD_ALPHA*)p2;
+
+    return( key_cmp( pA1->runNumber, pA1->apparatus, pA2->runNumber, pA2->apparatus ) );
+}
+
+
+static void
+encode_rec( char* b, MUD_ALPHA* pAlpha )
+{
+    MUD_ALPHA_PAIR* pPair;
+    int i;
+
+    bzero( b, ALPHA_REC_SIZE );
+    bencode_4( b, &pAlpha->runNumber );
+    bencode_4( b + 4, &pAlpha->exptNumber );
+    bencode_4( b + 8, &pAlpha->status );
+    bencode_4( b + 12, &pAlpha->nPairs );
+    bcopy( pAlpha->apparatus, b + 16, 16 );
+    b += 32;
+    for( i = 0; i < MUD_ALPHA_MAX_PAIRS; i++, b += ALPHA_PAIR_SIZE )
+    {
+	pPair = &pAlpha->pair[i];
+	bcopy( pPair->label, b, 8 );
+	bencode_4( b + 8, &pPair->hist1 );
+	bencode_4( b + 12, &pPair->hist2 );
+	bencode_double( b + 16, &pPair->alpha );
+	bencode_double( b + 24, &pPair->alphaErr );
+	bencode_double( b + 32, &pPair->ratio );
+    }
+}
+
+
+static void
+decode_rec( char* b, MUD_ALPHA* pAlpha )
+{
+    MUD_ALPHA_PAIR* pPair;
+    int i;
+
+    bdecode_4( b, &pAlpha->runNumber );
+    bdecode_4( b + 4, &pAlpha->exptNumber );
+    bdecode_4( b + 8, &pAlpha->status );
+    bdecode_4( b + 12, &pAlpha->nPairs );
+    bcopy( b + 16, pAlpha->apparatus, 16 );
+    pAlpha->apparatus[15] = '\0';
+    pAlpha->nPairs = _min( pAlpha->nPairs, MUD_ALPHA_MAX_PAIRS );
+    b += 32;
+    for( i = 0; i < MUD_ALPHA_MAX_PAIRS; i++, b += ALPHA_PAIR_SIZE )
+    {
+	pPair = &pAlpha->pair[i];
+	bcopy( b, pPair->label, 8 );
+	pPair->label[7] = '\0';
+	bdecode_4( b + 8, &pPair->hist1 );
+	bdecode_4( b + 12, &pPair->hist2 );
+	bdecode_double( b + 16, &pPair->alpha );
+	bdecode_double( b + 24, &pPair->alphaErr );
+	bdecode_double( b + 32, &pPair->ratio );
+    }
+}
+
+
+/*
+ *  Open the cache and check its header; NULL if absent or not a cache,
+ *  or if the file is too short for the records it claims
+ */
+static FILE*
+open_cache( char* cachename, UINT32* pNum )
+{
+    FILE* fin;
+    char hdr[ALPHA_HDR_SIZE];
+    UINT32 version;
+    long size;
+
+    if( ( fin = fopen( cachename, "rb" ) ) == NULL ) return( NULL );
+    if( fseek( fin, 0, SEEK_END ) != 0 || ( size = ftell( fin ) ) < ALPHA_HDR_SIZE ||
+	fseek( fin, 0, SEEK_SET ) != 0 ||
+	fread( hdr, ALPHA_HDR_SIZE, 1, fin ) != 1 ||
+	strncmp( hdr, ALPHA_CACHE_MAGIC, 8 ) != 0 )
+    {
+	fclose( fin );
+	return( NULL );
+    }
+    bdecode_4( hdr + 8, &version );
+    bdecode_4( hdr + 12, pNum );
+    if( version != ALPHA_CACHE_VERSION ||
+	*pNum > (UINT64)( size - ALPHA_HDR_SIZE )/ALPHA_REC_SIZE )
+    {
+	fclose( fin );
+	return( NULL );
+    }
+    return( fin );
+}
+
+
+/*
+ *  MUD_alphaCacheUpdate() - merge num results into the cache file
+ *  (created if need be), replacing records with the same run number and
+ *  apparatus.  Unsolved results (status 0) are not stored.  The new cache
+ *  is written beside the old and renamed over it.  Returns 1 on success.
+ */
+int
+MUD_alphaCacheUpdate( char* cachename, int num, MUD_ALPHA* pAlpha )
+{
+    FILE* fio;
+    MUD_ALPHA* pAll;
+    char rec[ALPHA_REC_SIZE];
+    char hdr[ALPHA_HDR_SIZE];
+    char* tmpname;
+    UINT32 nOld = 0, nAll, version, i, j;
+    int status = 0;
+
+    if( ( fio = open_cache( cachename, &nOld ) ) == NULL ) nOld = 0;
+
+    pAll = (MUD_ALPHA*)zalloc( ( nOld + num + 1 )*sizeof( MUD_ALPHA ) );
+    if( pAll == NULL )
+    {
+	if( fio != NULL ) fclose( fio );
+	return( 0 );
+    }
+
+    /*
+     *  New results first, so after a stable merge they win over old ones
+     */
+    for( i = 0, nAll = 0; i < num; i++ )
+    {
+	if( pAlpha[i].status ) pAll[nAll++] = pAlpha[i];
+    }
+    for( i = 0; i < nOld; i++ )
+    {
+	if( fread( rec, ALPHA_REC_SIZE, 1, fio ) != 1 ) break;
+	decode_rec( rec, &pAll[nAll++] );
+    }
+    if( fio != NULL ) fclose( fio );
+
+    /*
+     *  qsort is not stable, so tag each record with its arrival order
+     *  (in status, which is 1 for all stored records) to keep the newest.
+     */
+    for( i = 0; i < nAll; i++ ) pAll[i].status = i + 1;
+    qsort( pAll, nAll, sizeof( MUD_ALPHA ), alpha_cmp );
+    for( i = 0, j = 0; i < nAll; i++ )
+    {
+	if( j > 0 && alpha_cmp( &pAll[j-1], &pAll[i] ) == 0 )
+	{
+	    if( pAll[i].status < pAll[j-1].status ) pAll[j-1] = pAll[i];
+	    continue;
+	}
+	pAll[j++] = pAll[i];
+    }
+    nAll = j;
+
+    tmpname = (char*)zalloc( strlen( cachename ) + 8 );
+    if( tmpname == NULL ) goto done;
+    strcpy( tmpname, cachename );
+    strcat( tmpname, ".tmp" );
+
+    if( ( fio = fopen( tmpname, "wb" ) ) == NULL ) goto done;
+    bzero( hdr, sizeof( hdr ) );
+    bcopy( ALPHA_CACHE_MAGIC, hdr, 8 );
+    version = ALPHA_CACHE_VERSION;
+    bencode_4( hdr + 8, &version );
+    bencode_4( hdr + 12, &nAll );
+    status = ( fwrite( hdr, ALPHA_HDR_SIZE, 1, fio ) == 1 );
+    for( i = 0; i < nAll && status; i++ )
+    {
+	pAll[i].status = 1;
+	encode_rec( rec, &pAll[i] );
+	status = ( fwrite( rec, ALPHA_REC_SIZE, 1, fio ) == 1 );
+    }
+    if( fclose( fio ) != 0 ) status = 0;
+
+    if( status )
+    {
+#ifdef _WIN32
+	remove( cachename );
+#endif /* _WIN32 */
+	status = ( rename( tmpname, cachename ) == 0 );
+    }
+    if( !status ) remove( tmpname );
+
+done:
+    _free( tmpname );
+    free( pAll );
+    return( status );
+}
+
+
+/*
+ *  MUD_alphaCacheLookup() - find the calibration of a run and apparatus
+ *  in the cache.  Returns 1 if found, 0 if not.
+ */
+int
+MUD_alphaCacheLookup( char* cachename, UINT32 runNumber, char* apparatus, MUD_ALPHA* pAlpha )
+{
+    FILE* fin;
+    char rec[ALPHA_REC_SIZE];
+    char key[16];
+    UINT32 num, lo, hi, mid;
+    int cmp;
+
+    if( ( fin = open_cache( cachename, &num ) ) == NULL ) return( 0 );
+
+    bzero( key, sizeof( key ) );
+    strncpy( key, apparatus, sizeof( key ) - 1 );
+
+    lo = 0;
+    hi = num;
+    while( lo < hi )
+    {
+	mid = lo + ( hi - lo )/2;
+	if( fseek( fin, ALPHA_HDR_SIZE + (long)mid*ALPHA_REC_SIZE, SEEK_SET ) != 0 ||
+	    fread( rec, ALPHA_REC_SIZE, 1, fin ) != 1 ) break;
+	decode_rec( rec, pAlpha );
+
+	cmp = key_cmp( runNumber, key, pAlpha->runNumber, pAlpha->apparatus );
+	if( cmp == 0 )
+	{
+	    fclose( fin );
+	    return( 1 );
+	}
+	if( cmp < 0 )
+	    hi = mid;
+	else
+	    lo = mid + 1;
+    }
+
+    fclose( fin );
+    bzero( pAlpha, sizeof( MUD_ALPHA ) );
+    return( 0 );
+}
@@ -0,0 +1,1566 @@
+/*
+ *  mud_catalog.c -- catalog of the runs in directories of MUD files
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026  DJA Initial version
+ *          18-Oct-2026      File fingerprints; incremental refresh
+ *          18-Oct-2026      Parsed temperature and field columns
+ *          18-Oct-2026  DJA Bound the counts in a catalog file by its size
+ *          18-Oct-2026  DJA Add MUD_catalogFindRunFiles (MUD-C files too)
+ *
+ *  Description:
+ *    The catalog has one row per run file, holding the run description,
+ *    a summary of the histogram headers (number, bins, bin width, total
+ *    events and titles), the scalers and the independent variables.  It
+ *    is kept by column: each numeric column is an array of UINT32 or
+ *    UINT64, and each string column an array of string numbers into a
+ *    table of interned strings, so the many repeats of apparatus, sample,
+ *    experimenter etc. are stored once.  The temperature and field
+ *    strings are also parsed (MUD_parseQuantity) into REAL64 columns in
+ *    K and G, with their uncertainties and parse status, so that range
+ *    queries on them need no string work; the value is NaN where the
+ *    string has no number or an unknown unit.
+ *
+ *    Files are found by walking the directories (with getdents64 and
+ *    statx on Linux, which read many entries per system call), and are
+ *    read on several threads with MUD_readHeaders, which skips over the
+ *    histogram data.
+ *
+ *    Each row also holds the fingerprint of its file: device, inode,
+ *    size, modification time in ns and, optionally, a hash of the first
+ *    CAT_HEAD_BYTES bytes (the file group index and run description,
+ *    which catches headers patched without a change of time).  A
+ *    refresh (MUD_catalogUpdate) fingerprints the files found, re-reads
+ *    only those that are new or whose fingerprint changed, drops the
+ *    rows of files that are gone, and then compacts the columns and the
+ *    string table in place.
+ *
+ *    The catalog file holds (all integers little-endian):
+ *
+ *      char    magic[8]      "MUDCATLG"
+ *      UINT32  version       1
+ *      UINT32  num           number of rows
+ *      UINT32  nCols         number of columns stored
+ *      UINT32  nStrings      number of interned strings
+ *      UINT32  strBytes      size of the string table
+ *      UINT32  reserved
+ *      nCols x { UINT32 column, UINT32 type }
+ *      nCols x column data   num x 4 or num x 8 bytes each
+ *      nStrings x UINT32     offset of each string in the string table
+ *      strBytes              '\0'-terminated strings
+ *
+ *    A REAL64 column is stored as the UINT64 of its IEEE bits (and marked
+ *    as type MUD_CAT_UINT64).  Columns not known to the reader are
+ *    skipped, and columns missing from the file read as zero, so the
+ *    column set can grow; the parsed columns, if missing, are made from
+ *    the strings.
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE		/* for statx */
+#endif /* __linux__ */
+
+#include <ctype.h>
+#include "mud.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif /* __linux__ */
+
+#define CAT_MAGIC		"MUDCATLG"
+#define CAT_VERSION		1
+#define CAT_HDR_SIZE		32
+#define CAT_BATCH_SIZE		4096	/* files read per parallel batch */
+#define CAT_DIRBUF		65536	/* bytes of directory entries per call */
+#define CAT_SUMMARY		1024	/* longest joined summary string */
+#define CAT_HEAD_BYTES		4096	/* bytes covered by the header hash */
+#define CAT_NPRINT		5	/* MUD_CAT_DEV .. MUD_CAT_HEAD_HASH */
+
+typedef struct {
+    char*	name;
+    int		type;
+} CAT_COLDEF;
+
+static CAT_COLDEF colDefs[MUD_CAT_NCOLS] = {
+    { "path",		MUD_CAT_STRING },
+    { "run",		MUD_CAT_UINT32 },
+    { "expt",		MUD_CAT_UINT32 },
+    { "format",		MUD_CAT_UINT32 },
+    { "timeBegin",	MUD_CAT_UINT32 },
+    { "timeEnd",	MUD_CAT_UINT32 },
+    { "elapsedSec",	MUD_CAT_UINT32 },
+    { "title",		MUD_CAT_STRING },
+    { "lab",		MUD_CAT_STRING },
+    { "area",		MUD_CAT_STRING },
+    { "method",		MUD_CAT_STRING },
+    { "apparatus",	MUD_CAT_STRING },
+    { "insert",		MUD_CAT_STRING },
+    { "sample",		MUD_CAT_STRING },
+    { "orient",		MUD_CAT_STRING },
+    { "das",		MUD_CAT_STRING },
+    { "experimenter",	MUD_CAT_STRING },
+    { "temperature",	MUD_CAT_STRING },
+    { "field",		MUD_CAT_STRING },
+    { "nHists",		MUD_CAT_UINT32 },
+    { "nBins",		MUD_CAT_UINT32 },
+    { "fsPerBin",	MUD_CAT_UINT32 },
+    { "events",		MUD_CAT_UINT64 },
+    { "histTitles",	MUD_CAT_STRING },
+    { "nScalers",	MUD_CAT_UINT32 },
+    { "scalers",	MUD_CAT_STRING },
+    { "nIndVars",	MUD_CAT_UINT32 },
+    { "indVars",	MUD_CAT_STRING },
+    { "dev",		MUD_CAT_UINT64 },
+    { "ino",		MUD_CAT_UINT64 },
+    { "size",		MUD_CAT_UINT64 },
+    { "mtime",		MUD_CAT_UINT64 },
+    { "headHash",	MUD_CAT_UINT64 },
+    { "tempK",		MUD_CAT_REAL64 },
+    { "tempErr",	MUD_CAT_REAL64 },
+    { "tempStatus",	MUD_CAT_UINT32 },
+    { "fieldG",		MUD_CAT_REAL64 },
+    { "fieldErr",	MUD_CAT_REAL64 },
+    { "fieldStatus",	MUD_CAT_UINT32 }
+};
+
+/* One run as read, before its strings are interned */
+typedef struct {
+    int		ok;
+    UINT64	val[MUD_CAT_NCOLS];
+    REAL64	real[MUD_CAT_NCOLS];
+    char*	str[MUD_CAT_NCOLS];
+} CAT_ROW;
+
+typedef struct {
+    char**	files;
+    CAT_ROW*	pRows;
+    UINT64*	pPrints;	/* CAT_NPRINT per file, for print_task */
+    int		hashHead;
+} CAT_BATCH;
+
+/* Growable list of paths, for the directory walk */
+typedef struct {
+    int		num;
+    int		alloc;
+    char**	paths;
+} CAT_LIST;
+
+static UINT32 hash_str _ANSI_ARGS_(( char* s ));
+static int rehash _ANSI_ARGS_(( MUD_CATALOG* pCat, UINT32 size ));
+static int find_str _ANSI_ARGS_(( MUD_CATALOG* pCat, char* s, UINT32* pNum, UINT32* pSlot ));
+static int intern _ANSI_ARGS_(( MUD_CATALOG* pCat, char* s, UINT32* pNum ));
+static int compact_strings _ANSI_ARGS_(( MUD_CATALOG* pCat ));
+static void compact_rows _ANSI_ARGS_(( MUD_CATALOG* pCat, char* pKeep, UINT32 num ));
+static int grow_rows _ANSI_ARGS_(( MUD_CATALOG* pCat, UINT32 num ));
+static int col_size _ANSI_ARGS_(( int col ));
+static int file_type _ANSI_ARGS_(( int col ));
+static void parse_qty _ANSI_ARGS_(( char* s, int kind, REAL64* pValue, REAL64* pError, UINT32* pStatus ));
+static void parse_rows _ANSI_ARGS_(( MUD_CATALOG* pCat ));
+static char* join_path _ANSI_ARGS_(( char* dir, char* name ));
+static int list_add _ANSI_ARGS_(( CAT_LIST* pList, char* path ));
+static int is_run_file _ANSI_ARGS_(( char* name, int mudc ));
+static void walk _ANSI_ARGS_(( CAT_LIST* pFiles, char* top, int mudc ));
+static char** find_files _ANSI_ARGS_(( int nDirs, char** dirs, int mudc, int* pNum ));
+static int cmp_paths _ANSI_ARGS_(( const void* p1, const void* p2 ));
+static void append _ANSI_ARGS_(( char* buf, char* text ));
+static char* dup_str _ANSI_ARGS_(( char* s ));
+static void read_run _ANSI_ARGS_(( MUD_SEC_GRP* pMUD_fileGrp, CAT_ROW* pRow ));
+static int get_print _ANSI_ARGS_(( char* path, FILE* fin, int hashHead, UINT64* pPrint ));
+static void print_task _ANSI_ARGS_(( int task, int thread, void* pArg ));
+static void row_task _ANSI_ARGS_(( int task, int thread, void* pArg ));
+static void free_row _ANSI_ARGS_(( CAT_ROW* pRow ));
+static int store_row _ANSI_ARGS_(( MUD_CATALOG* pCat, UINT32 row, CAT_ROW* pRow ));
+static int add_files _ANSI_ARGS_(( MUD_CATALOG* pCat, int num, char** files, int* pSlots, char* pKeep, int hashHead, int nThreads ));
+
+
+/*
+ *  MUD_catalogNew() - an empty catalog; NULL if out of memory.
+ */
+MUD_CATALOG*
+MUD_catalogNew( void )
+{
+    MUD_CATALOG* pCat;
+    UINT32 n;
+
+    if( ( pCat = (MUD_CATALOG*)zalloc( sizeof( MUD_CATALOG ) ) ) == NULL )
+	return( NULL );
+
+    /*
+     *  String number 0 is the empty string
+     */
+    if( !intern( pCat, "", &n ) )
+    {
+	MUD_catalogFree( pCat );
+	return( NULL );
+    }
+    return( pCat );
+}
+
+
+void
+MUD_catalogFree( MUD_CATALOG* pCat )
+{
+    int col;
+
+    if( pCat == NULL ) return;
+    for( col = 0; col < MUD_CAT_NCOLS; col++ )
+    {
+	_free( pCat->pCols[col] );
+    }
+    _free( pCat->pStrOff );
+    _free( pCat->pStrings );
+    _free( pCat->pHash );
+    MUD_catalogFreeZones( pCat );
+    free( pCat );
+}
+
+
+/*
+ *  Columns by name and number
+ */
+int
+MUD_catalogColumn( char* name )
+{
+    int col;
+
+    for( col = 0; col < MUD_CAT_NCOLS; col++ )
+    {
+	if( strcmp( name, colDefs[col].name ) == 0 ) return( col );
+    }
+    return( -1 );
+}
+
+
+char*
+MUD_catalogColumnName( int col )
+{
+    if( col < 0 || col >= MUD_CAT_NCOLS ) return( NULL );
+    return( colDefs[col].name );
+}
+
+
+int
+MUD_catalogColumnType( int col )
+{
+    if( col < 0 || col >= MUD_CAT_NCOLS ) return( 0 );
+    return( colDefs[col].type );
+}
+
+
+static int
+col_size( int col )
+{
+    return( ( colDefs[col].type == MUD_CAT_UINT64 ||
+	      colDefs[col].type == MUD_CAT_REAL64 ) ? 8 : 4 );
+}
+
+
+/*
+ *  file_type() - the type of a column as stored in the catalog file
+ */
+static int
+file_type( int col )
+{
+    return( ( colDefs[col].type == MUD_CAT_REAL64 ) ? MUD_CAT_UINT64 : colDefs[col].type );
+}
+
+
+/*
+ *  MUD_catalogValue() - integer value in a row (the string number, for
+ *  a string column); 0 if there is no such row or column, or it is a
+ *  REAL64 column.
+ */
+UINT64
+MUD_catalogValue( MUD_CATALOG* pCat, int row, int col )
+{
+    if( col < 0 || col >= MUD_CAT_NCOLS || row < 0 || (UINT32)row >= pCat->num )
+	return( 0 );
+    if( colDefs[col].type == MUD_CAT_UINT64 )
+	return( ((UINT64*)pCat->pCols[col])[row] );
+    if( colDefs[col].type == MUD_CAT_REAL64 )
+	return( 0 );
+    return( (UINT64)((UINT32*)pCat->pCols[col])[row] );
+}
+
+
+/*
+ *  MUD_catalogReal() - value in a row of a numeric column, as a REAL64;
+ *  0 if there is no such row or column.
+ */
+REAL64
+MUD_catalogReal( MUD_CATALOG* pCat, int row, int col )
+{
+    if( col < 0 || col >= MUD_CAT_NCOLS || row < 0 || (UINT32)row >= pCat->num ||
+	colDefs[col].type == MUD_CAT_STRING ) return( 0.0 );
+    if( colDefs[col].type == MUD_CAT_REAL64 )
+	return( ((REAL64*)pCat->pCols[col])[row] );
+    return( (REAL64)MUD_catalogValue( pCat, row, col ) );
+}
+
+
+/*
+ *  MUD_catalogString() - string in a row of a string column; "" if
+ *  there is no such row or column.
+ */
+char*
+MUD_catalogString( MUD_CATALOG* pCat, int row, int col )
+{
+    UINT32 n;
+
+    if( MUD_catalogColumnType( col ) != MUD_CAT_STRING ) return( "" );
+    n = (UINT32)MUD_catalogValue( pCat, row, col );
+    if( n >= pCat->nStrings ) return( "" );
+    return( &pCat->pStrings[pCat->pStrOff[n]] );
+}
+
+
+/*
+ *  hash_str() - FNV-1a hash of a string, for interning
+ */
+static UINT32
+hash_str( char* s )
+{
+    UINT32 h = 2166136261U;
+
+    for( ; *s != '\0'; s++ )
+    {
+	h ^= (unsigned char)*s;
+	h *= 16777619U;
+    }
+    return( h );
+}
+
+
+/*
+ *  rehash() - rebuild the string hash table with size (a power of 2) slots
+ */
+static int
+rehash( MUD_CATALOG* pCat, UINT32 size )
+{
+    UINT32* pHash;
+    UINT32 h, n;
+
+    if( ( pHash = (UINT32*)zalloc( size*sizeof( UINT32 ) ) ) == NULL ) return( 0 );
+    for( n = 0; n < pCat->nStrings; n++ )
+    {
+	h = hash_str( &pCat->pStrings[pCat->pStrOff[n]] ) & ( size - 1 );
+	while( pHash[h] != 0 ) h = ( h + 1 ) & ( size - 1 );
+	pHash[h] = n + 1;
+    }
+    _free( pCat->pHash );
+    pCat->pHash = pHash;
+    pCat->hashSize = size;
+    return( 1 );
+}
+
+
+/*
+ *  find_str() - look up a string; returns 1 and its number if it is in
+ *  the table, else 0 and the empty hash slot where it would go.
+ */
+static int
+find_str( MUD_CATALOG* pCat, char* s, UINT32* pNum, UINT32* pSlot )
+{
+    UINT32 h, i;
+
+    if( pCat->hashSize == 0 ) return( 0 );
+    h = hash_str( s ) & ( pCat->hashSize - 1 );
+    while( ( i = pCat->pHash[h] ) != 0 )
+    {
+	if( strcmp( &pCat->pStrings[pCat->pStrOff[i-1]], s ) == 0 )
+	{
+	    *pNum = i - 1;
+	    return( 1 );
+	}
+	h = ( h + 1 ) & ( pCat->hashSize - 1 );
+    }
+    *pSlot = h;
+    return( 0 );
+}
+
+
+/*
+ *  intern() - number of a string in the string table, adding it if it is
+ *  new.  Returns 0 if out of memory.
+ */
+static int
+intern( MUD_CATALOG* pCat, char* s, UINT32* pNum )
+{
+    UINT32 h, len, size;
+    void* p;
+
+    /*
+     *  Keep the hash table at most half full
+     */
+    if( 2*( pCat->nStrings + 1 ) > pCat->hashSize &&
+	!rehash( pCat, ( pCat->hashSize == 0 ) ? 1024 : 2*pCat->hashSize ) )
+	return( 0 );
+
+    if( find_str( pCat, s, pNum, &h ) ) return( 1 );
+
+    /*
+     *  A new string
+     */
+    len = strlen( s ) + 1;
+    if( pCat->nStrings == pCat->strAlloc )
+    {
+	size = ( pCat->strAlloc == 0 ) ? 1024 : 2*pCat->strAlloc;
+	if( ( p = realloc( pCat->pStrOff, size*sizeof( UINT32 ) ) ) == NULL ) return( 0 );
+	pCat->pStrOff = (UINT32*)p;
+	pCat->strAlloc = size;
+    }
+    if( pCat->strBytes + len > pCat->strBytesAlloc )
+    {
+	size = ( pCat->strBytesAlloc == 0 ) ? 65536 : 2*pCat->strBytesAlloc;
+	while( size < pCat->strBytes + len ) size *= 2;
+	if( ( p = realloc( pCat->pStrings, size ) ) == NULL ) return( 0 );
+	pCat->pStrings = (char*)p;
+	pCat->strBytesAlloc = size;
+    }
+    bcopy( s, &pCat->pStrings[pCat->strBytes], len );
+    pCat->pStrOff[pCat->nStrings] = pCat->strBytes;
+    pCat->strBytes += len;
+    pCat->pHash[h] = ++pCat->nStrings;
+    *pNum = pCat->nStrings - 1;
+    return( 1 );
+}
+
+
+/*
+ *  compact_strings() - drop the strings no row refers to any more, and
+ *  renumber the rest (keeping their order, so moving them down is safe).
+ */
+static int
+compact_strings( MUD_CATALOG* pCat )
+{
+    UINT32* pMap;
+    UINT32* pCol;
+    UINT32 n, r, len, nStrings = 0, strBytes = 0, size;
+    int col;
+
+    if( ( pMap = (UINT32*)zalloc( pCat->nStrings*sizeof( UINT32 ) ) ) == NULL )
+	return( 0 );
+
+    pMap[0] = 1;
+    for( col = 0; col < MUD_CAT_NCOLS; col++ )
+    {
+	if( colDefs[col].type != MUD_CAT_STRING ) continue;
+	pCol = (UINT32*)pCat->pCols[col];
+	for( r = 0; r < pCat->num; r++ ) pMap[pCol[r]] = 1;
+    }
+
+    for( n = 0; n < pCat->nStrings; n++ )
+    {
+	if( !pMap[n] ) continue;
+	len = strlen( &pCat->pStrings[pCat->pStrOff[n]] ) + 1;
+	memmove( &pCat->pStrings[strBytes], &pCat->pStrings[pCat->pStrOff[n]], len );
+	pCat->pStrOff[nStrings] = strBytes;
+	strBytes += len;
+	pMap[n] = nStrings++;
+    }
+
+    for( col = 0; col < MUD_CAT_NCOLS; col++ )
+    {
+	if( colDefs[col].type != MUD_CAT_STRING ) continue;
+	pCol = (UINT32*)pCat->pCols[col];
+	for( r = 0; r < pCat->num; r++ ) pCol[r] = pMap[pCol[r]];
+    }
+    free( pMap );
+
+    pCat->nStrings = nStrings;
+    pCat->strBytes = strBytes;
+    for( size = 1024; size < 2*( nStrings + 1 ); size *= 2 ) ;
+    return( rehash( pCat, size ) );
+}
+
+
+/*
+ *  compact_rows() - drop the first num rows that are not marked in pKeep
+ *  (rows after num are all kept), moving the rest down in order.
+ */
+static void
+compact_rows( MUD_CATALOG* pCat, char* pKeep, UINT32 num )
+{
+    UINT32 r, w;
+    char* pCol;
+    int col, size;
+
+    MUD_catalogFreeZones( pCat );
+    for( r = 0, w = 0; r < pCat->num; r++ )
+    {
+	if( r < num && !pKeep[r] ) continue;
+	if( w != r )
+	{
+	    for( col = 0; col < MUD_CAT_NCOLS; col++ )
+	    {
+		size = col_size( col );
+		pCol = (char*)pCat->pCols[col];
+		bcopy( pCol + (size_t)r*size, pCol + (size_t)w*size, size );
+	    }
+	}
+	w++;
+    }
+    pCat->num = w;
+}
+
+
+/*
+ *  grow_rows() - make room for num rows in every column; 0 if out of
+ *  memory
+ */
+static int
+grow_rows( MUD_CATALOG* pCat, UINT32 num )
+{
+    UINT32 alloc;
+    void* p;
+    int col;
+
+    if( num <= pCat->alloc ) return( 1 );
+    alloc = ( pCat->alloc == 0 ) ? 256 : pCat->alloc;
+    while( alloc < num ) alloc = ( alloc > 0x7FFFFFFF ) ? num : 2*alloc;
+    if( alloc > ( (size_t)-1 )/sizeof( UINT64 ) ) return( 0 );
+
+    for( col = 0; col < MUD_CAT_NCOLS; col++ )
+    {
+	if( ( p = realloc( pCat->pCols[col], (size_t)alloc*col_size( col ) ) ) == NULL )
+	    return( 0 );
+	bzero( (char*)p + (size_t)pCat->alloc*col_size( col ),
+	       (size_t)( alloc - pCat->alloc )*col_size( col ) );
+	pCat->pCols[col] = p;
+    }
+    pCat->alloc = alloc;
+    return( 1 );
+}
+
+
+/*
+ *  Finding the run files: .msr or .mud, and .mudc if mudc
+ */
+static int
+is_run_file( char* name, int mudc )
+{
+    int len = strlen( name );
+
+    if( mudc && len >= 6 && name[len-5] == '.' &&
+	tolower( (unsigned char)name[len-4] ) == 'm' &&
+	tolower( (unsigned char)name[len-3] ) == 'u' &&
+	tolower( (unsigned char)name[len-2] ) == 'd' &&
+	tolower( (unsigned char)name[len-1] ) == 'c' ) return( 1 );
+    if( len < 5 || name[len-4] != '.' ) return( 0 );
+    return( ( tolower( (unsigned char)name[len-3] ) == 'm' &&
+	      tolower( (unsigned char)name[len-2] ) == 's' &&
+	      tolower( (unsigned char)name[len-1] ) == 'r' ) ||
+	    ( tolower( (unsigned char)name[len-3] ) == 'm' &&
+	      tolower( (unsigned char)name[len-2] ) == 'u' &&
+	      tolower( (unsigned char)name[len-1] ) == 'd' ) );
+}
+
+
+static char*
+join_path( char* dir, char* name )
+{
+    char* path;
+    int len = strlen( dir );
+
+    if( ( path = (char*)malloc( len + strlen( name ) + 2 ) ) == NULL ) return( NULL );
+    strcpy( path, dir );
+    if( len > 0 && dir[len-1] != '/' && name[0] != '\0' ) strcat( path, "/" );
+    strcat( path, name );
+    return( path );
+}
+
+
+/*
+ *  list_add() - add a path (from malloc) to a list, which then owns it
+ */
+static int
+list_add( CAT_LIST* pList, char* path )
+{
+    void* p;
+
+    if( path == NULL ) return( 0 );
+    if( pList->num == pList->alloc )
+    {
+	if( ( p = realloc( pList->paths, ( pList->alloc + 1024 )*2*sizeof( char* ) ) ) == NULL )
+	{
+	    free( path );
+	    return( 0 );
+	}
+	pList->paths = (char**)p;
+	pList->alloc = ( pList->alloc + 1024 )*2;
+    }
+    pList->paths[pList->num++] = path;
+    return( 1 );
+}
+
+
+#if defined(__linux__)
+/* Layout of the entries returned by getdents64 */
+typedef struct {
+    UINT64	d_ino;
+    INT64	d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char	d_name[1];
+} CAT_DIRENT64;
+
+#ifndef DT_UNKNOWN
+#define DT_UNKNOWN	0
+#define DT_DIR		4
+#define DT_REG		8
+#define DT_LNK		10
+#endif /* DT_UNKNOWN */
+
+/*
+ *  entry_type() - DT_DIR or DT_REG for an entry whose type the directory
+ *  did not give (or a symbolic link, which is followed to a file but not
+ *  to a directory, to avoid loops); DT_UNKNOWN for anything else.
+ */
+static int
+entry_type( int dirfd, char* name, int d_type )
+{
+#ifdef STATX_TYPE
+    struct statx stx;
+
+    if( statx( dirfd, name, ( d_type == DT_LNK ) ? 0 : AT_SYMLINK_NOFOLLOW,
+	       STATX_TYPE, &stx ) != 0 ) return( DT_UNKNOWN );
+    if( S_ISREG( stx.stx_mode ) ) return( DT_REG );
+    if( S_ISDIR( stx.stx_mode ) && d_type != DT_LNK ) return( DT_DIR );
+#else
+    struct stat st;
+
+    if( fstatat( dirfd, name, &st, ( d_type == DT_LNK ) ? 0 : AT_SYMLINK_NOFOLLOW ) != 0 )
+	return( DT_UNKNOWN );
+    if( S_ISREG( st.st_mode ) ) return( DT_REG );
+    if( S_ISDIR( st.st_mode ) && d_type != DT_LNK ) return( DT_DIR );
+#endif /* STATX_TYPE */
+    return( DT_UNKNOWN );
+}
+#endif /* __linux__ */
+
+
+/*
+ *  walk() - add the run files under directory top to the list.  The
+ *  directories are done breadth first, from a list, so one buffer of
+ *  entries serves them all.
+ */
+static void
+walk( CAT_LIST* pFiles, char* top, int mudc )
+{
+    CAT_LIST dirs;
+    int d;
+#if defined(__linux__)
+    CAT_DIRENT64* pEnt;
+    char* buf;
+    long nRead, off;
+    int fd, type;
+#else
+    DIR* pDir;
+    struct dirent* pEnt;
+    struct stat st;
+    char* path;
+#endif /* __linux__ */
+
+    bzero( &dirs, sizeof( CAT_LIST ) );
+    if( !list_add( &dirs, join_path( top, "" ) ) ) return;
+
+#if defined(__linux__)
+    if( ( buf = (char*)malloc( CAT_DIRBUF ) ) == NULL ) goto done;
+#endif /* __linux__ */
+
+    for( d = 0; d < dirs.num; d++ )
+    {
+#if defined(__linux__)
+	if( ( fd = open( dirs.paths[d], O_RDONLY | O_DIRECTORY ) ) < 0 ) continue;
+	while( ( nRead = syscall( SYS_getdents64, fd, buf, CAT_DIRBUF ) ) > 0 )
+	{
+	    for( off = 0; off < nRead; off += pEnt->d_reclen )
+	    {
+		pEnt = (CAT_DIRENT64*)( buf + off );
+		if( pEnt->d_name[0] == '.' ) continue;	/* also . and .. */
+
+		type = pEnt->d_type;
+		if( type != DT_DIR && type != DT_REG )
+		{
+		    if( type == DT_LNK && !is_run_file( pEnt->d_name, mudc ) ) continue;
+		    type = entry_type( fd, pEnt->d_name, type );
+		}
+		if( type == DT_DIR )
+		    list_add( &dirs, join_path( dirs.paths[d], pEnt->d_name ) );
+		else if( type == DT_REG && is_run_file( pEnt->d_name, mudc ) )
+		    list_add( pFiles, join_path( dirs.paths[d], pEnt->d_name ) );
+	    }
+	}
+	close( fd );
+#else
+	if( ( pDir = opendir( dirs.paths[d] ) ) == NULL ) continue;
+	while( ( pEnt = readdir( pDir ) ) != NULL )
+	{
+	    if( pEnt->d_name[0] == '.' ) continue;
+	    if( ( path = join_path( dirs.paths[d], pEnt->d_name ) ) == NULL ) break;
+	    if( stat( path, &st ) != 0 )
+		free( path );
+	    else if( S_ISDIR( st.st_mode ) )
+		list_add( &dirs, path );
+	    else if( S_ISREG( st.st_mode ) && is_run_file( pEnt->d_name, mudc ) )
+		list_add( pFiles, path );
+	    else
+		free( path );
+	}
+	closedir( pDir );
+#endif /* __linux__ */
+    }
+
+#if defined(__linux__)
+    free( buf );
+done:
+#endif /* __linux__ */
+    MUD_catalogFreeFiles( dirs.paths, dirs.num );
+}
+
+
+static int
+cmp_paths( const void* p1, const void* p2 )
+{
+    return( strcmp( *(char**)p1, *(char**)p2 ) );
+}
+
+
+/*
+ *  find_files() - the run files in and under the directories, sorted,
+ *  with the .mudc files if mudc
+ */
+static char**
+find_files( int nDirs, char** dirs, int mudc, int* pNum )
+{
+    CAT_LIST files;
+    struct stat st;
+    int i;
+
+    bzero( &files, sizeof( CAT_LIST ) );
+    for( i = 0; i < nDirs; i++ )
+    {
+	if( stat( dirs[i], &st ) == 0 && S_ISDIR( st.st_mode ) )
+	    walk( &files, dirs[i], mudc );
+	else
+	    list_add( &files, join_path( dirs[i], "" ) );
+    }
+    if( files.num > 1 )
+	qsort( files.paths, files.num, sizeof( char* ), cmp_paths );
+
+    *pNum = files.num;
+    return( files.paths );
+}
+
+
+/*
+ *  MUD_catalogFindFiles() - the run files (.msr or .mud) in and under
+ *  the directories, sorted by path.  An argument that is not a directory
+ *  is taken as a file.  Free the list with MUD_catalogFreeFiles.
+ */
+char**
+MUD_catalogFindFiles( int nDirs, char** dirs, int* pNum )
+{
+    return( find_files( nDirs, dirs, 0, pNum ) );
+}
+
+
+/*
+ *  MUD_catalogFindRunFiles() - as MUD_catalogFindFiles, with the MUD-C
+ *  files (.mudc) too, for programs that read the runs with
+ *  MUD_readRunFile.  The catalog itself reads only MUD files.
+ */
+char**
+MUD_catalogFindRunFiles( int nDirs, char** dirs, int* pNum )
+{
+    return( find_files( nDirs, dirs, 1, pNum ) );
+}
+
+
+void
+MUD_catalogFreeFiles( char** files, int num )
+{
+    int i;
+
+    if( files == NULL ) return;
+    for( i = 0; i < num; i++ )
+    {
+	_free( files[i] );
+    }
+    free( files );
+}
+
+
+/*
+ *  Reading the runs
+ */
+static void
+append( char* buf, char* text )
+{
+    int len = strlen( buf );
+
+    if( len > 0 && len < CAT_SUMMARY - 1 ) buf[len++] = ',';
+    strncpy( &buf[len], text, CAT_SUMMARY - 1 - len );
+    buf[CAT_SUMMARY-1] = '\0';
+}
+
+
+static char*
+dup_str( char* s )
+{
+    char* p;
+
+    if( s == NULL ) s = "";
+    if( ( p = (char*)malloc( strlen( s ) + 1 ) ) != NULL ) strcpy( p, s );
+    return( p );
+}
+
+
+/*
+ *  read_run() - catalog values of one run (as read by MUD_readHeaders)
+ */
+static void
+read_run( MUD_SEC_GRP* pMUD_fileGrp, CAT_ROW* pRow )
+{
+    MUD_SEC_GEN_RUN_DESC* pDesc;
+    MUD_SEC_TRI_TI_RUN_DESC* pIdesc;
+    MUD_SEC_GRP* pMUD_grp;
+    MUD_SEC_GEN_HIST_HDR* pHdr;
+    MUD_SEC_GEN_SCALER* pScal;
+    MUD_SEC_GEN_IND_VAR* pVar;
+    char summary[CAT_SUMMARY];
+    char text[256];
+    UINT32 i, status;
+
+    pRow->val[MUD_CAT_FORMAT] = MUD_instanceID( pMUD_fileGrp );
+
+    pDesc = (MUD_SEC_GEN_RUN_DESC*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_GEN_RUN_DESC_ID, (UINT32)1, (UINT32)0 );
+    pIdesc = (MUD_SEC_TRI_TI_RUN_DESC*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_TRI_TI_RUN_DESC_ID, (UINT32)1, (UINT32)0 );
+    if( pDesc != NULL )
+    {
+	pRow->val[MUD_CAT_RUN] = pDesc->runNumber;
+	pRow->val[MUD_CAT_EXPT] = pDesc->exptNumber;
+	pRow->val[MUD_CAT_TIME_BEGIN] = pDesc->timeBegin;
+	pRow->val[MUD_CAT_TIME_END] = pDesc->timeEnd;
+	pRow->val[MUD_CAT_ELAPSED] = pDesc->elapsedSec;
+	pRow->str[MUD_CAT_TITLE] = dup_str( pDesc->title );
+	pRow->str[MUD_CAT_LAB] = dup_str( pDesc->lab );
+	pRow->str[MUD_CAT_AREA] = dup_str( pDesc->area );
+	pRow->str[MUD_CAT_METHOD] = dup_str( pDesc->method );
+	pRow->str[MUD_CAT_APPARATUS] = dup_str( pDesc->apparatus );
+	pRow->str[MUD_CAT_INSERT] = dup_str( pDesc->insert );
+	pRow->str[MUD_CAT_SAMPLE] = dup_str( pDesc->sample );
+	pRow->str[MUD_CAT_ORIENT] = dup_str( pDesc->orient );
+	pRow->str[MUD_CAT_DAS] = dup_str( pDesc->das );
+	pRow->str[MUD_CAT_EXPERIMENTER] = dup_str( pDesc->experimenter );
+	pRow->str[MUD_CAT_TEMPERATURE] = dup_str( pDesc->temperature );
+	pRow->str[MUD_CAT_FIELD] = dup_str( pDesc->field );
+    }
+    else if( pIdesc != NULL )
+    {
+	pRow->val[MUD_CAT_RUN] = pIdesc->runNumber;
+	pRow->val[MUD_CAT_EXPT] = pIdesc->exptNumber;
+	pRow->val[MUD_CAT_TIME_BEGIN] = pIdesc->timeBegin;
+	pRow->val[MUD_CAT_TIME_END] = pIdesc->timeEnd;
+	pRow->val[MUD_CAT_ELAPSED] = pIdesc->elapsedSec;
+	pRow->str[MUD_CAT_TITLE] = dup_str( pIdesc->title );
+	pRow->str[MUD_CAT_LAB] = dup_str( pIdesc->lab );
+	pRow->str[MUD_CAT_AREA] = dup_str( pIdesc->area );
+	pRow->str[MUD_CAT_METHOD] = dup_str( pIdesc->method );
+	pRow->str[MUD_CAT_APPARATUS] = dup_str( pIdesc->apparatus );
+	pRow->str[MUD_CAT_INSERT] = dup_str( pIdesc->insert );
+	pRow->str[MUD_CAT_SAMPLE] = dup_str( pIdesc->sample );
+	pRow->str[MUD_CAT_ORIENT] = dup_str( pIdesc->orient );
+	pRow->str[MUD_CAT_DAS] = dup_str( pIdesc->das );
+	pRow->str[MUD_CAT_EXPERIMENTER] = dup_str( pIdesc->experimenter );
+    }
+
+    /*
+     *  Histogram headers
+     */
+    pMUD_grp = (MUD_SEC_GRP*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_GRP_ID, MUD_GRP_TRI_TD_HIST_ID, (UINT32)0 );
+    if( pMUD_grp == NULL )
+	pMUD_grp = (MUD_SEC_GRP*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_GRP_ID, MUD_GRP_TRI_TI_HIST_ID, (UINT32)0 );
+    if( pMUD_grp != NULL )
+    {
+	summary[0] = '\0';
+	pRow->val[MUD_CAT_NHISTS] = pMUD_grp->num/2;
+	for( i = 1; i <= pMUD_grp->num/2; i++ )
+	{
+	    pHdr = (MUD_SEC_GEN_HIST_HDR*)MUD_search( pMUD_grp->pMem,
+			  MUD_SEC_GEN_HIST_HDR_ID, i, (UINT32)0 );
+	    if( pHdr == NULL ) continue;
+	    if( i == 1 )
+	    {
+		pRow->val[MUD_CAT_NBINS] = pHdr->nBins;
+		pRow->val[MUD_CAT_FS_PER_BIN] = pHdr->fsPerBin;
+	    }
+	    pRow->val[MUD_CAT_EVENTS] += pHdr->nEvents;
+	    append( summary, pHdr->title ? pHdr->title : "" );
+	}
+	pRow->str[MUD_CAT_HIST_TITLES] = dup_str( summary );
+    }
+
+    /*
+     *  Scalers, as label=count
+     */
+    pMUD_grp = (MUD_SEC_GRP*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_GRP_ID, MUD_GRP_TRI_TD_SCALER_ID, (UINT32)0 );
+    if( pMUD_grp == NULL )
+	pMUD_grp = (MUD_SEC_GRP*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_GRP_ID, MUD_GRP_GEN_SCALER_ID, (UINT32)0 );
+    if( pMUD_grp != NULL )
+    {
+	summary[0] = '\0';
+	pRow->val[MUD_CAT_NSCALERS] = pMUD_grp->num;
+	for( i = 1; i <= pMUD_grp->num; i++ )
+	{
+	    pScal = (MUD_SEC_GEN_SCALER*)MUD_search( pMUD_grp->pMem,
+			  MUD_SEC_GEN_SCALER_ID, i, (UINT32)0 );
+	    if( pScal == NULL ) continue;
+	    sprintf( text, "%.200s=%lu", pScal->label ? pScal->label : "",
+		     (unsigned long)pScal->counts[0] );
+	    append( summary, text );
+	}
+	pRow->str[MUD_CAT_SCALERS] = dup_str( summary );
+    }
+
+    /*
+     *  Independent variables, as name=mean units
+     */
+    pMUD_grp = (MUD_SEC_GRP*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_GRP_ID, MUD_GRP_GEN_IND_VAR_ID, (UINT32)0 );
+    if( pMUD_grp == NULL )
+	pMUD_grp = (MUD_SEC_GRP*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_GRP_ID, MUD_GRP_GEN_IND_VAR_ARR_ID, (UINT32)0 );
+    if( pMUD_grp != NULL )
+    {
+	summary[0] = '\0';
+	for( i = 1; ( pVar = (MUD_SEC_GEN_IND_VAR*)MUD_search( pMUD_grp->pMem,
+			  MUD_SEC_GEN_IND_VAR_ID, i, (UINT32)0 ) ) != NULL; i++ )
+	{
+	    sprintf( text, "%.100s=%.6g%s%.40s", pVar->name ? pVar->name : "",
+		     pVar->mean, ( pVar->units && pVar->units[0] ) ? " " : "",
+		     pVar->units ? pVar->units : "" );
+	    append( summary, text );
+	}
+	pRow->val[MUD_CAT_NINDVARS] = i - 1;
+	pRow->str[MUD_CAT_INDVARS] = dup_str( summary );
+    }
+
+    /*
+     *  Temperature and field as numbers
+     */
+    parse_qty( pRow->str[MUD_CAT_TEMPERATURE], MUD_QTY_TEMPERATURE,
+	       &pRow->real[MUD_CAT_TEMP_K], &pRow->real[MUD_CAT_TEMP_ERR], &status );
+    pRow->val[MUD_CAT_TEMP_STATUS] = status;
+    parse_qty( pRow->str[MUD_CAT_FIELD], MUD_QTY_FIELD,
+	       &pRow->real[MUD_CAT_FIELD_G], &pRow->real[MUD_CAT_FIELD_ERR], &status );
+    pRow->val[MUD_CAT_FIELD_STATUS] = status;
+}
+
+
+/*
+ *  parse_qty() - a temperature or field string as numbers, for the
+ *  catalog: NaN unless there is a number, in a known unit or none
+ */
+static void
+parse_qty( char* s, int kind, REAL64* pValue, REAL64* pError, UINT32* pStatus )
+{
+    union { UINT64 u; REAL64 d; } nan;
+
+    *pStatus = (UINT32)MUD_parseQuantity( s, kind, pValue, pError );
+    if( !( *pStatus & MUD_QTY_VALUE ) || ( *pStatus & MUD_QTY_BADUNIT ) )
+    {
+	nan.u = 0x7FF8000000000000ULL;
+	*pValue = nan.d;
+	*pError = nan.d;
+    }
+}
+
+
+/*
+ *  parse_rows() - fill the parsed columns from the strings, for a
+ *  catalog written before they existed
+ */
+static void
+parse_rows( MUD_CATALOG* pCat )
+{
+    UINT32 r;
+
+    for( r = 0; r < pCat->num; r++ )
+    {
+	parse_qty( MUD_catalogString( pCat, (int)r, MUD_CAT_TEMPERATURE ), MUD_QTY_TEMPERATURE,
+		   &((REAL64*)pCat->pCols[MUD_CAT_TEMP_K])[r],
+		   &((REAL64*)pCat->pCols[MUD_CAT_TEMP_ERR])[r],
+		   &((UINT32*)pCat->pCols[MUD_CAT_TEMP_STATUS])[r] );
+	parse_qty( MUD_catalogString( pCat, (int)r, MUD_CAT_FIELD ), MUD_QTY_FIELD,
+		   &((REAL64*)pCat->pCols[MUD_CAT_FIELD_G])[r],
+		   &((REAL64*)pCat->pCols[MUD_CAT_FIELD_ERR])[r],
+		   &((UINT32*)pCat->pCols[MUD_CAT_FIELD_STATUS])[r] );
+    }
+}
+
+
+/*
+ *  get_print() - fingerprint of a file (of the open file fin, if not
+ *  NULL): MUD_CAT_DEV .. MUD_CAT_HEAD_HASH.  The hash is 0 unless
+ *  hashHead is set.  Returns 0 if the file cannot be examined.
+ */
+static int
+get_print( char* path, FILE* fin, int hashHead, UINT64* pPrint )
+{
+    struct stat st;
+    unsigned char buf[CAT_HEAD_BYTES];
+    UINT64 h;
+    FILE* f;
+    size_t i, n;
+
+    if( ( fin != NULL ) ? fstat( fileno( fin ), &st ) : stat( path, &st ) ) return( 0 );
+    pPrint[0] = (UINT64)st.st_dev;
+    pPrint[1] = (UINT64)st.st_ino;
+    pPrint[2] = (UINT64)st.st_size;
+#if defined(__linux__)
+    pPrint[3] = (UINT64)st.st_mtim.tv_sec*1000000000 + (UINT64)st.st_mtim.tv_nsec;
+#else
+    pPrint[3] = (UINT64)st.st_mtime*1000000000;
+#endif /* __linux__ */
+    pPrint[4] = 0;
+    if( !hashHead ) return( 1 );
+
+    /*
+     *  FNV-1a (64-bit) of the head of the file; never 0, so 0 means
+     *  "not hashed"
+     */
+    if( ( f = ( fin != NULL ) ? fin : MUD_openInput( path ) ) == NULL ) return( 0 );
+    rewind( f );
+    n = fread( buf, 1, CAT_HEAD_BYTES, f );
+    if( fin == NULL ) fclose( f );
+    h = 14695981039346656037ULL;
+    for( i = 0; i < n; i++ )
+    {
+	h ^= buf[i];
+	h *= 1099511628211ULL;
+    }
+    pPrint[4] = ( h != 0 ) ? h : 1;
+    return( 1 );
+}
+
+
+static void
+print_task( int task, int thread, void* pArg )
+{
+    CAT_BATCH* pB = (CAT_BATCH*)pArg;
+
+    if( !get_print( pB->files[task], NULL, pB->hashHead, &pB->pPrints[task*CAT_NPRINT] ) )
+	bzero( &pB->pPrints[task*CAT_NPRINT], CAT_NPRINT*sizeof( UINT64 ) );
+}
+
+
+static void
+row_task( int task, int thread, void* pArg )
+{
+    CAT_BATCH* pB = (CAT_BATCH*)pArg;
+    CAT_ROW* pRow = &pB->pRows[task];
+    MUD_SEC_GRP* pMUD_fileGrp;
+    FILE* fin;
+
+    if( ( fin = MUD_openInput( pB->files[task] ) ) == NULL ) return;
+    if( !get_print( pB->files[task], fin, pB->hashHead, &pRow->val[MUD_CAT_DEV] ) ||
+	( pMUD_fileGrp = (MUD_SEC_GRP*)MUD_readHeaders( fin ) ) == NULL )
+    {
+	fclose( fin );
+	return;
+    }
+    fclose( fin );
+
+    if( MUD_secID( pMUD_fileGrp ) == MUD_SEC_GRP_ID )
+    {
+	read_run( pMUD_fileGrp, pRow );
+	pRow->str[MUD_CAT_PATH] = dup_str( pB->files[task] );
+	pRow->ok = 1;
+    }
+    MUD_free( pMUD_fileGrp );
+}
+
+
+static void
+free_row( CAT_ROW* pRow )
+{
+    int col;
+
+    for( col = 0; col < MUD_CAT_NCOLS; col++ )
+    {
+	_free( pRow->str[col] );
+    }
+    bzero( pRow, sizeof( CAT_ROW ) );
+}
+
+
+/*
+ *  store_row() - set a row from a run as read, interning its strings
+ */
+static int
+store_row( MUD_CATALOG* pCat, UINT32 row, CAT_ROW* pRow )
+{
+    UINT32 n;
+    int col;
+
+    MUD_catalogFreeZones( pCat );
+    for( col = 0; col < MUD_CAT_NCOLS; col++ )
+    {
+	switch( colDefs[col].type )
+	{
+	    case MUD_CAT_STRING:
+		if( !intern( pCat, pRow->str[col] ? pRow->str[col] : "", &n ) ) return( 0 );
+		((UINT32*)pCat->pCols[col])[row] = n;
+		break;
+	    case MUD_CAT_UINT64:
+		((UINT64*)pCat->pCols[col])[row] = pRow->val[col];
+		break;
+	    case MUD_CAT_REAL64:
+		((REAL64*)pCat->pCols[col])[row] = pRow->real[col];
+		break;
+	    default:
+		((UINT32*)pCat->pCols[col])[row] = (UINT32)pRow->val[col];
+		break;
+	}
+    }
+    return( 1 );
+}
+
+
+/*
+ *  add_files() - read the files and store a row for each that is a MUD
+ *  file: in row pSlots[i] (marking it in pKeep) if that is >= 0, else in
+ *  a new row.  Returns the number of files read, or -1 if out of memory.
+ */
+static int
+add_files( MUD_CATALOG* pCat, int num, char** files, int* pSlots, char* pKeep,
+	   int hashHead, int nThreads )
+{
+    CAT_BATCH batch;
+    CAT_ROW* pRow;
+    UINT32 row;
+    int first, count, i, added = 0;
+
+    bzero( &batch, sizeof( CAT_BATCH ) );
+    batch.hashHead = hashHead;
+    batch.pRows = (CAT_ROW*)zalloc( CAT_BATCH_SIZE*sizeof( CAT_ROW ) );
+    if( batch.pRows == NULL ) return( -1 );
+
+    for( first = 0; first < num; first += CAT_BATCH_SIZE )
+    {
+	count = _min( num - first, CAT_BATCH_SIZE );
+	batch.files = &files[first];
+	MUD_parallelFor( count, nThreads, row_task, &batch );
+
+	/*
+	 *  Intern the strings, in file order
+	 */
+	if( !grow_rows( pCat, pCat->num + count ) ) goto fail;
+	for( i = 0; i < count; i++ )
+	{
+	    pRow = &batch.pRows[i];
+	    if( !pRow->ok ) continue;
+	    if( pSlots != NULL && pSlots[first+i] >= 0 )
+	    {
+		row = (UINT32)pSlots[first+i];
+		pKeep[row] = 1;
+	    }
+	    else
+	    {
+		row = pCat->num++;
+	    }
+	    if( !store_row( pCat, row, pRow ) ) goto fail;
+	    added++;
+	    free_row( pRow );
+	}
+    }
+    free( batch.pRows );
+    return( added );
+
+fail:
+    for( i = 0; i < CAT_BATCH_SIZE; i++ ) free_row( &batch.pRows[i] );
+    free( batch.pRows );
+    return( -1 );
+}
+
+
+/*
+ *  MUD_catalogAddFiles() - read the files (on nThreads threads; 0 = all
+ *  processors) and add a row for each that is a MUD file.  Returns the
+ *  number of rows added, or -1 if out of memory.
+ */
+int
+MUD_catalogAddFiles( MUD_CATALOG* pCat, int num, char** files, int nThreads )
+{
+    return( add_files( pCat, num, files, NULL, NULL, 0, nThreads ) );
+}
+
+
+/*
+ *  MUD_catalogUpdate() - bring the catalog up to date with the files
+ *  (sorted or not): re-read the new and changed ones, and drop the rows
+ *  of files not in the list.  With hashHead, the head of every file is
+ *  hashed too, and compared when the catalog has a hash for it (and
+ *  stored when it has not).
+ *  Returns the number of files read, or -1 on failure.
+ */
+int
+MUD_catalogUpdate( MUD_CATALOG* pCat, int num, char** files, int hashHead, int nThreads )
+{
+    CAT_BATCH batch;
+    UINT32 oldNum = pCat->num;
+    UINT64* pPrint;
+    int* pRowOf = NULL;
+    int* pSlots = NULL;
+    char** readFiles = NULL;
+    char* pKeep = NULL;
+    UINT32 n, slot, r;
+    int i, j, nRead = 0, status = -1;
+
+    bzero( &batch, sizeof( CAT_BATCH ) );
+    batch.files = files;
+    batch.hashHead = hashHead;
+    batch.pPrints = (UINT64*)zalloc( ( num + 1 )*CAT_NPRINT*sizeof( UINT64 ) );
+    pRowOf = (int*)malloc( pCat->nStrings*sizeof( int ) );
+    pSlots = (int*)malloc( ( num + 1 )*sizeof( int ) );
+    readFiles = (char**)malloc( ( num + 1 )*sizeof( char* ) );
+    pKeep = (char*)zalloc( oldNum + 1 );
+    if( batch.pPrints == NULL || pRowOf == NULL || pSlots == NULL ||
+	readFiles == NULL || pKeep == NULL ) goto done;
+
+    /*
+     *  Row of each path now in the catalog
+     */
+    for( n = 0; n < pCat->nStrings; n++ ) pRowOf[n] = -1;
+    for( r = 0; r < oldNum; r++ ) pRowOf[((UINT32*)pCat->pCols[MUD_CAT_PATH])[r]] = r;
+
+    MUD_parallelFor( num, nThreads, print_task, &batch );
+
+    for( i = 0; i < num; i++ )
+    {
+	if( find_str( pCat, files[i], &n, &slot ) && pRowOf[n] >= 0 )
+	{
+	    r = (UINT32)pRowOf[n];
+	    pRowOf[n] = -1;		/* a repeated path is read again */
+	    pPrint = &batch.pPrints[i*CAT_NPRINT];
+	    for( j = 0; j < CAT_NPRINT - 1; j++ )
+	    {
+		if( ((UINT64*)pCat->pCols[MUD_CAT_DEV+j])[r] != pPrint[j] ) break;
+	    }
+	    if( j == CAT_NPRINT - 1 && pPrint[3] != 0 &&
+		( !hashHead || ((UINT64*)pCat->pCols[MUD_CAT_HEAD_HASH])[r] == 0 ||
+		  ((UINT64*)pCat->pCols[MUD_CAT_HEAD_HASH])[r] == pPrint[4] ) )
+	    {
+		pKeep[r] = 1;
+		if( hashHead ) ((UINT64*)pCat->pCols[MUD_CAT_HEAD_HASH])[r] = pPrint[4];
+		continue;
+	    }
+	    pSlots[nRead] = (int)r;
+	}
+	else
+	{
+	    pSlots[nRead] = -1;
+	}
+	readFiles[nRead++] = files[i];
+    }
+
+    if( ( nRead = add_files( pCat, nRead, readFiles, pSlots, pKeep, hashHead, nThreads ) ) < 0 )
+	goto done;
+
+    compact_rows( pCat, pKeep, oldNum );
+    if( compact_strings( pCat ) ) status = nRead;
+
+done:
+    _free( batch.pPrints );
+    _free( pRowOf );
+    _free( pSlots );
+    _free( readFiles );
+    _free( pKeep );
+    return( status );
+}
+
+
+/*
+ *  MUD_catalogWrite() - write the catalog file; returns 1 on success.
+ *  The file is written under a temporary name and then renamed, so
+ *  readers never see a partial catalog.
+ */
+int
+MUD_catalogWrite( MUD_CATALOG* pCat, char* catname )
+{
+    FILE* fout;
+    char hdr[CAT_HDR_SIZE];
+    char b[8];
+    char* tmpname;
+    UINT64 v;
+    UINT32 u, lo, hi, i;
+    int col, status;
+
+    if( ( tmpname = (char*)malloc( strlen( catname ) + 5 ) ) == NULL ) return( 0 );
+    sprintf( tmpname, "%s.tmp", catname );
+    if( ( fout = fopen( tmpname, "wb" ) ) == NULL )
+    {
+	free( tmpname );
+	return( 0 );
+    }
+
+    bzero( hdr, CAT_HDR_SIZE );
+    bcopy( CAT_MAGIC, hdr, 8 );
+    u = CAT_VERSION;
+    bencode_4( hdr + 8, &u );
+    bencode_4( hdr + 12, &pCat->num );
+    u = MUD_CAT_NCOLS;
+    bencode_4( hdr + 16, &u );
+    bencode_4( hdr + 20, &pCat->nStrings );
+    bencode_4( hdr + 24, &pCat->strBytes );
+    status = ( fwrite( hdr, CAT_HDR_SIZE, 1, fout ) == 1 );
+
+    for( col = 0; col < MUD_CAT_NCOLS && status; col++ )
+    {
+	u = col;
+	bencode_4( b, &u );
+	u = file_type( col );
+	bencode_4( b + 4, &u );
+	status = ( fwrite( b, 8, 1, fout ) == 1 );
+    }
+    for( col = 0; col < MUD_CAT_NCOLS && status; col++ )
+    {
+	for( i = 0; i < pCat->num && status; i++ )
+	{
+	    if( col_size( col ) == 8 )
+	    {
+		bcopy( (char*)pCat->pCols[col] + 8*(size_t)i, &v, 8 );
+		lo = (UINT32)v;
+		hi = (UINT32)( v >> 32 );
+		bencode_4( b, &lo );
+		bencode_4( b + 4, &hi );
+		status = ( fwrite( b, 8, 1, fout ) == 1 );
+	    }
+	    else
+	    {
+		bencode_4( b, &((UINT32*)pCat->pCols[col])[i] );
+		status = ( fwrite( b, 4, 1, fout ) == 1 );
+	    }
+	}
+    }
+    for( i = 0; i < pCat->nStrings && status; i++ )
+    {
+	bencode_4( b, &pCat->pStrOff[i] );
+	status = ( fwrite( b, 4, 1, fout ) == 1 );
+    }
+    if( status && pCat->strBytes > 0 )
+	status = ( fwrite( pCat->pStrings, pCat->strBytes, 1, fout ) == 1 );
+
+    if( fclose( fout ) != 0 ) status = 0;
+    if( status ) status = ( rename( tmpname, catname ) == 0 );
+    if( !status ) remove( tmpname );
+    free( tmpname );
+    return( status );
+}
+
+
+/*
+ *  MUD_catalogRead() - read a catalog file into memory; NULL on failure.
+ */
+MUD_CATALOG*
+MUD_catalogRead( char* catname )
+{
+    FILE* fin;
+    MUD_CATALOG* pCat;
+    char hdr[CAT_HDR_SIZE];
+    char b[8];
+    UINT32* pColIDs = NULL;
+    UINT32* pTypes = NULL;
+    UINT64 v, rest;
+    UINT32 version, num, nCols, nStrings, strBytes, lo, hi, i, j;
+    int col, parsed = 0;
+    long size;
+
+    if( ( fin = fopen( catname, "rb" ) ) == NULL ) return( NULL );
+    if( fseek( fin, 0, SEEK_END ) != 0 || ( size = ftell( fin ) ) < CAT_HDR_SIZE ||
+	fseek( fin, 0, SEEK_SET ) != 0 ||
+	fread( hdr, CAT_HDR_SIZE, 1, fin ) != 1 || strncmp( hdr, CAT_MAGIC, 8 ) != 0 )
+    {
+	fclose( fin );
+	return( NULL );
+    }
+    bdecode_4( hdr + 8, &version );
+    bdecode_4( hdr + 12, &num );
+    bdecode_4( hdr + 16, &nCols );
+    bdecode_4( hdr + 20, &nStrings );
+    bdecode_4( hdr + 24, &strBytes );
+
+    /*
+     *  The columns (of at least 4 bytes a row, and at least one column
+     *  for any rows) and the strings must fit in the rest of the file,
+     *  before anything is allocated for them
+     */
+    rest = (UINT64)( size - CAT_HDR_SIZE );
+    if( version != CAT_VERSION || nStrings == 0 ||
+	8*(UINT64)nCols + 4*(UINT64)num*_max( nCols, 1 ) +
+	  4*(UINT64)nStrings + strBytes > rest ||
+	( pCat = (MUD_CATALOG*)zalloc( sizeof( MUD_CATALOG ) ) ) == NULL )
+    {
+	fclose( fin );
+	return( NULL );
+    }
+
+    pColIDs = (UINT32*)malloc( ( nCols + 1 )*sizeof( UINT32 ) );
+    pTypes = (UINT32*)malloc( ( nCols + 1 )*sizeof( UINT32 ) );
+    if( pColIDs == NULL || pTypes == NULL || !grow_rows( pCat, num ) ) goto fail;
+
+    for( j = 0; j < nCols; j++ )
+    {
+	if( fread( b, 8, 1, fin ) != 1 ) goto fail;
+	bdecode_4( b, &pColIDs[j] );
+	bdecode_4( b + 4, &pTypes[j] );
+	if( pTypes[j] < MUD_CAT_UINT32 || pTypes[j] > MUD_CAT_STRING ) goto fail;
+    }
+    for( j = 0; j < nCols; j++ )
+    {
+	col = (int)pColIDs[j];
+	if( col >= MUD_CAT_NCOLS || (UINT32)file_type( col ) != pTypes[j] )
+	{
+	    /*
+	     *  A column this version does not know
+	     */
+	    if( fseek( fin, (long)num*( ( pTypes[j] == MUD_CAT_UINT64 ) ? 8 : 4 ), SEEK_CUR ) != 0 )
+		goto fail;
+	    continue;
+	}
+	if( col == MUD_CAT_TEMP_STATUS ) parsed = 1;
+	for( i = 0; i < num; i++ )
+	{
+	    if( col_size( col ) == 8 )
+	    {
+		if( fread( b, 8, 1, fin ) != 1 ) goto fail;
+		bdecode_4( b, &lo );
+		bdecode_4( b + 4, &hi );
+		v = ( (UINT64)hi << 32 ) | lo;
+		bcopy( &v, (char*)pCat->pCols[col] + 8*(size_t)i, 8 );
+	    }
+	    else
+	    {
+		if( fread( b, 4, 1, fin ) != 1 ) goto fail;
+		bdecode_4( b, &((UINT32*)pCat->pCols[col])[i] );
+		if( colDefs[col].type == MUD_CAT_STRING &&
+		    ((UINT32*)pCat->pCols[col])[i] >= nStrings ) goto fail;
+	    }
+	}
+    }
+    pCat->num = num;
+
+    pCat->pStrOff = (UINT32*)malloc( nStrings*sizeof( UINT32 ) );
+    pCat->pStrings = (char*)malloc( strBytes + 1 );
+    if( pCat->pStrOff == NULL || pCat->pStrings == NULL ) goto fail;
+    pCat->strAlloc = nStrings;
+    pCat->strBytesAlloc = strBytes + 1;
+    for( i = 0; i < nStrings; i++ )
+    {
+	if( fread( b, 4, 1, fin ) != 1 ) goto fail;
+	bdecode_4( b, &pCat->pStrOff[i] );
+	if( pCat->pStrOff[i] >= strBytes ) goto fail;
+    }
+    if( strBytes > 0 && fread( pCat->pStrings, strBytes, 1, fin ) != 1 ) goto fail;
+    pCat->pStrings[strBytes] = '\0';
+    pCat->strBytes = strBytes;
+    pCat->nStrings = nStrings;
+    if( !parsed ) parse_rows( pCat );
+    fclose( fin );
+    free( pColIDs );
+    free( pTypes );
+
+    /*
+     *  Rebuild the hash table, so rows can still be added
+     */
+    for( j = 1024; j < 2*( nStrings + 1 ); j *= 2 ) ;
+    if( !rehash( pCat, j ) )
+    {
+	MUD_catalogFree( pCat );
+	return( NULL );
+    }
+    return( pCat );
+
+fail:
+    fclose( fin );
+    _free( pColIDs );
+    _free( pTypes );
+    MUD_catalogFree( pCat );
+    return( NULL );
+}
+
+
+/*
+ *  MUD_catalogBuild() - catalog all the run files in and under the
+ *  directories.  Returns the number of runs catalogued, or -1 on
+ *  failure.
+ */
+int
+MUD_catalogBuild( int nDirs, char** dirs, char* catname, int nThreads )
+{
+    MUD_CATALOG* pCat;
+    char** files;
+    int num, n;
+
+    if( ( pCat = MUD_catalogNew() ) == NULL ) return( -1 );
+    files = MUD_catalogFindFiles( nDirs, dirs, &num );
+    n = MUD_catalogAddFiles( pCat, num, files, nThreads );
+    MUD_catalogFreeFiles( files, num );
+    if( n >= 0 && !MUD_catalogWrite( pCat, catname ) ) n = -1;
+    MUD_catalogFree( pCat );
+    return( n );
+}
+
+
+/*
+ *  MUD_catalogRefresh() - update the catalog file for the run files in
+ *  and under the directories, creating it if need be; *pNumRead (if not
+ *  NULL) is set to the number of files read.  Returns the number of runs
+ *  in the catalog, or -1 on failure.
+ */
+int
+MUD_catalogRefresh( char* catname, int nDirs, char** dirs, int hashHead, int nThreads,
+		    int* pNumRead )
+{
+    MUD_CATALOG* pCat;
+    char** files;
+    int num, n;
+
+    if( ( pCat = MUD_catalogRead( catname ) ) == NULL &&
+	( pCat = MUD_catalogNew() ) == NULL ) return( -1 );
+    files = MUD_catalogFindFiles( nDirs, dirs, &num );
+    n = MUD_catalogUpdate( pCat, num, files, hashHead, nThreads );
+    MUD_catalogFreeFiles( files, num );
+    if( pNumRead != NULL ) *pNumRead = n;
+    if( n < 0 || !MUD_catalogWrite( pCat, catname ) )
+	n = -1;
+    else
+	n = (int)pCat->num;
+    MUD_catalogFree( pCat );
+    return( n );
+}
@@ -0,0 +1,930 @@
+/*
+ *  mud_catquery.c -- selecting runs from a run catalog (see mud_catalog.c)
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version
+ *          18-Oct-2026      REAL64 columns
+ *
+ *  Description:
+ *    MUD_catalogSelect( pCat, query, &pRows ) returns the rows matching
+ *    a filter such as
+ *
+ *      temperature BETWEEN 5 AND 10 AND field > 100 AND sample LIKE 'YBCO%'
+ *
+ *    made of comparisons (=, !=, <>, <, <=, >, >=), BETWEEN .. AND ..,
+ *    [NOT] LIKE, AND, OR, NOT and parentheses.  Keywords may be in either
+ *    case; strings are quoted with ' or ", or may be single bare words.
+ *    LIKE patterns use % (any characters) and _ (one character), and
+ *    ignore case.  On a string column a number compares with the number
+ *    the string starts with (so "10.0(1)K" is 10), and a string with the
+ *    whole string; the parsed columns tempK and fieldG are better for
+ *    ranges, as they are in one unit.  A REAL64 column that is NaN (no
+ *    value) fails every comparison but != .
+ *
+ *    A filter is evaluated column by column into a bitmap of rows.  A
+ *    numeric test is a range check, done 8 rows at a time with AVX2 when
+ *    available (REAL64 values are first mapped to UINT64 keys in the
+ *    same order, so they are checked the same way), and skipping whole blocks of MUD_CAT_ZONE rows whose
+ *    minimum and maximum (the zone map, built on the first query) show
+ *    they all match or none do.  A string test is first made once for
+ *    every distinct string in the string table, so the row scan is only
+ *    a table look-up.  The terms of an AND only look at the rows still
+ *    selected by the terms before them.
+ */
+
+#include <ctype.h>
+#include <math.h>
+#include "mud.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif /* __AVX2__ */
+
+/* Node types */
+#define Q_AND		1
+#define Q_OR		2
+#define Q_NOT		3
+#define Q_RANGE		4	/* numeric column (or its key) in [lo, hi] */
+#define Q_STRING	5	/* string column; pMatch by string number */
+
+/* Token types */
+#define T_END		0
+#define T_WORD		1
+#define T_NUMBER	2
+#define T_STRING	3
+#define T_LPAREN	4
+#define T_RPAREN	5
+#define T_OP		6
+
+/* Comparisons */
+#define OP_EQ		1
+#define OP_NE		2
+#define OP_LT		3
+#define OP_LE		4
+#define OP_GT		5
+#define OP_GE		6
+#define OP_BETWEEN	7
+#define OP_LIKE		8
+#define OP_NOT_LIKE	9
+
+#define Q_MAX_TOKEN	256
+
+typedef struct _Q_NODE {
+    int		type;
+    int		col;
+    int		negate;		/* for Q_RANGE: select rows outside the range */
+    UINT64	lo;
+    UINT64	hi;
+    char*	pMatch;		/* for Q_STRING: 1 for matching strings */
+    struct _Q_NODE* pLeft;
+    struct _Q_NODE* pRight;
+} Q_NODE;
+
+typedef struct {
+    MUD_CATALOG* pCat;
+    char*	pos;		/* next character of the query */
+    int		tok;		/* current token */
+    char	text[Q_MAX_TOKEN];
+    double	num;
+    int		error;
+} Q_PARSE;
+
+static void next_token _ANSI_ARGS_(( Q_PARSE* pP ));
+static int is_keyword _ANSI_ARGS_(( Q_PARSE* pP, char* word ));
+static Q_NODE* new_node _ANSI_ARGS_(( Q_PARSE* pP, int type, Q_NODE* pLeft, Q_NODE* pRight ));
+static void free_node _ANSI_ARGS_(( Q_NODE* pNode ));
+static Q_NODE* parse_or _ANSI_ARGS_(( Q_PARSE* pP ));
+static Q_NODE* parse_and _ANSI_ARGS_(( Q_PARSE* pP ));
+static Q_NODE* parse_not _ANSI_ARGS_(( Q_PARSE* pP ));
+static Q_NODE* parse_pred _ANSI_ARGS_(( Q_PARSE* pP ));
+static int get_value _ANSI_ARGS_(( Q_PARSE* pP, int* pIsNum, double* pNum, char* text ));
+static int op_code _ANSI_ARGS_(( char* op ));
+static int op_test _ANSI_ARGS_(( int op, int c ));
+static Q_NODE* num_pred _ANSI_ARGS_(( Q_PARSE* pP, int col, int op, double a, double b ));
+static Q_NODE* real_pred _ANSI_ARGS_(( Q_PARSE* pP, int col, int op, double a, double b ));
+static Q_NODE* str_pred _ANSI_ARGS_(( Q_PARSE* pP, int col, int op, int isNum, double a, double b, char* text ));
+static int like _ANSI_ARGS_(( char* s, char* pat ));
+static UINT64 real_key _ANSI_ARGS_(( REAL64 x ));
+static int build_zones _ANSI_ARGS_(( MUD_CATALOG* pCat ));
+static void scan_range _ANSI_ARGS_(( MUD_CATALOG* pCat, Q_NODE* pNode, UINT64* pCand, UINT64* pOut ));
+static void scan_string _ANSI_ARGS_(( MUD_CATALOG* pCat, Q_NODE* pNode, UINT64* pCand, UINT64* pOut ));
+static int eval _ANSI_ARGS_(( MUD_CATALOG* pCat, Q_NODE* pNode, UINT64* pCand, UINT64* pOut ));
+
+
+/*
+ *  Zone maps: the minimum and maximum of each numeric column over each
+ *  block of MUD_CAT_ZONE rows.  They are dropped whenever rows change.
+ */
+void
+MUD_catalogFreeZones( MUD_CATALOG* pCat )
+{
+    int col;
+
+    for( col = 0; col < MUD_CAT_NCOLS; col++ )
+    {
+	_free( pCat->pZoneMin[col] );
+	_free( pCat->pZoneMax[col] );
+    }
+    pCat->nZones = 0;
+}
+
+
+static int
+build_zones( MUD_CATALOG* pCat )
+{
+    UINT32 nZones, z, r, end;
+    UINT64 v, lo, hi;
+    int col, type;
+
+    nZones = ( pCat->num + MUD_CAT_ZONE - 1 )/MUD_CAT_ZONE;
+    if( pCat->nZones == nZones && nZones > 0 ) return( 1 );
+    MUD_catalogFreeZones( pCat );
+
+    for( col = 0; col < MUD_CAT_NCOLS; col++ )
+    {
+	if( ( type = MUD_catalogColumnType( col ) ) == MUD_CAT_STRING ) continue;
+	pCat->pZoneMin[col] = (UINT64*)malloc( ( nZones + 1 )*sizeof( UINT64 ) );
+	pCat->pZoneMax[col] = (UINT64*)malloc( ( nZones + 1 )*sizeof( UINT64 ) );
+	if( pCat->pZoneMin[col] == NULL || pCat->pZoneMax[col] == NULL )
+	{
+	    MUD_catalogFreeZones( pCat );
+	    return( 0 );
+	}
+	for( z = 0; z < nZones; z++ )
+	{
+	    end = _min( ( z + 1 )*MUD_CAT_ZONE, pCat->num );
+	    lo = ~(UINT64)0;
+	    hi = 0;
+	    for( r = z*MUD_CAT_ZONE; r < end; r++ )
+	    {
+		v = ( type == MUD_CAT_UINT64 ) ? ((UINT64*)pCat->pCols[col])[r] :
+		    ( type == MUD_CAT_REAL64 ) ? real_key( ((REAL64*)pCat->pCols[col])[r] ) :
+						 ((UINT32*)pCat->pCols[col])[r];
+		if( v < lo ) lo = v;
+		if( v > hi ) hi = v;
+	    }
+	    pCat->pZoneMin[col][z] = lo;
+	    pCat->pZoneMax[col][z] = hi;
+	}
+    }
+    pCat->nZones = nZones;
+    return( 1 );
+}
+
+
+/*
+ *  The parser (recursive descent):
+ *
+ *    or   := and { OR and }
+ *    and  := not { AND not }
+ *    not  := NOT not | ( or ) | pred
+ *    pred := column op value | column BETWEEN value AND value
+ *          | column [NOT] LIKE string
+ */
+static void
+next_token( Q_PARSE* pP )
+{
+    char* p = pP->pos;
+    char* end;
+    char quote;
+    int n = 0;
+
+    while( isspace( (unsigned char)*p ) ) p++;
+    pP->text[0] = '\0';
+
+    if( *p == '\0' )
+    {
+	pP->tok = T_END;
+    }
+    else if( *p == '(' || *p == ')' )
+    {
+	pP->tok = ( *p++ == '(' ) ? T_LPAREN : T_RPAREN;
+    }
+    else if( *p == '\'' || *p == '"' )
+    {
+	for( quote = *p++; *p != '\0' && *p != quote; p++ )
+	{
+	    if( n < Q_MAX_TOKEN - 1 ) pP->text[n++] = *p;
+	}
+	pP->text[n] = '\0';
+	if( *p != quote ) pP->error = 1;
+	else p++;
+	pP->tok = T_STRING;
+    }
+    else if( strchr( "=!<>", *p ) != NULL )
+    {
+	pP->text[n++] = *p++;
+	if( *p == '=' || ( pP->text[0] == '<' && *p == '>' ) ) pP->text[n++] = *p++;
+	pP->text[n] = '\0';
+	if( strcmp( pP->text, "!" ) == 0 ) pP->error = 1;
+	pP->tok = T_OP;
+    }
+    else if( ( isdigit( (unsigned char)*p ) || *p == '-' || *p == '+' || *p == '.' ) &&
+	     ( pP->num = strtod( p, &end ), end > p ) )
+    {
+	p = end;
+	pP->tok = T_NUMBER;
+    }
+    else
+    {
+	while( *p != '\0' && !isspace( (unsigned char)*p ) && strchr( "()=!<>'\"", *p ) == NULL )
+	{
+	    if( n < Q_MAX_TOKEN - 1 ) pP->text[n++] = *p;
+	    p++;
+	}
+	pP->text[n] = '\0';
+	if( n == 0 )
+	{
+	    pP->error = 1;
+	    p++;
+	}
+	pP->tok = T_WORD;
+    }
+    pP->pos = p;
+}
+
+
+static int
+is_keyword( Q_PARSE* pP, char* word )
+{
+    char* s;
+
+    if( pP->tok != T_WORD ) return( 0 );
+    for( s = pP->text; *s != '\0' && *word != '\0'; s++, word++ )
+    {
+	if( toupper( (unsigned char)*s ) != *word ) return( 0 );
+    }
+    return( *s == '\0' && *word == '\0' );
+}
+
+
+static Q_NODE*
+new_node( Q_PARSE* pP, int type, Q_NODE* pLeft, Q_NODE* pRight )
+{
+    Q_NODE* pNode;
+
+    if( ( pNode = (Q_NODE*)zalloc( sizeof( Q_NODE ) ) ) == NULL )
+    {
+	pP->error = 2;
+	free_node( pLeft );
+	free_node( pRight );
+	return( NULL );
+    }
+    pNode->type = type;
+    pNode->pLeft = pLeft;
+    pNode->pRight = pRight;
+    return( pNode );
+}
+
+
+static void
+free_node( Q_NODE* pNode )
+{
+    if( pNode == NULL ) return;
+    free_node( pNode->pLeft );
+    free_node( pNode->pRight );
+    _free( pNode->pMatch );
+    free( pNode );
+}
+
+
+static Q_NODE*
+parse_or( Q_PARSE* pP )
+{
+    Q_NODE* pNode;
+
+    pNode = parse_and( pP );
+    while( pNode != NULL && is_keyword( pP, "OR" ) )
+    {
+	next_token( pP );
+	pNode = new_node( pP, Q_OR, pNode, parse_and( pP ) );
+	if( pNode != NULL && pNode->pRight == NULL )
+	{
+	    free_node( pNode );
+	    return( NULL );
+	}
+    }
+    return( pNode );
+}
+
+
+static Q_NODE*
+parse_and( Q_PARSE* pP )
+{
+    Q_NODE* pNode;
+
+    pNode = parse_not( pP );
+    while( pNode != NULL && is_keyword( pP, "AND" ) )
+    {
+	next_token( pP );
+	pNode = new_node( pP, Q_AND, pNode, parse_not( pP ) );
+	if( pNode != NULL && pNode->pRight == NULL )
+	{
+	    free_node( pNode );
+	    return( NULL );
+	}
+    }
+    return( pNode );
+}
+
+
+static Q_NODE*
+parse_not( Q_PARSE* pP )
+{
+    Q_NODE* pNode;
+
+    if( is_keyword( pP, "NOT" ) )
+    {
+	next_token( pP );
+	if( ( pNode = parse_not( pP ) ) == NULL ) return( NULL );
+	return( new_node( pP, Q_NOT, pNode, NULL ) );
+    }
+    if( pP->tok == T_LPAREN )
+    {
+	next_token( pP );
+	if( ( pNode = parse_or( pP ) ) == NULL ) return( NULL );
+	if( pP->tok != T_RPAREN )
+	{
+	    free_node( pNode );
+	    pP->error = 1;
+	    return( NULL );
+	}
+	next_token( pP );
+	return( pNode );
+    }
+    return( parse_pred( pP ) );
+}
+
+
+/*
+ *  get_value() - a constant: a number, or a string (quoted or a bare word)
+ */
+static int
+get_value( Q_PARSE* pP, int* pIsNum, double* pNum, char* text )
+{
+    if( pP->tok == T_NUMBER )
+    {
+	*pIsNum = 1;
+	*pNum = pP->num;
+    }
+    else if( pP->tok == T_STRING || ( pP->tok == T_WORD && !is_keyword( pP, "AND" ) &&
+				       !is_keyword( pP, "OR" ) ) )
+    {
+	*pIsNum = 0;
+	strcpy( text, pP->text );
+    }
+    else
+    {
+	pP->error = 1;
+	return( 0 );
+    }
+    next_token( pP );
+    return( 1 );
+}
+
+
+static Q_NODE*
+parse_pred( Q_PARSE* pP )
+{
+    char text[Q_MAX_TOKEN];
+    char text2[Q_MAX_TOKEN];
+    double a, b = 0.0;
+    int col, op, isNum, isNum2, negate = 0;
+
+    if( pP->tok != T_WORD || ( col = MUD_catalogColumn( pP->text ) ) < 0 )
+    {
+	pP->error = 1;
+	return( NULL );
+    }
+    next_token( pP );
+
+    if( is_keyword( pP, "NOT" ) )
+    {
+	negate = 1;
+	next_token( pP );
+	if( !is_keyword( pP, "LIKE" ) )
+	{
+	    pP->error = 1;
+	    return( NULL );
+	}
+    }
+
+    if( is_keyword( pP, "BETWEEN" ) )
+    {
+	next_token( pP );
+	if( !get_value( pP, &isNum, &a, text ) ) return( NULL );
+	if( !is_keyword( pP, "AND" ) )
+	{
+	    pP->error = 1;
+	    return( NULL );
+	}
+	next_token( pP );
+	if( !get_value( pP, &isNum2, &b, text2 ) ) return( NULL );
+	if( !isNum || !isNum2 )
+	{
+	    pP->error = 1;
+	    return( NULL );
+	}
+	op = OP_BETWEEN;
+    }
+    else if( is_keyword( pP, "LIKE" ) )
+    {
+	next_token( pP );
+	if( !get_value( pP, &isNum, &a, text ) ) return( NULL );
+	if( isNum || MUD_catalogColumnType( col ) != MUD_CAT_STRING )
+	{
+	    pP->error = 1;
+	    return( NULL );
+	}
+	op = negate ? OP_NOT_LIKE : OP_LIKE;
+    }
+    else if( pP->tok == T_OP && ( op = op_code( pP->text ) ) != 0 )
+    {
+	next_token( pP );
+	if( !get_value( pP, &isNum, &a, text ) ) return( NULL );
+    }
+    else
+    {
+	pP->error = 1;
+	return( NULL );
+    }
+
+    if( MUD_catalogColumnType( col ) == MUD_CAT_STRING )
+	return( str_pred( pP, col, op, isNum, a, b, text ) );
+    if( !isNum )
+    {
+	pP->error = 1;
+	return( NULL );
+    }
+    return( num_pred( pP, col, op, a, b ) );
+}
+
+
+static int
+op_code( char* op )
+{
+    if( strcmp( op, "=" ) == 0 || strcmp( op, "==" ) == 0 ) return( OP_EQ );
+    if( strcmp( op, "!=" ) == 0 || strcmp( op, "<>" ) == 0 ) return( OP_NE );
+    if( strcmp( op, "<" ) == 0 ) return( OP_LT );
+    if( strcmp( op, "<=" ) == 0 ) return( OP_LE );
+    if( strcmp( op, ">" ) == 0 ) return( OP_GT );
+    if( strcmp( op, ">=" ) == 0 ) return( OP_GE );
+    return( 0 );
+}
+
+
+/*
+ *  op_test() - result of a comparison, given c < 0, 0 or > 0 as the
+ *  value is less than, equal to or greater than the constant
+ */
+static int
+op_test( int op, int c )
+{
+    switch( op )
+    {
+	case OP_EQ:	return( c == 0 );
+	case OP_NE:	return( c != 0 );
+	case OP_LT:	return( c < 0 );
+	case OP_LE:	return( c <= 0 );
+	case OP_GT:	return( c > 0 );
+	case OP_GE:	return( c >= 0 );
+    }
+    return( 0 );
+}
+
+
+/*
+ *  num_pred() - a test on a numeric column, as a range [lo, hi] of
+ *  integers (or the rows outside it, for !=)
+ */
+static Q_NODE*
+num_pred( Q_PARSE* pP, int col, int op, double a, double b )
+{
+    Q_NODE* pNode;
+    double lo = 0.0, hi = 18446744073709551615.0;
+
+    if( MUD_catalogColumnType( col ) == MUD_CAT_REAL64 )
+	return( real_pred( pP, col, op, a, b ) );
+
+    switch( op )
+    {
+	case OP_BETWEEN:	lo = ceil( a ); hi = floor( b ); break;
+	case OP_GT:		lo = floor( a ) + 1.0; break;
+	case OP_GE:		lo = ceil( a ); break;
+	case OP_LT:		hi = ceil( a ) - 1.0; break;
+	case OP_LE:		hi = floor( a ); break;
+	case OP_EQ:
+	case OP_NE:		lo = ceil( a ); hi = floor( a ); break;
+	default:
+	    pP->error = 1;
+	    return( NULL );
+    }
+
+    if( ( pNode = new_node( pP, Q_RANGE, NULL, NULL ) ) == NULL ) return( NULL );
+    pNode->col = col;
+    pNode->negate = ( op == OP_NE );
+    if( lo < 0.0 ) lo = 0.0;
+    if( lo > hi || lo >= 18446744073709551615.0 )
+    {
+	/*
+	 *  Nothing can match: an empty range
+	 */
+	pNode->lo = 1;
+	pNode->hi = 0;
+    }
+    else
+    {
+	pNode->lo = (UINT64)lo;
+	pNode->hi = ( hi >= 18446744073709551615.0 ) ? ~(UINT64)0 : (UINT64)hi;
+    }
+    return( pNode );
+}
+
+
+/*
+ *  real_key() - a UINT64 in the same order as the REAL64 values: the
+ *  bits with the sign bit flipped, or all of them for negative values.
+ *  -0 is taken as 0, and NaN comes after +infinity.
+ */
+static UINT64
+real_key( REAL64 x )
+{
+    union { REAL64 d; UINT64 u; } k;
+
+    k.d = ( x == 0.0 ) ? 0.0 : x;
+    return( ( k.u >> 63 ) ? ~k.u : ( k.u | 0x8000000000000000ULL ) );
+}
+
+
+/*
+ *  real_pred() - a test on a REAL64 column, as a range of keys; the
+ *  range stops at +-infinity, so NaN never matches
+ */
+static Q_NODE*
+real_pred( Q_PARSE* pP, int col, int op, double a, double b )
+{
+    Q_NODE* pNode;
+    UINT64 minKey = real_key( -HUGE_VAL ), maxKey = real_key( HUGE_VAL );
+    UINT64 lo = minKey, hi = maxKey;
+
+    switch( op )
+    {
+	case OP_BETWEEN:	lo = real_key( a ); hi = real_key( b ); break;
+	case OP_GT:		lo = real_key( a ) + 1; break;
+	case OP_GE:		lo = real_key( a ); break;
+	case OP_LT:		hi = real_key( a ) - 1; break;
+	case OP_LE:		hi = real_key( a ); break;
+	case OP_EQ:
+	case OP_NE:		lo = hi = real_key( a ); break;
+	default:
+	    pP->error = 1;
+	    return( NULL );
+    }
+
+    if( ( pNode = new_node( pP, Q_RANGE, NULL, NULL ) ) == NULL ) return( NULL );
+    pNode->col = col;
+    pNode->negate = ( op == OP_NE );
+    pNode->lo = _max( lo, minKey );
+    pNode->hi = _min( hi, maxKey );
+    if( a != a || b != b || pNode->lo > pNode->hi )
+    {
+	pNode->lo = 1;
+	pNode->hi = 0;
+    }
+    return( pNode );
+}
+
+
+/*
+ *  str_pred() - a test on a string column, made once for every string
+ *  in the string table
+ */
+static Q_NODE*
+str_pred( Q_PARSE* pP, int col, int op, int isNum, double a, double b, char* text )
+{
+    MUD_CATALOG* pCat = pP->pCat;
+    Q_NODE* pNode;
+    char* s;
+    char* end;
+    double v;
+    UINT32 n;
+    int m;
+
+    if( op == OP_BETWEEN && !isNum )
+    {
+	pP->error = 1;
+	return( NULL );
+    }
+    if( ( pNode = new_node( pP, Q_STRING, NULL, NULL ) ) == NULL ) return( NULL );
+    pNode->col = col;
+    if( ( pNode->pMatch = (char*)malloc( pCat->nStrings + 1 ) ) == NULL )
+    {
+	pP->error = 2;
+	free_node( pNode );
+	return( NULL );
+    }
+
+    for( n = 0; n < pCat->nStrings; n++ )
+    {
+	s = &pCat->pStrings[pCat->pStrOff[n]];
+	if( op == OP_LIKE || op == OP_NOT_LIKE )
+	{
+	    m = ( like( s, text ) == ( op == OP_LIKE ) );
+	}
+	else if( isNum )
+	{
+	    /*
+	     *  The number the string starts with; none matches nothing
+	     */
+	    v = strtod( s, &end );
+	    if( end == s )
+		m = 0;
+	    else if( op == OP_BETWEEN )
+		m = ( v >= a && v <= b );
+	    else
+		m = op_test( op, ( v < a ) ? -1 : ( v > a ) );
+	}
+	else
+	{
+	    m = op_test( op, strcmp( s, text ) );
+	}
+	pNode->pMatch[n] = (char)m;
+    }
+    return( pNode );
+}
+
+
+/*
+ *  like() - SQL LIKE, ignoring case
+ */
+static int
+like( char* s, char* pat )
+{
+    for( ; *pat != '\0'; pat++, s++ )
+    {
+	if( *pat == '%' )
+	{
+	    while( *( pat + 1 ) == '%' ) pat++;
+	    if( *( pat + 1 ) == '\0' ) return( 1 );
+	    for( ; *s != '\0'; s++ )
+	    {
+		if( like( s, pat + 1 ) ) return( 1 );
+	    }
+	    return( 0 );
+	}
+	if( *s == '\0' ) return( 0 );
+	if( *pat != '_' && tolower( (unsigned char)*pat ) != tolower( (unsigned char)*s ) )
+	    return( 0 );
+    }
+    return( *s == '\0' );
+}
+
+
+/*
+ *  scan_range() - pOut = rows among pCand with the column in the node's
+ *  range (or outside it, if negate)
+ */
+static void
+scan_range( MUD_CATALOG* pCat, Q_NODE* pNode, UINT64* pCand, UINT64* pOut )
+{
+    UINT32 nWords = ( pCat->num + 63 )/64;
+    UINT64 lo = pNode->lo, hi = pNode->hi, span = pNode->hi - pNode->lo;
+    UINT64 bits, zMin, zMax;
+    UINT64* p64 = (UINT64*)pCat->pCols[pNode->col];
+    UINT32* p32 = (UINT32*)pCat->pCols[pNode->col];
+    REAL64* pReal = (REAL64*)pCat->pCols[pNode->col];
+    UINT32 w, z, r, i, n;
+    int type = MUD_catalogColumnType( pNode->col );
+    int zone;
+#ifdef __AVX2__
+    __m256i vLo, vSpan, vSign, v;
+
+    /*
+     *  Unsigned ( v - lo ) <= span, as a signed compare with the sign
+     *  bits flipped; hi is first cut to 32 bits so the difference cannot
+     *  wrap round into the range
+     */
+    vSign = _mm256_set1_epi32( (int)0x80000000U );
+    vLo = _mm256_set1_epi32( (int)(UINT32)lo );
+    vSpan = _mm256_set1_epi32( (int)( (UINT32)( _min( hi, 0xffffffffU ) - lo ) ^ 0x80000000U ) );
+#endif /* __AVX2__ */
+
+    for( w = 0; w < nWords; w++ )
+    {
+	if( pCand[w] == 0 || lo > hi )
+	{
+	    pOut[w] = pNode->negate ? pCand[w] : 0;
+	    continue;
+	}
+
+	/*
+	 *  Blocks where every row is in the range (1), or none is (0)
+	 */
+	zone = -1;
+	if( pCat->nZones > 0 )
+	{
+	    z = w*64/MUD_CAT_ZONE;
+	    zMin = pCat->pZoneMin[pNode->col][z];
+	    zMax = pCat->pZoneMax[pNode->col][z];
+	    if( zMax < lo || zMin > hi ) zone = 0;
+	    else if( zMin >= lo && zMax <= hi ) zone = 1;
+	}
+	if( zone >= 0 )
+	{
+	    pOut[w] = ( zone != pNode->negate ) ? pCand[w] : 0;
+	    continue;
+	}
+
+	r = w*64;
+	n = _min( 64, pCat->num - r );
+	bits = 0;
+	i = 0;
+	if( type == MUD_CAT_REAL64 )
+	{
+	    for( ; i < n; i++ )
+		bits |= (UINT64)( real_key( pReal[r+i] ) - lo <= span ) << i;
+	}
+	else if( type == MUD_CAT_UINT64 )
+	{
+	    for( ; i < n; i++ )
+		bits |= (UINT64)( p64[r+i] - lo <= span ) << i;
+	}
+	else
+	{
+#ifdef __AVX2__
+	    for( ; lo <= 0xffffffffU && i + 8 <= n; i += 8 )
+	    {
+		v = _mm256_loadu_si256( (__m256i*)&p32[r+i] );
+		v = _mm256_xor_si256( _mm256_sub_epi32( v, vLo ), vSign );
+		bits |= (UINT64)( ~_mm256_movemask_ps( _mm256_castsi256_ps(
+			    _mm256_cmpgt_epi32( v, vSpan ) ) ) & 0xff ) << i;
+	    }
+#endif /* __AVX2__ */
+	    for( ; i < n; i++ )
+		bits |= (UINT64)( (UINT64)p32[r+i] - lo <= span ) << i;
+	}
+	if( pNode->negate ) bits = ~bits;
+	pOut[w] = bits & pCand[w];
+    }
+}
+
+
+/*
+ *  scan_string() - pOut = rows among pCand whose string matches
+ */
+static void
+scan_string( MUD_CATALOG* pCat, Q_NODE* pNode, UINT64* pCand, UINT64* pOut )
+{
+    UINT32 nWords = ( pCat->num + 63 )/64;
+    UINT32* p32 = (UINT32*)pCat->pCols[pNode->col];
+    char* pMatch = pNode->pMatch;
+    UINT64 bits;
+    UINT32 w, r, i, n;
+
+    for( w = 0; w < nWords; w++ )
+    {
+	if( pCand[w] == 0 )
+	{
+	    pOut[w] = 0;
+	    continue;
+	}
+	r = w*64;
+	n = _min( 64, pCat->num - r );
+	for( i = 0, bits = 0; i < n; i++ )
+	{
+	    bits |= (UINT64)pMatch[p32[r+i]] << i;
+	}
+	pOut[w] = bits & pCand[w];
+    }
+}
+
+
+/*
+ *  eval() - pOut = rows among pCand that match the node.  Returns 0 if
+ *  out of memory.
+ */
+static int
+eval( MUD_CATALOG* pCat, Q_NODE* pNode, UINT64* pCand, UINT64* pOut )
+{
+    UINT32 nWords = ( pCat->num + 63 )/64;
+    UINT64* pTmp;
+    UINT32 w;
+    int ok;
+
+    switch( pNode->type )
+    {
+	case Q_RANGE:
+	    scan_range( pCat, pNode, pCand, pOut );
+	    return( 1 );
+	case Q_STRING:
+	    scan_string( pCat, pNode, pCand, pOut );
+	    return( 1 );
+	case Q_AND:
+	    /*
+	     *  The right side only looks at what the left side selected
+	     */
+	    if( !eval( pCat, pNode->pLeft, pCand, pOut ) ) return( 0 );
+	    if( ( pTmp = (UINT64*)malloc( ( nWords + 1 )*sizeof( UINT64 ) ) ) == NULL ) return( 0 );
+	    ok = eval( pCat, pNode->pRight, pOut, pTmp );
+	    for( w = 0; w < nWords; w++ ) pOut[w] &= pTmp[w];
+	    free( pTmp );
+	    return( ok );
+	case Q_OR:
+	    /*
+	     *  The right side only looks at what the left side did not select
+	     */
+	    if( !eval( pCat, pNode->pLeft, pCand, pOut ) ) return( 0 );
+	    if( ( pTmp = (UINT64*)malloc( ( 2*nWords + 1 )*sizeof( UINT64 ) ) ) == NULL ) return( 0 );
+	    for( w = 0; w < nWords; w++ ) pTmp[w] = pCand[w] & ~pOut[w];
+	    ok = eval( pCat, pNode->pRight, pTmp, pTmp + nWords );
+	    for( w = 0; w < nWords; w++ ) pOut[w] |= pTmp[nWords+w];
+	    free( pTmp );
+	    return( ok );
+	case Q_NOT:
+	    if( !eval( pCat, pNode->pLeft, pCand, pOut ) ) return( 0 );
+	    for( w = 0; w < nWords; w++ ) pOut[w] = pCand[w] & ~pOut[w];
+	    return( 1 );
+    }
+    return( 0 );
+}
+
+
+/*
+ *  MUD_catalogSelect() - rows of the catalog matching the query; an empty
+ *  query matches every row.  *ppRows is set to an array (free with free())
+ *  of the row numbers in order.  Returns the number of rows, -1 if the
+ *  query is not understood, or -2 if out of memory.
+ */
+int
+MUD_catalogSelect( MUD_CATALOG* pCat, char* query, int** ppRows )
+{
+    Q_PARSE parse;
+    Q_NODE* pRoot = NULL;
+    UINT64* pCand = NULL;
+    UINT64* pOut = NULL;
+    UINT64 bits;
+    UINT32 nWords, w, r;
+    int num = -2, i;
+
+    *ppRows = NULL;
+    bzero( &parse, sizeof( Q_PARSE ) );
+    parse.pCat = pCat;
+    parse.pos = query;
+    next_token( &parse );
+    if( parse.tok != T_END )
+    {
+	pRoot = parse_or( &parse );
+	if( pRoot == NULL || parse.tok != T_END || parse.error )
+	{
+	    num = ( parse.error == 2 ) ? -2 : -1;
+	    goto done;
+	}
+    }
+
+    nWords = ( pCat->num + 63 )/64;
+    pCand = (UINT64*)malloc( ( nWords + 1 )*sizeof( UINT64 ) );
+    pOut = (UINT64*)malloc( ( nWords + 1 )*sizeof( UINT64 ) );
+    *ppRows = (int*)malloc( ( pCat->num + 1 )*sizeof( int ) );
+    if( pCand == NULL || pOut == NULL || *ppRows == NULL ) goto done;
+
+    for( w = 0; w < nWords; w++ ) pCand[w] = ~(UINT64)0;
+    if( pCat->num % 64 ) pCand[nWords-1] = ( (UINT64)1 << ( pCat->num % 64 ) ) - 1;
+
+    if( pRoot != NULL )
+    {
+	build_zones( pCat );	/* without them, every block is scanned */
+	if( !eval( pCat, pRoot, pCand, pOut ) ) goto done;
+    }
+    else
+    {
+	bcopy( pCand, pOut, nWords*sizeof( UINT64 ) );
+    }
+
+    for( w = 0, num = 0; w < nWords; w++ )
+    {
+	for( bits = pOut[w], i = 0; bits != 0; bits >>= 1, i++ )
+	{
+	    r = w*64 + i;
+	    if( bits & 1 ) (*ppRows)[num++] = (int)r;
+	}
+    }
+
+done:
+    if( num < 0 ) _free( *ppRows );
+    _free( pCand );
+    _free( pOut );
+    free_node( pRoot );
+    return( num );
+}
@@ -0,0 +1,376 @@
+/*
+ *  mud_dat.c -- write the histograms and headers of runs as text (.dat)
+ *               files, one per run, as BEAMS reads them
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version
+ *          18-Oct-2026      Which runs were written, in pDone
+ *
+ *  Description:
+ *    MUD_writeDat() writes each run as a text file of lines ending in
+ *    "\n":
+ *
+ *      BEAMS
+ *      name:value    for each of path, title .. comment3 that is not
+ *                    empty, then format .. elapsed_sec (times in seconds
+ *                    since 1970), temperature_k and field_g (if there
+ *                    is a number, see mud_quantity.c) and n_hists
+ *      name:v1,v2,.. for each of hist_type .. n_events, one value per
+ *                    histogram
+ *      t1,t2,..      the histogram titles
+ *      c1,c2,..      the counts, one line per bin, to the longest
+ *                    histogram; a field is empty past the end of a
+ *                    shorter one
+ *
+ *    Line breaks in strings are written as spaces, and so are commas in
+ *    the titles.  The names are those of MUD_exportValName() etc.  A run
+ *    is written to its name with ".dat" for its extension, in the
+ *    directory given, or else beside it; runs that cannot be read or
+ *    written are left out, and marked 0 in pDone if it is given.
+ *
+ *    The counts of a block of runs are read in parallel (see
+ *    mud_export.c), then each run of the block is formatted, in
+ *    parallel, into a buffer the size of its file, by hand rather than
+ *    by printf(), and written with one fwrite() into a temporary file
+ *    that is renamed into place.
+ */
+
+#include "mud.h"
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif /* _WIN32 */
+
+#define DAT_UINT_LEN	11		/* of a UINT32 and a comma */
+#define DAT_REAL_LEN	32
+
+typedef struct {
+    MUD_EXPORT*	pExp;
+    int		first;		/* run of the block */
+    UINT32*	pCounts;	/* of the block */
+    char*	dir;
+    char*	pWritten;	/* by run of the block */
+} DAT_BATCH;
+
+static char digits[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static char* put_uint _ANSI_ARGS_(( char* p, UINT32 v ));
+static char* put_str _ANSI_ARGS_(( char* p, char* s, int comma ));
+static char* put_name _ANSI_ARGS_(( char* p, char* name ));
+static char* dat_name _ANSI_ARGS_(( char* path, char* dir ));
+static size_t dat_size _ANSI_ARGS_(( MUD_EXPORT_RUN* pRun ));
+static size_t format_run _ANSI_ARGS_(( MUD_EXPORT_RUN* pRun, UINT32* pCounts, UINT32 maxBins, char* buf ));
+static int write_run _ANSI_ARGS_(( char* datname, char* buf, size_t len ));
+static void dat_task _ANSI_ARGS_(( int task, int thread, void* pArg ));
+
+
+/*
+ *  put_uint() - v in decimal, two digits at a time
+ */
+static char*
+put_uint( char* p, UINT32 v )
+{
+    char tmp[10];
+    char* q = tmp + sizeof( tmp );
+    int n;
+
+    while( v >= 100 )
+    {
+	q -= 2;
+	bcopy( &digits[2*( v % 100 )], q, 2 );
+	v /= 100;
+    }
+    if( v >= 10 )
+    {
+	q -= 2;
+	bcopy( &digits[2*v], q, 2 );
+    }
+    else
+    {
+	*--q = (char)( '0' + v );
+    }
+    n = (int)( tmp + sizeof( tmp ) - q );
+    bcopy( q, p, n );
+    return( p + n );
+}
+
+
+/*
+ *  put_str() - s with line breaks (and commas, if comma) as spaces
+ */
+static char*
+put_str( char* p, char* s, int comma )
+{
+    if( s == NULL ) return( p );
+    for( ; *s != '\0'; s++ )
+    {
+	*p++ = ( *s == '\n' || *s == '\r' || ( comma && *s == ',' ) ) ? ' ' : *s;
+    }
+    return( p );
+}
+
+
+static char*
+put_name( char* p, char* name )
+{
+    p = put_str( p, name, 0 );
+    *p++ = ':';
+    return( p );
+}
+
+
+/*
+ *  dat_name() - the .dat file of the run at path, in dir or beside it
+ */
+static char*
+dat_name( char* path, char* dir )
+{
+    char* base;
+    char* ext;
+    char* name;
+    int len;
+
+    for( base = path + strlen( path ); base > path; base-- )
+    {
+	if( base[-1] == '/' || base[-1] == '\\' ) break;
+    }
+    ext = strrchr( base, '.' );
+    len = ( ext != NULL && ext > base ) ? (int)( ext - path ) : (int)strlen( path );
+    if( dir != NULL )
+	len += (int)strlen( dir ) + 1 - (int)( base - path );
+
+    if( ( name = (char*)malloc( len + 5 ) ) == NULL ) return( NULL );
+    if( dir != NULL )
+    {
+	sprintf( name, "%s/", dir );
+	strncat( name, base, len - strlen( name ) );
+    }
+    else
+    {
+	strncpy( name, path, len );
+	name[len] = '\0';
+    }
+    strcat( name, ".dat" );
+    return( name );
+}
+
+
+/*
+ *  dat_size() - the most bytes the .dat file of a run can take
+ */
+static size_t
+dat_size( MUD_EXPORT_RUN* pRun )
+{
+    size_t size;
+    UINT32 i;
+
+    size = 64 + ( MUD_SHM_NSTR + MUD_EXP_NVALS + 3 )*32 + 2*DAT_REAL_LEN;
+    for( i = 0; i < MUD_SHM_NSTR; i++ )
+    {
+	if( pRun->str[i] != NULL ) size += strlen( pRun->str[i] );
+    }
+    size += (size_t)( MUD_EXP_NHISTVALS + 1 + pRun->maxBins )*pRun->nHists*DAT_UINT_LEN;
+    for( i = 0; i < pRun->nHists; i++ )
+    {
+	if( pRun->pHistTitles[i] != NULL ) size += strlen( pRun->pHistTitles[i] );
+    }
+    return( size + pRun->maxBins + MUD_EXP_NHISTVALS );
+}
+
+
+/*
+ *  format_run() - the .dat file of a run, whose counts (maxBins per
+ *  histogram) are at pCounts, into buf; returns its length
+ */
+static size_t
+format_run( MUD_EXPORT_RUN* pRun, UINT32* pCounts, UINT32 maxBins, char* buf )
+{
+    UINT32* v;
+    UINT32 i, j, nBins;
+    char* p = buf;
+
+    p = put_str( p, "BEAMS", 0 );
+    *p++ = '\n';
+    for( i = 0; i < MUD_SHM_NSTR; i++ )
+    {
+	if( pRun->str[i] == NULL ) continue;
+	p = put_name( p, MUD_exportStrName( i ) );
+	p = put_str( p, pRun->str[i], 0 );
+	*p++ = '\n';
+    }
+    for( i = 0; i < MUD_EXP_NVALS; i++ )
+    {
+	p = put_name( p, MUD_exportValName( i ) );
+	p = put_uint( p, pRun->val[i] );
+	*p++ = '\n';
+    }
+    if( pRun->tempK == pRun->tempK )
+    {
+	sprintf( p, "temperature_k:%.10g\n", pRun->tempK );
+	p += strlen( p );
+    }
+    if( pRun->fieldG == pRun->fieldG )
+    {
+	sprintf( p, "field_g:%.10g\n", pRun->fieldG );
+	p += strlen( p );
+    }
+    p = put_name( p, "n_hists" );
+    p = put_uint( p, pRun->nHists );
+    *p++ = '\n';
+
+    for( j = 0; j < MUD_EXP_NHISTVALS; j++ )
+    {
+	p = put_name( p, MUD_exportHistValName( j ) );
+	for( i = 0; i < pRun->nHists; i++ )
+	{
+	    if( i > 0 ) *p++ = ',';
+	    p = put_uint( p, pRun->pHistVals[i*MUD_EXP_NHISTVALS + j] );
+	}
+	*p++ = '\n';
+    }
+
+    for( i = 0; i < pRun->nHists; i++ )
+    {
+	if( i > 0 ) *p++ = ',';
+	p = put_str( p, pRun->pHistTitles[i], 1 );
+    }
+    *p++ = '\n';
+
+    for( j = 0; j < pRun->maxBins; j++ )
+    {
+	for( i = 0; i < pRun->nHists; i++ )
+	{
+	    if( i > 0 ) *p++ = ',';
+	    v = &pRun->pHistVals[i*MUD_EXP_NHISTVALS];
+	    nBins = _min( v[MUD_EXP_NBINS], maxBins );
+	    if( j < nBins ) p = put_uint( p, pCounts[(size_t)i*maxBins + j] );
+	}
+	*p++ = '\n';
+    }
+    return( (size_t)( p - buf ) );
+}
+
+
+static int
+write_run( char* datname, char* buf, size_t len )
+{
+    FILE* fout;
+    char* tmpname;
+    int status = 0;
+
+    if( ( tmpname = (char*)malloc( strlen( datname ) + 24 ) ) == NULL ) return( 0 );
+    sprintf( tmpname, "%s.%lu.tmp", datname, (unsigned long)getpid() );
+    if( ( fout = fopen( tmpname, "wb" ) ) != NULL )
+    {
+	status = ( fwrite( buf, 1, len, fout ) == len );
+	status = ( fclose( fout ) == 0 ) && status;
+	if( status )
+	{
+#ifdef _WIN32
+	    remove( datname );
+#endif /* _WIN32 */
+	    status = ( rename( tmpname, datname ) == 0 );
+	}
+	if( !status ) remove( tmpname );
+    }
+    free( tmpname );
+    return( status );
+}
+
+
+static void
+dat_task( int task, int thread, void* pArg )
+{
+    DAT_BATCH* pB = (DAT_BATCH*)pArg;
+    MUD_EXPORT_RUN* pRun = &pB->pExp->pRuns[pB->first + task];
+    UINT32* pCounts;
+    char* datname;
+    char* buf;
+    size_t len;
+
+    pCounts = pB->pCounts + (size_t)task*pB->pExp->maxHists*pB->pExp->maxBins;
+    if( ( datname = dat_name( pRun->str[MUD_SHM_PATH], pB->dir ) ) == NULL ) return;
+    if( ( buf = (char*)malloc( dat_size( pRun ) ) ) != NULL )
+    {
+	len = format_run( pRun, pCounts, pB->pExp->maxBins, buf );
+	pB->pWritten[task] = (char)write_run( datname, buf, len );
+	free( buf );
+    }
+    free( datname );
+}
+
+
+/*
+ *  MUD_writeDat() - write runs as .dat files (see above), into dir, or
+ *  beside the runs if dir is NULL; returns the number of runs written,
+ *  or -1 if out of memory.  If pDone is not NULL, pDone[i] is set to 1
+ *  if files[i] was written and 0 if not.
+ */
+int
+MUD_writeDat( int num, char** files, char* dir, int nThreads, char* pDone )
+{
+    MUD_EXPORT* pExp;
+    DAT_BATCH batch;
+    UINT32* pCounts;
+    size_t runBytes;
+    int block, i, j, n, k = 0, nWritten = 0;
+
+    if( pDone != NULL ) bzero( pDone, num );
+    if( ( pExp = MUD_exportOpen( num, files, nThreads ) ) == NULL ) return( -1 );
+    runBytes = (size_t)pExp->maxHists*pExp->maxBins*sizeof( UINT32 );
+    block = MUD_exportBlock( pExp );
+    pCounts = (UINT32*)malloc( block*runBytes + 1 );
+    bzero( &batch, sizeof( batch ) );
+    if( pCounts == NULL || ( batch.pWritten = (char*)malloc( block ) ) == NULL )
+    {
+	_free( pCounts );
+	MUD_exportClose( pExp );
+	return( -1 );
+    }
+
+    batch.pExp = pExp;
+    batch.pCounts = pCounts;
+    batch.dir = dir;
+    for( i = 0; i < pExp->nRuns; i += block )
+    {
+	n = _min( block, pExp->nRuns - i );
+	MUD_exportCounts( pExp, i, n, pCounts );
+	bzero( batch.pWritten, n );
+	batch.first = i;
+	MUD_parallelFor( n, nThreads, dat_task, &batch );
+	for( j = 0; j < n; j++ )
+	{
+	    nWritten += batch.pWritten[j];
+	    if( pDone == NULL ) continue;
+
+	    /*
+	     *  The runs read are those of files, in order
+	     */
+	    while( k < num && strcmp( files[k], pExp->pRuns[i+j].str[MUD_SHM_PATH] ) != 0 ) k++;
+	    if( k < num ) pDone[k++] = batch.pWritten[j];
+	}
+    }
+
+    free( batch.pWritten );
+    free( pCounts );
+    MUD_exportClose( pExp );
+    return( nWritten );
+}
@@ -0,0 +1,586 @@
+/*
+ *  mud_dedup.c -- content hashes of runs, for finding the same run under
+ *                 different paths and names
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version
+ *
+ *  Description:
+ *    Two files hold the same run if they decode to the same sections,
+ *    whatever the order of the sections in the file and however the
+ *    histograms are packed.  MUD_runCanon() writes a run in a canonical
+ *    form, which is the same for all such files:
+ *
+ *      one record per section (groups are not recorded themselves, but
+ *      their members are, recursively), sorted by key and contents:
+ *        key       the instance of the enclosing group (the format, at
+ *                  the top), the section ID and the instance, 4 bytes
+ *                  each as written in MUD files
+ *        length    4 bytes
+ *        contents  the section as written in MUD files, without the
+ *                  core; histogram headers with nBytes and bytesPerBin
+ *                  set to 0, histogram data unpacked to 4 bytes per bin
+ *
+ *    Left out are what changes when a file is rewritten: the sizes of
+ *    sections, the indexes of groups, the order of sections and the
+ *    packing of histograms.
+ *
+ *    MUD_runHash() is a 64-bit hash of the canonical form: two CRC32C
+ *    (Castagnoli) sums over alternate 8-byte words.  CRC32C is done by
+ *    the SSE4.2 or ARMv8 CRC instructions when the library is compiled
+ *    for them ("-msse4.2", "-march=armv8-a+crc"), and from a table
+ *    otherwise.  Runs with the same hash are compared by their canonical
+ *    forms before they are taken to be the same (MUD_dedupRuns).
+ */
+
+#include "mud.h"
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif /* __SSE4_2__ */
+
+#define DD_KEY		12		/* bytes of the key of a record */
+
+static UINT32 crcTable[256] = {
+    0x00000000U, 0xF26B8303U, 0xE13B70F7U, 0x1350F3F4U,
+    0xC79A971FU, 0x35F1141CU, 0x26A1E7E8U, 0xD4CA64EBU,
+    0x8AD958CFU, 0x78B2DBCCU, 0x6BE22838U, 0x9989AB3BU,
+    0x4D43CFD0U, 0xBF284CD3U, 0xAC78BF27U, 0x5E133C24U,
+    0x105EC76FU, 0xE235446CU, 0xF165B798U, 0x030E349BU,
+    0xD7C45070U, 0x25AFD373U, 0x36FF2087U, 0xC494A384U,
+    0x9A879FA0U, 0x68EC1CA3U, 0x7BBCEF57U, 0x89D76C54U,
+    0x5D1D08BFU, 0xAF768BBCU, 0xBC267848U, 0x4E4DFB4BU,
+    0x20BD8EDEU, 0xD2D60DDDU, 0xC186FE29U, 0x33ED7D2AU,
+    0xE72719C1U, 0x154C9AC2U, 0x061C6936U, 0xF477EA35U,
+    0xAA64D611U, 0x580F5512U, 0x4B5FA6E6U, 0xB93425E5U,
+    0x6DFE410EU, 0x9F95C20DU, 0x8CC531F9U, 0x7EAEB2FAU,
+    0x30E349B1U, 0xC288CAB2U, 0xD1D83946U, 0x23B3BA45U,
+    0xF779DEAEU, 0x05125DADU, 0x1642AE59U, 0xE4292D5AU,
+    0xBA3A117EU, 0x4851927DU, 0x5B016189U, 0xA96AE28AU,
+    0x7DA08661U, 0x8FCB0562U, 0x9C9BF696U, 0x6EF07595U,
+    0x417B1DBCU, 0xB3109EBFU, 0xA0406D4BU, 0x522BEE48U,
+    0x86E18AA3U, 0x748A09A0U, 0x67DAFA54U, 0x95B17957U,
+    0xCBA24573U, 0x39C9C670U, 0x2A993584U, 0xD8F2B687U,
+    0x0C38D26CU, 0xFE53516FU, 0xED03A29BU, 0x1F682198U,
+    0x5125DAD3U, 0xA34E59D0U, 0xB01EAA24U, 0x42752927U,
+    0x96BF4DCCU, 0x64D4CECFU, 0x77843D3BU, 0x85EFBE38U,
+    0xDBFC821CU, 0x2997011FU, 0x3AC7F2EBU, 0xC8AC71E8U,
+    0x1C661503U, 0xEE0D9600U, 0xFD5D65F4U, 0x0F36E6F7U,
+    0x61C69362U, 0x93AD1061U, 0x80FDE395U, 0x72966096U,
+    0xA65C047DU, 0x5437877EU, 0x4767748AU, 0xB50CF789U,
+    0xEB1FCBADU, 0x197448AEU, 0x0A24BB5AU, 0xF84F3859U,
+    0x2C855CB2U, 0xDEEEDFB1U, 0xCDBE2C45U, 0x3FD5AF46U,
+    0x7198540DU, 0x83F3D70EU, 0x90A324FAU, 0x62C8A7F9U,
+    0xB602C312U, 0x44694011U, 0x5739B3E5U, 0xA55230E6U,
+    0xFB410CC2U, 0x092A8FC1U, 0x1A7A7C35U, 0xE811FF36U,
+    0x3CDB9BDDU, 0xCEB018DEU, 0xDDE0EB2AU, 0x2F8B6829U,
+    0x82F63B78U, 0x709DB87BU, 0x63CD4B8FU, 0x91A6C88CU,
+    0x456CAC67U, 0xB7072F64U, 0xA457DC90U, 0x563C5F93U,
+    0x082F63B7U, 0xFA44E0B4U, 0xE9141340U, 0x1B7F9043U,
+    0xCFB5F4A8U, 0x3DDE77ABU, 0x2E8E845FU, 0xDCE5075CU,
+    0x92A8FC17U, 0x60C37F14U, 0x73938CE0U, 0x81F80FE3U,
+    0x55326B08U, 0xA759E80BU, 0xB4091BFFU, 0x466298FCU,
+    0x1871A4D8U, 0xEA1A27DBU, 0xF94AD42FU, 0x0B21572CU,
+    0xDFEB33C7U, 0x2D80B0C4U, 0x3ED04330U, 0xCCBBC033U,
+    0xA24BB5A6U, 0x502036A5U, 0x4370C551U, 0xB11B4652U,
+    0x65D122B9U, 0x97BAA1BAU, 0x84EA524EU, 0x7681D14DU,
+    0x2892ED69U, 0xDAF96E6AU, 0xC9A99D9EU, 0x3BC21E9DU,
+    0xEF087A76U, 0x1D63F975U, 0x0E330A81U, 0xFC588982U,
+    0xB21572C9U, 0x407EF1CAU, 0x532E023EU, 0xA145813DU,
+    0x758FE5D6U, 0x87E466D5U, 0x94B49521U, 0x66DF1622U,
+    0x38CC2A06U, 0xCAA7A905U, 0xD9F75AF1U, 0x2B9CD9F2U,
+    0xFF56BD19U, 0x0D3D3E1AU, 0x1E6DCDEEU, 0xEC064EEDU,
+    0xC38D26C4U, 0x31E6A5C7U, 0x22B65633U, 0xD0DDD530U,
+    0x0417B1DBU, 0xF67C32D8U, 0xE52CC12CU, 0x1747422FU,
+    0x49547E0BU, 0xBB3FFD08U, 0xA86F0EFCU, 0x5A048DFFU,
+    0x8ECEE914U, 0x7CA56A17U, 0x6FF599E3U, 0x9D9E1AE0U,
+    0xD3D3E1ABU, 0x21B862A8U, 0x32E8915CU, 0xC083125FU,
+    0x144976B4U, 0xE622F5B7U, 0xF5720643U, 0x07198540U,
+    0x590AB964U, 0xAB613A67U, 0xB831C993U, 0x4A5A4A90U,
+    0x9E902E7BU, 0x6CFBAD78U, 0x7FAB5E8CU, 0x8DC0DD8FU,
+    0xE330A81AU, 0x115B2B19U, 0x020BD8EDU, 0xF0605BEEU,
+    0x24AA3F05U, 0xD6C1BC06U, 0xC5914FF2U, 0x37FACCF1U,
+    0x69E9F0D5U, 0x9B8273D6U, 0x88D28022U, 0x7AB90321U,
+    0xAE7367CAU, 0x5C18E4C9U, 0x4F48173DU, 0xBD23943EU,
+    0xF36E6F75U, 0x0105EC76U, 0x12551F82U, 0xE03E9C81U,
+    0x34F4F86AU, 0xC69F7B69U, 0xD5CF889DU, 0x27A40B9EU,
+    0x79B737BAU, 0x8BDCB4B9U, 0x988C474DU, 0x6AE7C44EU,
+    0xBE2DA0A5U, 0x4C4623A6U, 0x5F16D052U, 0xAD7D5351U
+};
+
+typedef struct {
+    char*	buf;
+    size_t	len;
+    size_t	max;
+} DD_BUF;
+
+typedef struct {
+    size_t	off;		/* of the record in the buffer */
+    size_t	len;
+    char*	p;		/* the record, once the buffer is complete */
+} DD_REC;
+
+typedef struct {
+    DD_BUF	data;
+    DD_REC*	pRecs;
+    int		nRecs;
+    int		maxRecs;
+} DD_CANON;
+
+typedef struct {
+    char**	files;
+    UINT64*	pHashes;
+    int*	pFirst;
+    int*	pOK;
+} DD_BATCH;
+
+typedef struct {
+    UINT64	hash;
+    int		index;
+} DD_ORDER;
+
+static UINT32 crc_bytes _ANSI_ARGS_(( UINT32 crc, UINT8* p, size_t n ));
+static UINT32 crc_word _ANSI_ARGS_(( UINT32 crc, UINT8* p ));
+static char* grow _ANSI_ARGS_(( DD_BUF* pBuf, size_t n ));
+static int add_sections _ANSI_ARGS_(( DD_CANON* pCanon, MUD_SEC_GRP* pMUD_grp ));
+static int add_record _ANSI_ARGS_(( DD_CANON* pCanon, MUD_SEC_GRP* pMUD_grp, MUD_SEC* pSec ));
+static int cmp_recs _ANSI_ARGS_(( const void* p1, const void* p2 ));
+static int cmp_order _ANSI_ARGS_(( const void* p1, const void* p2 ));
+static int read_canon _ANSI_ARGS_(( char* filename, char** ppBuf, size_t* pSize ));
+static void hash_task _ANSI_ARGS_(( int task, int thread, void* pArg ));
+static void verify_task _ANSI_ARGS_(( int task, int thread, void* pArg ));
+
+
+static UINT32
+crc_bytes( UINT32 crc, UINT8* p, size_t n )
+{
+    for( ; n > 0; n--, p++ )
+    {
+	crc = crcTable[( crc ^ *p ) & 0xFF] ^ ( crc >> 8 );
+    }
+    return( crc );
+}
+
+
+/*
+ *  crc_word() - CRC32C of 8 bytes in memory order
+ */
+static UINT32
+crc_word( UINT32 crc, UINT8* p )
+{
+#if defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32)
+    UINT64 w;
+
+    bcopy( p, &w, 8 );
+#if defined(__SSE4_2__)
+    return( (UINT32)_mm_crc32_u64( crc, w ) );
+#else
+    return( __crc32cd( crc, w ) );
+#endif /* __SSE4_2__ */
+#else
+    return( crc_bytes( crc, p, 8 ) );
+#endif /* __SSE4_2__ || __ARM_FEATURE_CRC32 */
+}
+
+
+/*
+ *  MUD_crc32c() - CRC32C of n bytes, continuing from crc (0 to start)
+ */
+UINT32
+MUD_crc32c( UINT32 crc, void* pData, size_t n )
+{
+    UINT8* p = (UINT8*)pData;
+
+    crc = ~crc;
+    for( ; n >= 8; n -= 8, p += 8 ) crc = crc_word( crc, p );
+    return( ~crc_bytes( crc, p, n ) );
+}
+
+
+static char*
+grow( DD_BUF* pBuf, size_t n )
+{
+    char* buf;
+    size_t max;
+
+    if( pBuf->len + n > pBuf->max )
+    {
+	for( max = _max( pBuf->max, 4096 ); max < pBuf->len + n; max *= 2 ) ;
+	if( ( buf = (char*)realloc( pBuf->buf, max ) ) == NULL ) return( NULL );
+	pBuf->buf = buf;
+	pBuf->max = max;
+    }
+    buf = pBuf->buf + pBuf->len;
+    pBuf->len += n;
+    return( buf );
+}
+
+
+/*
+ *  add_record() - the record of a section of the group pMUD_grp
+ */
+static int
+add_record( DD_CANON* pCanon, MUD_SEC_GRP* pMUD_grp, MUD_SEC* pSec )
+{
+    MUD_SEC_GEN_HIST_HDR hdr;
+    MUD_SEC_GEN_HIST_HDR* pHdr = NULL;
+    MUD_SEC_GEN_HIST_DAT* pDat;
+    MUD_SEC* pHdrSec;
+    DD_REC* pRecs;
+    UINT32* pBins = NULL;
+    UINT32 key[3], len, i;
+    BUF buf;
+    char* b;
+    size_t off;
+
+    /*
+     *  Histogram data go with their header, unpacked
+     */
+    if( MUD_secID( pSec ) == MUD_SEC_GEN_HIST_DAT_ID )
+    {
+	pDat = (MUD_SEC_GEN_HIST_DAT*)pSec;
+	for( pHdrSec = (MUD_SEC*)pMUD_grp->pMem; pHdrSec != NULL; pHdrSec = MUD_pNext( pHdrSec ) )
+	{
+	    if( MUD_secID( pHdrSec ) == MUD_SEC_GEN_HIST_HDR_ID &&
+		MUD_instanceID( pHdrSec ) == MUD_instanceID( pSec ) ) break;
+	}
+	pHdr = (MUD_SEC_GEN_HIST_HDR*)pHdrSec;
+	if( pHdr != NULL && pDat->pData != NULL &&
+	    ( pHdr->bytesPerBin == 0 || pHdr->bytesPerBin == 1 ||
+	      pHdr->bytesPerBin == 2 || pHdr->bytesPerBin == 4 ||
+	      pHdr->bytesPerBin == MUD_BPB_SPARSE ) )
+	{
+	    if( ( pBins = (UINT32*)malloc( ( pHdr->nBins + 1 )*sizeof( UINT32 ) ) ) == NULL )
+		return( 0 );
+	    MUD_SEC_GEN_HIST_unpackData( pHdr->nBins, pHdr->bytesPerBin, pDat->pData, pDat->nBytes, 4, pBins );
+	    len = pHdr->nBins*4;
+	}
+	else
+	{
+	    len = ( pDat->pData != NULL ) ? pDat->nBytes : 0;
+	}
+    }
+    else if( MUD_secID( pSec ) == MUD_SEC_GEN_HIST_HDR_ID )
+    {
+	bcopy( pSec, &hdr, sizeof( hdr ) );
+	hdr.nBytes = 0;
+	hdr.bytesPerBin = 0;
+	pSec = (MUD_SEC*)&hdr;
+	len = (UINT32)(*pSec->core.proc)( MUD_GET_SIZE, NULL, (void*)pSec );
+    }
+    else
+    {
+	len = (UINT32)(*pSec->core.proc)( MUD_GET_SIZE, NULL, (void*)pSec );
+    }
+
+    if( pCanon->nRecs == pCanon->maxRecs )
+    {
+	pCanon->maxRecs = _max( 2*pCanon->maxRecs, 64 );
+	pRecs = (DD_REC*)realloc( pCanon->pRecs, pCanon->maxRecs*sizeof( DD_REC ) );
+	if( pRecs == NULL )
+	{
+	    _free( pBins );
+	    return( 0 );
+	}
+	pCanon->pRecs = pRecs;
+    }
+    off = pCanon->data.len;
+    if( ( b = grow( &pCanon->data, DD_KEY + 4 + len ) ) == NULL )
+    {
+	_free( pBins );
+	return( 0 );
+    }
+
+    key[0] = MUD_instanceID( pMUD_grp );
+    key[1] = MUD_secID( pSec );
+    key[2] = MUD_instanceID( pSec );
+    bencode_4( b, &key[0] );
+    bencode_4( b + 4, &key[1] );
+    bencode_4( b + 8, &key[2] );
+    bencode_4( b + 12, &len );
+    b += DD_KEY + 4;
+
+    if( pBins != NULL )
+    {
+	for( i = 0; i < pHdr->nBins; i++ ) bencode_4( b + 4*i, &pBins[i] );
+	free( pBins );
+    }
+    else if( MUD_secID( pSec ) == MUD_SEC_GEN_HIST_DAT_ID )
+    {
+	if( len > 0 ) bcopy( ((MUD_SEC_GEN_HIST_DAT*)pSec)->pData, b, len );
+    }
+    else
+    {
+	buf.buf = b;
+	buf.pos = 0;
+	buf.size = len;
+	(*pSec->core.proc)( MUD_ENCODE, &buf, (void*)pSec );
+    }
+
+    pCanon->pRecs[pCanon->nRecs].off = off;
+    pCanon->pRecs[pCanon->nRecs].len = DD_KEY + 4 + len;
+    pCanon->nRecs++;
+    return( 1 );
+}
+
+
+static int
+add_sections( DD_CANON* pCanon, MUD_SEC_GRP* pMUD_grp )
+{
+    MUD_SEC* pSec;
+
+    for( pSec = (MUD_SEC*)pMUD_grp->pMem; pSec != NULL; pSec = MUD_pNext( pSec ) )
+    {
+	if( MUD_secID( pSec ) == MUD_SEC_GRP_ID )
+	{
+	    if( !add_sections( pCanon, (MUD_SEC_GRP*)pSec ) ) return( 0 );
+	}
+	else if( MUD_secID( pSec ) != MUD_SEC_EOF_ID )
+	{
+	    if( !add_record( pCanon, pMUD_grp, pSec ) ) return( 0 );
+	}
+    }
+    return( 1 );
+}
+
+
+/*
+ *  cmp_recs() - by key, then contents
+ */
+static int
+cmp_recs( const void* p1, const void* p2 )
+{
+    DD_REC* pRec1 = (DD_REC*)p1;
+    DD_REC* pRec2 = (DD_REC*)p2;
+    int c;
+
+    c = memcmp( pRec1->p, pRec2->p, _min( pRec1->len, pRec2->len ) );
+    if( c != 0 ) return( c );
+    return( ( pRec1->len < pRec2->len ) ? -1 : ( pRec1->len > pRec2->len ) );
+}
+
+
+/*
+ *  MUD_runCanon() - the canonical form of a run (as read by MUD_readFile)
+ *  in a buffer from malloc, *ppBuf, of *pSize bytes; returns 0 if out
+ *  of memory.
+ */
+int
+MUD_runCanon( MUD_SEC_GRP* pMUD_fileGrp, char** ppBuf, size_t* pSize )
+{
+    DD_CANON canon;
+    char* buf = NULL;
+    size_t len;
+    int i, status = 0;
+
+    bzero( &canon, sizeof( canon ) );
+    if( !add_sections( &canon, pMUD_fileGrp ) ) goto done;
+
+    /*
+     *  The keys are as written (not in the byte order of the machine),
+     *  so the records are sorted by their bytes
+     */
+    for( i = 0; i < canon.nRecs; i++ )
+	canon.pRecs[i].p = canon.data.buf + canon.pRecs[i].off;
+    if( canon.nRecs > 1 ) qsort( canon.pRecs, canon.nRecs, sizeof( DD_REC ), cmp_recs );
+
+    if( ( buf = (char*)malloc( canon.data.len + 1 ) ) == NULL ) goto done;
+    for( i = 0, len = 0; i < canon.nRecs; i++ )
+    {
+	bcopy( canon.pRecs[i].p, buf + len, canon.pRecs[i].len );
+	len += canon.pRecs[i].len;
+    }
+    *ppBuf = buf;
+    *pSize = len;
+    status = 1;
+
+done:
+    _free( canon.data.buf );
+    _free( canon.pRecs );
+    return( status );
+}
+
+
+/*
+ *  MUD_runHash() - the content hash of a run (as read by MUD_readFile);
+ *  returns 0 if out of memory.
+ */
+int
+MUD_runHash( MUD_SEC_GRP* pMUD_fileGrp, UINT64* pHash )
+{
+    UINT8 len[8];
+    UINT8* p;
+    char* buf;
+    size_t n;
+    UINT32 a = 0xFFFFFFFF, b = 0xFFFFFFFF;
+    int i;
+
+    if( !MUD_runCanon( pMUD_fileGrp, &buf, &n ) ) return( 0 );
+
+    /*
+     *  Two independent sums, which the CRC instructions overlap
+     */
+    for( i = 0; i < 8; i++ ) len[i] = (UINT8)( (UINT64)n >> ( 8*i ) );
+    for( p = (UINT8*)buf; n >= 16; n -= 16, p += 16 )
+    {
+	a = crc_word( a, p );
+	b = crc_word( b, p + 8 );
+    }
+    if( n >= 8 )
+    {
+	a = crc_word( a, p );
+	p += 8;
+	n -= 8;
+    }
+    a = crc_bytes( a, p, n );
+    b = crc_word( b, len );
+
+    free( buf );
+    *pHash = ( (UINT64)~b << 32 ) | (UINT64)~a;
+    return( 1 );
+}
+
+
+static int
+cmp_order( const void* p1, const void* p2 )
+{
+    DD_ORDER* pOrder1 = (DD_ORDER*)p1;
+    DD_ORDER* pOrder2 = (DD_ORDER*)p2;
+
+    if( pOrder1->hash != pOrder2->hash ) return( ( pOrder1->hash < pOrder2->hash ) ? -1 : 1 );
+    return( pOrder1->index - pOrder2->index );
+}
+
+
+static int
+read_canon( char* filename, char** ppBuf, size_t* pSize )
+{
+    MUD_SEC_GRP* pMUD_fileGrp;
+    FILE* fin;
+    int status;
+
+    if( ( fin = MUD_openInput( filename ) ) == NULL ) return( 0 );
+    pMUD_fileGrp = (MUD_SEC_GRP*)MUD_readFile( fin );
+    fclose( fin );
+    if( pMUD_fileGrp == NULL ) return( 0 );
+    status = MUD_runCanon( pMUD_fileGrp, ppBuf, pSize );
+    MUD_free( pMUD_fileGrp );
+    return( status );
+}
+
+
+static void
+hash_task( int task, int thread, void* pArg )
+{
+    DD_BATCH* pB = (DD_BATCH*)pArg;
+    MUD_SEC_GRP* pMUD_fileGrp;
+    FILE* fin;
+
+    pB->pOK[task] = 0;
+    if( ( fin = MUD_openInput( pB->files[task] ) ) == NULL ) return;
+    pMUD_fileGrp = (MUD_SEC_GRP*)MUD_readFile( fin );
+    fclose( fin );
+    if( pMUD_fileGrp == NULL ) return;
+
+    pB->pOK[task] = MUD_runHash( pMUD_fileGrp, &pB->pHashes[task] );
+    MUD_free( pMUD_fileGrp );
+}
+
+
+/*
+ *  verify_task() - a run with the hash of an earlier one is a copy of it
+ *  only if their canonical forms are the same
+ */
+static void
+verify_task( int task, int thread, void* pArg )
+{
+    DD_BATCH* pB = (DD_BATCH*)pArg;
+    char* buf1 = NULL;
+    char* buf2 = NULL;
+    size_t n1, n2;
+    int first = pB->pFirst[task];
+
+    if( first == task || first < 0 ) return;
+    if( !read_canon( pB->files[task], &buf1, &n1 ) ||
+	!read_canon( pB->files[first], &buf2, &n2 ) ||
+	n1 != n2 || memcmp( buf1, buf2, n1 ) != 0 ) pB->pFirst[task] = task;
+    _free( buf1 );
+    _free( buf2 );
+}
+
+
+/*
+ *  MUD_dedupRuns() - the content hashes of num files, read on nThreads
+ *  threads (0 for the default), in pHashes, and for each file the index
+ *  of the first file holding the same run, in pFirst: the file itself
+ *  if there is no earlier copy, -1 if it cannot be read.  (Runs with
+ *  the same hash but different contents are taken as different, but
+ *  then only the first is found as a copy.)  Returns the number of
+ *  different runs, -1 if out of memory.
+ */
+int
+MUD_dedupRuns( int num, char** files, int nThreads, UINT64* pHashes, int* pFirst )
+{
+    DD_BATCH batch;
+    DD_ORDER* pOrder;
+    int i, j, n;
+
+    batch.files = files;
+    batch.pHashes = pHashes;
+    batch.pFirst = pFirst;
+    batch.pOK = (int*)zalloc( ( num + 1 )*sizeof( int ) );
+    pOrder = (DD_ORDER*)malloc( ( num + 1 )*sizeof( DD_ORDER ) );
+    if( batch.pOK == NULL || pOrder == NULL )
+    {
+	_free( batch.pOK );
+	_free( pOrder );
+	return( -1 );
+    }
+
+    MUD_parallelFor( num, nThreads, hash_task, &batch );
+
+    /*
+     *  Files by hash, then by index; the first of each hash stands for
+     *  the others
+     */
+    for( i = 0, n = 0; i < num; i++ )
+    {
+	pFirst[i] = -1;
+	if( batch.pOK[i] )
+	{
+	    pOrder[n].hash = pHashes[i];
+	    pOrder[n].index = i;
+	    n++;
+	}
+    }
+    if( n > 1 ) qsort( pOrder, n, sizeof( DD_ORDER ), cmp_order );
+    for( i = 0; i < n; i = j )
+    {
+	for( j = i; j < n && pOrder[j].hash == pOrder[i].hash; j++ )
+	    pFirst[pOrder[j].index] = pOrder[i].index;
+    }
+
+    MUD_parallelFor( num, nThreads, verify_task, &batch );
+
+    for( i = 0, n = 0; i < num; i++ )
+    {
+	if( pFirst[i] == i ) n++;
+    }
+    free( pOrder );
+    free( batch.pOK );
+    return( n );
+}
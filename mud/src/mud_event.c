@@ -0,0 +1,582 @@
+/*
+ *  mud_event.c -- event-mode (list-mode) data: encoding of MUD_SEC_GEN_EVENT
+ *                 sections, and histogramming of events into the usual
+ *                 MUD_SEC_GEN_HIST_HDR/DAT histograms
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version
+ *          18-Oct-2026      Fail on blocks that cannot be decoded; AVX2 binning
+ *
+ *  Description:
+ *    An event is a (detector, time) pair: a 16-bit detector number and a
+ *    32-bit time stamp counted in ticks of fsPerTick femtoseconds.  The
+ *    events of one MUD_SEC_GEN_EVENT section are stored in blocks of at
+ *    most MUD_EVENT_BLOCK_LEN events:
+ *
+ *      UINT32  nBytes        bytes of encoded events following this header
+ *      UINT32  nEvents       events in the block
+ *      nEvents x { varint zigzag(time - previous time),
+ *                  varint zigzag(detector - previous detector) }
+ *
+ *    where the "previous" values start at zero in each block, so every
+ *    block can be decoded on its own (and in parallel).  The varints use
+ *    7 bits per byte, low-order first, with the high bit set on all but
+ *    the last byte.  For time-ordered data from a few detectors that is
+ *    typically 2-3 bytes per event.
+ *
+ *    A long run is split over several sections of at most
+ *    MUD_EVENT_SEC_LEN events, collected in a MUD_GRP_GEN_EVENT_ID group,
+ *    which keeps every section well inside the 32-bit section size and
+ *    lets the file be read one section at a time.
+ *
+ *    MUD_SEC_GEN_EVENT_hist() gives the blocks to threads; each decodes a
+ *    block, works out the bins of all its events (four at a time with
+ *    AVX2, for a power of two ticks per bin, when the library is compiled
+ *    for it, "-mavx2"), then counts them into its own histograms.
+ */
+
+#include "mud.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif /* __AVX2__ */
+
+#define MUD_EVENT_BLOCK_LEN	4096
+#define MUD_EVENT_SEC_LEN	(1024*MUD_EVENT_BLOCK_LEN)
+#define MUD_EVENT_BLOCK_HDR	8
+#define MUD_EVENT_MAX_BYTES	8	/* worst case bytes per encoded event */
+
+#define _zigzag( d )		( ( (UINT32)(d) << 1 ) ^ (UINT32)( (INT32)(d) >> 31 ) )
+#define _unzigzag( z )		( ( (z) >> 1 ) ^ ( 0 - ( (z) & 1 ) ) )
+
+typedef struct {
+    MUD_SEC_GEN_EVENT* pMUD;
+    UINT32	num;
+    UINT16*	pDet;
+    UINT32*	pTime;
+    UINT8*	pScratch;	/* worst-case sized region per block */
+    UINT32*	pLen;		/* encoded length of each block */
+} EVENT_ENCODE;
+
+typedef struct {
+    UINT8*	pBlock;		/* block header */
+    UINT8*	pEnd;		/* end of the section data */
+} EVENT_BLOCK;
+
+typedef struct {
+    EVENT_BLOCK* pBlocks;
+    MUD_EVENT_BINNING* pBin;
+    INT64	tStart;		/* tick at the start of bin 0 */
+    int		shift;		/* log2(ticksPerBin), or -1 */
+    UINT32*	pHists;		/* nThreads sets of nHists*nBins bins */
+    size_t	nTot;		/* nHists*nBins */
+    int		nThreads;
+    UINT32*	pTimes;		/* per thread, the events of a block */
+    UINT16*	pDets;
+    UINT64*	pIdx;		/* per thread, the bin of each event, or nTot */
+    char*	pFailed;	/* per thread, a block could not be decoded */
+} EVENT_HIST;
+
+static int put_varint _ANSI_ARGS_(( UINT8* p, UINT32 v ));
+static int get_varint _ANSI_ARGS_(( UINT8** pp, UINT8* pEnd, UINT32* pv ));
+static void encode_block _ANSI_ARGS_(( int task, int thread, void* pArg ));
+static void bin_events _ANSI_ARGS_(( EVENT_HIST* pH, UINT32 n, UINT32* pTime, UINT16* pDet, UINT64* pIdx ));
+static void hist_block _ANSI_ARGS_(( int task, int thread, void* pArg ));
+static void merge_bins _ANSI_ARGS_(( int task, int thread, void* pArg ));
+static int count_blocks _ANSI_ARGS_(( MUD_SEC* pMUD_list, EVENT_BLOCK* pBlocks ));
+
+
+static int
+put_varint( UINT8* p, UINT32 v )
+{
+    int n = 0;
+
+    while( v >= 0x80 )
+    {
+	p[n++] = (UINT8)( v | 0x80 );
+	v >>= 7;
+    }
+    p[n++] = (UINT8)v;
+    return( n );
+}
+
+
+static int
+get_varint( UINT8** pp, UINT8* pEnd, UINT32* pv )
+{
+    UINT8* p = *pp;
+    UINT32 v = 0;
+    int shift = 0;
+
+    while( p < pEnd && shift < 35 )
+    {
+	v |= (UINT32)( *p & 0x7f ) << shift;
+	if( !( *p++ & 0x80 ) )
+	{
+	    *pp = p;
+	    *pv = v;
+	    return( 1 );
+	}
+	shift += 7;
+    }
+    return( 0 );
+}
+
+
+static void
+encode_block( int task, int thread, void* pArg )
+{
+    EVENT_ENCODE* pE = (EVENT_ENCODE*)pArg;
+    UINT8* p;
+    UINT32 first, n, i;
+    UINT32 prevTime = 0;
+    UINT16 prevDet = 0;
+    UINT32 len;
+
+    first = (UINT32)task*MUD_EVENT_BLOCK_LEN;
+    n = _min( pE->num - first, MUD_EVENT_BLOCK_LEN );
+    p = pE->pScratch + (size_t)task*( MUD_EVENT_BLOCK_HDR +
+				      MUD_EVENT_BLOCK_LEN*MUD_EVENT_MAX_BYTES );
+    len = MUD_EVENT_BLOCK_HDR;
+
+    for( i = first; i < first + n; i++ )
+    {
+	len += put_varint( p + len, _zigzag( pE->pTime[i] - prevTime ) );
+	len += put_varint( p + len, _zigzag( (INT32)pE->pDet[i] - (INT32)prevDet ) );
+	prevTime = pE->pTime[i];
+	prevDet = pE->pDet[i];
+    }
+
+    i = len - MUD_EVENT_BLOCK_HDR;
+    bencode_4( p, &i );
+    bencode_4( p + 4, &n );
+    pE->pLen[task] = len;
+}
+
+
+/*
+ *  MUD_SEC_GEN_EVENT_encode() - encode num events into the section,
+ *  replacing any data it had.  Returns 1 on success, 0 on failure.
+ */
+int
+MUD_SEC_GEN_EVENT_encode( MUD_SEC_GEN_EVENT* pMUD, UINT32 num, UINT16* pDet, UINT32* pTime )
+{
+    EVENT_ENCODE enc;
+    UINT32 nBlocks;
+    size_t stride;
+    UINT32 i;
+    UINT32 pos;
+
+    nBlocks = ( num + MUD_EVENT_BLOCK_LEN - 1 )/MUD_EVENT_BLOCK_LEN;
+    stride = MUD_EVENT_BLOCK_HDR + MUD_EVENT_BLOCK_LEN*MUD_EVENT_MAX_BYTES;
+
+    bzero( &enc, sizeof( enc ) );
+    enc.pMUD = pMUD;
+    enc.num = num;
+    enc.pDet = pDet;
+    enc.pTime = pTime;
+    enc.pScratch = (UINT8*)malloc( _max( nBlocks, 1 )*stride );
+    enc.pLen = (UINT32*)malloc( _max( nBlocks, 1 )*sizeof( UINT32 ) );
+    if( enc.pScratch == NULL || enc.pLen == NULL )
+    {
+	_free( enc.pScratch );
+	_free( enc.pLen );
+	return( 0 );
+    }
+
+    /*
+     *  Blocks are independent, so encode them in parallel into
+     *  worst-case slots, then squeeze out the gaps.
+     */
+    MUD_parallelFor( (int)nBlocks, 0, encode_block, &enc );
+
+    for( i = 0, pos = 0; i < nBlocks; i++ )
+    {
+	memmove( enc.pScratch + pos, enc.pScratch + i*stride, enc.pLen[i] );
+	pos += enc.pLen[i];
+    }
+
+    _free( pMUD->pData );
+    pMUD->pData = (caddr_t)realloc( enc.pScratch, _max( pos, 1 ) );
+    if( pMUD->pData == NULL ) pMUD->pData = (caddr_t)enc.pScratch;
+    pMUD->nBytes = pos;
+    pMUD->nBlocks = nBlocks;
+    pMUD->nEvents = num;
+
+    free( enc.pLen );
+    return( 1 );
+}
+
+
+/*
+ *  MUD_SEC_GEN_EVENT_decode() - decode all events of the section into
+ *  pDet[nEvents] and pTime[nEvents].  Returns 1 on success, 0 if the
+ *  data are corrupt.
+ */
+int
+MUD_SEC_GEN_EVENT_decode( MUD_SEC_GEN_EVENT* pMUD, UINT16* pDet, UINT32* pTime )
+{
+    UINT8* p;
+    UINT8* pEnd;
+    UINT8* pBlockEnd;
+    UINT32 nBytes, n, b, i, k;
+    UINT32 t, d, prevTime;
+    UINT16 prevDet;
+
+    p = (UINT8*)pMUD->pData;
+    pEnd = p + pMUD->nBytes;
+    k = 0;
+
+    for( b = 0; b < pMUD->nBlocks; b++ )
+    {
+	if( p + MUD_EVENT_BLOCK_HDR > pEnd ) return( 0 );
+	bdecode_4( p, &nBytes );
+	bdecode_4( p + 4, &n );
+	p += MUD_EVENT_BLOCK_HDR;
+	pBlockEnd = p + nBytes;
+	if( pBlockEnd > pEnd || k + n > pMUD->nEvents ) return( 0 );
+
+	prevTime = 0;
+	prevDet = 0;
+	for( i = 0; i < n; i++, k++ )
+	{
+	    if( !get_varint( &p, pBlockEnd, &t ) ) return( 0 );
+	    if( !get_varint( &p, pBlockEnd, &d ) ) return( 0 );
+	    prevTime += _unzigzag( t );
+	    prevDet += (UINT16)_unzigzag( d );
+	    pTime[k] = prevTime;
+	    pDet[k] = prevDet;
+	}
+	p = pBlockEnd;
+    }
+
+    return( k == pMUD->nEvents );
+}
+
+
+/*
+ *  MUD_SEC_GEN_EVENT_group() - build a MUD_GRP_GEN_EVENT_ID group holding
+ *  num events, split over as many sections as needed.
+ */
+MUD_SEC_GRP*
+MUD_SEC_GEN_EVENT_group( UINT32 num, UINT32 fsPerTick, UINT16* pDet, UINT32* pTime )
+{
+    MUD_SEC_GRP* pMUD_grp;
+    MUD_SEC_GEN_EVENT* pMUD_event;
+    UINT32 first, n;
+    int i;
+
+    pMUD_grp = (MUD_SEC_GRP*)MUD_new( MUD_SEC_GRP_ID, MUD_GRP_GEN_EVENT_ID );
+    if( pMUD_grp == NULL ) return( NULL );
+
+    for( first = 0, i = 1; first < num || i == 1; first += n, i++ )
+    {
+	n = _min( num - first, MUD_EVENT_SEC_LEN );
+	pMUD_event = (MUD_SEC_GEN_EVENT*)MUD_new( MUD_SEC_GEN_EVENT_ID, i );
+	if( pMUD_event == NULL ||
+	    !MUD_SEC_GEN_EVENT_encode( pMUD_event, n, &pDet[first], &pTime[first] ) )
+	{
+	    MUD_free( pMUD_event );
+	    MUD_free( pMUD_grp );
+	    return( NULL );
+	}
+	pMUD_event->fsPerTick = fsPerTick;
+	MUD_addToGroup( pMUD_grp, pMUD_event );
+	if( n == 0 ) break;
+    }
+
+    return( pMUD_grp );
+}
+
+
+/*
+ *  Locate the blocks of all event sections in a list (descending into
+ *  groups).  With pBlocks NULL, just count them.
+ */
+static int
+count_blocks( MUD_SEC* pMUD_list, EVENT_BLOCK* pBlocks )
+{
+    MUD_SEC* pMUD;
+    MUD_SEC_GEN_EVENT* pMUD_event;
+    UINT8* p;
+    UINT8* pEnd;
+    UINT32 nBytes, b;
+    int nBlocks = 0;
+    int n;
+
+    for( pMUD = pMUD_list; pMUD != NULL; pMUD = pMUD->core.pNext )
+    {
+	if( MUD_secID( pMUD ) == MUD_SEC_GRP_ID )
+	{
+	    n = count_blocks( ((MUD_SEC_GRP*)pMUD)->pMem,
+			      ( pBlocks == NULL ) ? NULL : &pBlocks[nBlocks] );
+	    if( n < 0 ) return( n );
+	    nBlocks += n;
+	    continue;
+	}
+	if( MUD_secID( pMUD ) != MUD_SEC_GEN_EVENT_ID ) continue;
+
+	pMUD_event = (MUD_SEC_GEN_EVENT*)pMUD;
+	p = (UINT8*)pMUD_event->pData;
+	pEnd = p + pMUD_event->nBytes;
+	for( b = 0; b < pMUD_event->nBlocks; b++ )
+	{
+	    if( p + MUD_EVENT_BLOCK_HDR > pEnd ) return( -1 );
+	    if( pBlocks != NULL )
+	    {
+		pBlocks[nBlocks].pBlock = p;
+		pBlocks[nBlocks].pEnd = pEnd;
+	    }
+	    nBlocks++;
+	    bdecode_4( p, &nBytes );
+	    p += MUD_EVENT_BLOCK_HDR + nBytes;
+	}
+    }
+
+    return( nBlocks );
+}
+
+
+/*
+ *  bin_events() - the bin (det*nBins + bin) of each of n events, or nTot
+ *  for those cut.  With a power of two ticks per bin, four events at a
+ *  time with AVX2 when the library is compiled for it ("-mavx2").
+ */
+static void
+bin_events( EVENT_HIST* pH, UINT32 n, UINT32* pTime, UINT16* pDet, UINT64* pIdx )
+{
+    MUD_EVENT_BINNING* pBin = pH->pBin;
+    UINT32 i = 0;
+    INT64 dt;
+
+#ifdef __AVX2__
+    __m256i t, d, b, ok, start, tMin, tMax, nHists, nBins, nTot, none;
+    __m128i sh;
+
+    if( pH->shift >= 0 )
+    {
+	start = _mm256_set1_epi64x( pH->tStart );
+	tMin = _mm256_set1_epi64x( (INT64)pBin->tMin - 1 );
+	tMax = _mm256_set1_epi64x( ( pBin->tMax != 0 ) ? (INT64)pBin->tMax : (INT64)1 << 40 );
+	nHists = _mm256_set1_epi64x( (INT64)pBin->nHists );
+	nBins = _mm256_set1_epi64x( (INT64)pBin->nBins );
+	nTot = _mm256_set1_epi64x( (INT64)pH->nTot );
+	none = _mm256_set1_epi64x( -1 );
+	sh = _mm_cvtsi32_si128( pH->shift );
+	for( ; i + 4 <= n; i += 4 )
+	{
+	    t = _mm256_cvtepu32_epi64( _mm_loadu_si128( (__m128i*)&pTime[i] ) );
+	    d = _mm256_cvtepu16_epi64( _mm_loadl_epi64( (__m128i*)&pDet[i] ) );
+	    b = _mm256_sub_epi64( t, start );
+	    ok = _mm256_cmpgt_epi64( b, none );
+	    b = _mm256_srl_epi64( b, sh );
+	    ok = _mm256_and_si256( ok, _mm256_cmpgt_epi64( nBins, b ) );
+	    ok = _mm256_and_si256( ok, _mm256_cmpgt_epi64( t, tMin ) );
+	    ok = _mm256_and_si256( ok, _mm256_cmpgt_epi64( tMax, t ) );
+	    ok = _mm256_and_si256( ok, _mm256_cmpgt_epi64( nHists, d ) );
+	    b = _mm256_add_epi64( _mm256_mul_epu32( d, nBins ), b );
+	    _mm256_storeu_si256( (__m256i*)&pIdx[i], _mm256_blendv_epi8( nTot, b, ok ) );
+	}
+    }
+#endif /* __AVX2__ */
+
+    for( ; i < n; i++ )
+    {
+	pIdx[i] = pH->nTot;
+	if( pDet[i] >= pBin->nHists || pTime[i] < pBin->tMin ) continue;
+	if( pBin->tMax != 0 && pTime[i] >= pBin->tMax ) continue;
+	dt = (INT64)pTime[i] - pH->tStart;
+	if( dt < 0 ) continue;
+	if( pH->shift >= 0 )
+	    dt >>= pH->shift;
+	else
+	    dt /= pBin->ticksPerBin;
+	if( dt >= pBin->nBins ) continue;
+	pIdx[i] = (UINT64)pDet[i]*pBin->nBins + (UINT64)dt;
+    }
+}
+
+
+/*
+ *  hist_block() - decode a block, bin its events, then count them into
+ *  the thread's histograms
+ */
+static void
+hist_block( int task, int thread, void* pArg )
+{
+    EVENT_HIST* pH = (EVENT_HIST*)pArg;
+    UINT32* pHist;
+    UINT32* pTime;
+    UINT16* pDet;
+    UINT64* pIdx;
+    UINT8* p;
+    UINT8* pBlockEnd;
+    UINT32 nBytes, n, i;
+    UINT32 t, d, time;
+    UINT16 det;
+
+    pHist = pH->pHists + (size_t)thread*pH->nTot;
+    pTime = pH->pTimes + (size_t)thread*MUD_EVENT_BLOCK_LEN;
+    pDet = pH->pDets + (size_t)thread*MUD_EVENT_BLOCK_LEN;
+    pIdx = pH->pIdx + (size_t)thread*MUD_EVENT_BLOCK_LEN;
+    p = pH->pBlocks[task].pBlock;
+    bdecode_4( p, &nBytes );
+    bdecode_4( p + 4, &n );
+    p += MUD_EVENT_BLOCK_HDR;
+    if( n > MUD_EVENT_BLOCK_LEN || nBytes > (size_t)( pH->pBlocks[task].pEnd - p ) )
+    {
+	pH->pFailed[thread] = 1;
+	return;
+    }
+    pBlockEnd = p + nBytes;
+
+    time = 0;
+    det = 0;
+    for( i = 0; i < n; i++ )
+    {
+	if( !get_varint( &p, pBlockEnd, &t ) ||
+	    !get_varint( &p, pBlockEnd, &d ) )
+	{
+	    pH->pFailed[thread] = 1;
+	    return;
+	}
+	time += _unzigzag( t );
+	det += (UINT16)_unzigzag( d );
+	pTime[i] = time;
+	pDet[i] = det;
+    }
+
+    bin_events( pH, n, pTime, pDet, pIdx );
+    for( i = 0; i < n; i++ )
+    {
+	if( pIdx[i] < pH->nTot ) pHist[pIdx[i]]++;
+    }
+}
+
+
+#define MERGE_CHUNK 16384
+
+static void
+merge_bins( int task, int thread, void* pArg )
+{
+    EVENT_HIST* pH = (EVENT_HIST*)pArg;
+    size_t first;
+    int n, t;
+
+    first = (size_t)task*MERGE_CHUNK;
+    n = (int)_min( pH->nTot - first, MERGE_CHUNK );
+    for( t = 1; t < pH->nThreads; t++ )
+    {
+	MUD_addHist32( &pH->pHists[first], &pH->pHists[(size_t)t*pH->nTot + first], n );
+    }
+}
+
+
+/*
+ *  MUD_SEC_GEN_EVENT_hist() - histogram the events of all event sections
+ *  in the list pMUD_list (e.g. the members of a file group; groups are
+ *  searched too) according to pBin.  Histogram h (detector h) goes to
+ *  pHists[h*nBins ... h*nBins+nBins-1], which must have room for
+ *  nHists*nBins bins and is overwritten.  Each thread fills its own
+ *  copy of the histograms, and the copies are summed at the end.
+ *  Returns 1 on success, 0 on failure (including a block that cannot be
+ *  decoded, when pHists is incomplete).
+ */
+int
+MUD_SEC_GEN_EVENT_hist( MUD_SEC* pMUD_list, MUD_EVENT_BINNING* pBin, UINT32* pHists,
+			int nThreads )
+{
+    EVENT_HIST h;
+    int nBlocks;
+    int s, status = 1;
+
+    if( pBin->ticksPerBin == 0 || pBin->nHists == 0 || pBin->nBins == 0 ) return( 0 );
+
+    bzero( &h, sizeof( h ) );
+    h.pBin = pBin;
+    h.nTot = (size_t)pBin->nHists*pBin->nBins;
+    if( h.nTot/pBin->nBins != pBin->nHists ||
+	h.nTot > ( (size_t)-1 )/sizeof( UINT32 ) ) return( 0 );
+    h.tStart = (INT64)pBin->t0 - (INT64)pBin->t0_bin*pBin->ticksPerBin;
+    h.shift = -1;
+    for( s = 0; s < 32; s++ )
+    {
+	if( pBin->ticksPerBin == ( (UINT32)1 << s ) ) h.shift = s;
+    }
+
+    bzero( pHists, h.nTot*sizeof( UINT32 ) );
+
+    nBlocks = count_blocks( pMUD_list, NULL );
+    if( nBlocks <= 0 ) return( nBlocks == 0 );
+
+    h.pBlocks = (EVENT_BLOCK*)malloc( nBlocks*sizeof( EVENT_BLOCK ) );
+    if( h.pBlocks == NULL ) return( 0 );
+    count_blocks( pMUD_list, h.pBlocks );
+
+    /*
+     *  Thread-local histograms: with one thread, the caller's array;
+     *  otherwise one set per thread, summed into the caller's at the end.
+     */
+    h.nThreads = _min( MUD_numThreads( nThreads ), nBlocks );
+    if( h.nThreads > 1 )
+    {
+	if( h.nTot > ( (size_t)-1 )/sizeof( UINT32 )/h.nThreads ||
+	    ( h.pHists = (UINT32*)malloc( (size_t)h.nThreads*h.nTot*sizeof( UINT32 ) ) ) == NULL )
+	    h.nThreads = 1;
+    }
+    if( h.nThreads > 1 )
+    {
+	bzero( h.pHists, (size_t)h.nThreads*h.nTot*sizeof( UINT32 ) );
+    }
+    else
+    {
+	h.pHists = pHists;
+    }
+
+    h.pTimes = (UINT32*)malloc( (size_t)h.nThreads*MUD_EVENT_BLOCK_LEN*sizeof( UINT32 ) );
+    h.pDets = (UINT16*)malloc( (size_t)h.nThreads*MUD_EVENT_BLOCK_LEN*sizeof( UINT16 ) );
+    h.pIdx = (UINT64*)malloc( (size_t)h.nThreads*MUD_EVENT_BLOCK_LEN*sizeof( UINT64 ) );
+    h.pFailed = (char*)zalloc( h.nThreads );
+    if( h.pTimes == NULL || h.pDets == NULL || h.pIdx == NULL || h.pFailed == NULL )
+    {
+	status = 0;
+	goto done;
+    }
+
+    MUD_parallelFor( nBlocks, h.nThreads, hist_block, &h );
+    for( s = 0; s < h.nThreads; s++ )
+    {
+	if( h.pFailed[s] ) status = 0;
+    }
+
+    if( h.pHists != pHists )
+    {
+	MUD_parallelFor( (int)( ( h.nTot + MERGE_CHUNK - 1 )/MERGE_CHUNK ), h.nThreads,
+			 merge_bins, &h );
+	bcopy( h.pHists, pHists, h.nTot*sizeof( UINT32 ) );
+    }
+
+done:
+    if( h.pHists != pHists )
+    {
+	_free( h.pHists );
+    }
+    _free( h.pTimes );
+    _free( h.pDets );
+    _free( h.pIdx );
+    _free( h.pFailed );
+    free( h.pBlocks );
+    return( status );
+}
@@ -0,0 +1,405 @@
+/*
+ *  mud_export.c -- the headers and histograms of many runs, gathered for
+ *                  the exporters (mud_npy.c, mud_arrow.c,
+ *                  mud_dat.c)
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version
+ *          18-Oct-2026      Read MUD-C files too
+ *
+ *  Description:
+ *    The exporters write the runs as arrays: the counts as (runs,
+ *    histograms, bins), zero past the end of shorter runs and histograms,
+ *    and the headers alongside.  MUD_exportOpen() reads the headers of
+ *    all runs (by MUD_readRunFile, in parallel, so from MUD or MUD-C
+ *    files) for the shapes of the arrays and the header values; runs
+ *    that cannot be read are left out.  MUD_exportCounts() then reads
+ *    the counts of a block of runs, in parallel, unpacking the histograms
+ *    straight into the caller's buffer, so that an exporter never holds
+ *    more than a block of them.  MUD_exportBlock() is the number of runs
+ *    in a block that keeps the buffer to a few tens of megabytes.
+ *
+ *    The values of a run are indexed by MUD_EXP_FORMAT .. MUD_EXP_ELAPSED,
+ *    those of its histograms by MUD_EXP_HIST_TYPE .. MUD_EXP_NEVENTS, and
+ *    its strings by MUD_SHM_PATH .. MUD_SHM_COMMENT3; MUD_exportValName()
+ *    etc. are the names the exporters give them.
+ */
+
+#include "mud.h"
+
+#define EXP_BLOCK_BYTES	( 64*1048576 )	/* of counts read at a time */
+#define EXP_MAX_BLOCK	1024		/* runs read at a time */
+
+static char* valNames[MUD_EXP_NVALS] = {
+    "format", "expt_number", "run_number", "time_begin", "time_end", "elapsed_sec"
+};
+
+static char* histValNames[MUD_EXP_NHISTVALS] = {
+    "hist_type", "n_bins", "fs_per_bin", "t0_ps", "t0_bin",
+    "good_bin1", "good_bin2", "bkgd1", "bkgd2", "n_events"
+};
+
+static char* strNames[MUD_SHM_NSTR] = {
+    "path", "title", "lab", "area", "method", "apparatus", "insert", "sample",
+    "orient", "das", "experimenter", "temperature", "field", "subtitle",
+    "comment1", "comment2", "comment3"
+};
+
+typedef struct {
+    char**	files;		/* of the runs, for the headers */
+    MUD_EXPORT_RUN* pRuns;
+    UINT32*	pCounts;	/* of the block */
+    UINT32	maxHists;
+    UINT32	maxBins;
+} EXP_BATCH;
+
+static char* dup_str _ANSI_ARGS_(( char* s ));
+static REAL64 parse_qty _ANSI_ARGS_(( char* s, int kind ));
+static MUD_SEC_GRP* hist_group _ANSI_ARGS_(( MUD_SEC_GRP* pMUD_fileGrp ));
+static void read_run _ANSI_ARGS_(( MUD_SEC_GRP* pMUD_fileGrp, MUD_EXPORT_RUN* pRun ));
+static void free_run _ANSI_ARGS_(( MUD_EXPORT_RUN* pRun ));
+static void header_task _ANSI_ARGS_(( int task, int thread, void* pArg ));
+static void counts_task _ANSI_ARGS_(( int task, int thread, void* pArg ));
+
+
+char*
+MUD_exportValName( int i )
+{
+    return( ( i >= 0 && i < MUD_EXP_NVALS ) ? valNames[i] : NULL );
+}
+
+
+char*
+MUD_exportHistValName( int i )
+{
+    return( ( i >= 0 && i < MUD_EXP_NHISTVALS ) ? histValNames[i] : NULL );
+}
+
+
+char*
+MUD_exportStrName( int i )
+{
+    return( ( i >= 0 && i < MUD_SHM_NSTR ) ? strNames[i] : NULL );
+}
+
+
+static char*
+dup_str( char* s )
+{
+    char* p;
+
+    if( s == NULL || s[0] == '\0' ) return( NULL );
+    if( ( p = (char*)malloc( strlen( s ) + 1 ) ) != NULL ) strcpy( p, s );
+    return( p );
+}
+
+
+/*
+ *  parse_qty() - a temperature or field as a number; NaN unless there
+ *  is a number, in a known unit or none
+ */
+static REAL64
+parse_qty( char* s, int kind )
+{
+    union { UINT64 u; REAL64 d; } nan;
+    REAL64 value, error;
+    int status;
+
+    status = MUD_parseQuantity( s, kind, &value, &error );
+    if( !( status & MUD_QTY_VALUE ) || ( status & MUD_QTY_BADUNIT ) )
+    {
+	nan.u = 0x7FF8000000000000ULL;
+	return( nan.d );
+    }
+    return( value );
+}
+
+
+static MUD_SEC_GRP*
+hist_group( MUD_SEC_GRP* pMUD_fileGrp )
+{
+    MUD_SEC_GRP* pMUD_grp;
+
+    pMUD_grp = (MUD_SEC_GRP*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_GRP_ID, MUD_GRP_TRI_TD_HIST_ID, (UINT32)0 );
+    if( pMUD_grp == NULL )
+	pMUD_grp = (MUD_SEC_GRP*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_GRP_ID, MUD_GRP_TRI_TI_HIST_ID, (UINT32)0 );
+    return( pMUD_grp );
+}
+
+
+/*
+ *  read_run() - the values and strings of a run (as read by
+ *  MUD_readHeaders), but the path
+ */
+static void
+read_run( MUD_SEC_GRP* pMUD_fileGrp, MUD_EXPORT_RUN* pRun )
+{
+    MUD_SEC_GEN_RUN_DESC* pDesc;
+    MUD_SEC_TRI_TI_RUN_DESC* pIdesc;
+    MUD_SEC_GRP* pMUD_grp;
+    MUD_SEC_GEN_HIST_HDR* pHdr;
+    UINT32* v;
+    UINT32 i;
+
+    pRun->val[MUD_EXP_FORMAT] = MUD_instanceID( pMUD_fileGrp );
+
+    pDesc = (MUD_SEC_GEN_RUN_DESC*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_GEN_RUN_DESC_ID, (UINT32)1, (UINT32)0 );
+    pIdesc = (MUD_SEC_TRI_TI_RUN_DESC*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_TRI_TI_RUN_DESC_ID, (UINT32)1, (UINT32)0 );
+    if( pDesc != NULL )
+    {
+	pRun->val[MUD_EXP_EXPT] = pDesc->exptNumber;
+	pRun->val[MUD_EXP_RUN] = pDesc->runNumber;
+	pRun->val[MUD_EXP_TIME_BEGIN] = pDesc->timeBegin;
+	pRun->val[MUD_EXP_TIME_END] = pDesc->timeEnd;
+	pRun->val[MUD_EXP_ELAPSED] = pDesc->elapsedSec;
+	pRun->str[MUD_SHM_TITLE] = dup_str( pDesc->title );
+	pRun->str[MUD_SHM_LAB] = dup_str( pDesc->lab );
+	pRun->str[MUD_SHM_AREA] = dup_str( pDesc->area );
+	pRun->str[MUD_SHM_METHOD] = dup_str( pDesc->method );
+	pRun->str[MUD_SHM_APPARATUS] = dup_str( pDesc->apparatus );
+	pRun->str[MUD_SHM_INSERT] = dup_str( pDesc->insert );
+	pRun->str[MUD_SHM_SAMPLE] = dup_str( pDesc->sample );
+	pRun->str[MUD_SHM_ORIENT] = dup_str( pDesc->orient );
+	pRun->str[MUD_SHM_DAS] = dup_str( pDesc->das );
+	pRun->str[MUD_SHM_EXPERIMENTER] = dup_str( pDesc->experimenter );
+	pRun->str[MUD_SHM_TEMPERATURE] = dup_str( pDesc->temperature );
+	pRun->str[MUD_SHM_FIELD] = dup_str( pDesc->field );
+    }
+    else if( pIdesc != NULL )
+    {
+	pRun->val[MUD_EXP_EXPT] = pIdesc->exptNumber;
+	pRun->val[MUD_EXP_RUN] = pIdesc->runNumber;
+	pRun->val[MUD_EXP_TIME_BEGIN] = pIdesc->timeBegin;
+	pRun->val[MUD_EXP_TIME_END] = pIdesc->timeEnd;
+	pRun->val[MUD_EXP_ELAPSED] = pIdesc->elapsedSec;
+	pRun->str[MUD_SHM_TITLE] = dup_str( pIdesc->title );
+	pRun->str[MUD_SHM_LAB] = dup_str( pIdesc->lab );
+	pRun->str[MUD_SHM_AREA] = dup_str( pIdesc->area );
+	pRun->str[MUD_SHM_METHOD] = dup_str( pIdesc->method );
+	pRun->str[MUD_SHM_APPARATUS] = dup_str( pIdesc->apparatus );
+	pRun->str[MUD_SHM_INSERT] = dup_str( pIdesc->insert );
+	pRun->str[MUD_SHM_SAMPLE] = dup_str( pIdesc->sample );
+	pRun->str[MUD_SHM_ORIENT] = dup_str( pIdesc->orient );
+	pRun->str[MUD_SHM_DAS] = dup_str( pIdesc->das );
+	pRun->str[MUD_SHM_EXPERIMENTER] = dup_str( pIdesc->experimenter );
+	pRun->str[MUD_SHM_SUBTITLE] = dup_str( pIdesc->subtitle );
+	pRun->str[MUD_SHM_COMMENT1] = dup_str( pIdesc->comment1 );
+	pRun->str[MUD_SHM_COMMENT2] = dup_str( pIdesc->comment2 );
+	pRun->str[MUD_SHM_COMMENT3] = dup_str( pIdesc->comment3 );
+    }
+    pRun->tempK = parse_qty( pRun->str[MUD_SHM_TEMPERATURE], MUD_QTY_TEMPERATURE );
+    pRun->fieldG = parse_qty( pRun->str[MUD_SHM_FIELD], MUD_QTY_FIELD );
+
+    if( ( pMUD_grp = hist_group( pMUD_fileGrp ) ) == NULL ) return;
+    pRun->pHistVals = (UINT32*)zalloc( ( pMUD_grp->num/2 + 1 )*MUD_EXP_NHISTVALS*sizeof( UINT32 ) );
+    pRun->pHistTitles = (char**)zalloc( ( pMUD_grp->num/2 + 1 )*sizeof( char* ) );
+    if( pRun->pHistVals == NULL || pRun->pHistTitles == NULL ) return;
+
+    pRun->nHists = pMUD_grp->num/2;
+    for( i = 0; i < pRun->nHists; i++ )
+    {
+	pHdr = (MUD_SEC_GEN_HIST_HDR*)MUD_search( pMUD_grp->pMem,
+			  MUD_SEC_GEN_HIST_HDR_ID, i + 1, (UINT32)0 );
+	if( pHdr == NULL ) continue;
+	v = &pRun->pHistVals[i*MUD_EXP_NHISTVALS];
+	v[MUD_EXP_HIST_TYPE] = pHdr->histType;
+	v[MUD_EXP_NBINS] = pHdr->nBins;
+	v[MUD_EXP_FS_PER_BIN] = pHdr->fsPerBin;
+	v[MUD_EXP_T0_PS] = pHdr->t0_ps;
+	v[MUD_EXP_T0_BIN] = pHdr->t0_bin;
+	v[MUD_EXP_GOOD_BIN1] = pHdr->goodBin1;
+	v[MUD_EXP_GOOD_BIN2] = pHdr->goodBin2;
+	v[MUD_EXP_BKGD1] = pHdr->bkgd1;
+	v[MUD_EXP_BKGD2] = pHdr->bkgd2;
+	v[MUD_EXP_NEVENTS] = pHdr->nEvents;
+	pRun->pHistTitles[i] = dup_str( pHdr->title );
+	pRun->maxBins = _max( pRun->maxBins, pHdr->nBins );
+    }
+}
+
+
+static void
+free_run( MUD_EXPORT_RUN* pRun )
+{
+    UINT32 i;
+
+    for( i = 0; i < MUD_SHM_NSTR; i++ )
+    {
+	_free( pRun->str[i] );
+    }
+    if( pRun->pHistTitles != NULL )
+    {
+	for( i = 0; i < pRun->nHists; i++ )
+	{
+	    _free( pRun->pHistTitles[i] );
+	}
+	free( pRun->pHistTitles );
+    }
+    _free( pRun->pHistVals );
+    bzero( pRun, sizeof( MUD_EXPORT_RUN ) );
+}
+
+
+static void
+header_task( int task, int thread, void* pArg )
+{
+    EXP_BATCH* pB = (EXP_BATCH*)pArg;
+    MUD_EXPORT_RUN* pRun = &pB->pRuns[task];
+    MUD_SEC_GRP* pMUD_fileGrp;
+
+    pMUD_fileGrp = (MUD_SEC_GRP*)MUD_readRunFile( pB->files[task], 1 );
+    if( pMUD_fileGrp == NULL ) return;
+
+    read_run( pMUD_fileGrp, pRun );
+    pRun->str[MUD_SHM_PATH] = dup_str( pB->files[task] );
+    MUD_free( pMUD_fileGrp );
+}
+
+
+/*
+ *  counts_task() - unpack the histograms of a run of the block into its
+ *  part of the block; zero where the run has none
+ */
+static void
+counts_task( int task, int thread, void* pArg )
+{
+    EXP_BATCH* pB = (EXP_BATCH*)pArg;
+    MUD_SEC_GRP* pMUD_fileGrp;
+    MUD_SEC_GRP* pMUD_grp;
+    MUD_SEC_GEN_HIST_HDR* pHdr;
+    MUD_SEC_GEN_HIST_DAT* pDat;
+    UINT32* pCounts;
+    UINT32 i, n;
+
+    pCounts = pB->pCounts + (size_t)task*pB->maxHists*pB->maxBins;
+    bzero( pCounts, (size_t)pB->maxHists*pB->maxBins*sizeof( UINT32 ) );
+
+    pMUD_fileGrp = (MUD_SEC_GRP*)MUD_readRunFile( pB->pRuns[task].str[MUD_SHM_PATH], 0 );
+    if( pMUD_fileGrp == NULL ) return;
+
+    if( ( pMUD_grp = hist_group( pMUD_fileGrp ) ) != NULL )
+    {
+	n = _min( pMUD_grp->num/2, pB->maxHists );
+	for( i = 0; i < n; i++ )
+	{
+	    pHdr = (MUD_SEC_GEN_HIST_HDR*)MUD_search( pMUD_grp->pMem,
+			  MUD_SEC_GEN_HIST_HDR_ID, i + 1, (UINT32)0 );
+	    pDat = (MUD_SEC_GEN_HIST_DAT*)MUD_search( pMUD_grp->pMem,
+			  MUD_SEC_GEN_HIST_DAT_ID, i + 1, (UINT32)0 );
+	    if( pHdr == NULL || pDat == NULL || pDat->pData == NULL ||
+		pHdr->nBins > pB->maxBins ) continue;
+	    if( pHdr->bytesPerBin != 0 && pHdr->bytesPerBin != 1 &&
+		pHdr->bytesPerBin != 2 && pHdr->bytesPerBin != 4 &&
+		pHdr->bytesPerBin != MUD_BPB_SPARSE ) continue;
+	    MUD_SEC_GEN_HIST_unpackData( pHdr->nBins, pHdr->bytesPerBin, pDat->pData, pDat->nBytes,
+				     4, pCounts + (size_t)i*pB->maxBins );
+	}
+    }
+    MUD_free( pMUD_fileGrp );
+}
+
+
+/*
+ *  MUD_exportOpen() - read the headers of the runs of files, in order;
+ *  returns NULL if out of memory
+ */
+MUD_EXPORT*
+MUD_exportOpen( int num, char** files, int nThreads )
+{
+    MUD_EXPORT* pExp;
+    MUD_EXPORT_RUN* pRun;
+    EXP_BATCH batch;
+    int i;
+
+    if( ( pExp = (MUD_EXPORT*)zalloc( sizeof( MUD_EXPORT ) ) ) == NULL ) return( NULL );
+    if( ( pExp->pRuns = (MUD_EXPORT_RUN*)zalloc( ( num + 1 )*sizeof( MUD_EXPORT_RUN ) ) ) == NULL )
+    {
+	free( pExp );
+	return( NULL );
+    }
+    pExp->nThreads = nThreads;
+
+    bzero( &batch, sizeof( batch ) );
+    batch.files = files;
+    batch.pRuns = pExp->pRuns;
+    MUD_parallelFor( num, nThreads, header_task, &batch );
+
+    for( i = 0; i < num; i++ )
+    {
+	if( pExp->pRuns[i].str[MUD_SHM_PATH] == NULL )
+	{
+	    free_run( &pExp->pRuns[i] );
+	    continue;
+	}
+	pRun = &pExp->pRuns[pExp->nRuns++];
+	if( pRun != &pExp->pRuns[i] )
+	{
+	    *pRun = pExp->pRuns[i];
+	    bzero( &pExp->pRuns[i], sizeof( MUD_EXPORT_RUN ) );
+	}
+	pExp->maxHists = _max( pExp->maxHists, pRun->nHists );
+	pExp->maxBins = _max( pExp->maxBins, pRun->maxBins );
+    }
+    return( pExp );
+}
+
+
+void
+MUD_exportClose( MUD_EXPORT* pExp )
+{
+    int i;
+
+    if( pExp == NULL ) return;
+    for( i = 0; i < pExp->nRuns; i++ ) free_run( &pExp->pRuns[i] );
+    free( pExp->pRuns );
+    free( pExp );
+}
+
+
+/*
+ *  MUD_exportBlock() - the number of runs to read at a time
+ */
+int
+MUD_exportBlock( MUD_EXPORT* pExp )
+{
+    size_t runBytes;
+
+    runBytes = (size_t)pExp->maxHists*pExp->maxBins*sizeof( UINT32 );
+    if( runBytes == 0 ) return( EXP_MAX_BLOCK );
+    return( (int)_min( _max( EXP_BLOCK_BYTES/runBytes, 1 ), EXP_MAX_BLOCK ) );
+}
+
+
+/*
+ *  MUD_exportCounts() - the counts of runs first .. first + num - 1 into
+ *  pCounts, UINT32 (num, maxHists, maxBins)
+ */
+void
+MUD_exportCounts( MUD_EXPORT* pExp, int first, int num, UINT32* pCounts )
+{
+    EXP_BATCH batch;
+
+    bzero( &batch, sizeof( batch ) );
+    batch.pRuns = &pExp->pRuns[first];
+    batch.pCounts = pCounts;
+    batch.maxHists = pExp->maxHists;
+    batch.maxBins = pExp->maxBins;
+    if( (size_t)batch.maxHists*batch.maxBins > 0 )
+	MUD_parallelFor( num, pExp->nThreads, counts_task, &batch );
+}
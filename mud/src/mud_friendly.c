@@ -32,6 +32,19 @@
  *    22-Apr-2003  v1.6  DJA  Add mud_openReadWrite
  *    25-May-2011  v1.7  DJA  Fix cast in MUD_setHistSecondsPerBin
  *    15-Oct-2020  v1.8  DF   Fix group/instance numbers in _sea_cmtgrp
+ *    18-Oct-2026  v1.9       Add event-mode data routines
+ *    18-Oct-2026  v1.10      Add MUD_getAlpha
+ *    18-Oct-2026  v1.11 DJA  Add MUD_getHistT0Auto
+ *    18-Oct-2026  v1.12 DJA  Add MUD_getHistGroupData
+ *    18-Oct-2026  v1.13      Add MUD_getTemperatureValue, MUD_getFieldValue
+ *    18-Oct-2026  v1.14      Histogram cache (mud_histcache.c); MUD_getHistCachedData
+ *    18-Oct-2026  v1.15      Shared read-only fds from the run cache (mud_runcache.c)
+ *    18-Oct-2026  v1.16      Sparse histograms (mud_sparse.c); MUD_getHistNonzero
+ *    18-Oct-2026  v1.17      MUD_getHistData fails on sparse data too short for its pairs
+ *    18-Oct-2026  v1.18 DJA  MUD_getHistT0Auto unpacks to 4-byte bins, whatever the
+ *                            bytesPerBin of the file
+ *    18-Oct-2026  v1.19 DJA  So does MUD_getHistGroupData, which no longer keeps
+ *                            the histogram group across a read of the data
  *
  *  Description:
  *
@@ -73,6 +86,8 @@
  *    Not in TRI_TI:
  *    int MUD_getTemperature( int fd, char* temperature, int strdim )
  *    int MUD_getField( int fd, char* field, int strdim )
+ *    int MUD_getTemperatureValue( int fd, REAL64* pTemp, REAL64* pTempErr )
+ *    int MUD_getFieldValue( int fd, REAL64* pField, REAL64* pFieldErr )
  *    TRI_TI only:
  *    int MUD_getSubtitle( int fd, char* subtitle, int strdim )
  *    int MUD_getComment1( int fd, char* comment1, int strdim )
@@ -143,6 +158,10 @@
  *    int MUD_getHistpData( int fd, int num, void** ppData )
  *    int MUD_getHistTimeData( int fd, int num, UINT32* pTimeData )
  *    int MUD_getHistpTimeData( int fd, int num, UINT32** ppTimeData )
+ *    int MUD_getHistT0Auto( int fd, int num, MUD_T0* pT0 )
+ *    int MUD_getHistGroupData( int fd, int* pGroup, int nOut, UINT64* pSum )
+ *    int MUD_getHistCachedData( int fd, int num, UINT32** ppData )
+ *    int MUD_getHistNonzero( int fd, int num, UINT32* pNum, UINT32* pBins, UINT32* pCounts )
  *
  *    int MUD_setHists( int fd, UINT32 type, UINT32 num )
  *    int MUD_setHistType( int fd, int num, UINT32 type )
@@ -164,6 +183,16 @@
  *    int MUD_setHistTimeData( int fd, int num, UINT32* pTimeData )
  *    int MUD_setHistpTimeData( int fd, int num, UINT32* pTimeData )
  * 
+ *    Event-mode (list-mode) data:
+ *
+ *    int MUD_getEvents( int fd, UINT32* pNum, UINT32* pFsPerTick )
+ *    int MUD_getEventData( int fd, UINT16* pDet, UINT32* pTime )
+ *
+ *    int MUD_setEvents( int fd, UINT32 num, UINT32 fsPerTick, UINT16* pDet, UINT32* pTime )
+ *    int MUD_setHistsFromEvents( int fd, UINT32 type, MUD_EVENT_BINNING* pBin, UINT32 bytesPerBin )
+ *
+ *    int MUD_getAlpha( int fd, MUD_ALPHA* pAlpha )
+ *
  *    int MUD_pack( int num, int inBinSize, void* inArray, int outBinSize, void* outArray )
  *    int MUD_unpack( int num, int inBinSize, void* inArray, int outBinSize, void* outArray )
  * 
@@ -229,6 +258,37 @@
 
 static FILE* mud_f[MUD_MAX_FILES] = { 0 };
 static MUD_SEC_GRP* pMUD_fileGrp[MUD_MAX_FILES];
+static MUD_HIST_CACHE* pMUD_histCache[MUD_MAX_FILES] = { 0 };
+static int mud_hdrsOnly[MUD_MAX_FILES] = { 0 };
+static MUD_CACHED_RUN* mud_run[MUD_MAX_FILES] = { 0 };
+
+static int read_data _ANSI_ARGS_(( int fd ));
+static int get_hist_data4 _ANSI_ARGS_(( int fd, int num, UINT32* pData ));
+static MUD_SEC_GRP* find_histgrp _ANSI_ARGS_(( int fd ));
+
+/*
+ *  The cached histograms of a file are dropped when it is closed, or
+ *  when its histograms are changed
+ */
+#define _drop_cache( fd ) \
+  MUD_histCacheClose( pMUD_histCache[fd] ); \
+  pMUD_histCache[fd] = NULL
+
+/*
+ *  A file with its histograms in the cache is opened with only its
+ *  headers read (MUD_readHeaders).  Anything that needs the bulk data,
+ *  or changes the file, reads the whole file first.
+ */
+#define _need_data( fd ) \
+  if( mud_hdrsOnly[fd] && !read_data( fd ) ) return( 0 )
+
+/*
+ *  A run from the run cache is shared by all the fds open on it, so it
+ *  cannot be changed
+ */
+#define _need_write( fd ) \
+  if( mud_run[fd] != NULL ) return( 0 ); \
+  _need_data( fd )
 
 #define _strncpy( To, From, Len) strncpy( To, From, Len )[Len-1]='\0'
 
@@ -239,10 +299,22 @@ MUD_openRead( char* filename, UINT32* pType )
 
   for( fd = 0; fd < MUD_MAX_FILES; fd++ ) 
   {
-    if( mud_f[fd] == NULL ) break;
+    if( mud_f[fd] == NULL && mud_run[fd] == NULL ) break;
   }
   if( fd == MUD_MAX_FILES ) return( -1 );
 
+  /*
+   *  A run already decoded, if the run cache is in use
+   */
+  if( MUD_getRunCacheSize() > 0 && 
+      ( mud_run[fd] = MUD_runCacheGet( filename ) ) != NULL )
+  {
+    pMUD_fileGrp[fd] = mud_run[fd]->pMUD_fileGrp;
+    pMUD_histCache[fd] = mud_run[fd]->pHistCache;
+    *pType = MUD_instanceID( pMUD_fileGrp[fd] );
+    return( fd );
+  }
+
   mud_f[fd] = MUD_openInput( filename );
   if( mud_f[fd] == NULL ) return( -1 );
 
@@ -251,10 +323,19 @@ MUD_openRead( char* filename, UINT32* pType )
    *  Might want to make this more complicated, 
    *  i.e., only read when needed, keep track of 
    *  what's already read.
+   *  With the histograms in the cache (if one is in use), just the 
+   *  headers; else the cache is written from the file.  A run to be
+   *  kept in the run cache is always read whole.
    */
-  pMUD_fileGrp[fd] = (MUD_SEC_GRP*)MUD_readFile( mud_f[fd] );
+  pMUD_histCache[fd] = MUD_histCacheOpen( filename, mud_f[fd], NULL );
+  mud_hdrsOnly[fd] = ( pMUD_histCache[fd] != NULL && MUD_getRunCacheSize() == 0 );
+  if( mud_hdrsOnly[fd] )
+    pMUD_fileGrp[fd] = (MUD_SEC_GRP*)MUD_readHeaders( mud_f[fd] );
+  else
+    pMUD_fileGrp[fd] = (MUD_SEC_GRP*)MUD_readFile( mud_f[fd] );
   if( pMUD_fileGrp[fd] == NULL )
   {
+    _drop_cache( fd );
     fclose( mud_f[fd] );
     mud_f[fd] = NULL;
     return( -1 );
@@ -262,9 +343,41 @@ MUD_openRead( char* filename, UINT32* pType )
 
   *pType = MUD_instanceID( pMUD_fileGrp[fd] );
 
+  if( pMUD_histCache[fd] == NULL )
+    pMUD_histCache[fd] = MUD_histCacheOpen( filename, mud_f[fd], pMUD_fileGrp[fd] );
+
+  /*
+   *  Hand the run over to the run cache; the fd then shares it
+   */
+  if( !mud_hdrsOnly[fd] && 
+      ( mud_run[fd] = MUD_runCachePut( filename, mud_f[fd], pMUD_fileGrp[fd], 
+                                       pMUD_histCache[fd] ) ) != NULL )
+  {
+    fclose( mud_f[fd] );
+    mud_f[fd] = NULL;
+  }
+
   return( fd );
 }
 
+/*
+ *  Read the whole of a file opened with its headers only.  Nothing has
+ *  been changed yet (see _need_data), so the tree is just replaced.
+ */
+static int
+read_data( int fd )
+{
+  MUD_SEC_GRP* pMUD_grp;
+
+  pMUD_grp = (MUD_SEC_GRP*)MUD_readFile( mud_f[fd] );
+  if( pMUD_grp == NULL ) return( 0 );
+
+  MUD_free( pMUD_fileGrp[fd] );
+  pMUD_fileGrp[fd] = pMUD_grp;
+  mud_hdrsOnly[fd] = 0;
+  return( 1 );
+}
+
 int 
 MUD_openReadWrite( char* filename, UINT32* pType )
 {
@@ -272,7 +385,7 @@ MUD_openReadWrite( char* filename, UINT32* pType )
 
   for( fd = 0; fd < MUD_MAX_FILES; fd++ ) 
   {
-    if( mud_f[fd] == NULL ) break;
+    if( mud_f[fd] == NULL && mud_run[fd] == NULL ) break;
   }
   if( fd == MUD_MAX_FILES ) return( -1 );
 
@@ -303,7 +416,7 @@ MUD_openWrite( char* filename, UINT32 type )
 
   for( fd = 0; fd < MUD_MAX_FILES; fd++ ) 
   {
-    if( mud_f[fd] == NULL ) break;
+    if( mud_f[fd] == NULL && mud_run[fd] == NULL ) break;
   }
   if( fd == MUD_MAX_FILES ) return( -1 );
 
@@ -325,11 +438,19 @@ MUD_openWrite( char* filename, UINT32 type )
 int 
 MUD_closeRead( int fd )
 {
-  if( ( fd < 0 ) || ( fd >= MUD_MAX_FILES ) || ( mud_f[fd] == NULL ) ) 
+  if( ( fd < 0 ) || ( fd >= MUD_MAX_FILES ) ) return( 0 );
+
+  if( mud_run[fd] != NULL )
   {
-    return( 0 );
+    MUD_runCacheRelease( mud_run[fd] );
+    mud_run[fd] = NULL;
+    pMUD_fileGrp[fd] = NULL;
+    pMUD_histCache[fd] = NULL;
+    return( 1 );
   }
 
+  if( mud_f[fd] == NULL ) return( 0 );
+
   /*
    *  Free the list
    */
@@ -338,6 +459,8 @@ MUD_closeRead( int fd )
     MUD_free( pMUD_fileGrp[fd] );
     pMUD_fileGrp[fd] = NULL;
   }
+  _drop_cache( fd );
+  mud_hdrsOnly[fd] = 0;
 
   fclose( mud_f[fd] );
   mud_f[fd] = NULL;
@@ -349,6 +472,11 @@ MUD_closeRead( int fd )
 int 
 MUD_closeWrite( int fd )
 {
+  if( ( fd >= 0 ) && ( fd < MUD_MAX_FILES ) && ( mud_run[fd] != NULL ) ) 
+  {
+    MUD_closeRead( fd );
+    return( 0 );
+  }
   if( ( fd < 0 ) || ( fd >= MUD_MAX_FILES ) || ( mud_f[fd] == NULL ) ) 
   {
     return( 0 );
@@ -371,6 +499,8 @@ MUD_closeWrite( int fd )
     MUD_free( pMUD_fileGrp[fd] );
     pMUD_fileGrp[fd] = NULL;
   }
+  _drop_cache( fd );
+  mud_hdrsOnly[fd] = 0;
 
   fclose( mud_f[fd] );
   mud_f[fd] = NULL;
@@ -381,11 +511,18 @@ MUD_closeWrite( int fd )
 int 
 MUD_closeWriteFile( int fd, char* outname )
 {
+  if( ( fd >= 0 ) && ( fd < MUD_MAX_FILES ) && ( mud_run[fd] != NULL ) ) 
+  {
+    MUD_closeRead( fd );
+    return( 0 );
+  }
   if( ( fd < 0 ) || ( fd >= MUD_MAX_FILES ) || ( mud_f[fd] == NULL ) ) 
   {
     return( 0 );
   }
 
+  _need_data( fd );
+
   /*
    * Close the input file
    */
@@ -414,6 +551,8 @@ MUD_closeWriteFile( int fd, char* outname )
     MUD_free( pMUD_fileGrp[fd] );
     pMUD_fileGrp[fd] = NULL;
   }
+  _drop_cache( fd );
+  mud_hdrsOnly[fd] = 0;
 
   fclose( mud_f[fd] );
   mud_f[fd] = NULL;
@@ -424,7 +563,7 @@ MUD_closeWriteFile( int fd, char* outname )
 
 #define _check_fd( fd )  if( ( fd < 0 ) || \
                              ( fd >= MUD_MAX_FILES ) || \
-                             ( mud_f[fd] == NULL ) ) return( 0 )
+                             ( mud_f[fd] == NULL && mud_run[fd] == NULL ) ) return( 0 )
 
 /*
  *  Run Description
@@ -484,6 +623,7 @@ int name( int fd, UINT32 var) \
   MUD_SEC_GEN_RUN_DESC* pMUD_desc=0; \
   MUD_SEC_TRI_TI_RUN_DESC* pMUD_idesc=0; \
   _check_fd( fd ); \
+  _need_write( fd ); \
   _sea_desc( fd ); \
   switch( MUD_instanceID( pMUD_fileGrp[fd] ) ) \
   { \
@@ -516,6 +656,7 @@ int name( int fd, char* var ) \
   MUD_SEC_GEN_RUN_DESC* pMUD_desc=0; \
   MUD_SEC_TRI_TI_RUN_DESC* pMUD_idesc=0; \
   _check_fd( fd ); \
+  _need_write( fd ); \
   _sea_desc( fd ); \
   switch( MUD_instanceID( pMUD_fileGrp[fd] ) ) \
   { \
@@ -539,11 +680,26 @@ int name( int fd, char* var, int strdim ) \
 }
 
 
+/*
+ *  Temperature (K) or field (G) parsed from the string; returns the
+ *  MUD_QTY_ flags (see mud_quantity.c), 0 if there is no value
+ */
+#define _gdesc_qty_getproc( name, var, kind ) \
+int name( int fd, REAL64* pValue, REAL64* pError ) \
+{ \
+  MUD_SEC_GEN_RUN_DESC* pMUD_desc=0; \
+  _check_fd( fd ); \
+  _sea_gdesc( fd ); \
+  return( MUD_parseQuantity( pMUD_desc->var, kind, pValue, pError ) ); \
+}
+
+
 #define _gdesc_char_setproc( name, var ) \
 int name( int fd, char* var ) \
 { \
   MUD_SEC_GEN_RUN_DESC* pMUD_desc=0; \
   _check_fd( fd ); \
+  _need_write( fd ); \
   _sea_gdesc( fd ); \
   _free( pMUD_desc->var ); \
   pMUD_desc->var = strdup( var ); \
@@ -567,6 +723,7 @@ int name( int fd, char* var ) \
 { \
   MUD_SEC_TRI_TI_RUN_DESC* pMUD_idesc=0; \
   _check_fd( fd ); \
+  _need_write( fd ); \
   _sea_idesc( fd ); \
   _free( pMUD_idesc->var ); \
   pMUD_idesc->var = strdup( var ); \
@@ -611,6 +768,7 @@ MUD_setRunDesc( int fd, UINT32 type )
   MUD_SEC_TRI_TI_RUN_DESC* pMUD_idesc=0;
 
   _check_fd( fd );
+  _need_write( fd );
 
   switch( MUD_instanceID( pMUD_fileGrp[fd] ) )
   {
@@ -648,6 +806,8 @@ _desc_char_getproc( MUD_getExperimenter, experimenter )
 /* not in TRI_TI */
 _gdesc_char_getproc( MUD_getTemperature, temperature )
 _gdesc_char_getproc( MUD_getField, field )
+_gdesc_qty_getproc( MUD_getTemperatureValue, temperature, MUD_QTY_TEMPERATURE )
+_gdesc_qty_getproc( MUD_getFieldValue, field, MUD_QTY_FIELD )
 /* TRI_TI only */
 _idesc_char_getproc( MUD_getSubtitle, subtitle )
 _idesc_char_getproc( MUD_getComment1, comment1 )
@@ -717,6 +877,7 @@ name( int fd, int num, UINT32 var ) \
   MUD_SEC_GRP* pMUD_cmtGrp=0; \
   MUD_SEC_CMT* pMUD_cmt=0; \
   _check_fd( fd ); \
+  _need_write( fd ); \
   _sea_cmtgrp( fd ); \
   _sea_cmt( fd, num ); \
   pMUD_cmt->var = var; \
@@ -744,6 +905,7 @@ name( int fd, int num, char* var ) \
   MUD_SEC_GRP* pMUD_cmtGrp=0; \
   MUD_SEC_CMT* pMUD_cmt=0; \
   _check_fd( fd ); \
+  _need_write( fd ); \
   _sea_cmtgrp( fd ); \
   _sea_cmt( fd, num ); \
   _free( pMUD_cmt->var ); \
@@ -772,6 +934,7 @@ MUD_setComments( int fd, UINT32 type, UINT32 num )
   int i;
 
   _check_fd( fd );
+  _need_write( fd );
 
   pMUD_cmtGrp = (MUD_SEC_GRP*)MUD_new( MUD_SEC_GRP_ID, type );
   if( pMUD_cmtGrp == NULL ) return( 0 );
@@ -862,6 +1025,7 @@ name( int fd, int num, UINT32 var ) \
   MUD_SEC_GRP* pMUD_histGrp=0; \
   MUD_SEC_GEN_HIST_HDR* pMUD_histHdr=0; \
   _check_fd( fd ); \
+  _need_write( fd ); \
   _sea_histgrp( fd ); \
   _sea_histhdr( fd, num ); \
   pMUD_histHdr->var = var; \
@@ -888,6 +1052,7 @@ name( int fd, int num, char* var ) \
   MUD_SEC_GRP* pMUD_histGrp=0; \
   MUD_SEC_GEN_HIST_HDR* pMUD_histHdr=0; \
   _check_fd( fd ); \
+  _need_write( fd ); \
   _sea_histgrp( fd ); \
   _sea_histhdr( fd, num ); \
   _free( pMUD_histHdr->var ); \
@@ -925,6 +1090,8 @@ MUD_setHists( int fd, UINT32 type, UINT32 num )
   int i;
 
   _check_fd( fd );
+  _need_write( fd );
+  _drop_cache( fd );
 
   pMUD_grp = (MUD_SEC_GRP*)MUD_new( MUD_SEC_GRP_ID, type );
   if( pMUD_grp == NULL ) return( 0 );
@@ -986,6 +1153,7 @@ MUD_getHistpData( int fd, int num, void** ppData )
   MUD_SEC_GRP* pMUD_histGrp=0;
   MUD_SEC_GEN_HIST_DAT* pMUD_histDat=0;
   _check_fd( fd );
+  _need_data( fd );
   _sea_histgrp( fd );
   
   pMUD_histDat = (MUD_SEC_GEN_HIST_DAT*)MUD_search( pMUD_histGrp->pMem,
@@ -1003,6 +1171,8 @@ MUD_setHistpData( int fd, int num, void* pData )
   MUD_SEC_GRP* pMUD_histGrp=0;
   MUD_SEC_GEN_HIST_DAT* pMUD_histDat=0;
   _check_fd( fd );
+  _need_write( fd );
+  _drop_cache( fd );
   _sea_histgrp( fd );
   
   pMUD_histDat = (MUD_SEC_GEN_HIST_DAT*)MUD_search( pMUD_histGrp->pMem,
@@ -1020,6 +1190,9 @@ MUD_getHistData( int fd, int num, void* pData )
   MUD_SEC_GRP* pMUD_histGrp=0;
   MUD_SEC_GEN_HIST_HDR* pMUD_histHdr=0;
   MUD_SEC_GEN_HIST_DAT* pMUD_histDat=0;
+  MUD_HIST_CACHE_ENTRY* pEntry;
+  UINT32* pCached;
+  UINT32 i;
   _check_fd( fd );
   _sea_histgrp( fd );
   
@@ -1028,17 +1201,48 @@ MUD_getHistData( int fd, int num, void* pData )
                              (UINT32)0 );
   if( pMUD_histHdr == NULL ) return( 0 );
 
+  /*
+   *  Already unpacked in the cache: just copy (narrowing to the bin size)
+   */
+  pCached = MUD_histCacheData( pMUD_histCache[fd], num, &pEntry );
+  if( pCached != NULL && pEntry->nBins == pMUD_histHdr->nBins && 
+      pEntry->bytesPerBin == pMUD_histHdr->bytesPerBin )
+  {
+    switch( pMUD_histHdr->bytesPerBin )
+    {
+      case 1:
+        for( i = 0; i < pEntry->nBins; i++ ) ((UINT8*)pData)[i] = (UINT8)pCached[i];
+        break;
+      case 2:
+        for( i = 0; i < pEntry->nBins; i++ ) ((UINT16*)pData)[i] = (UINT16)pCached[i];
+        break;
+      default:
+        bcopy( pCached, pData, pEntry->nBins*sizeof( UINT32 ) );
+        break;
+    }
+    return( 1 );
+  }
+
+  if( mud_hdrsOnly[fd] )
+  {
+    if( !read_data( fd ) ) return( 0 );
+    return( MUD_getHistData( fd, num, pData ) );
+  }
+
   pMUD_histDat = (MUD_SEC_GEN_HIST_DAT*)MUD_search( pMUD_histGrp->pMem,
                              MUD_SEC_GEN_HIST_DAT_ID, (UINT32)num,
                              (UINT32)0 );
   if( pMUD_histDat == NULL ) return( 0 );
 
   /*
-   *  Do unpacking/byte swapping
+   *  Do unpacking/byte swapping; sparse data must fit in its section
    */
-  MUD_unpack( pMUD_histHdr->nBins, 
-            pMUD_histHdr->bytesPerBin, pMUD_histDat->pData, 
-    ( pMUD_histHdr->bytesPerBin == 0 ) ? 4 : pMUD_histHdr->bytesPerBin, pData );
+  if( MUD_SEC_GEN_HIST_unpackData( pMUD_histHdr->nBins, 
+            pMUD_histHdr->bytesPerBin, pMUD_histDat->pData, pMUD_histDat->nBytes,
+    ( pMUD_histHdr->bytesPerBin == 0 || pMUD_histHdr->bytesPerBin == MUD_BPB_SPARSE ) ? 
+              4 : pMUD_histHdr->bytesPerBin, pData ) == 0 &&
+      pMUD_histHdr->bytesPerBin == MUD_BPB_SPARSE && pMUD_histHdr->nBins > 0 )
+    return( 0 );
 
   return( 1 );
 }
@@ -1050,6 +1254,8 @@ MUD_setHistData( int fd, int num, void* pData )
   MUD_SEC_GEN_HIST_HDR* pMUD_histHdr=0;
   MUD_SEC_GEN_HIST_DAT* pMUD_histDat=0;
   _check_fd( fd );
+  _need_write( fd );
+  _drop_cache( fd );
   _sea_histgrp( fd );
   
   pMUD_histHdr = (MUD_SEC_GEN_HIST_HDR*)MUD_search( pMUD_histGrp->pMem,
@@ -1069,6 +1275,10 @@ MUD_setHistData( int fd, int num, void* pData )
     case 0:
       pMUD_histDat->pData = (caddr_t)zalloc( 4*pMUD_histHdr->nBins + 32 );
       break;
+    case MUD_BPB_SPARSE:
+      pMUD_histDat->pData = (caddr_t)zalloc( 
+                               MUD_sparseSize( pMUD_histHdr->nBins, 4, pData ) );
+      break;
     default:
       pMUD_histDat->pData = (caddr_t)zalloc( 
                                pMUD_histHdr->nBins*pMUD_histHdr->bytesPerBin );
@@ -1080,12 +1290,208 @@ MUD_setHistData( int fd, int num, void* pData )
    */
   pMUD_histDat->nBytes = pMUD_histHdr->nBytes = 
     MUD_pack( pMUD_histHdr->nBins, 
-              ( pMUD_histHdr->bytesPerBin == 0 ) ? 4 : pMUD_histHdr->bytesPerBin, pData,
+              ( pMUD_histHdr->bytesPerBin == 0 || pMUD_histHdr->bytesPerBin == MUD_BPB_SPARSE ) ? 
+                4 : pMUD_histHdr->bytesPerBin, pData,
               pMUD_histHdr->bytesPerBin, pMUD_histDat->pData );
 
   return( 1 );
 }
 
+/*
+ *  Histogram num unpacked into 4-byte bins, whatever its bytesPerBin
+ *  (MUD_getHistData keeps the bin size of the file, so 1 or 2 bytes
+ *  for packed histograms): from the cache if it is there
+ */
+static int
+get_hist_data4( int fd, int num, UINT32* pData )
+{
+  MUD_SEC_GRP* pMUD_histGrp=0;
+  MUD_SEC_GEN_HIST_HDR* pMUD_histHdr=0;
+  MUD_SEC_GEN_HIST_DAT* pMUD_histDat=0;
+  MUD_HIST_CACHE_ENTRY* pEntry;
+  UINT32* pCached;
+  _sea_histgrp( fd );
+  _sea_histhdr( fd, num );
+
+  pCached = MUD_histCacheData( pMUD_histCache[fd], num, &pEntry );
+  if( pCached != NULL && pEntry->nBins == pMUD_histHdr->nBins )
+  {
+    bcopy( pCached, pData, pEntry->nBins*sizeof( UINT32 ) );
+    return( 1 );
+  }
+
+  /*
+   *  Reading the data replaces the sections found so far
+   */
+  if( mud_hdrsOnly[fd] )
+  {
+    if( !read_data( fd ) ) return( 0 );
+    return( get_hist_data4( fd, num, pData ) );
+  }
+
+  pMUD_histDat = (MUD_SEC_GEN_HIST_DAT*)MUD_search( pMUD_histGrp->pMem,
+                             MUD_SEC_GEN_HIST_DAT_ID, (UINT32)num,
+                             (UINT32)0 );
+  if( pMUD_histDat == NULL ) return( 0 );
+
+  if( MUD_SEC_GEN_HIST_unpackData( pMUD_histHdr->nBins, 
+            pMUD_histHdr->bytesPerBin, pMUD_histDat->pData, pMUD_histDat->nBytes,
+            4, pData ) == 0 &&
+      pMUD_histHdr->bytesPerBin == MUD_BPB_SPARSE && pMUD_histHdr->nBins > 0 )
+    return( 0 );
+
+  return( 1 );
+}
+
+/*
+ *  The histogram group of a file, or NULL
+ */
+static MUD_SEC_GRP*
+find_histgrp( int fd )
+{
+  MUD_SEC_GRP* pMUD_histGrp=0;
+  _sea_histgrp( fd );
+  return( pMUD_histGrp );
+}
+
+/*
+ *  Automatic t0 of a histogram, from its data (see mud_t0.c)
+ */
+int 
+MUD_getHistT0Auto( int fd, int num, MUD_T0* pT0 )
+{
+  MUD_SEC_GRP* pMUD_histGrp=0;
+  MUD_SEC_GEN_HIST_HDR* pMUD_histHdr=0;
+  UINT32* pData;
+  int status;
+  _check_fd( fd );
+  _sea_histgrp( fd );
+  _sea_histhdr( fd, num );
+
+  pData = (UINT32*)zalloc( ( pMUD_histHdr->nBins + 1 )*sizeof( UINT32 ) );
+  if( pData == NULL ) return( 0 );
+  if( !get_hist_data4( fd, num, pData ) )
+  {
+    free( pData );
+    return( 0 );
+  }
+  status = MUD_findT0( pData, pMUD_histHdr->nBins, pT0 );
+  free( pData );
+  return( status );
+}
+
+/*
+ *  Sum the file's histograms into nOut groups: histogram n goes into
+ *  group pGroup[n-1] (none if negative).  All histograms must have the
+ *  same number of bins; group g is pSum[g*nBins ...].
+ */
+int 
+MUD_getHistGroupData( int fd, int* pGroup, int nOut, UINT64* pSum )
+{
+  MUD_SEC_GRP* pMUD_histGrp=0;
+  MUD_SEC_GEN_HIST_HDR* pMUD_histHdr=0;
+  UINT32** ppHists;
+  UINT32 nBins=0;
+  int i, nHists, status=0;
+  _check_fd( fd );
+  _sea_histgrp( fd );
+
+  nHists = pMUD_histGrp->num/2;
+  ppHists = (UINT32**)zalloc( ( nHists + 1 )*sizeof( UINT32* ) );
+  if( ppHists == NULL ) return( 0 );
+
+  for( i = 0; i < nHists; i++ )
+  {
+    /*
+     *  Unpacking reads the data of a file opened with only its headers,
+     *  replacing the sections found so far
+     */
+    if( ( pMUD_histGrp = find_histgrp( fd ) ) == NULL ) goto done;
+    pMUD_histHdr = (MUD_SEC_GEN_HIST_HDR*)MUD_search( pMUD_histGrp->pMem,
+                               MUD_SEC_GEN_HIST_HDR_ID, (UINT32)(i+1),
+                               (UINT32)0 );
+    if( pMUD_histHdr == NULL ) goto done;
+    if( i == 0 ) nBins = pMUD_histHdr->nBins;
+    if( pMUD_histHdr->nBins != nBins ) goto done;
+
+    ppHists[i] = (UINT32*)zalloc( ( nBins + 1 )*sizeof( UINT32 ) );
+    if( ppHists[i] == NULL ) goto done;
+    if( pGroup[i] >= 0 && !get_hist_data4( fd, i+1, ppHists[i] ) ) goto done;
+  }
+
+  status = MUD_histGroupSum( nHists, ppHists, nBins, pGroup, nOut, pSum, 0 );
+
+done:
+  for( i = 0; i < nHists; i++ ) _free( ppHists[i] );
+  free( ppHists );
+  return( status );
+}
+
+/*
+ *  Pointer to the unpacked bins (4 bytes each) of histogram num in the
+ *  histogram cache (see mud_histcache.c), valid until the file is
+ *  closed; read-only.  Returns 0 if the histogram is not cached, when
+ *  MUD_getHistData must be used instead.
+ */
+int 
+MUD_getHistCachedData( int fd, int num, UINT32** ppData )
+{
+  MUD_SEC_GRP* pMUD_histGrp=0;
+  MUD_SEC_GEN_HIST_HDR* pMUD_histHdr=0;
+  MUD_HIST_CACHE_ENTRY* pEntry;
+  UINT32* pCached;
+  _check_fd( fd );
+  _sea_histgrp( fd );
+  _sea_histhdr( fd, num );
+
+  pCached = MUD_histCacheData( pMUD_histCache[fd], num, &pEntry );
+  if( pCached == NULL || pEntry->nBins != pMUD_histHdr->nBins ) return( 0 );
+
+  *ppData = pCached;
+  return( 1 );
+}
+
+/*
+ *  The nonzero bins (from 0) of histogram num and their counts, in
+ *  order, found without unpacking it (see mud_sparse.c): *pNum of them
+ *  into pBins and pCounts, either of which may be NULL (to learn *pNum
+ *  first).  Each must hold as many as the histogram has bins, or *pNum.
+ */
+int 
+MUD_getHistNonzero( int fd, int num, UINT32* pNum, UINT32* pBins, UINT32* pCounts )
+{
+  MUD_SEC_GRP* pMUD_histGrp=0;
+  MUD_SEC_GEN_HIST_HDR* pMUD_histHdr=0;
+  MUD_SEC_GEN_HIST_DAT* pMUD_histDat=0;
+  MUD_SPARSE_ITER iter;
+  UINT32 bin, count, n=0;
+  _check_fd( fd );
+  _sea_histgrp( fd );
+  _sea_histhdr( fd, num );
+
+  if( mud_hdrsOnly[fd] )
+  {
+    if( !read_data( fd ) ) return( 0 );
+    return( MUD_getHistNonzero( fd, num, pNum, pBins, pCounts ) );
+  }
+
+  pMUD_histDat = (MUD_SEC_GEN_HIST_DAT*)MUD_search( pMUD_histGrp->pMem,
+                             MUD_SEC_GEN_HIST_DAT_ID, (UINT32)num,
+                             (UINT32)0 );
+  if( pMUD_histDat == NULL ) return( 0 );
+
+  if( !MUD_sparseIterInit( &iter, pMUD_histHdr->nBins, pMUD_histHdr->bytesPerBin,
+                           pMUD_histDat->pData, pMUD_histDat->nBytes ) ) return( 0 );
+  while( MUD_sparseNext( &iter, &bin, &count ) )
+  {
+    if( pBins != NULL ) pBins[n] = bin;
+    if( pCounts != NULL ) pCounts[n] = count;
+    n++;
+  }
+  *pNum = n;
+  return( 1 );
+}
+
 int 
 MUD_getHistpTimeData( int fd, int num, UINT32** ppTimeData )
 {
@@ -1118,6 +1524,130 @@ MUD_setHistTimeData( int fd, int num, UINT32* pTimeData )
   return( 1 );
 }
 
+/*
+ *  Event-mode (list-mode) data
+ */
+#define _sea_eventgrp( fd ) \
+  pMUD_eventGrp = (MUD_SEC_GRP*)MUD_search( pMUD_fileGrp[fd]->pMem, \
+                                 MUD_SEC_GRP_ID, MUD_GRP_GEN_EVENT_ID, \
+                                 (UINT32)0 ); \
+  if( pMUD_eventGrp == NULL ) return( 0 )
+
+int 
+MUD_getEvents( int fd, UINT32* pNum, UINT32* pFsPerTick )
+{
+  MUD_SEC_GRP* pMUD_eventGrp=0;
+  MUD_SEC* pMUD;
+  _check_fd( fd );
+  _sea_eventgrp( fd );
+
+  *pNum = 0;
+  *pFsPerTick = 0;
+  for( pMUD = pMUD_eventGrp->pMem; pMUD != NULL; pMUD = pMUD->core.pNext )
+  {
+    if( MUD_secID( pMUD ) != MUD_SEC_GEN_EVENT_ID ) continue;
+    *pNum += ((MUD_SEC_GEN_EVENT*)pMUD)->nEvents;
+    *pFsPerTick = ((MUD_SEC_GEN_EVENT*)pMUD)->fsPerTick;
+  }
+  return( 1 );
+}
+
+int 
+MUD_getEventData( int fd, UINT16* pDet, UINT32* pTime )
+{
+  MUD_SEC_GRP* pMUD_eventGrp=0;
+  MUD_SEC* pMUD;
+  UINT32 k = 0;
+  _check_fd( fd );
+  _need_data( fd );
+  _sea_eventgrp( fd );
+
+  for( pMUD = pMUD_eventGrp->pMem; pMUD != NULL; pMUD = pMUD->core.pNext )
+  {
+    if( MUD_secID( pMUD ) != MUD_SEC_GEN_EVENT_ID ) continue;
+    if( !MUD_SEC_GEN_EVENT_decode( (MUD_SEC_GEN_EVENT*)pMUD, &pDet[k], &pTime[k] ) )
+      return( 0 );
+    k += ((MUD_SEC_GEN_EVENT*)pMUD)->nEvents;
+  }
+  return( 1 );
+}
+
+int 
+MUD_setEvents( int fd, UINT32 num, UINT32 fsPerTick, UINT16* pDet, UINT32* pTime )
+{
+  MUD_SEC_GRP* pMUD_grp;
+  _check_fd( fd );
+  _need_write( fd );
+
+  pMUD_grp = MUD_SEC_GEN_EVENT_group( num, fsPerTick, pDet, pTime );
+  if( pMUD_grp == NULL ) return( 0 );
+
+  MUD_addToGroup( pMUD_fileGrp[fd], pMUD_grp );
+  return( 1 );
+}
+
+/*
+ *  Histogram the file's events into a new histogram group of type
+ *  (e.g. MUD_GRP_TRI_TD_HIST_ID), one histogram per detector, packed
+ *  with bytesPerBin (0 for variable size bins).
+ */
+int 
+MUD_setHistsFromEvents( int fd, UINT32 type, MUD_EVENT_BINNING* pBin, UINT32 bytesPerBin )
+{
+  MUD_SEC_GRP* pMUD_eventGrp=0;
+  MUD_SEC_GEN_EVENT* pMUD_event;
+  UINT32* pHists;
+  UINT32 fsPerBin, nEvents;
+  int i, j;
+  _check_fd( fd );
+  _need_write( fd );
+  _sea_eventgrp( fd );
+
+  pMUD_event = (MUD_SEC_GEN_EVENT*)MUD_search( pMUD_eventGrp->pMem,
+                             MUD_SEC_GEN_EVENT_ID, (UINT32)1, (UINT32)0 );
+  if( pMUD_event == NULL ) return( 0 );
+  fsPerBin = pMUD_event->fsPerTick*pBin->ticksPerBin;
+
+  pHists = (UINT32*)malloc( (size_t)pBin->nHists*pBin->nBins*sizeof( UINT32 ) );
+  if( pHists == NULL ) return( 0 );
+
+  if( !MUD_SEC_GEN_EVENT_hist( pMUD_eventGrp->pMem, pBin, pHists, 0 ) ||
+      !MUD_setHists( fd, type, pBin->nHists ) )
+  {
+    free( pHists );
+    return( 0 );
+  }
+
+  for( i = 0; i < pBin->nHists; i++ )
+  {
+    for( j = 0, nEvents = 0; j < pBin->nBins; j++ )
+      nEvents += pHists[(size_t)i*pBin->nBins + j];
+
+    MUD_setHistType( fd, i+1, type );
+    MUD_setHistNumBins( fd, i+1, pBin->nBins );
+    MUD_setHistBytesPerBin( fd, i+1, bytesPerBin );
+    MUD_setHistFsPerBin( fd, i+1, fsPerBin );
+    MUD_setHistT0_Bin( fd, i+1, pBin->t0_bin );
+    MUD_setHistT0_Ps( fd, i+1, (UINT32)( (double)pBin->t0_bin*fsPerBin/1000.0 ) );
+    MUD_setHistNumEvents( fd, i+1, nEvents );
+    MUD_setHistData( fd, i+1, &pHists[(size_t)i*pBin->nBins] );
+  }
+
+  free( pHists );
+  return( 1 );
+}
+
+/*
+ *  Detector balance (alpha) of the file's histogram pairs
+ */
+int 
+MUD_getAlpha( int fd, MUD_ALPHA* pAlpha )
+{
+  _check_fd( fd );
+  _need_data( fd );
+  return( MUD_alphaSolve( pMUD_fileGrp[fd], pAlpha ) );
+}
+
 /*
  *  Returns number of bytes in outArray
  *  (not success/failure)
@@ -1188,6 +1718,7 @@ MUD_setScalers( int fd, UINT32 type, UINT32 num )
   int i;
 
   _check_fd( fd );
+  _need_write( fd );
 
   pMUD_grp = (MUD_SEC_GRP*)MUD_new( MUD_SEC_GRP_ID, type );
   if( pMUD_grp == NULL ) return( 0 );
@@ -1229,6 +1760,7 @@ MUD_setScalerLabel( int fd, int num, char* label )
   MUD_SEC_GEN_SCALER* pMUD_scal=0;
 
   _check_fd( fd );
+  _need_write( fd );
   _sea_scalgrp( fd );
   _sea_scal( fd, num );
   _free( pMUD_scal->label );
@@ -1260,6 +1792,7 @@ MUD_setScalerCounts( int fd, int num, UINT32* pCounts )
   MUD_SEC_GEN_SCALER* pMUD_scal=0;
 
   _check_fd( fd );
+  _need_write( fd );
   _sea_scalgrp( fd );
   _sea_scal( fd, num );
 
@@ -1338,6 +1871,7 @@ name( int fd, int num, double var ) \
   MUD_SEC_GRP* pMUD_indVarGrp=0; \
   MUD_SEC_GEN_IND_VAR* pMUD_indVar=0; \
   _check_fd( fd ); \
+  _need_write( fd ); \
   _sea_indvargrp( fd ); \
   _sea_indvar( fd, num ); \
   pMUD_indVar->var = var; \
@@ -1365,6 +1899,7 @@ name( int fd, int num, char* var ) \
   MUD_SEC_GRP* pMUD_indVarGrp=0; \
   MUD_SEC_GEN_IND_VAR* pMUD_indVar=0; \
   _check_fd( fd ); \
+  _need_write( fd ); \
   _sea_indvargrp( fd ); \
   _sea_indvar( fd, num ); \
   _free( pMUD_indVar->var ); \
@@ -1393,6 +1928,7 @@ name( int fd, int n, UINT32 var ) \
   MUD_SEC_GRP* pMUD_indVarGrp=0; \
   MUD_SEC_GEN_ARRAY* pMUD_array=0; \
   _check_fd( fd ); \
+  _need_write( fd ); \
   _sea_indvargrp( fd ); \
   _sea_indvardat( fd, n ); \
   pMUD_array->var = var; \
@@ -1434,6 +1970,7 @@ MUD_setIndVars( int fd, UINT32 type, UINT32 num )
   int i;
 
   _check_fd( fd );
+  _need_write( fd );
 
   pMUD_grp = (MUD_SEC_GRP*)MUD_new( MUD_SEC_GRP_ID, type );
   if( pMUD_grp == NULL ) return( 0 );
@@ -1498,6 +2035,7 @@ MUD_getIndVarpData( int fd, int num, void** ppData )
   MUD_SEC_GRP* pMUD_indVarGrp=0; 
   MUD_SEC_GEN_ARRAY* pMUD_array=0; 
   _check_fd( fd ); 
+  _need_data( fd );
   _sea_indvargrp( fd ); 
   _sea_indvardat( fd, num ); 
   *ppData = (void*)pMUD_array->pData;
@@ -1510,6 +2048,7 @@ MUD_setIndVarpData( int fd, int num, void* pData )
   MUD_SEC_GRP* pMUD_indVarGrp=0; 
   MUD_SEC_GEN_ARRAY* pMUD_array=0; 
   _check_fd( fd ); 
+  _need_write( fd );
   _sea_indvargrp( fd ); 
   _sea_indvardat( fd, num ); 
   pMUD_array->pData = (caddr_t)pData;
@@ -1522,6 +2061,7 @@ MUD_getIndVarData( int fd, int num, void* pData )
   MUD_SEC_GRP* pMUD_indVarGrp=0; 
   MUD_SEC_GEN_ARRAY* pMUD_array=0; 
   _check_fd( fd ); 
+  _need_data( fd );
   _sea_indvargrp( fd ); 
   _sea_indvardat( fd, num ); 
 
@@ -1549,6 +2089,7 @@ MUD_setIndVarData( int fd, int num, void* pData )
   MUD_SEC_GRP* pMUD_indVarGrp=0; 
   MUD_SEC_GEN_ARRAY* pMUD_array=0; 
   _check_fd( fd ); 
+  _need_write( fd );
   _sea_indvargrp( fd ); 
   _sea_indvardat( fd, num ); 
   _free( pMUD_array->pData );
@@ -1586,6 +2127,7 @@ MUD_getIndVarpTimeData( int fd, int num, UINT32** ppData )
   MUD_SEC_GRP* pMUD_indVarGrp=0; 
   MUD_SEC_GEN_ARRAY* pMUD_array=0; 
   _check_fd( fd ); 
+  _need_data( fd );
   _sea_indvargrp( fd ); 
   _sea_indvardat( fd, num ); 
   *ppData = (UINT32*)pMUD_array->pTime;
@@ -1598,6 +2140,7 @@ MUD_setIndVarpTimeData( int fd, int num, UINT32* pData )
   MUD_SEC_GRP* pMUD_indVarGrp=0; 
   MUD_SEC_GEN_ARRAY* pMUD_array=0; 
   _check_fd( fd ); 
+  _need_write( fd );
   _sea_indvargrp( fd ); 
   _sea_indvardat( fd, num ); 
   pMUD_array->pTime = (TIME*)pData;
@@ -1610,6 +2153,7 @@ MUD_getIndVarTimeData( int fd, int num, UINT32* pData )
   MUD_SEC_GRP* pMUD_indVarGrp=0; 
   MUD_SEC_GEN_ARRAY* pMUD_array=0; 
   _check_fd( fd ); 
+  _need_data( fd );
   _sea_indvargrp( fd ); 
   _sea_indvardat( fd, num ); 
 
@@ -1628,6 +2172,7 @@ MUD_setIndVarTimeData( int fd, int num, UINT32* pData )
   MUD_SEC_GEN_ARRAY* pMUD_array=0; 
 
   _check_fd( fd ); 
+  _need_write( fd );
   _sea_indvargrp( fd ); 
   _sea_indvardat( fd, num );
   _free( pMUD_array->pTime );
@@ -24,6 +24,11 @@
  *   v1.0d  11-Jul-1994  [TW] Fixed "unaligned data access" messages in
  *			 MUD_SEC_GEN_HIST_pack()
  *          25-Nov-2009  DA  Handle 8-byte time_t
+ *          18-Oct-2026  DA  Add GEN_EVENT (list-mode) section
+ *          18-Oct-2026      Pass pack/unpack op as an argument (reentrant)
+ *          18-Oct-2026      Add GEN_LIVE section
+ *          18-Oct-2026      Pack to and unpack from sparse histograms
+ *          18-Oct-2026  DA  GEN_EVENT data must fit in its section
  */
 
 #include <time.h>
@@ -33,12 +38,10 @@
 /* #define DEBUG 1 */ /*  (un)comment for debug */  
 #define PACK_OP 1
 #define UNPACK_OP 2
-static int pack_op;
-
-static int MUD_SEC_GEN_HIST_dopack _ANSI_ARGS_(( int num, int inBinSize, void* inHist, int outBinSize, void* outHist ));
+static int MUD_SEC_GEN_HIST_dopack _ANSI_ARGS_(( int pack_op, int num, int inBinSize, void* inHist, int outBinSize, void* outHist ));
 static int n_bytes_needed _ANSI_ARGS_(( UINT32 val ));
-static UINT32 varBinArray _ANSI_ARGS_(( void* pHistData, int binSize, int index ));
-static void next_few_bins _ANSI_ARGS_(( int num_tot, int inBinSize, void* pHistData, int outBinSize_now, MUD_VAR_BIN_LEN_TYPE *pNum_next, MUD_VAR_BIN_SIZ_TYPE *pOutBinSize_next ));
+static UINT32 varBinArray _ANSI_ARGS_(( int pack_op, void* pHistData, int binSize, int index ));
+static void next_few_bins _ANSI_ARGS_(( int pack_op, int num_tot, int inBinSize, void* pHistData, int outBinSize_now, MUD_VAR_BIN_LEN_TYPE *pNum_next, MUD_VAR_BIN_SIZ_TYPE *pOutBinSize_next ));
 
 
 int
@@ -530,22 +533,116 @@ MUD_SEC_GEN_ARRAY_proc( MUD_OPT op, BUF* pBuf, MUD_SEC_GEN_ARRAY* pMUD )
 }
 
 
+int 
+MUD_SEC_GEN_EVENT_proc( MUD_OPT op, BUF* pBuf, MUD_SEC_GEN_EVENT* pMUD )
+{
+    int size;
+
+    switch( op )
+    {
+	case MUD_FREE:
+	    _free( pMUD->pData );
+	    break;
+	case MUD_DECODE:
+	    decode_4( pBuf, &pMUD->nEvents );
+	    decode_4( pBuf, &pMUD->nBlocks );
+	    decode_4( pBuf, &pMUD->fsPerTick );
+	    decode_4( pBuf, &pMUD->nBytes );
+
+	    /*
+	     *  The buffer holds just this section (see MUD_decode), so the
+	     *  events must fit in what is left of its size
+	     */
+	    if( (UINT32)pBuf->pos > pMUD->core.size ||
+		pMUD->nBytes > pMUD->core.size - (UINT32)pBuf->pos )
+	    {
+		pMUD->nBytes = 0;
+		return( 0 );
+	    }
+	    pMUD->pData = (caddr_t)zalloc( pMUD->nBytes );
+	    _decode_obj( pBuf, pMUD->pData, pMUD->nBytes );
+	    break;
+	case MUD_ENCODE:
+	    encode_4( pBuf, &pMUD->nEvents );
+	    encode_4( pBuf, &pMUD->nBlocks );
+	    encode_4( pBuf, &pMUD->fsPerTick );
+	    encode_4( pBuf, &pMUD->nBytes );
+	    _encode_obj( pBuf, pMUD->pData, pMUD->nBytes );
+	    break;
+	case MUD_GET_SIZE:
+	    size = 4*sizeof( UINT32 );
+	    size += pMUD->nBytes;
+	    return( size );
+	case MUD_SHOW:
+	    printf( "  MUD_SEC_GEN_EVENT: nEvents:[%lu], nBlocks:[%lu], fsPerTick:[%lu], nBytes:[%lu]\n",
+                    (unsigned long)(pMUD->nEvents), (unsigned long)(pMUD->nBlocks),
+                    (unsigned long)(pMUD->fsPerTick), (unsigned long)(pMUD->nBytes) );
+	    break;
+	case MUD_HEADS:
+	    printf( "  Events: %lu in %lu blocks\n",
+                    (unsigned long)(pMUD->nEvents), (unsigned long)(pMUD->nBlocks) );
+	    break;
+    }
+    return( 1 );
+}
+
+
+int 
+MUD_SEC_GEN_LIVE_proc( MUD_OPT op, BUF* pBuf, MUD_SEC_GEN_LIVE* pMUD )
+{
+    switch( op )
+    {
+	case MUD_FREE:
+	    break;
+	case MUD_DECODE:
+	    decode_4( pBuf, &pMUD->generation );
+	    break;
+	case MUD_ENCODE:
+	    encode_4( pBuf, &pMUD->generation );
+	    break;
+	case MUD_GET_SIZE:
+	    return( sizeof( UINT32 ) );
+	case MUD_SHOW:
+	    printf( "  MUD_SEC_GEN_LIVE: generation:[%lu]\n",
+                    (unsigned long)(pMUD->generation) );
+	    break;
+	case MUD_HEADS:
+	    printf( "  Live generation: %lu\n", (unsigned long)(pMUD->generation) );
+	    break;
+    }
+    return( 1 );
+}
+
+
 int
 MUD_SEC_GEN_HIST_pack( int num, int inBinSize, void* inHist, int outBinSize, void* outHist )
 {
-  pack_op = PACK_OP;
-  return( MUD_SEC_GEN_HIST_dopack( num, inBinSize, inHist, outBinSize, outHist ) );
+  return( MUD_SEC_GEN_HIST_dopack( PACK_OP, num, inBinSize, inHist, outBinSize, outHist ) );
 }
 
 int
 MUD_SEC_GEN_HIST_unpack( int num, int inBinSize, void* inHist, int outBinSize, void* outHist )
 {
-  pack_op = UNPACK_OP;
-  return( MUD_SEC_GEN_HIST_dopack( num, inBinSize, inHist, outBinSize, outHist ) );
+  return( MUD_SEC_GEN_HIST_dopack( UNPACK_OP, num, inBinSize, inHist, outBinSize, outHist ) );
+}
+
+/*
+ *  MUD_SEC_GEN_HIST_unpackData() - as MUD_SEC_GEN_HIST_unpack(), for
+ *  inBytes of data as stored, which sparse data is checked to fit in
+ *  (see mud_sparse.c); returns 0, the bins cleared, if it does not.
+ */
+int
+MUD_SEC_GEN_HIST_unpackData( int num, int inBinSize, void* inHist, UINT32 inBytes,
+			     int outBinSize, void* outHist )
+{
+  if( inBinSize == MUD_BPB_SPARSE &&
+      ( outBinSize == 1 || outBinSize == 2 || outBinSize == 4 ) )
+    return( MUD_sparseUnpack( num, inHist, inBytes, outBinSize, outHist ) );
+  return( MUD_SEC_GEN_HIST_unpack( num, inBinSize, inHist, outBinSize, outHist ) );
 }
 
 static int
-MUD_SEC_GEN_HIST_dopack( int num, int inBinSize, void* inHist, int outBinSize, void* outHist )
+MUD_SEC_GEN_HIST_dopack( int pack_op, int num, int inBinSize, void* inHist, int outBinSize, void* outHist )
 {
     int i;
     int outLen = 0;
@@ -575,6 +672,21 @@ MUD_SEC_GEN_HIST_dopack( int num, int inBinSize, void* inHist, int outBinSize, v
 
 #endif /* DEBUG */
     
+    /*
+     *  Sparse histograms (see mud_sparse.c), to or from bins of 1, 2
+     *  or 4 bytes
+     */
+    if( inBinSize == MUD_BPB_SPARSE || outBinSize == MUD_BPB_SPARSE )
+    {
+	if( pack_op == PACK_OP && outBinSize == MUD_BPB_SPARSE &&
+	    ( inBinSize == 1 || inBinSize == 2 || inBinSize == 4 ) )
+	    return( MUD_sparsePack( num, inBinSize, inHist, outHist ) );
+	if( pack_op == UNPACK_OP && inBinSize == MUD_BPB_SPARSE &&
+	    ( outBinSize == 1 || outBinSize == 2 || outBinSize == 4 ) )
+	    return( MUD_sparseUnpack( num, inHist, 0xFFFFFFFF, outBinSize, outHist ) );
+	return( 0 );
+    }
+
     if( inBinSize == 1 && outBinSize == 1 )
     {
 	bcopy( inHist, outHist, num );
@@ -844,11 +956,11 @@ MUD_SEC_GEN_HIST_dopack( int num, int inBinSize, void* inHist, int outBinSize, v
 	bin = 0;
 	inLoc = 0;
 	outLoc = 0;
-        outBinSize_now = n_bytes_needed( varBinArray( inHist, inBinSize, 0 ) );
+        outBinSize_now = n_bytes_needed( varBinArray( pack_op, inHist, inBinSize, 0 ) );
 
 	while( bin < num )
 	{
-	    next_few_bins( num - bin, inBinSize, &((char*)inHist)[inLoc],
+	    next_few_bins( pack_op, num - bin, inBinSize, &((char*)inHist)[inLoc],
 			   outBinSize_now, &num_temp, &outBinSize_next );
 
 #ifdef DEBUG
@@ -912,7 +1024,7 @@ n_bytes_needed( UINT32 val )
 
 
 static UINT32
-varBinArray( void* pHistData, int binSize, int index )
+varBinArray( int pack_op, void* pHistData, int binSize, int index )
 {
   UINT8  c;
   UINT16 s;
@@ -954,7 +1066,7 @@ varBinArray( void* pHistData, int binSize, int index )
 
 
 static void
-next_few_bins( int num_tot, int inBinSize, void* pHistData, int outBinSize_now,
+next_few_bins( int pack_op, int num_tot, int inBinSize, void* pHistData, int outBinSize_now,
                MUD_VAR_BIN_LEN_TYPE* pNum_next, MUD_VAR_BIN_SIZ_TYPE* pOutBinSize_next )
 {
     int val;
@@ -997,7 +1109,7 @@ next_few_bins( int num_tot, int inBinSize, void* pHistData, int outBinSize_now,
         break;
       } 
 
-	val = varBinArray( pHistData, inBinSize, num_next );
+	val = varBinArray( pack_op, pHistData, inBinSize, num_next );
 	outBinSize_next = n_bytes_needed( val );
 	if( outBinSize_next == outBinSize_now ) 
 	{
@@ -0,0 +1,344 @@
+/*
+ *  mud_hist.c -- arithmetic on unpacked histograms: sums, detector
+ *                grouping, scaling and normalization with errors
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026  DJA Initial version
+ *          18-Oct-2026  DJA Error 1 for empty grouped bins, as for raw ones
+ *
+ *  Description:
+ *    Histograms here are unpacked arrays of nBins bins, as returned by
+ *    MUD_getHistData with 4 bytes per bin.  Raw counts are summed into
+ *    64-bit bins so that grouping many long runs cannot overflow.  Once
+ *    weights or normalization come in, histograms are REAL64 values with
+ *    a parallel array of REAL64 errors (standard deviations); errors of
+ *    raw counts are Poisson, sqrt(n), taking 1 for empty bins.
+ *
+ *    Grouping (e.g. summing the 8 segments of a detector ring into
+ *    "Forw" and "Back") is done in chunks of bins spread over threads
+ *    with MUD_parallelFor.  The inner loops use AVX2 when the library
+ *    is compiled for it ("-mavx2"), and plain C otherwise.
+ */
+
+#include <math.h>
+#include "mud.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif /* __AVX2__ */
+
+#define HIST_CHUNK	8192	/* bins per task */
+
+typedef struct {
+    int		nIn;
+    UINT32**	ppIn;
+    UINT32	nBins;
+    int		nOut;
+    int*	pGroup;		/* MUD_histGroupSum */
+    UINT64*	pSum;
+    REAL64*	pMatrix;	/* MUD_histGroupMatrix */
+    REAL64*	pOut;
+    REAL64*	pErr;
+} HIST_GROUP;
+
+static void add_u32_u64 _ANSI_ARGS_(( UINT64* pSum, UINT32* pAdd, UINT32 num ));
+static void axpy_u32 _ANSI_ARGS_(( REAL64* pOut, REAL64* pVar, REAL64 w, UINT32* pIn, UINT32 num ));
+static void group_sum_task _ANSI_ARGS_(( int task, int thread, void* pArg ));
+static void group_matrix_task _ANSI_ARGS_(( int task, int thread, void* pArg ));
+
+
+/*
+ *  pSum[i] += pAdd[i], 32-bit bins into 64-bit bins
+ */
+static void
+add_u32_u64( UINT64* pSum, UINT32* pAdd, UINT32 num )
+{
+    UINT32 i = 0;
+
+#ifdef __AVX2__
+    __m256i s, a;
+
+    for( ; i + 4 <= num; i += 4 )
+    {
+	a = _mm256_cvtepu32_epi64( _mm_loadu_si128( (__m128i*)&pAdd[i] ) );
+	s = _mm256_loadu_si256( (__m256i*)&pSum[i] );
+	_mm256_storeu_si256( (__m256i*)&pSum[i], _mm256_add_epi64( s, a ) );
+    }
+#endif /* __AVX2__ */
+
+    for( ; i < num; i++ )
+    {
+	pSum[i] += pAdd[i];
+    }
+}
+
+
+/*
+ *  pOut[i] += w*pIn[i]; pVar[i] += w*w*pIn[i]
+ */
+static void
+axpy_u32( REAL64* pOut, REAL64* pVar, REAL64 w, UINT32* pIn, UINT32 num )
+{
+    UINT32 i = 0;
+    REAL64 c;
+
+#ifdef __AVX2__
+    __m256d vw, vw2, vc, big;
+    __m128i x, sign;
+
+    vw = _mm256_set1_pd( w );
+    vw2 = _mm256_set1_pd( w*w );
+    big = _mm256_set1_pd( 2147483648.0 );
+    sign = _mm_set1_epi32( (int)0x80000000 );
+    for( ; i + 4 <= num; i += 4 )
+    {
+	/* unsigned to double: flip the sign bit, convert, add 2^31 */
+	x = _mm_xor_si128( _mm_loadu_si128( (__m128i*)&pIn[i] ), sign );
+	vc = _mm256_add_pd( _mm256_cvtepi32_pd( x ), big );
+	_mm256_storeu_pd( &pOut[i], _mm256_add_pd( _mm256_loadu_pd( &pOut[i] ),
+						    _mm256_mul_pd( vw, vc ) ) );
+	_mm256_storeu_pd( &pVar[i], _mm256_add_pd( _mm256_loadu_pd( &pVar[i] ),
+						    _mm256_mul_pd( vw2, vc ) ) );
+    }
+#endif /* __AVX2__ */
+
+    for( ; i < num; i++ )
+    {
+	c = pIn[i];
+	pOut[i] += w*c;
+	pVar[i] += w*w*c;
+    }
+}
+
+
+static void
+group_sum_task( int task, int thread, void* pArg )
+{
+    HIST_GROUP* pG = (HIST_GROUP*)pArg;
+    UINT32 first, n;
+    int i, o;
+
+    first = (UINT32)task*HIST_CHUNK;
+    n = _min( pG->nBins - first, HIST_CHUNK );
+
+    for( o = 0; o < pG->nOut; o++ )
+	bzero( &pG->pSum[(size_t)o*pG->nBins + first], n*sizeof( UINT64 ) );
+
+    for( i = 0; i < pG->nIn; i++ )
+    {
+	o = pG->pGroup[i];
+	if( o < 0 || o >= pG->nOut ) continue;
+	add_u32_u64( &pG->pSum[(size_t)o*pG->nBins + first], &pG->ppIn[i][first], n );
+    }
+}
+
+
+/*
+ *  MUD_histGroupSum() - sum nIn histograms of nBins bins into nOut
+ *  groups: input i is added to output pGroup[i] (skipped if negative).
+ *  Output o is pSum[o*nBins ... o*nBins+nBins-1].  Returns 1.
+ */
+int
+MUD_histGroupSum( int nIn, UINT32** ppIn, UINT32 nBins, int* pGroup, int nOut,
+		  UINT64* pSum, int nThreads )
+{
+    HIST_GROUP g;
+
+    bzero( &g, sizeof( g ) );
+    g.nIn = nIn;
+    g.ppIn = ppIn;
+    g.nBins = nBins;
+    g.pGroup = pGroup;
+    g.nOut = nOut;
+    g.pSum = pSum;
+
+    MUD_parallelFor( ( nBins + HIST_CHUNK - 1 )/HIST_CHUNK, nThreads, group_sum_task, &g );
+    return( 1 );
+}
+
+
+static void
+group_matrix_task( int task, int thread, void* pArg )
+{
+    HIST_GROUP* pG = (HIST_GROUP*)pArg;
+    REAL64* pOut;
+    REAL64* pErr;
+    REAL64 w;
+    UINT32 first, n, k;
+    int i, o;
+
+    first = (UINT32)task*HIST_CHUNK;
+    n = _min( pG->nBins - first, HIST_CHUNK );
+
+    for( o = 0; o < pG->nOut; o++ )
+    {
+	pOut = &pG->pOut[(size_t)o*pG->nBins + first];
+	pErr = &pG->pErr[(size_t)o*pG->nBins + first];
+	bzero( pOut, n*sizeof( REAL64 ) );
+	bzero( pErr, n*sizeof( REAL64 ) );
+
+	for( i = 0; i < pG->nIn; i++ )
+	{
+	    w = pG->pMatrix[(size_t)o*pG->nIn + i];
+	    if( w != 0.0 ) axpy_u32( pOut, pErr, w, &pG->ppIn[i][first], n );
+	}
+
+	/* variance to error; a bin with no counts gets the error of one count */
+	for( k = 0; k < n; k++ )
+	{
+	    pErr[k] = ( pErr[k] > 0.0 ) ? sqrt( pErr[k] ) : 1.0;
+	}
+    }
+}
+
+
+/*
+ *  MUD_histGroupMatrix() - weighted grouping of nIn raw histograms:
+ *  pOut[o] = sum over i of pMatrix[o*nIn+i]*ppIn[i], with Poisson errors
+ *  propagated into pErr.  pOut and pErr hold nOut*nBins values.  Returns 1.
+ */
+int
+MUD_histGroupMatrix( int nIn, UINT32** ppIn, UINT32 nBins, int nOut, REAL64* pMatrix,
+		     REAL64* pOut, REAL64* pErr, int nThreads )
+{
+    HIST_GROUP g;
+
+    bzero( &g, sizeof( g ) );
+    g.nIn = nIn;
+    g.ppIn = ppIn;
+    g.nBins = nBins;
+    g.nOut = nOut;
+    g.pMatrix = pMatrix;
+    g.pOut = pOut;
+    g.pErr = pErr;
+
+    MUD_parallelFor( ( nBins + HIST_CHUNK - 1 )/HIST_CHUNK, nThreads, group_matrix_task, &g );
+    return( 1 );
+}
+
+
+/*
+ *  MUD_histToReal() - raw counts (32 or 64-bit bins, per binSize) to
+ *  values and Poisson errors.  Returns 1, or 0 for a bad binSize.
+ */
+int
+MUD_histToReal( void* pIn, int binSize, UINT32 nBins, REAL64* pOut, REAL64* pErr )
+{
+    UINT32 i;
+    REAL64 c;
+
+    if( binSize != 4 && binSize != 8 ) return( 0 );
+
+    for( i = 0; i < nBins; i++ )
+    {
+	c = ( binSize == 4 ) ? (REAL64)((UINT32*)pIn)[i] : (REAL64)((UINT64*)pIn)[i];
+	pOut[i] = c;
+	pErr[i] = ( c > 0.0 ) ? sqrt( c ) : 1.0;
+    }
+    return( 1 );
+}
+
+
+/*
+ *  MUD_histAdd() - pA += factor*pB with errors added in quadrature
+ *  (factor -1 subtracts).  Returns 1.
+ */
+int
+MUD_histAdd( REAL64* pA, REAL64* pAErr, REAL64* pB, REAL64* pBErr, REAL64 factor,
+	     UINT32 nBins )
+{
+    UINT32 i = 0;
+
+#ifdef __AVX2__
+    __m256d f, f2, ea, eb;
+
+    f = _mm256_set1_pd( factor );
+    f2 = _mm256_set1_pd( factor*factor );
+    for( ; i + 4 <= nBins; i += 4 )
+    {
+	_mm256_storeu_pd( &pA[i], _mm256_add_pd( _mm256_loadu_pd( &pA[i] ),
+				  _mm256_mul_pd( f, _mm256_loadu_pd( &pB[i] ) ) ) );
+	ea = _mm256_loadu_pd( &pAErr[i] );
+	eb = _mm256_loadu_pd( &pBErr[i] );
+	ea = _mm256_add_pd( _mm256_mul_pd( ea, ea ),
+			    _mm256_mul_pd( f2, _mm256_mul_pd( eb, eb ) ) );
+	_mm256_storeu_pd( &pAErr[i], _mm256_sqrt_pd( ea ) );
+    }
+#endif /* __AVX2__ */
+
+    for( ; i < nBins; i++ )
+    {
+	pA[i] += factor*pB[i];
+	pAErr[i] = sqrt( pAErr[i]*pAErr[i] + factor*factor*pBErr[i]*pBErr[i] );
+    }
+    return( 1 );
+}
+
+
+/*
+ *  MUD_histScale() - multiply by factor +- factorErr; the relative
+ *  error of the factor is added in quadrature to each bin's.  Returns 1.
+ */
+int
+MUD_histScale( REAL64* p, REAL64* pErr, REAL64 factor, REAL64 factorErr, UINT32 nBins )
+{
+    UINT32 i = 0;
+    REAL64 rel2;
+
+    rel2 = ( factor != 0.0 ) ? ( factorErr*factorErr )/( factor*factor ) : 0.0;
+
+#ifdef __AVX2__
+    {
+	__m256d f, r2, v, e;
+
+	f = _mm256_set1_pd( factor );
+	r2 = _mm256_set1_pd( rel2 );
+	for( ; i + 4 <= nBins; i += 4 )
+	{
+	    v = _mm256_mul_pd( f, _mm256_loadu_pd( &p[i] ) );
+	    e = _mm256_mul_pd( f, _mm256_loadu_pd( &pErr[i] ) );
+	    e = _mm256_add_pd( _mm256_mul_pd( e, e ),
+			       _mm256_mul_pd( r2, _mm256_mul_pd( v, v ) ) );
+	    _mm256_storeu_pd( &p[i], v );
+	    _mm256_storeu_pd( &pErr[i], _mm256_sqrt_pd( e ) );
+	}
+    }
+#endif /* __AVX2__ */
+
+    for( ; i < nBins; i++ )
+    {
+	p[i] *= factor;
+	pErr[i] *= factor;
+	pErr[i] = sqrt( pErr[i]*pErr[i] + rel2*p[i]*p[i] );
+    }
+    return( 1 );
+}
+
+
+/*
+ *  MUD_histNormalize() - divide by a normalization: MUD_NORM_EVENTS
+ *  (norm is a number of events, with Poisson error) or MUD_NORM_TIME
+ *  (norm is a time, e.g. elapsedSec, taken as exact).  Returns 1, or 0
+ *  if norm is not positive.
+ */
+int
+MUD_histNormalize( REAL64* p, REAL64* pErr, UINT32 nBins, REAL64 norm, int normType )
+{
+    if( norm <= 0.0 ) return( 0 );
+
+    return( MUD_histScale( p, pErr, 1.0/norm,
+			   ( normType == MUD_NORM_EVENTS ) ? 1.0/( norm*sqrt( norm ) ) : 0.0,
+			   nBins ) );
+}
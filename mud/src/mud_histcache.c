@@ -0,0 +1,454 @@
+/*
+ *  mud_histcache.c -- on-disk cache of unpacked histograms, mapped into
+ *                     memory by later opens
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version
+ *
+ *  Description:
+ *    The cache is opt-in: it is used only when a cache directory is set,
+ *    by MUD_setHistCacheDir() or the environment variable MUD_CACHE_DIR.
+ *    The directory must exist.  Then the first MUD_openRead() of a run
+ *    unpacks all its histograms and stores them, 4 bytes per bin, in a
+ *    file of the cache directory.  Later opens read only the headers of
+ *    the run (MUD_readHeaders), map that file, and copy (MUD_getHistData)
+ *    or point at (MUD_getHistCachedData) the bins instead of reading and
+ *    unpacking them again.  The rest of the run is read only if needed.
+ *
+ *    A cache file is named by a hash of the fingerprint of the run file
+ *    (device, inode, size and modification time), which is also stored
+ *    in it and checked, so a run file that is rewritten or replaced just
+ *    gets a new cache file.  Old cache files are never removed here; the
+ *    directory may be emptied at any time.  Cache files are written under
+ *    a temporary name and renamed, never modified in place, so a mapping
+ *    stays valid while another process replaces the file.
+ *
+ *    The file is in the byte order of the machine that wrote it, so that
+ *    it can be used as mapped; a cache from another byte order is ignored
+ *    (and rewritten):
+ *
+ *      HC_HEADER             64 bytes: "MUDHISTC", version, byte-order
+ *                            mark, fingerprint, nHists
+ *      nHists x MUD_HIST_CACHE_ENTRY   64 bytes each: histogram header
+ *                            fields, offset of the bins
+ *      bins                  nBins x UINT32 per histogram, each array
+ *                            starting on a 64-byte boundary
+ *
+ *    Without mmap (Windows) the whole file is read into memory instead.
+ */
+
+#include "mud.h"
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif /* _WIN32 */
+
+#define HC_MAGIC	"MUDHISTC"
+#define HC_VERSION	1
+#define HC_BYTE_ORDER	0x01020304
+#define HC_ALIGN	64
+
+typedef struct {
+    char	magic[8];
+    UINT32	version;
+    UINT32	byteOrder;	/* HC_BYTE_ORDER as written */
+    UINT64	print[4];	/* device, inode, size, mtime (ns) */
+    UINT32	nHists;
+    UINT32	spare[3];
+} HC_HEADER;
+
+static char* cacheDir = NULL;
+
+static int get_print _ANSI_ARGS_(( char* path, FILE* fin, UINT64* pPrint ));
+static char* cache_name _ANSI_ARGS_(( char* dir, UINT64* pPrint ));
+static MUD_SEC_GRP* find_hist_grp _ANSI_ARGS_(( MUD_SEC_GRP* pMUD_fileGrp ));
+static int write_cache _ANSI_ARGS_(( char* cachename, UINT64* pPrint, MUD_SEC_GRP* pMUD_fileGrp ));
+static MUD_HIST_CACHE* map_cache _ANSI_ARGS_(( char* cachename, UINT64* pPrint ));
+static int check_cache _ANSI_ARGS_(( MUD_HIST_CACHE* pCache, UINT64* pPrint ));
+
+
+/*
+ *  MUD_setHistCacheDir() - use the cache in dir; NULL goes back to the
+ *  environment variable MUD_CACHE_DIR, and "" turns the cache off.
+ */
+void
+MUD_setHistCacheDir( char* dir )
+{
+    _free( cacheDir );
+    if( dir != NULL ) cacheDir = strdup( dir );
+}
+
+
+/*
+ *  MUD_getHistCacheDir() - the cache directory in use, NULL if none
+ */
+char*
+MUD_getHistCacheDir( void )
+{
+    char* dir;
+
+    dir = ( cacheDir != NULL ) ? cacheDir : getenv( "MUD_CACHE_DIR" );
+    return( ( dir != NULL && *dir != '\0' ) ? dir : NULL );
+}
+
+
+/*
+ *  get_print() - device, inode, size and modification time (ns) of a
+ *  file (of the open file fin, if not NULL); returns 0 if it cannot be
+ *  examined.
+ */
+static int
+get_print( char* path, FILE* fin, UINT64* pPrint )
+{
+    struct stat st;
+
+    if( ( fin != NULL ) ? fstat( fileno( fin ), &st ) : stat( path, &st ) ) return( 0 );
+    pPrint[0] = (UINT64)st.st_dev;
+    pPrint[1] = (UINT64)st.st_ino;
+    pPrint[2] = (UINT64)st.st_size;
+#if defined(__linux__)
+    pPrint[3] = (UINT64)st.st_mtim.tv_sec*1000000000 + (UINT64)st.st_mtim.tv_nsec;
+#else
+    pPrint[3] = (UINT64)st.st_mtime*1000000000;
+#endif /* __linux__ */
+    return( 1 );
+}
+
+
+/*
+ *  cache_name() - dir/<FNV-1a hash of the fingerprint>.mhc; free() it
+ */
+static char*
+cache_name( char* dir, UINT64* pPrint )
+{
+    char* name;
+    UINT64 h = 14695981039346656037ULL;
+    int i, j;
+
+    for( i = 0; i < 4; i++ )
+    {
+	for( j = 0; j < 64; j += 8 )
+	{
+	    h ^= ( pPrint[i] >> j ) & 0xFF;
+	    h *= 1099511628211ULL;
+	}
+    }
+    if( ( name = (char*)malloc( strlen( dir ) + 22 ) ) == NULL ) return( NULL );
+    sprintf( name, "%s/%016llx.mhc", dir, (unsigned long long)h );
+    return( name );
+}
+
+
+static MUD_SEC_GRP*
+find_hist_grp( MUD_SEC_GRP* pMUD_fileGrp )
+{
+    return( (MUD_SEC_GRP*)MUD_search( pMUD_fileGrp->pMem, MUD_SEC_GRP_ID,
+		( MUD_instanceID( pMUD_fileGrp ) == MUD_FMT_TRI_TI_ID ) ?
+		MUD_GRP_TRI_TI_HIST_ID : MUD_GRP_TRI_TD_HIST_ID, (UINT32)0 ) );
+}
+
+
+/*
+ *  write_cache() - unpack the histograms of the run and write them to
+ *  the cache file.  Histograms without data are left out.  Returns 1 on
+ *  success, 0 if there is nothing to cache or the file cannot be written.
+ */
+static int
+write_cache( char* cachename, UINT64* pPrint, MUD_SEC_GRP* pMUD_fileGrp )
+{
+    MUD_SEC_GRP* pMUD_histGrp;
+    MUD_SEC* pSec;
+    MUD_SEC* pDatSec;
+    MUD_SEC_GEN_HIST_HDR* pHdr;
+    MUD_SEC_GEN_HIST_DAT* pDat;
+    MUD_SEC_GEN_HIST_HDR** ppHdrs = NULL;
+    MUD_SEC_GEN_HIST_DAT** ppDats = NULL;
+    MUD_HIST_CACHE_ENTRY* pEntries = NULL;
+    HC_HEADER hdr;
+    UINT32* pBins = NULL;
+    UINT32 maxBins = 0;
+    UINT64 offset;
+    static char zeros[HC_ALIGN];
+    char* tmpname = NULL;
+    FILE* fout = NULL;
+    int i, n, nSec, status = 0;
+    size_t pad;
+
+    if( ( pMUD_histGrp = find_hist_grp( pMUD_fileGrp ) ) == NULL ) return( 0 );
+
+    for( nSec = 0, pSec = (MUD_SEC*)pMUD_histGrp->pMem; pSec != NULL; pSec = MUD_pNext( pSec ) )
+	nSec++;
+    ppHdrs = (MUD_SEC_GEN_HIST_HDR**)zalloc( ( nSec + 1 )*sizeof( MUD_SEC_GEN_HIST_HDR* ) );
+    ppDats = (MUD_SEC_GEN_HIST_DAT**)zalloc( ( nSec + 1 )*sizeof( MUD_SEC_GEN_HIST_DAT* ) );
+    if( ppHdrs == NULL || ppDats == NULL ) goto done;
+
+    /*
+     *  Pair each header with the data of the same instance
+     */
+    for( n = 0, pSec = (MUD_SEC*)pMUD_histGrp->pMem; pSec != NULL; pSec = MUD_pNext( pSec ) )
+    {
+	if( MUD_secID( pSec ) != MUD_SEC_GEN_HIST_HDR_ID ) continue;
+	pHdr = (MUD_SEC_GEN_HIST_HDR*)pSec;
+	for( pDatSec = (MUD_SEC*)pMUD_histGrp->pMem; pDatSec != NULL; pDatSec = MUD_pNext( pDatSec ) )
+	{
+	    if( MUD_secID( pDatSec ) == MUD_SEC_GEN_HIST_DAT_ID &&
+		MUD_instanceID( pDatSec ) == MUD_instanceID( pHdr ) ) break;
+	}
+	pDat = (MUD_SEC_GEN_HIST_DAT*)pDatSec;
+	if( pDat == NULL || pDat->pData == NULL || pHdr->nBins == 0 ) continue;
+	if( pHdr->bytesPerBin != 0 && pHdr->bytesPerBin != 1 &&
+	    pHdr->bytesPerBin != 2 && pHdr->bytesPerBin != 4 &&
+	    pHdr->bytesPerBin != MUD_BPB_SPARSE ) continue;
+	ppHdrs[n] = pHdr;
+	ppDats[n] = pDat;
+	maxBins = _max( maxBins, pHdr->nBins );
+	n++;
+    }
+    if( n == 0 ) goto done;
+
+    pEntries = (MUD_HIST_CACHE_ENTRY*)zalloc( n*sizeof( MUD_HIST_CACHE_ENTRY ) );
+    pBins = (UINT32*)zalloc( ( maxBins + 1 )*sizeof( UINT32 ) );
+    if( pEntries == NULL || pBins == NULL ) goto done;
+
+    offset = sizeof( HC_HEADER ) + n*sizeof( MUD_HIST_CACHE_ENTRY );
+    for( i = 0; i < n; i++ )
+    {
+	pHdr = ppHdrs[i];
+	offset = ( offset + HC_ALIGN - 1 ) & ~(UINT64)( HC_ALIGN - 1 );
+	pEntries[i].num = MUD_instanceID( pHdr );
+	pEntries[i].histType = pHdr->histType;
+	pEntries[i].nBytes = pHdr->nBytes;
+	pEntries[i].nBins = pHdr->nBins;
+	pEntries[i].bytesPerBin = pHdr->bytesPerBin;
+	pEntries[i].fsPerBin = pHdr->fsPerBin;
+	pEntries[i].t0_ps = pHdr->t0_ps;
+	pEntries[i].t0_bin = pHdr->t0_bin;
+	pEntries[i].goodBin1 = pHdr->goodBin1;
+	pEntries[i].goodBin2 = pHdr->goodBin2;
+	pEntries[i].bkgd1 = pHdr->bkgd1;
+	pEntries[i].bkgd2 = pHdr->bkgd2;
+	pEntries[i].nEvents = pHdr->nEvents;
+	pEntries[i].offset = offset;
+	offset += (UINT64)pHdr->nBins*sizeof( UINT32 );
+    }
+
+    bzero( &hdr, sizeof( hdr ) );
+    bcopy( HC_MAGIC, hdr.magic, 8 );
+    hdr.version = HC_VERSION;
+    hdr.byteOrder = HC_BYTE_ORDER;
+    bcopy( pPrint, hdr.print, sizeof( hdr.print ) );
+    hdr.nHists = n;
+
+    if( ( tmpname = (char*)malloc( strlen( cachename ) + 24 ) ) == NULL ) goto done;
+    sprintf( tmpname, "%s.%lu.tmp", cachename, (unsigned long)getpid() );
+    if( ( fout = fopen( tmpname, "wb" ) ) == NULL ) goto done;
+
+    status = ( fwrite( &hdr, sizeof( hdr ), 1, fout ) == 1 &&
+	       fwrite( pEntries, sizeof( MUD_HIST_CACHE_ENTRY ), n, fout ) == (size_t)n );
+    offset = sizeof( HC_HEADER ) + n*sizeof( MUD_HIST_CACHE_ENTRY );
+    for( i = 0; status && i < n; i++ )
+    {
+	pad = (size_t)( pEntries[i].offset - offset );
+	if( pad > 0 ) status = ( fwrite( zeros, 1, pad, fout ) == pad );
+	MUD_SEC_GEN_HIST_unpackData( ppHdrs[i]->nBins, ppHdrs[i]->bytesPerBin, ppDats[i]->pData, ppDats[i]->nBytes,
+				 4, pBins );
+	if( status )
+	    status = ( fwrite( pBins, sizeof( UINT32 ), ppHdrs[i]->nBins, fout ) == ppHdrs[i]->nBins );
+	offset = pEntries[i].offset + (UINT64)ppHdrs[i]->nBins*sizeof( UINT32 );
+    }
+    if( fclose( fout ) != 0 ) status = 0;
+
+    if( status )
+    {
+#ifdef _WIN32
+	remove( cachename );
+#endif /* _WIN32 */
+	status = ( rename( tmpname, cachename ) == 0 );
+    }
+    if( !status ) remove( tmpname );
+
+done:
+    _free( tmpname );
+    _free( pBins );
+    _free( pEntries );
+    _free( ppDats );
+    _free( ppHdrs );
+    return( status );
+}
+
+
+/*
+ *  check_cache() - whether the mapped file is a complete cache, in this
+ *  byte order, of the file with fingerprint pPrint
+ */
+static int
+check_cache( MUD_HIST_CACHE* pCache, UINT64* pPrint )
+{
+    HC_HEADER* pHdr = (HC_HEADER*)pCache->pBase;
+    MUD_HIST_CACHE_ENTRY* pEntry;
+    UINT32 i;
+
+    if( pCache->size < sizeof( HC_HEADER ) ||
+	strncmp( pHdr->magic, HC_MAGIC, 8 ) != 0 ||
+	pHdr->version != HC_VERSION ||
+	pHdr->byteOrder != HC_BYTE_ORDER ||
+	memcmp( pHdr->print, pPrint, sizeof( pHdr->print ) ) != 0 ) return( 0 );
+    if( ( pCache->size - sizeof( HC_HEADER ) )/sizeof( MUD_HIST_CACHE_ENTRY ) < pHdr->nHists )
+	return( 0 );
+
+    pCache->nHists = pHdr->nHists;
+    pCache->pEntries = (MUD_HIST_CACHE_ENTRY*)( pHdr + 1 );
+    for( i = 0; i < pCache->nHists; i++ )
+    {
+	pEntry = &pCache->pEntries[i];
+	if( pEntry->offset % sizeof( UINT32 ) != 0 || pEntry->offset > pCache->size ||
+	    ( pCache->size - pEntry->offset )/sizeof( UINT32 ) < pEntry->nBins ) return( 0 );
+    }
+    return( 1 );
+}
+
+
+/*
+ *  map_cache() - map the cache file, if it is a good one
+ */
+static MUD_HIST_CACHE*
+map_cache( char* cachename, UINT64* pPrint )
+{
+    MUD_HIST_CACHE* pCache;
+#ifdef _WIN32
+    FILE* fin;
+    long size;
+
+    if( ( fin = fopen( cachename, "rb" ) ) == NULL ) return( NULL );
+    if( fseek( fin, 0, SEEK_END ) != 0 || ( size = ftell( fin ) ) <= 0 )
+    {
+	fclose( fin );
+	return( NULL );
+    }
+    rewind( fin );
+    pCache = (MUD_HIST_CACHE*)zalloc( sizeof( MUD_HIST_CACHE ) );
+    if( pCache == NULL || ( pCache->pBase = malloc( size ) ) == NULL ||
+	fread( pCache->pBase, 1, size, fin ) != (size_t)size )
+    {
+	fclose( fin );
+	MUD_histCacheClose( pCache );
+	return( NULL );
+    }
+    fclose( fin );
+    pCache->size = (size_t)size;
+#else
+    struct stat st;
+    void* pBase;
+    int f;
+
+    if( ( f = open( cachename, O_RDONLY ) ) < 0 ) return( NULL );
+    if( fstat( f, &st ) != 0 || st.st_size < (off_t)sizeof( HC_HEADER ) )
+    {
+	close( f );
+	return( NULL );
+    }
+    pBase = mmap( NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, f, 0 );
+    close( f );
+    if( pBase == MAP_FAILED ) return( NULL );
+    if( ( pCache = (MUD_HIST_CACHE*)zalloc( sizeof( MUD_HIST_CACHE ) ) ) == NULL )
+    {
+	munmap( pBase, (size_t)st.st_size );
+	return( NULL );
+    }
+    pCache->pBase = pBase;
+    pCache->size = (size_t)st.st_size;
+    pCache->mapped = 1;
+#endif /* _WIN32 */
+
+    if( !check_cache( pCache, pPrint ) )
+    {
+	MUD_histCacheClose( pCache );
+	return( NULL );
+    }
+    return( pCache );
+}
+
+
+/*
+ *  MUD_histCacheOpen() - the cache of the run file filename (open as fin,
+ *  or NULL).  If there is none yet and pMUD_fileGrp (the file as read by
+ *  MUD_readFile) is given, the cache is written from it first.  Returns
+ *  NULL if no cache directory is set or there is no usable cache; the
+ *  caller then unpacks the histograms as usual.
+ */
+MUD_HIST_CACHE*
+MUD_histCacheOpen( char* filename, FILE* fin, MUD_SEC_GRP* pMUD_fileGrp )
+{
+    MUD_HIST_CACHE* pCache;
+    UINT64 print[4];
+    char* dir;
+    char* cachename;
+
+    if( ( dir = MUD_getHistCacheDir() ) == NULL ) return( NULL );
+    if( !get_print( filename, fin, print ) ) return( NULL );
+    if( ( cachename = cache_name( dir, print ) ) == NULL ) return( NULL );
+
+    pCache = map_cache( cachename, print );
+    if( pCache == NULL && pMUD_fileGrp != NULL && write_cache( cachename, print, pMUD_fileGrp ) )
+	pCache = map_cache( cachename, print );
+
+    free( cachename );
+    return( pCache );
+}
+
+
+/*
+ *  MUD_histCacheData() - the cached bins (4 bytes each, read-only) of
+ *  histogram num, and its header fields in *ppEntry if not NULL; NULL if
+ *  the histogram is not in the cache
+ */
+UINT32*
+MUD_histCacheData( MUD_HIST_CACHE* pCache, int num, MUD_HIST_CACHE_ENTRY** ppEntry )
+{
+    UINT32 i;
+
+    if( pCache == NULL ) return( NULL );
+    for( i = 0; i < pCache->nHists; i++ )
+    {
+	if( pCache->pEntries[i].num == (UINT32)num )
+	{
+	    if( ppEntry != NULL ) *ppEntry = &pCache->pEntries[i];
+	    return( (UINT32*)( (char*)pCache->pBase + pCache->pEntries[i].offset ) );
+	}
+    }
+    return( NULL );
+}
+
+
+void
+MUD_histCacheClose( MUD_HIST_CACHE* pCache )
+{
+    if( pCache == NULL ) return;
+#ifndef _WIN32
+    if( pCache->mapped )
+    {
+	munmap( pCache->pBase, pCache->size );
+	pCache->pBase = NULL;
+    }
+#endif /* !_WIN32 */
+    _free( pCache->pBase );
+    free( pCache );
+}
@@ -0,0 +1,1064 @@
+/*
+ *  mud_import.c -- build MUD files from arrays of headers and counts, and
+ *                  from .npz files
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026  DJA Initial version
+ *          18-Oct-2026  DJA Bound the shapes of arrays by their zip entries
+ *
+ *  Description:
+ *    The reverse of the exporters (mud_export.c), for runs simulated or
+ *    taken by other systems.  A MUD_IMPORT_RUN holds a run as columns:
+ *    its headers as a MUD_EXPORT_RUN, its counts as a matrix of nHists
+ *    rows, and a map of other metadata, written as comments (title the
+ *    name, body the value).  MUD_importBuild() makes the whole tree of
+ *    sections for it in one go, each histogram's data allocated at its
+ *    size, and packs the histograms in parallel; MUD_importRun() writes
+ *    it out (by MUD_writeRunFile) as well.  The format is TRI_TI if
+ *    val[MUD_EXP_FORMAT] says so, else TRI_TD.  A temperature or field
+ *    given only as a number (tempK, fieldG) is written as "n K" or "n G".
+ *
+ *    MUD_importNpz() writes a MUD file for each run of a .npz file laid
+ *    out as MUD_writeNpz() writes it (see mud_npy.c): counts (runs,
+ *    histograms, bins), or (histograms, bins) for one run, with the
+ *    headers by name alongside, any of them missing.  Integers, floats
+ *    and strings (bytes or unicode) of any width and byte order are
+ *    taken; other arrays of one value per run are the metadata.  A run
+ *    has the histograms up to the last with n_bins (if given) not zero.
+ *    The counts are read a block of runs at a time, in order, and the
+ *    runs of a block built and written in parallel.  Deflated entries
+ *    need the library built with zlib (make ZLIB=1).  An array whose
+ *    shape is more than its zip entry holds (or than deflate could hold
+ *    in its compressed size) is not read, nor are counts of more than
+ *    2^32 - 1 bins.
+ */
+
+#include "mud.h"
+
+#ifdef MUD_ZLIB
+#include <zlib.h>
+#endif /* MUD_ZLIB */
+
+#ifdef _WIN32
+#define npz_seek( f, off )	_fseeki64( f, (__int64)( off ), SEEK_SET )
+#define npz_tell( f )		(UINT64)_ftelli64( f )
+#define npz_seek_end( f )	_fseeki64( f, 0, SEEK_END )
+#else
+#define npz_seek( f, off )	fseeko( f, (off_t)( off ), SEEK_SET )
+#define npz_tell( f )		(UINT64)ftello( f )
+#define npz_seek_end( f )	fseeko( f, 0, SEEK_END )
+#endif /* _WIN32 */
+
+#define IMP_BLOCK_BYTES	( 64*1048576 )	/* of counts read at a time */
+#define IMP_MAX_BLOCK	1024		/* runs read at a time */
+#define NPZ_ZBUF	65536
+#define NPZ_MAX_HEADER	65536
+#define NPZ_MAX_DIR	( 64*1048576 )	/* bytes of central directory */
+#define NPZ_MAX_RATIO	1032		/* of deflate, at best */
+
+typedef struct {
+    char	name[32];
+    UINT64	offset;		/* of the local header of its zip entry */
+    UINT64	compSize;
+    UINT64	size;		/* uncompressed */
+    int		method;		/* 0 stored, 8 deflated */
+    char	kind;		/* of its dtype: b, i, u, f, S or U */
+    int		itemSize;
+    int		swap;		/* other than our byte order */
+    int		fortran;
+    int		ndim;
+    UINT64	shape[4];
+    UINT64	nElems;
+} NPZ_ARRAY;
+
+typedef struct {
+    FILE*	fin;
+    UINT64	left;		/* bytes of the entry yet to read */
+    int		method;
+    int		error;
+#ifdef MUD_ZLIB
+    z_stream	zs;
+    Bytef	zbuf[NPZ_ZBUF];
+#endif /* MUD_ZLIB */
+} NPZ_STREAM;
+
+typedef struct {
+    MUD_IMPORT_RUN* pImp;
+    MUD_SEC_GEN_HIST_HDR** ppHdrs;
+    MUD_SEC_GEN_HIST_DAT** ppDats;
+    int		error;
+} PACK_BATCH;
+
+typedef struct {
+    MUD_IMPORT_RUN* pImps;	/* of the block */
+    int		first;		/* run of the block */
+    char*	dir;
+    int		byRunNumber;	/* name the files so, else by index */
+    char*	pWritten;	/* by run of the block */
+} IMP_BATCH;
+
+static UINT32 get_16 _ANSI_ARGS_(( UINT8* b ));
+static UINT32 get_32 _ANSI_ARGS_(( UINT8* b ));
+static UINT64 get_64 _ANSI_ARGS_(( UINT8* b ));
+static char* dup_str _ANSI_ARGS_(( char* s ));
+static void pack_task _ANSI_ARGS_(( int task, int thread, void* pArg ));
+static NPZ_ARRAY* read_dir _ANSI_ARGS_(( FILE* fin, int* pNum ));
+static int stream_open _ANSI_ARGS_(( NPZ_STREAM* pS, FILE* fin, NPZ_ARRAY* pArr ));
+static size_t stream_read _ANSI_ARGS_(( NPZ_STREAM* pS, void* p, size_t n ));
+static void stream_close _ANSI_ARGS_(( NPZ_STREAM* pS ));
+static int parse_header _ANSI_ARGS_(( char* h, NPZ_ARRAY* pArr ));
+static int array_open _ANSI_ARGS_(( NPZ_STREAM* pS, FILE* fin, NPZ_ARRAY* pArr ));
+static UINT8* array_read _ANSI_ARGS_(( FILE* fin, NPZ_ARRAY* pArr ));
+static UINT64 elem_bits _ANSI_ARGS_(( UINT8* p, NPZ_ARRAY* pArr ));
+static REAL64 elem_real _ANSI_ARGS_(( UINT8* p, NPZ_ARRAY* pArr ));
+static UINT32 elem_u32 _ANSI_ARGS_(( UINT8* p, NPZ_ARRAY* pArr ));
+static char* elem_str _ANSI_ARGS_(( UINT8* p, NPZ_ARRAY* pArr ));
+static int find_name _ANSI_ARGS_(( char* name, char* (*nameOf)( int ), int num ));
+static char* run_name _ANSI_ARGS_(( char* dir, MUD_IMPORT_RUN* pImp, int index, int byRunNumber ));
+static void import_task _ANSI_ARGS_(( int task, int thread, void* pArg ));
+
+
+static UINT32
+get_16( UINT8* b )
+{
+    return( (UINT32)b[0] | ( (UINT32)b[1] << 8 ) );
+}
+
+
+static UINT32
+get_32( UINT8* b )
+{
+    return( get_16( b ) | ( get_16( b + 2 ) << 16 ) );
+}
+
+
+static UINT64
+get_64( UINT8* b )
+{
+    return( (UINT64)get_32( b ) | ( (UINT64)get_32( b + 4 ) << 32 ) );
+}
+
+
+static char*
+dup_str( char* s )
+{
+    char* p;
+
+    if( s == NULL ) s = "";
+    if( ( p = (char*)malloc( strlen( s ) + 1 ) ) != NULL ) strcpy( p, s );
+    return( p );
+}
+
+
+/*
+ *  pack_task() - a histogram into its data section, at the bytes per bin
+ *  asked for, or the fewest that hold its counts
+ */
+static void
+pack_task( int task, int thread, void* pArg )
+{
+    PACK_BATCH* pB = (PACK_BATCH*)pArg;
+    MUD_SEC_GEN_HIST_HDR* pHdr = pB->ppHdrs[task];
+    MUD_SEC_GEN_HIST_DAT* pDat = pB->ppDats[task];
+    UINT32* pCounts;
+    UINT32 i, max = 0;
+    int bpb;
+
+    pCounts = pB->pImp->pCounts + (size_t)task*pB->pImp->binStride;
+    bpb = pB->pImp->bytesPerBin;
+    if( bpb != 0 && bpb != 1 && bpb != 2 && bpb != 4 && bpb != MUD_BPB_SPARSE )
+    {
+	for( i = 0; i < pHdr->nBins; i++ )
+	{
+	    if( pCounts[i] > max ) max = pCounts[i];
+	}
+	bpb = ( max < 0x100 ) ? 1 : ( max < 0x10000 ) ? 2 : 4;
+    }
+
+    pHdr->bytesPerBin = bpb;
+    pDat->pData = (caddr_t)zalloc( ( bpb == 0 ) ? 4*(size_t)pHdr->nBins + 32 :
+				   ( bpb == MUD_BPB_SPARSE ) ?
+				   (size_t)MUD_sparseSize( pHdr->nBins, 4, pCounts ) :
+				   (size_t)pHdr->nBins*bpb + 1 );
+    if( pDat->pData == NULL )
+    {
+	pB->error = 1;
+	return;
+    }
+    pDat->nBytes = pHdr->nBytes =
+	MUD_SEC_GEN_HIST_pack( pHdr->nBins, 4, pCounts, bpb, pDat->pData );
+}
+
+
+/*
+ *  MUD_importBuild() - the tree of sections of a run (see above); NULL
+ *  if out of memory.  Free it with MUD_free.
+ */
+void*
+MUD_importBuild( MUD_IMPORT_RUN* pImp, int nThreads )
+{
+    MUD_EXPORT_RUN* pRun = &pImp->run;
+    MUD_SEC_GRP* pMUD_fileGrp;
+    MUD_SEC_GRP* pMUD_grp;
+    MUD_SEC_GEN_RUN_DESC* pDesc;
+    MUD_SEC_TRI_TI_RUN_DESC* pIdesc;
+    MUD_SEC_CMT* pCmt;
+    PACK_BATCH batch;
+    UINT32* v;
+    UINT32 type, i;
+    char qty[64];
+    int ti;
+
+    bzero( &batch, sizeof( batch ) );
+    ti = ( pRun->val[MUD_EXP_FORMAT] == MUD_FMT_TRI_TI_ID );
+    type = ti ? MUD_FMT_TRI_TI_ID : MUD_FMT_TRI_TD_ID;
+    if( ( pMUD_fileGrp = (MUD_SEC_GRP*)MUD_new( MUD_SEC_GRP_ID, type ) ) == NULL )
+	return( NULL );
+
+    /*
+     *  Run description
+     */
+    if( ti )
+    {
+	if( ( pIdesc = (MUD_SEC_TRI_TI_RUN_DESC*)MUD_new( MUD_SEC_TRI_TI_RUN_DESC_ID, 1 ) ) == NULL )
+	    goto fail;
+	MUD_addToGroup( pMUD_fileGrp, pIdesc );
+	pIdesc->exptNumber = pRun->val[MUD_EXP_EXPT];
+	pIdesc->runNumber = pRun->val[MUD_EXP_RUN];
+	pIdesc->timeBegin = pRun->val[MUD_EXP_TIME_BEGIN];
+	pIdesc->timeEnd = pRun->val[MUD_EXP_TIME_END];
+	pIdesc->elapsedSec = pRun->val[MUD_EXP_ELAPSED];
+	pIdesc->title = dup_str( pRun->str[MUD_SHM_TITLE] );
+	pIdesc->lab = dup_str( pRun->str[MUD_SHM_LAB] );
+	pIdesc->area = dup_str( pRun->str[MUD_SHM_AREA] );
+	pIdesc->method = dup_str( pRun->str[MUD_SHM_METHOD] );
+	pIdesc->apparatus = dup_str( pRun->str[MUD_SHM_APPARATUS] );
+	pIdesc->insert = dup_str( pRun->str[MUD_SHM_INSERT] );
+	pIdesc->sample = dup_str( pRun->str[MUD_SHM_SAMPLE] );
+	pIdesc->orient = dup_str( pRun->str[MUD_SHM_ORIENT] );
+	pIdesc->das = dup_str( pRun->str[MUD_SHM_DAS] );
+	pIdesc->experimenter = dup_str( pRun->str[MUD_SHM_EXPERIMENTER] );
+	pIdesc->subtitle = dup_str( pRun->str[MUD_SHM_SUBTITLE] );
+	pIdesc->comment1 = dup_str( pRun->str[MUD_SHM_COMMENT1] );
+	pIdesc->comment2 = dup_str( pRun->str[MUD_SHM_COMMENT2] );
+	pIdesc->comment3 = dup_str( pRun->str[MUD_SHM_COMMENT3] );
+    }
+    else
+    {
+	if( ( pDesc = (MUD_SEC_GEN_RUN_DESC*)MUD_new( MUD_SEC_GEN_RUN_DESC_ID, 1 ) ) == NULL )
+	    goto fail;
+	MUD_addToGroup( pMUD_fileGrp, pDesc );
+	pDesc->exptNumber = pRun->val[MUD_EXP_EXPT];
+	pDesc->runNumber = pRun->val[MUD_EXP_RUN];
+	pDesc->timeBegin = pRun->val[MUD_EXP_TIME_BEGIN];
+	pDesc->timeEnd = pRun->val[MUD_EXP_TIME_END];
+	pDesc->elapsedSec = pRun->val[MUD_EXP_ELAPSED];
+	pDesc->title = dup_str( pRun->str[MUD_SHM_TITLE] );
+	pDesc->lab = dup_str( pRun->str[MUD_SHM_LAB] );
+	pDesc->area = dup_str( pRun->str[MUD_SHM_AREA] );
+	pDesc->method = dup_str( pRun->str[MUD_SHM_METHOD] );
+	pDesc->apparatus = dup_str( pRun->str[MUD_SHM_APPARATUS] );
+	pDesc->insert = dup_str( pRun->str[MUD_SHM_INSERT] );
+	pDesc->sample = dup_str( pRun->str[MUD_SHM_SAMPLE] );
+	pDesc->orient = dup_str( pRun->str[MUD_SHM_ORIENT] );
+	pDesc->das = dup_str( pRun->str[MUD_SHM_DAS] );
+	pDesc->experimenter = dup_str( pRun->str[MUD_SHM_EXPERIMENTER] );
+	qty[0] = '\0';
+	if( pRun->str[MUD_SHM_TEMPERATURE] == NULL && pRun->tempK == pRun->tempK )
+	    sprintf( qty, "%.6g K", pRun->tempK );
+	pDesc->temperature = dup_str( ( qty[0] != '\0' ) ? qty : pRun->str[MUD_SHM_TEMPERATURE] );
+	qty[0] = '\0';
+	if( pRun->str[MUD_SHM_FIELD] == NULL && pRun->fieldG == pRun->fieldG )
+	    sprintf( qty, "%.6g G", pRun->fieldG );
+	pDesc->field = dup_str( ( qty[0] != '\0' ) ? qty : pRun->str[MUD_SHM_FIELD] );
+    }
+
+    /*
+     *  Metadata, as comments
+     */
+    if( pImp->nMeta > 0 )
+    {
+	if( ( pMUD_grp = (MUD_SEC_GRP*)MUD_new( MUD_SEC_GRP_ID, MUD_GRP_CMT_ID ) ) == NULL )
+	    goto fail;
+	MUD_addToGroup( pMUD_fileGrp, pMUD_grp );
+	for( i = 0; i < (UINT32)pImp->nMeta; i++ )
+	{
+	    if( ( pCmt = (MUD_SEC_CMT*)MUD_new( MUD_SEC_CMT_ID, i + 1 ) ) == NULL ) goto fail;
+	    MUD_addToGroup( pMUD_grp, pCmt );
+	    pCmt->ID = i + 1;
+	    pCmt->time = pRun->val[MUD_EXP_TIME_END];
+	    pCmt->author = dup_str( NULL );
+	    pCmt->title = dup_str( pImp->pMetaNames[i] );
+	    pCmt->comment = dup_str( pImp->pMetaValues[i] );
+	}
+    }
+
+    /*
+     *  Histograms: all the sections first, then the packing in parallel
+     */
+    batch.pImp = pImp;
+    batch.ppHdrs = (MUD_SEC_GEN_HIST_HDR**)zalloc( ( pRun->nHists + 1 )*sizeof( void* ) );
+    batch.ppDats = (MUD_SEC_GEN_HIST_DAT**)zalloc( ( pRun->nHists + 1 )*sizeof( void* ) );
+    if( batch.ppHdrs == NULL || batch.ppDats == NULL ||
+	( pMUD_grp = (MUD_SEC_GRP*)MUD_new( MUD_SEC_GRP_ID,
+		     ti ? MUD_GRP_TRI_TI_HIST_ID : MUD_GRP_TRI_TD_HIST_ID ) ) == NULL )
+	goto fail;
+    MUD_addToGroup( pMUD_fileGrp, pMUD_grp );
+    for( i = 0; i < pRun->nHists; i++ )
+    {
+	if( ( batch.ppHdrs[i] = (MUD_SEC_GEN_HIST_HDR*)MUD_new( MUD_SEC_GEN_HIST_HDR_ID, i + 1 ) ) == NULL )
+	    goto fail;
+	MUD_addToGroup( pMUD_grp, batch.ppHdrs[i] );
+	if( ( batch.ppDats[i] = (MUD_SEC_GEN_HIST_DAT*)MUD_new( MUD_SEC_GEN_HIST_DAT_ID, i + 1 ) ) == NULL )
+	    goto fail;
+	MUD_addToGroup( pMUD_grp, batch.ppDats[i] );
+
+	v = &pRun->pHistVals[i*MUD_EXP_NHISTVALS];
+	batch.ppHdrs[i]->histType = v[MUD_EXP_HIST_TYPE];
+	batch.ppHdrs[i]->nBins = _min( v[MUD_EXP_NBINS], pImp->binStride );
+	batch.ppHdrs[i]->fsPerBin = v[MUD_EXP_FS_PER_BIN];
+	batch.ppHdrs[i]->t0_ps = v[MUD_EXP_T0_PS];
+	batch.ppHdrs[i]->t0_bin = v[MUD_EXP_T0_BIN];
+	batch.ppHdrs[i]->goodBin1 = v[MUD_EXP_GOOD_BIN1];
+	batch.ppHdrs[i]->goodBin2 = v[MUD_EXP_GOOD_BIN2];
+	batch.ppHdrs[i]->bkgd1 = v[MUD_EXP_BKGD1];
+	batch.ppHdrs[i]->bkgd2 = v[MUD_EXP_BKGD2];
+	batch.ppHdrs[i]->nEvents = v[MUD_EXP_NEVENTS];
+	batch.ppHdrs[i]->title = dup_str( ( pRun->pHistTitles != NULL ) ? pRun->pHistTitles[i] : NULL );
+    }
+    MUD_parallelFor( (int)pRun->nHists, nThreads, pack_task, &batch );
+    if( batch.error ) goto fail;
+
+    free( batch.ppHdrs );
+    free( batch.ppDats );
+    MUD_setSizes( pMUD_fileGrp );
+    return( pMUD_fileGrp );
+
+fail:
+    _free( batch.ppHdrs );
+    _free( batch.ppDats );
+    MUD_free( pMUD_fileGrp );
+    return( NULL );
+}
+
+
+/*
+ *  MUD_importRun() - build a run (see above) and write it as the MUD file
+ *  outFile; returns 1 on success, 0 on failure.
+ */
+int
+MUD_importRun( MUD_IMPORT_RUN* pImp, char* outFile, int nThreads )
+{
+    MUD_SEC_GRP* pMUD_fileGrp;
+    int status;
+
+    if( ( pMUD_fileGrp = (MUD_SEC_GRP*)MUD_importBuild( pImp, nThreads ) ) == NULL )
+	return( 0 );
+    status = MUD_writeRunFile( pMUD_fileGrp, outFile );
+    MUD_free( pMUD_fileGrp );
+    return( status );
+}
+
+
+/*
+ *  read_dir() - the .npy entries of the central directory of a .npz
+ */
+static NPZ_ARRAY*
+read_dir( FILE* fin, int* pNum )
+{
+    NPZ_ARRAY* pArrs = NULL;
+    UINT8 tail[65557];
+    UINT8* pDir = NULL;
+    UINT8* p;
+    UINT8* x;
+    UINT64 size, eocd, cdOffset, cdSize, nEntries, comp, uncomp, offset;
+    size_t nTail;
+    int i, nlen, xlen, clen, tag, tlen, pos, num = 0;
+
+    if( npz_seek_end( fin ) != 0 ) return( NULL );
+    size = npz_tell( fin );
+    nTail = (size_t)_min( size, sizeof( tail ) );
+    if( nTail < 22 || npz_seek( fin, size - nTail ) != 0 ||
+	fread( tail, 1, nTail, fin ) != nTail ) return( NULL );
+    for( i = (int)nTail - 22; i >= 0; i-- )
+    {
+	if( get_32( tail + i ) == 0x06054B50 ) break;
+    }
+    if( i < 0 ) return( NULL );
+    eocd = size - nTail + i;
+    nEntries = get_16( tail + i + 10 );
+    cdSize = get_32( tail + i + 12 );
+    cdOffset = get_32( tail + i + 16 );
+
+    if( nEntries == 0xFFFF || cdSize == 0xFFFFFFFFU || cdOffset == 0xFFFFFFFFU )
+    {
+	/*
+	 *  Zip64 end of central directory, by way of its locator
+	 */
+	if( eocd < 20 || npz_seek( fin, eocd - 20 ) != 0 ||
+	    fread( tail, 1, 20, fin ) != 20 || get_32( tail ) != 0x07064B50 ||
+	    npz_seek( fin, get_64( tail + 8 ) ) != 0 ||
+	    fread( tail, 1, 56, fin ) != 56 || get_32( tail ) != 0x06064B50 ) return( NULL );
+	nEntries = get_64( tail + 32 );
+	cdSize = get_64( tail + 40 );
+	cdOffset = get_64( tail + 48 );
+    }
+    if( cdSize > NPZ_MAX_DIR || cdOffset + cdSize > size ) return( NULL );
+
+    if( ( pDir = (UINT8*)malloc( (size_t)cdSize + 1 ) ) == NULL ||
+	( pArrs = (NPZ_ARRAY*)zalloc( ( (size_t)cdSize/46 + 1 )*sizeof( NPZ_ARRAY ) ) ) == NULL ||
+	npz_seek( fin, cdOffset ) != 0 || fread( pDir, 1, (size_t)cdSize, fin ) != (size_t)cdSize )
+    {
+	_free( pDir );
+	_free( pArrs );
+	return( NULL );
+    }
+
+    for( p = pDir; p + 46 <= pDir + cdSize && get_32( p ) == 0x02014B50; p += 46 + nlen + xlen + clen )
+    {
+	nlen = (int)get_16( p + 28 );
+	xlen = (int)get_16( p + 30 );
+	clen = (int)get_16( p + 32 );
+	if( p + 46 + nlen + xlen > pDir + cdSize ) break;
+	comp = get_32( p + 20 );
+	uncomp = get_32( p + 24 );
+	offset = get_32( p + 42 );
+
+	for( x = p + 46 + nlen; x + 4 <= p + 46 + nlen + xlen; x += 4 + tlen )
+	{
+	    tag = (int)get_16( x );
+	    tlen = (int)get_16( x + 2 );
+	    if( tag != 0x0001 ) continue;
+	    pos = 4;
+	    if( uncomp == 0xFFFFFFFFU && pos + 8 <= 4 + tlen )
+	    {
+		uncomp = get_64( x + pos );
+		pos += 8;
+	    }
+	    if( comp == 0xFFFFFFFFU && pos + 8 <= 4 + tlen )
+	    {
+		comp = get_64( x + pos );
+		pos += 8;
+	    }
+	    if( offset == 0xFFFFFFFFU && pos + 8 <= 4 + tlen ) offset = get_64( x + pos );
+	}
+
+	if( nlen <= 4 || nlen - 4 >= (int)sizeof( pArrs[num].name ) ||
+	    strncmp( (char*)p + 46 + nlen - 4, ".npy", 4 ) != 0 ) continue;
+	bcopy( p + 46, pArrs[num].name, nlen - 4 );
+	pArrs[num].name[nlen - 4] = '\0';
+	pArrs[num].offset = offset;
+	pArrs[num].compSize = comp;
+	pArrs[num].method = (int)get_16( p + 10 );
+	pArrs[num].size = uncomp;
+
+	/*
+	 *  What an entry holds is bounded by what it takes in the file
+	 */
+	if( comp > size ||
+	    ( pArrs[num].method == 0 && uncomp > comp ) ||
+	    ( pArrs[num].method != 0 && uncomp/NPZ_MAX_RATIO > comp ) ) continue;
+	num++;
+    }
+
+    free( pDir );
+    *pNum = num;
+    return( pArrs );
+}
+
+
+/*
+ *  stream_open() .. stream_close() - read the bytes of a zip entry, in
+ *  order
+ */
+static int
+stream_open( NPZ_STREAM* pS, FILE* fin, NPZ_ARRAY* pArr )
+{
+    UINT8 local[30];
+
+    bzero( pS, sizeof( NPZ_STREAM ) );
+    pS->fin = fin;
+    pS->method = pArr->method;
+    pS->left = pArr->compSize;
+    if( npz_seek( fin, pArr->offset ) != 0 || fread( local, 1, 30, fin ) != 30 ||
+	get_32( local ) != 0x04034B50 ||
+	npz_seek( fin, pArr->offset + 30 + get_16( local + 26 ) + get_16( local + 28 ) ) != 0 )
+	return( 0 );
+
+    if( pS->method == 0 ) return( 1 );
+#ifdef MUD_ZLIB
+    if( pS->method == 8 && inflateInit2( &pS->zs, -MAX_WBITS ) == Z_OK )
+	return( 1 );
+#endif /* MUD_ZLIB */
+    pS->method = -1;
+    return( 0 );
+}
+
+
+static size_t
+stream_read( NPZ_STREAM* pS, void* p, size_t n )
+{
+    size_t got;
+#ifdef MUD_ZLIB
+    size_t chunk, done = 0;
+    int status;
+#endif /* MUD_ZLIB */
+
+    if( pS->error ) return( 0 );
+    if( pS->method == 0 )
+    {
+	got = fread( p, 1, (size_t)_min( n, pS->left ), pS->fin );
+	pS->left -= got;
+	if( got < n ) pS->error = 1;
+	return( got );
+    }
+
+#ifdef MUD_ZLIB
+    while( done < n && !pS->error )
+    {
+	chunk = _min( n - done, 1073741824 );
+	pS->zs.next_out = (Bytef*)p + done;
+	pS->zs.avail_out = (uInt)chunk;
+	while( pS->zs.avail_out > 0 )
+	{
+	    if( pS->zs.avail_in == 0 && pS->left > 0 )
+	    {
+		got = fread( pS->zbuf, 1, (size_t)_min( NPZ_ZBUF, pS->left ), pS->fin );
+		if( got == 0 ) break;
+		pS->left -= got;
+		pS->zs.next_in = pS->zbuf;
+		pS->zs.avail_in = (uInt)got;
+	    }
+	    status = inflate( &pS->zs, Z_NO_FLUSH );
+	    if( status != Z_OK ) break;
+	}
+	done += chunk - pS->zs.avail_out;
+	if( pS->zs.avail_out > 0 ) pS->error = 1;
+    }
+    return( done );
+#else
+    pS->error = 1;
+    return( 0 );
+#endif /* MUD_ZLIB */
+}
+
+
+static void
+stream_close( NPZ_STREAM* pS )
+{
+#ifdef MUD_ZLIB
+    if( pS->method == 8 ) inflateEnd( &pS->zs );
+#endif /* MUD_ZLIB */
+    pS->method = -1;
+}
+
+
+/*
+ *  parse_header() - the dtype and shape of a .npy header dictionary
+ */
+static int
+parse_header( char* h, NPZ_ARRAY* pArr )
+{
+    char* p;
+    char* end;
+    double d;
+    int order;
+
+    if( ( p = strstr( h, "'descr'" ) ) == NULL || ( p = strchr( p + 7, ':' ) ) == NULL )
+	return( 0 );
+    for( p++; *p == ' '; p++ ) ;
+    if( *p != '\'' && *p != '"' ) return( 0 );
+    order = p[1];
+    pArr->kind = p[2];
+    pArr->itemSize = (int)strtol( p + 3, &end, 10 );
+    if( *end != *p || strchr( "<>|=", order ) == NULL ||
+	strchr( "biufSU", pArr->kind ) == NULL || pArr->itemSize <= 0 ) return( 0 );
+    if( pArr->kind == 'U' ) pArr->itemSize *= 4;
+    if( ( pArr->kind == 'f' && pArr->itemSize != 4 && pArr->itemSize != 8 ) ||
+	( strchr( "biu", pArr->kind ) != NULL && pArr->itemSize > 8 ) ) return( 0 );
+#ifdef MUD_BIG_ENDIAN
+    pArr->swap = ( order == '<' );
+#else
+    pArr->swap = ( order == '>' );
+#endif /* MUD_BIG_ENDIAN */
+
+    if( ( p = strstr( h, "'fortran_order'" ) ) == NULL ) return( 0 );
+    pArr->fortran = ( strstr( p, "True" ) != NULL && strstr( p, "True" ) < strchr( p, ',' ) );
+
+    if( ( p = strstr( h, "'shape'" ) ) == NULL || ( p = strchr( p, '(' ) ) == NULL )
+	return( 0 );
+    pArr->ndim = 0;
+    pArr->nElems = 1;
+    for( p++; ; )
+    {
+	while( *p == ' ' || *p == ',' ) p++;
+	if( *p == ')' ) break;
+	if( *p < '0' || *p > '9' || pArr->ndim == 4 ) return( 0 );
+	d = strtod( p, &end );
+	if( d >= 18446744073709551616.0 ) return( 0 );
+	pArr->shape[pArr->ndim] = (UINT64)d;
+	if( pArr->shape[pArr->ndim] != 0 &&
+	    pArr->nElems > pArr->size/pArr->shape[pArr->ndim] ) return( 0 );
+	pArr->nElems *= pArr->shape[pArr->ndim++];
+	p = end;
+	if( *p == 'L' ) p++;
+    }
+
+    /*
+     *  The data must fit in the entry (after this header)
+     */
+    return( pArr->nElems <= pArr->size/pArr->itemSize );
+}
+
+
+/*
+ *  array_open() - start reading an array: its .npy header
+ */
+static int
+array_open( NPZ_STREAM* pS, FILE* fin, NPZ_ARRAY* pArr )
+{
+    UINT8 b[12];
+    char* h;
+    size_t hlen;
+    int pre, status;
+
+    if( !stream_open( pS, fin, pArr ) ) return( 0 );
+    if( stream_read( pS, b, 10 ) != 10 || memcmp( b, "\223NUMPY", 6 ) != 0 ) return( 0 );
+    pre = ( b[6] == 1 ) ? 10 : 12;
+    if( pre == 12 && stream_read( pS, b + 10, 2 ) != 2 ) return( 0 );
+    hlen = ( pre == 10 ) ? get_16( b + 8 ) : get_32( b + 8 );
+    if( hlen > NPZ_MAX_HEADER || ( h = (char*)malloc( hlen + 1 ) ) == NULL ) return( 0 );
+    status = ( stream_read( pS, h, hlen ) == hlen );
+    h[hlen] = '\0';
+    status = status && parse_header( h, pArr );
+    free( h );
+    return( status );
+}
+
+
+/*
+ *  array_read() - the whole data of an array
+ */
+static UINT8*
+array_read( FILE* fin, NPZ_ARRAY* pArr )
+{
+    NPZ_STREAM* pS;
+    UINT8* pData = NULL;
+    size_t size;
+
+    size = (size_t)pArr->nElems*pArr->itemSize;
+    if( ( pS = (NPZ_STREAM*)malloc( sizeof( NPZ_STREAM ) ) ) == NULL ) return( NULL );
+    if( array_open( pS, fin, pArr ) && ( pData = (UINT8*)malloc( size + 1 ) ) != NULL &&
+	stream_read( pS, pData, size ) != size )
+    {
+	free( pData );
+	pData = NULL;
+    }
+    stream_close( pS );
+    free( pS );
+    return( pData );
+}
+
+
+/*
+ *  elem_bits() .. elem_str() - an element of an array, as an integer's
+ *  bits, a number, a count (rounded, and clamped to UINT32) or a string
+ */
+static UINT64
+elem_bits( UINT8* p, NPZ_ARRAY* pArr )
+{
+    UINT64 u = 0;
+    int i, n = pArr->itemSize;
+
+    for( i = 0; i < n; i++ )
+    {
+#ifdef MUD_BIG_ENDIAN
+	u |= (UINT64)p[pArr->swap ? i : n - 1 - i] << ( 8*i );
+#else
+	u |= (UINT64)p[pArr->swap ? n - 1 - i : i] << ( 8*i );
+#endif /* MUD_BIG_ENDIAN */
+    }
+    return( u );
+}
+
+
+static REAL64
+elem_real( UINT8* p, NPZ_ARRAY* pArr )
+{
+    union { UINT32 u; float f; } f4;
+    union { UINT64 u; REAL64 d; } f8;
+    UINT64 u = elem_bits( p, pArr );
+    int shift;
+
+    switch( pArr->kind )
+    {
+	case 'f':
+	    if( pArr->itemSize == 4 )
+	    {
+		f4.u = (UINT32)u;
+		return( (REAL64)f4.f );
+	    }
+	    f8.u = u;
+	    return( f8.d );
+	case 'i':
+	    shift = 64 - 8*pArr->itemSize;
+	    return( (REAL64)( (INT64)( u << shift ) >> shift ) );
+	default:
+	    return( (REAL64)u );
+    }
+}
+
+
+static UINT32
+elem_u32( UINT8* p, NPZ_ARRAY* pArr )
+{
+    UINT64 u;
+    REAL64 d;
+
+    if( pArr->kind == 'u' || pArr->kind == 'b' )
+    {
+	u = elem_bits( p, pArr );
+	return( ( u > 0xFFFFFFFFU ) ? 0xFFFFFFFFU : (UINT32)u );
+    }
+    d = elem_real( p, pArr );
+    if( !( d > 0 ) ) return( 0 );
+    return( ( d >= 4294967295.0 ) ? 0xFFFFFFFFU : (UINT32)( d + 0.5 ) );
+}
+
+
+static char*
+elem_str( UINT8* p, NPZ_ARRAY* pArr )
+{
+    char* s;
+    UINT32 c;
+    int i, n, little;
+
+    if( pArr->kind != 'S' && pArr->kind != 'U' )
+    {
+	if( ( s = (char*)malloc( 32 ) ) == NULL ) return( NULL );
+	if( pArr->kind == 'f' )
+	    sprintf( s, "%.10g", elem_real( p, pArr ) );
+	else if( pArr->kind == 'i' )
+	    sprintf( s, "%.0f", elem_real( p, pArr ) );
+	else
+	    sprintf( s, "%llu", (unsigned long long)elem_bits( p, pArr ) );
+	return( s );
+    }
+
+#ifdef MUD_BIG_ENDIAN
+    little = pArr->swap;
+#else
+    little = !pArr->swap;
+#endif /* MUD_BIG_ENDIAN */
+    n = ( pArr->kind == 'U' ) ? pArr->itemSize/4 : pArr->itemSize;
+    if( ( s = (char*)malloc( n + 1 ) ) == NULL ) return( NULL );
+    for( i = 0; i < n; i++ )
+    {
+	if( pArr->kind == 'U' )
+	{
+	    c = little ? get_32( p + 4*i ) :
+		( (UINT32)p[4*i] << 24 ) | ( (UINT32)p[4*i+1] << 16 ) | ( (UINT32)p[4*i+2] << 8 ) | p[4*i+3];
+	    s[i] = ( c < 256 ) ? (char)c : '?';
+	}
+	else
+	{
+	    s[i] = (char)p[i];
+	}
+	if( s[i] == '\0' ) break;
+    }
+    s[i] = '\0';
+    if( s[0] == '\0' )
+    {
+	free( s );
+	return( NULL );
+    }
+    return( s );
+}
+
+
+static int
+find_name( char* name, char* (*nameOf)( int ), int num )
+{
+    int i;
+
+    for( i = 0; i < num; i++ )
+    {
+	if( strcmp( name, (*nameOf)( i ) ) == 0 ) return( i );
+    }
+    return( -1 );
+}
+
+
+/*
+ *  run_name() - dir/ the name of the path the run came from, else its
+ *  run number (or index), with ".msr" for its extension
+ */
+static char*
+run_name( char* dir, MUD_IMPORT_RUN* pImp, int index, int byRunNumber )
+{
+    char* path = pImp->run.str[MUD_SHM_PATH];
+    char* base;
+    char* name;
+    char* ext;
+
+    if( ( name = (char*)malloc( strlen( dir ) + ( path != NULL ? strlen( path ) : 0 ) + 24 ) ) == NULL )
+	return( NULL );
+    if( path == NULL )
+    {
+	sprintf( name, "%s/%06lu.msr", dir,
+		 (unsigned long)( byRunNumber ? pImp->run.val[MUD_EXP_RUN] : (UINT32)index + 1 ) );
+	return( name );
+    }
+    for( base = path + strlen( path ); base > path; base-- )
+    {
+	if( base[-1] == '/' || base[-1] == '\\' ) break;
+    }
+    sprintf( name, "%s/%s", dir, base );
+    base = name + strlen( dir ) + 1;
+    if( ( ext = strrchr( base, '.' ) ) != NULL && ext > base ) *ext = '\0';
+    strcat( name, ".msr" );
+    return( name );
+}
+
+
+static void
+import_task( int task, int thread, void* pArg )
+{
+    IMP_BATCH* pB = (IMP_BATCH*)pArg;
+    char* name;
+
+    if( ( name = run_name( pB->dir, &pB->pImps[task], pB->first + task, pB->byRunNumber ) ) == NULL )
+	return;
+    pB->pWritten[task] = (char)MUD_importRun( &pB->pImps[task], name, 1 );
+    free( name );
+}
+
+
+/*
+ *  MUD_importNpz() - write the runs of a .npz file (see above) as MUD
+ *  files into dir; bytesPerBin as for MUD_IMPORT_RUN.  Returns the number
+ *  of runs written, or -1 if the file cannot be read.
+ */
+int
+MUD_importNpz( char* filename, char* dir, int bytesPerBin, int nThreads )
+{
+    FILE* fin;
+    NPZ_ARRAY* pArrs;
+    NPZ_ARRAY* pArr;
+    NPZ_ARRAY* pCountsArr = NULL;
+    NPZ_STREAM* pS = NULL;
+    MUD_IMPORT_RUN* pImps = NULL;
+    MUD_EXPORT_RUN* pRun;
+    IMP_BATCH batch;
+    UINT8* pData;
+    UINT8* pRaw = NULL;
+    UINT32* pCounts = NULL;
+    UINT32* pHistVals = NULL;
+    UINT32* v;
+    char** pHistTitles = NULL;
+    char** pMetaNames = NULL;
+    char** pMetaValues = NULL;
+    union { UINT64 u; REAL64 d; } nan;
+    UINT64 nRuns = 0, nHists = 0, nBins;
+    size_t runCells, j;
+    int nArrs = 0, nMeta = 0, block, i, k, n, r, h, hist, byRun = 0, nWritten = -1;
+
+    if( ( fin = fopen( filename, "rb" ) ) == NULL ) return( -1 );
+    bzero( &batch, sizeof( batch ) );
+    if( ( pArrs = read_dir( fin, &nArrs ) ) == NULL ||
+	( pS = (NPZ_STREAM*)malloc( sizeof( NPZ_STREAM ) ) ) == NULL ) goto done;
+
+    /*
+     *  The dtypes and shapes, and so the runs
+     */
+    for( i = 0; i < nArrs; i++ )
+    {
+	pArr = &pArrs[i];
+	if( !array_open( pS, fin, pArr ) ) pArr->kind = '\0';
+	stream_close( pS );
+	if( pArr->kind != '\0' && strcmp( pArr->name, "counts" ) == 0 ) pCountsArr = pArr;
+    }
+    if( pCountsArr == NULL || strchr( "SU", pCountsArr->kind ) != NULL ||
+	pCountsArr->ndim < 1 || pCountsArr->ndim > 3 ||
+	( pCountsArr->fortran && pCountsArr->ndim > 1 ) ) goto done;
+    nRuns = ( pCountsArr->ndim == 3 ) ? pCountsArr->shape[0] : 1;
+    nHists = ( pCountsArr->ndim >= 2 ) ? pCountsArr->shape[pCountsArr->ndim - 2] : 1;
+    nBins = pCountsArr->shape[pCountsArr->ndim - 1];
+    if( nRuns > 0x7FFFFFFF || nHists > 0xFFFFFF || nBins > 0xFFFFFFFF ||
+	nHists*nBins > (UINT64)( (size_t)-1 )/( 8*IMP_MAX_BLOCK ) ) goto done;
+    runCells = (size_t)( nHists*nBins );
+
+    nan.u = 0x7FF8000000000000ULL;
+    if( ( pImps = (MUD_IMPORT_RUN*)zalloc( ( nRuns + 1 )*sizeof( MUD_IMPORT_RUN ) ) ) == NULL ||
+	( pHistVals = (UINT32*)zalloc( ( nRuns*nHists + 1 )*MUD_EXP_NHISTVALS*sizeof( UINT32 ) ) ) == NULL ||
+	( pHistTitles = (char**)zalloc( ( nRuns*nHists + 1 )*sizeof( char* ) ) ) == NULL ||
+	( pMetaNames = (char**)zalloc( ( nArrs + 1 )*sizeof( char* ) ) ) == NULL ||
+	( pMetaValues = (char**)zalloc( ( nRuns*nArrs + 1 )*sizeof( char* ) ) ) == NULL ) goto done;
+    for( r = 0; r < (int)nRuns; r++ )
+    {
+	pRun = &pImps[r].run;
+	pRun->tempK = pRun->fieldG = nan.d;
+	pRun->nHists = (UINT32)nHists;
+	pRun->pHistVals = pHistVals + (size_t)r*nHists*MUD_EXP_NHISTVALS;
+	pRun->pHistTitles = pHistTitles + (size_t)r*nHists;
+	for( h = 0; h < (int)nHists; h++ )
+	    pRun->pHistVals[h*MUD_EXP_NHISTVALS + MUD_EXP_NBINS] = (UINT32)nBins;
+	pImps[r].binStride = (UINT32)nBins;
+	pImps[r].bytesPerBin = bytesPerBin;
+	pImps[r].pMetaNames = pMetaNames;
+	pImps[r].pMetaValues = pMetaValues + (size_t)r*nArrs;
+    }
+
+    /*
+     *  The headers, and the metadata, whole
+     */
+    for( i = 0; i < nArrs; i++ )
+    {
+	pArr = &pArrs[i];
+	if( pArr == pCountsArr || pArr->kind == '\0' || pArr->fortran ) continue;
+	k = find_name( pArr->name, MUD_exportHistValName, MUD_EXP_NHISTVALS );
+	hist = ( k >= 0 || strcmp( pArr->name, "hist_title" ) == 0 );
+	if( pArr->nElems != ( hist ? nRuns*nHists : nRuns ) ) continue;
+	if( ( pData = array_read( fin, pArr ) ) == NULL ) goto done;
+
+	if( k >= 0 )
+	{
+	    for( j = 0; j < nRuns*nHists; j++ )
+		pHistVals[j*MUD_EXP_NHISTVALS + k] = elem_u32( pData + j*pArr->itemSize, pArr );
+	}
+	else if( hist )
+	{
+	    for( j = 0; j < nRuns*nHists; j++ )
+		pHistTitles[j] = elem_str( pData + j*pArr->itemSize, pArr );
+	}
+	else if( ( k = find_name( pArr->name, MUD_exportValName, MUD_EXP_NVALS ) ) >= 0 )
+	{
+	    for( r = 0; r < (int)nRuns; r++ )
+		pImps[r].run.val[k] = elem_u32( pData + (size_t)r*pArr->itemSize, pArr );
+	    if( k == MUD_EXP_RUN ) byRun = 1;
+	}
+	else if( ( k = find_name( pArr->name, MUD_exportStrName, MUD_SHM_NSTR ) ) >= 0 )
+	{
+	    for( r = 0; r < (int)nRuns; r++ )
+		pImps[r].run.str[k] = elem_str( pData + (size_t)r*pArr->itemSize, pArr );
+	}
+	else if( strcmp( pArr->name, "temperature_k" ) == 0 )
+	{
+	    for( r = 0; r < (int)nRuns; r++ )
+		pImps[r].run.tempK = elem_real( pData + (size_t)r*pArr->itemSize, pArr );
+	}
+	else if( strcmp( pArr->name, "field_g" ) == 0 )
+	{
+	    for( r = 0; r < (int)nRuns; r++ )
+		pImps[r].run.fieldG = elem_real( pData + (size_t)r*pArr->itemSize, pArr );
+	}
+	else
+	{
+	    pMetaNames[nMeta] = pArr->name;
+	    for( r = 0; r < (int)nRuns; r++ )
+		pMetaValues[(size_t)r*nArrs + nMeta] = elem_str( pData + (size_t)r*pArr->itemSize, pArr );
+	    nMeta++;
+	}
+	free( pData );
+    }
+
+    /*
+     *  The histograms of each run, up to the last with bins
+     */
+    for( r = 0; r < (int)nRuns; r++ )
+    {
+	pRun = &pImps[r].run;
+	pImps[r].nMeta = nMeta;
+	for( h = (int)nHists; h > 0; h-- )
+	{
+	    if( pRun->pHistVals[( h - 1 )*MUD_EXP_NHISTVALS + MUD_EXP_NBINS] != 0 ) break;
+	}
+	pRun->nHists = h;
+	for( h = 0; h < (int)pRun->nHists; h++ )
+	{
+	    v = &pRun->pHistVals[h*MUD_EXP_NHISTVALS];
+	    v[MUD_EXP_NBINS] = _min( v[MUD_EXP_NBINS], (UINT32)nBins );
+	    pRun->maxBins = _max( pRun->maxBins, v[MUD_EXP_NBINS] );
+	}
+    }
+
+    /*
+     *  The counts, a block of runs at a time, each block then built and
+     *  written in parallel
+     */
+    block = (int)_min( _max( IMP_BLOCK_BYTES/( runCells*sizeof( UINT32 ) + 1 ), 1 ), IMP_MAX_BLOCK );
+    if( ( pCounts = (UINT32*)malloc( block*runCells*sizeof( UINT32 ) + 1 ) ) == NULL ||
+	( pRaw = (UINT8*)malloc( block*runCells*pCountsArr->itemSize + 1 ) ) == NULL ||
+	( batch.pWritten = (char*)malloc( block ) ) == NULL ||
+	!array_open( pS, fin, pCountsArr ) ) goto done;
+    batch.dir = dir;
+    batch.byRunNumber = byRun;
+    nWritten = 0;
+    for( r = 0; r < (int)nRuns; r += block )
+    {
+	n = (int)_min( (UINT64)block, nRuns - r );
+	if( stream_read( pS, pRaw, n*runCells*pCountsArr->itemSize ) !=
+	    n*runCells*pCountsArr->itemSize ) break;
+	for( j = 0; j < n*runCells; j++ )
+	    pCounts[j] = elem_u32( pRaw + j*pCountsArr->itemSize, pCountsArr );
+	for( i = 0; i < n; i++ )
+	    pImps[r + i].pCounts = pCounts + (size_t)i*runCells;
+
+	bzero( batch.pWritten, block );
+	batch.pImps = &pImps[r];
+	batch.first = r;
+	MUD_parallelFor( n, nThreads, import_task, &batch );
+	for( i = 0; i < n; i++ ) nWritten += batch.pWritten[i];
+    }
+    stream_close( pS );
+
+done:
+    if( pImps != NULL )
+    {
+	for( r = 0; r < (int)nRuns; r++ )
+	{
+	    for( k = 0; k < MUD_SHM_NSTR; k++ )
+	    {
+		_free( pImps[r].run.str[k] );
+	    }
+	}
+	free( pImps );
+    }
+    if( pHistTitles != NULL )
+    {
+	for( j = 0; j < nRuns*nHists; j++ )
+	{
+	    _free( pHistTitles[j] );
+	}
+	free( pHistTitles );
+    }
+    if( pMetaValues != NULL )
+    {
+	for( j = 0; j < nRuns*nArrs; j++ )
+	{
+	    _free( pMetaValues[j] );
+	}
+	free( pMetaValues );
+    }
+    _free( pMetaNames );
+    _free( pHistVals );
+    _free( pCounts );
+    _free( pRaw );
+    _free( batch.pWritten );
+    _free( pS );
+    _free( pArrs );
+    fclose( fin );
+    return( nWritten );
+}
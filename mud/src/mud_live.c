@@ -0,0 +1,530 @@
+/*
+ *  mud_live.c -- write a run while it is acquiring, updating its counts,
+ *                scalers and times in place
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version
+ *          18-Oct-2026      Back off between reads; report a file left
+ *                           mid-checkpoint
+ *
+ *  Description:
+ *    MUD_liveOpen() lays out a run for live writing and writes it, as an
+ *    ordinary MUD file, with a MUD_SEC_GEN_LIVE section for the first
+ *    member of the file group.  Every histogram is stored at 4 bytes per
+ *    bin, so its counts always take the same room.  MUD_liveCheckpoint()
+ *    then overwrites, in place, only the counts (and nEvents) of the
+ *    histograms, the counts of the scalers, and timeEnd and elapsedSec of
+ *    the run description; nothing else in the file moves.
+ *
+ *    The generation of the live section is a sequence lock: a checkpoint
+ *    makes it odd, and flushes, before writing anything else, and even
+ *    again, once the rest is flushed.  MUD_liveReadFile() reads the
+ *    generation, then the run, then the generation again, and takes the
+ *    run only if the two are equal and even; otherwise it waits, a
+ *    little longer each time (from LIVE_WAIT_MIN to LIVE_WAIT_MAX
+ *    microseconds), and reads it again.  If the generation is still odd
+ *    after LIVE_TRIES reads (about a second), the writer has most likely
+ *    died (or stalled) within a checkpoint: MUD_liveReadFile() returns
+ *    NULL with that odd generation, where other failures give 0.
+ *    The generation is at a fixed place, just after the header of the
+ *    file group, so it is found without decoding the run.
+ *
+ *    The sections are those of the tree given, so a live file is read
+ *    like any other (older versions of the library pass over the live
+ *    section).  A checkpoint is flushed to the system but not synced to
+ *    the disk.
+ */
+
+#include "mud.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif /* _WIN32 */
+
+#define LIVE_TRIES	100		/* reads of a run being checkpointed */
+#define LIVE_WAIT_MIN	50		/* microseconds between them */
+#define LIVE_WAIT_MAX	10000
+
+typedef struct {
+    int		n;
+    int		max;
+    MUD_SEC**	ppSecs;		/* in the order of the file */
+    MUD_SEC**	ppParents;
+    long*	pOffsets;
+} LIVE_WALK;
+
+static long walk_secs _ANSI_ARGS_(( LIVE_WALK* pW, MUD_SEC* pMUD, MUD_SEC* pParent, long offset ));
+static void free_walk _ANSI_ARGS_(( LIVE_WALK* pW ));
+static int find_hdr _ANSI_ARGS_(( LIVE_WALK* pW, int dat ));
+static void to_front _ANSI_ARGS_(( MUD_SEC_GRP* pMUD_grp, MUD_SEC* pMUD ));
+static int repack _ANSI_ARGS_(( MUD_SEC_GEN_HIST_HDR* pHdr, MUD_SEC_GEN_HIST_DAT* pDat ));
+static int put_4 _ANSI_ARGS_(( FILE* fio, long offset, UINT32 val ));
+static int put_generation _ANSI_ARGS_(( MUD_LIVE* pLive, UINT32 generation ));
+static long get_generation _ANSI_ARGS_(( FILE* fin, UINT32* pGeneration ));
+static void live_wait _ANSI_ARGS_(( int n ));
+static void free_live _ANSI_ARGS_(( MUD_LIVE* pLive ));
+
+
+/*
+ *  walk_secs() - list the sections from pMUD on, and their members, with
+ *  their offsets in the file; returns the offset past them, or -1 if out
+ *  of memory.
+ */
+static long
+walk_secs( LIVE_WALK* pW, MUD_SEC* pMUD, MUD_SEC* pParent, long offset )
+{
+    void* p;
+    int max;
+
+    for( ; pMUD != NULL; pMUD = pMUD->core.pNext )
+    {
+	if( pW->n == pW->max )
+	{
+	    max = 2*pW->max + 64;
+	    if( ( p = realloc( pW->ppSecs, max*sizeof( MUD_SEC* ) ) ) == NULL ) return( -1 );
+	    pW->ppSecs = (MUD_SEC**)p;
+	    if( ( p = realloc( pW->ppParents, max*sizeof( MUD_SEC* ) ) ) == NULL ) return( -1 );
+	    pW->ppParents = (MUD_SEC**)p;
+	    if( ( p = realloc( pW->pOffsets, max*sizeof( long ) ) ) == NULL ) return( -1 );
+	    pW->pOffsets = (long*)p;
+	    pW->max = max;
+	}
+	pW->ppSecs[pW->n] = pMUD;
+	pW->ppParents[pW->n] = pParent;
+	pW->pOffsets[pW->n] = offset;
+	pW->n++;
+
+	offset += MUD_getSize( pMUD );
+	if( MUD_secID( pMUD ) == MUD_SEC_GRP_ID )
+	{
+	    offset = walk_secs( pW, ((MUD_SEC_GRP*)pMUD)->pMem, pMUD, offset );
+	    if( offset < 0 ) return( -1 );
+	}
+    }
+    return( offset );
+}
+
+
+static void
+free_walk( LIVE_WALK* pW )
+{
+    _free( pW->ppSecs );
+    _free( pW->ppParents );
+    _free( pW->pOffsets );
+    bzero( pW, sizeof( LIVE_WALK ) );
+}
+
+
+/*
+ *  find_hdr() - the header, in the same group, of the histogram data
+ *  section dat of the walk; -1 if none
+ */
+static int
+find_hdr( LIVE_WALK* pW, int dat )
+{
+    int i;
+
+    for( i = 0; i < pW->n; i++ )
+    {
+	if( MUD_secID( pW->ppSecs[i] ) == MUD_SEC_GEN_HIST_HDR_ID &&
+	    MUD_instanceID( pW->ppSecs[i] ) == MUD_instanceID( pW->ppSecs[dat] ) &&
+	    pW->ppParents[i] == pW->ppParents[dat] )
+	    return( i );
+    }
+    return( -1 );
+}
+
+
+/*
+ *  to_front() - make pMUD, a member of the group, its first member, and
+ *  the first of its index
+ */
+static void
+to_front( MUD_SEC_GRP* pMUD_grp, MUD_SEC* pMUD )
+{
+    MUD_SEC** ppMUD;
+    MUD_INDEX** ppIndex;
+    MUD_INDEX* pIndex;
+
+    for( ppMUD = &pMUD_grp->pMem; *ppMUD != pMUD; ppMUD = &(*ppMUD)->core.pNext ) ;
+    *ppMUD = pMUD->core.pNext;
+    pMUD->core.pNext = pMUD_grp->pMem;
+    pMUD_grp->pMem = pMUD;
+
+    for( ppIndex = &pMUD_grp->pMemIndex; *ppIndex != NULL; ppIndex = &(*ppIndex)->pNext )
+    {
+	if( (*ppIndex)->secID == MUD_secID( pMUD ) &&
+	    (*ppIndex)->instanceID == MUD_instanceID( pMUD ) )
+	{
+	    pIndex = *ppIndex;
+	    *ppIndex = pIndex->pNext;
+	    pIndex->pNext = pMUD_grp->pMemIndex;
+	    pMUD_grp->pMemIndex = pIndex;
+	    break;
+	}
+    }
+}
+
+
+/*
+ *  repack() - store a histogram at 4 bytes per bin
+ */
+static int
+repack( MUD_SEC_GEN_HIST_HDR* pHdr, MUD_SEC_GEN_HIST_DAT* pDat )
+{
+    UINT32* pCounts;
+    caddr_t pData;
+    UINT32 nBytes = 4*pHdr->nBins;
+
+    if( pHdr->bytesPerBin == 4 && pHdr->nBytes == nBytes && pDat->nBytes == nBytes &&
+	pDat->pData != NULL )
+	return( 1 );
+
+    pCounts = (UINT32*)zalloc( (size_t)nBytes + 1 );
+    pData = (caddr_t)zalloc( (size_t)nBytes + 1 );
+    if( pCounts == NULL || pData == NULL )
+    {
+	_free( pCounts );
+	_free( pData );
+	return( 0 );
+    }
+    if( pDat->pData != NULL && pDat->nBytes > 0 )
+	MUD_SEC_GEN_HIST_unpackData( pHdr->nBins, pHdr->bytesPerBin, pDat->pData, pDat->nBytes, 4, pCounts );
+    MUD_SEC_GEN_HIST_pack( pHdr->nBins, 4, pCounts, 4, pData );
+    free( pCounts );
+
+    _free( pDat->pData );
+    pDat->pData = pData;
+    pHdr->bytesPerBin = 4;
+    pHdr->nBytes = pDat->nBytes = nBytes;
+    return( 1 );
+}
+
+
+static int
+put_4( FILE* fio, long offset, UINT32 val )
+{
+    UINT32 buf;
+
+    bencode_4( &buf, &val );
+    return( fseek( fio, offset, SEEK_SET ) == 0 && fwrite( &buf, 4, 1, fio ) == 1 );
+}
+
+
+static int
+put_generation( MUD_LIVE* pLive, UINT32 generation )
+{
+    pLive->generation = generation;
+    return( put_4( pLive->fio, pLive->genOffset, generation ) &&
+	    fflush( pLive->fio ) == 0 );
+}
+
+
+/*
+ *  get_generation() - the generation of a live file; returns its offset,
+ *  or 0 if the file is not live
+ */
+static long
+get_generation( FILE* fin, UINT32* pGeneration )
+{
+    UINT32 size;
+    UINT32 buf[4];
+
+    if( fseek( fin, 0, SEEK_SET ) != 0 || fread( &size, 4, 1, fin ) != 1 ) return( 0 );
+    bdecode_4( &size, &size );
+    if( fseek( fin, (long)size, SEEK_SET ) != 0 || fread( buf, 4, 4, fin ) != 4 ) return( 0 );
+    bdecode_4( &buf[1], &buf[1] );
+    if( buf[1] != MUD_SEC_GEN_LIVE_ID ) return( 0 );
+    bdecode_4( &buf[3], pGeneration );
+    return( (long)size + 12 );
+}
+
+
+static void
+free_live( MUD_LIVE* pLive )
+{
+    if( pLive->fio != NULL ) fclose( pLive->fio );
+    _free( pLive->pNBins );
+    _free( pLive->pDatOffsets );
+    _free( pLive->pHdrOffsets );
+    _free( pLive->pScalerOffsets );
+    _free( pLive->pBuf );
+    free( pLive );
+}
+
+
+/*
+ *  MUD_liveOpen() - lay out the run pMUD_fileGrp for live writing (see
+ *  above) and write it as the MUD file filename, by way of a temporary
+ *  file; returns the live file to checkpoint, or NULL on failure.
+ *
+ *  The histograms are taken in the order of the file, each data section
+ *  with the header of the same instance in its group; the scalers, too.
+ *  The tree is changed (its histograms repacked, a live section added
+ *  if it has none) but is still the caller's, to free.
+ */
+MUD_LIVE*
+MUD_liveOpen( char* filename, void* pMUD_fileGrp )
+{
+    MUD_SEC_GRP* pMUD_grp = (MUD_SEC_GRP*)pMUD_fileGrp;
+    MUD_SEC* pMUD_live;
+    MUD_LIVE* pLive;
+    LIVE_WALK walk;
+    UINT32 maxBins = 0;
+    int i, h, s, n;
+
+    if( pMUD_grp == NULL || MUD_secID( pMUD_grp ) != MUD_SEC_GRP_ID ) return( NULL );
+
+    for( pMUD_live = pMUD_grp->pMem; pMUD_live != NULL; pMUD_live = pMUD_live->core.pNext )
+    {
+	if( MUD_secID( pMUD_live ) == MUD_SEC_GEN_LIVE_ID ) break;
+    }
+    if( pMUD_live == NULL )
+    {
+	if( ( pMUD_live = MUD_new( MUD_SEC_GEN_LIVE_ID, 1 ) ) == NULL ) return( NULL );
+	MUD_addToGroup( pMUD_grp, pMUD_live );
+    }
+    ((MUD_SEC_GEN_LIVE*)pMUD_live)->generation = 0;
+    to_front( pMUD_grp, pMUD_live );
+
+    /*
+     *  Repack the histograms, then write the run and find its offsets
+     */
+    bzero( &walk, sizeof( walk ) );
+    if( walk_secs( &walk, (MUD_SEC*)pMUD_grp, NULL, 0 ) < 0 )
+    {
+	free_walk( &walk );
+	return( NULL );
+    }
+    for( i = 0; i < walk.n; i++ )
+    {
+	if( MUD_secID( walk.ppSecs[i] ) != MUD_SEC_GEN_HIST_DAT_ID ||
+	    ( h = find_hdr( &walk, i ) ) < 0 ) continue;
+	if( !repack( (MUD_SEC_GEN_HIST_HDR*)walk.ppSecs[h],
+		     (MUD_SEC_GEN_HIST_DAT*)walk.ppSecs[i] ) )
+	{
+	    free_walk( &walk );
+	    return( NULL );
+	}
+    }
+    MUD_setSizes( pMUD_grp );
+    if( !MUD_writeRunFile( pMUD_grp, filename ) )
+    {
+	free_walk( &walk );
+	return( NULL );
+    }
+    walk.n = 0;
+    if( walk_secs( &walk, (MUD_SEC*)pMUD_grp, NULL, 0 ) < 0 )
+    {
+	free_walk( &walk );
+	return( NULL );
+    }
+
+    n = walk.n;
+    if( ( pLive = (MUD_LIVE*)zalloc( sizeof( MUD_LIVE ) ) ) == NULL ||
+	( pLive->pNBins = (UINT32*)zalloc( n*sizeof( UINT32 ) ) ) == NULL ||
+	( pLive->pDatOffsets = (long*)zalloc( n*sizeof( long ) ) ) == NULL ||
+	( pLive->pHdrOffsets = (long*)zalloc( n*sizeof( long ) ) ) == NULL ||
+	( pLive->pScalerOffsets = (long*)zalloc( n*sizeof( long ) ) ) == NULL )
+    {
+	if( pLive != NULL ) free_live( pLive );
+	free_walk( &walk );
+	return( NULL );
+    }
+
+    pLive->genOffset = MUD_getSize( pMUD_grp ) + MUD_CORE_proc( MUD_GET_SIZE, NULL, NULL );
+    for( i = 0; i < n; i++ )
+    {
+	switch( MUD_secID( walk.ppSecs[i] ) )
+	{
+	    case MUD_SEC_GEN_HIST_DAT_ID:
+		if( ( h = find_hdr( &walk, i ) ) < 0 ) break;
+		pLive->pNBins[pLive->nHists] = ((MUD_SEC_GEN_HIST_HDR*)walk.ppSecs[h])->nBins;
+		pLive->pDatOffsets[pLive->nHists] = walk.pOffsets[i] +
+		    MUD_CORE_proc( MUD_GET_SIZE, NULL, NULL ) + sizeof( UINT32 );
+		pLive->pHdrOffsets[pLive->nHists] = walk.pOffsets[h] +
+		    MUD_CORE_proc( MUD_GET_SIZE, NULL, NULL ) + 11*sizeof( UINT32 );
+		maxBins = _max( maxBins, pLive->pNBins[pLive->nHists] );
+		pLive->nHists++;
+		break;
+	    case MUD_SEC_GEN_SCALER_ID:
+		s = pLive->nScalers++;
+		pLive->pScalerOffsets[s] = walk.pOffsets[i] + MUD_CORE_proc( MUD_GET_SIZE, NULL, NULL );
+		break;
+	    case MUD_SEC_GEN_RUN_DESC_ID:
+	    case MUD_SEC_TRI_TI_RUN_DESC_ID:
+		if( pLive->descOffset == 0 )
+		    pLive->descOffset = walk.pOffsets[i] +
+			MUD_CORE_proc( MUD_GET_SIZE, NULL, NULL ) + 3*sizeof( UINT32 );
+		break;
+	}
+    }
+    free_walk( &walk );
+
+    if( ( pLive->pBuf = (UINT8*)zalloc( 4*(size_t)maxBins + 1 ) ) == NULL ||
+	( pLive->fio = MUD_openInOut( filename ) ) == NULL )
+    {
+	free_live( pLive );
+	return( NULL );
+    }
+    return( pLive );
+}
+
+
+/*
+ *  MUD_liveCheckpoint() - write the counts of the histograms (ppCounts
+ *  has nHists of them; a NULL one is left as it was, as are all if
+ *  ppCounts is NULL), of the scalers (two for each of nScalers; none if
+ *  NULL), and the times of the run, in place; returns 1 on success, 0 on
+ *  failure.  nEvents of each histogram written is the sum of its counts.
+ *  After a failure the generation stays odd, so readers do not take the
+ *  file.
+ */
+int
+MUD_liveCheckpoint( MUD_LIVE* pLive, UINT32** ppCounts, UINT32* pScalers,
+		    UINT32 elapsedSec, UINT32 timeEnd )
+{
+    UINT32 nEvents, j;
+    int i, status;
+
+    if( pLive == NULL ) return( 0 );
+    if( !put_generation( pLive, pLive->generation + 1 ) ) return( 0 );
+
+    status = 1;
+    for( i = 0; ppCounts != NULL && i < pLive->nHists; i++ )
+    {
+	if( ppCounts[i] == NULL ) continue;
+	MUD_SEC_GEN_HIST_pack( pLive->pNBins[i], 4, ppCounts[i], 4, pLive->pBuf );
+	for( nEvents = 0, j = 0; j < pLive->pNBins[i]; j++ ) nEvents += ppCounts[i][j];
+	if( fseek( pLive->fio, pLive->pDatOffsets[i], SEEK_SET ) != 0 ||
+	    fwrite( pLive->pBuf, 4, pLive->pNBins[i], pLive->fio ) != pLive->pNBins[i] ||
+	    !put_4( pLive->fio, pLive->pHdrOffsets[i], nEvents ) )
+	    status = 0;
+    }
+    for( i = 0; pScalers != NULL && i < pLive->nScalers; i++ )
+    {
+	if( !put_4( pLive->fio, pLive->pScalerOffsets[i], pScalers[2*i] ) ||
+	    !put_4( pLive->fio, pLive->pScalerOffsets[i] + 4, pScalers[2*i+1] ) )
+	    status = 0;
+    }
+    if( pLive->descOffset != 0 )
+    {
+	if( !put_4( pLive->fio, pLive->descOffset, timeEnd ) ||
+	    !put_4( pLive->fio, pLive->descOffset + 4, elapsedSec ) )
+	    status = 0;
+    }
+    if( fflush( pLive->fio ) != 0 ) status = 0;
+
+    return( status && put_generation( pLive, pLive->generation + 1 ) );
+}
+
+
+/*
+ *  MUD_liveClose() - close a live file, leaving it as last checkpointed;
+ *  returns 1 on success, 0 on failure.
+ */
+int
+MUD_liveClose( MUD_LIVE* pLive )
+{
+    int status;
+
+    if( pLive == NULL ) return( 0 );
+    status = ( fclose( pLive->fio ) == 0 );
+    pLive->fio = NULL;
+    free_live( pLive );
+    return( status );
+}
+
+
+/*
+ *  live_wait() - wait before read n + 1 of a run being checkpointed:
+ *  not at all after the first, then twice as long each time
+ */
+static void
+live_wait( int n )
+{
+    long us;
+
+    if( n == 0 ) return;
+    us = LIVE_WAIT_MIN;
+    while( --n > 0 && us < LIVE_WAIT_MAX ) us *= 2;
+    us = _min( us, LIVE_WAIT_MAX );
+#ifdef _WIN32
+    Sleep( ( us + 999 )/1000 );
+#else
+    usleep( us );
+#endif /* _WIN32 */
+}
+
+
+/*
+ *  MUD_liveReadFile() - read the MUD file filename, which may be being
+ *  checkpointed, as of a whole checkpoint (see above); returns the run,
+ *  with its generation in *pGeneration (0 if it is not a live file), or
+ *  NULL if it cannot be read, or was being checkpointed at each of
+ *  LIVE_TRIES tries.  On failure, *pGeneration is odd (the generation
+ *  last read) if the file was left mid-checkpoint, and 0 otherwise.
+ *  Free it with MUD_free.
+ */
+void*
+MUD_liveReadFile( char* filename, UINT32* pGeneration )
+{
+    MUD_SEC_GRP* pMUD_fileGrp;
+    MUD_SEC* pMUD_live;
+    FILE* fin;
+    UINT32 gen1, gen2;
+    long offset;
+    int i;
+
+    if( pGeneration != NULL ) *pGeneration = 0;
+    for( i = 0; i < LIVE_TRIES; i++ )
+    {
+	live_wait( i );
+	if( ( fin = MUD_openInput( filename ) ) == NULL ) return( NULL );
+	setvbuf( fin, NULL, _IONBF, 0 );
+
+	offset = get_generation( fin, &gen1 );
+	if( offset != 0 && ( gen1 & 1 ) )
+	{
+	    fclose( fin );
+	    if( pGeneration != NULL ) *pGeneration = gen1;
+	    continue;
+	}
+	if( pGeneration != NULL ) *pGeneration = 0;
+	pMUD_fileGrp = (MUD_SEC_GRP*)MUD_readFile( fin );
+	if( offset == 0 )
+	{
+	    fclose( fin );
+	    if( pGeneration != NULL ) *pGeneration = 0;
+	    return( pMUD_fileGrp );
+	}
+	if( get_generation( fin, &gen2 ) != offset ) gen2 = gen1 + 1;
+	fclose( fin );
+
+	if( pMUD_fileGrp != NULL && gen2 == gen1 &&
+	    MUD_secID( pMUD_fileGrp ) == MUD_SEC_GRP_ID &&
+	    ( pMUD_live = pMUD_fileGrp->pMem ) != NULL &&
+	    MUD_secID( pMUD_live ) == MUD_SEC_GEN_LIVE_ID &&
+	    ((MUD_SEC_GEN_LIVE*)pMUD_live)->generation == gen1 )
+	{
+	    if( pGeneration != NULL ) *pGeneration = gen1;
+	    return( pMUD_fileGrp );
+	}
+	if( pMUD_fileGrp != NULL ) MUD_free( pMUD_fileGrp );
+    }
+    return( NULL );
+}
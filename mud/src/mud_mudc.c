@@ -0,0 +1,736 @@
+/*
+ *  mud_mudc.c -- MUD-C, a run with its histograms in compressed chunks,
+ *                read a range of bins at a time
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version
+ *
+ *  Description:
+ *    A MUD-C file holds the same section tree as a MUD file, for
+ *    archives: the histograms (of the TD or TI histogram group) are cut
+ *    into chunks of chunkBins bins, each coded on its own, so that a
+ *    range of bins is read by decoding only the chunks that cover it.
+ *    MUD_mudcWrite() converts a MUD file to MUD-C, and MUD_mudcToClassic()
+ *    back again; MUD_mudcOpen() reads the headers of a MUD-C file, and
+ *    MUD_mudcReadBins() then reads the bins wanted.  MUD_readRunFile()
+ *    reads a run from either kind of file.
+ *
+ *    A chunk holds the differences of successive bins (from 0 at the
+ *    start of the chunk), zigzag-coded as unsigned varints (7 bits to a
+ *    byte), which takes one or two bytes for most bins of a muSR
+ *    histogram.  With MUD_MUDC_DEFLATE (and the library built with zlib,
+ *    make ZLIB=1) these are deflated as well, and a chunk is kept as
+ *    plain 32-bit counts if neither is smaller.  Each chunk has a CRC32C
+ *    (see mud_dedup.c) of its bytes as stored, checked as it is read.
+ *
+ *    The file, with all numbers little-endian:
+ *
+ *      header      (64 bytes) magic "\0\0\0\0MUDC", version, chunkBins,
+ *                  number of histograms, flags, then 64-bit offset and
+ *                  length of the skeleton, offset of the index, and the
+ *                  length and CRC32C of the index
+ *      skeleton    the run as a MUD file (see MUD_write()), with the
+ *                  histogram data sections empty
+ *      chunks
+ *      index       per histogram: its number, bins, bytes per bin of the
+ *                  MUD file and number of chunks; then per chunk its
+ *                  64-bit offset, length, coding and CRC32C
+ *
+ *    The magic begins with a section of size zero, so that MUD_readFile()
+ *    and the like read nothing from a MUD-C file rather than nonsense.
+ */
+
+#include "mud.h"
+
+#ifdef MUD_ZLIB
+#include <zlib.h>
+#endif /* MUD_ZLIB */
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#define mudc_seek( f, off )	_fseeki64( f, (__int64)( off ), SEEK_SET )
+#else
+#include <unistd.h>
+#define mudc_seek( f, off )	fseeko( f, (off_t)( off ), SEEK_SET )
+#endif /* _WIN32 */
+
+#define MUDC_VERSION	1
+#define MUDC_HDR_LEN	64
+#define MUDC_HIST_LEN	16		/* of a histogram in the index */
+#define MUDC_CHUNK_LEN	20		/* of a chunk in the index */
+#define MUDC_MAX_CHUNK	1048576		/* bins */
+
+#define MUDC_RAW	0		/* codings of a chunk */
+#define MUDC_VARINT	1
+#define MUDC_DEFLATED	2
+
+static char magic[8] = { 0, 0, 0, 0, 'M', 'U', 'D', 'C' };
+
+static void put_32 _ANSI_ARGS_(( UINT8* b, UINT32 v ));
+static void put_64 _ANSI_ARGS_(( UINT8* b, UINT64 v ));
+static UINT32 get_32 _ANSI_ARGS_(( UINT8* b ));
+static UINT64 get_64 _ANSI_ARGS_(( UINT8* b ));
+static MUD_SEC_GRP* hist_group _ANSI_ARGS_(( MUD_SEC_GRP* pMUD_fileGrp ));
+static size_t encode_varint _ANSI_ARGS_(( UINT32* pCounts, UINT32 num, UINT8* out ));
+static int decode_varint _ANSI_ARGS_(( UINT8* in, size_t len, UINT32 num, UINT32* pCounts ));
+static size_t encode_chunk _ANSI_ARGS_(( UINT32* pCounts, UINT32 num, int flags, UINT8* out, UINT8* tmp, UINT32* pCoding ));
+static int decode_chunk _ANSI_ARGS_(( MUD_MUDC* pMudc, MUD_MUDC_CHUNK* pChunk, UINT32 num, UINT32* pCounts ));
+static int read_index _ANSI_ARGS_(( MUD_MUDC* pMudc, UINT8* b, size_t len ));
+
+
+/*
+ *  put_32() .. get_64() - little-endian
+ */
+static void
+put_32( UINT8* b, UINT32 v )
+{
+    b[0] = (UINT8)v;
+    b[1] = (UINT8)( v >> 8 );
+    b[2] = (UINT8)( v >> 16 );
+    b[3] = (UINT8)( v >> 24 );
+}
+
+
+static void
+put_64( UINT8* b, UINT64 v )
+{
+    put_32( b, (UINT32)v );
+    put_32( b + 4, (UINT32)( v >> 32 ) );
+}
+
+
+static UINT32
+get_32( UINT8* b )
+{
+    return( (UINT32)b[0] | ( (UINT32)b[1] << 8 ) |
+	    ( (UINT32)b[2] << 16 ) | ( (UINT32)b[3] << 24 ) );
+}
+
+
+static UINT64
+get_64( UINT8* b )
+{
+    return( (UINT64)get_32( b ) | ( (UINT64)get_32( b + 4 ) << 32 ) );
+}
+
+
+static MUD_SEC_GRP*
+hist_group( MUD_SEC_GRP* pMUD_fileGrp )
+{
+    MUD_SEC_GRP* pMUD_grp;
+
+    pMUD_grp = (MUD_SEC_GRP*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_GRP_ID, MUD_GRP_TRI_TD_HIST_ID, (UINT32)0 );
+    if( pMUD_grp == NULL )
+	pMUD_grp = (MUD_SEC_GRP*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_GRP_ID, MUD_GRP_TRI_TI_HIST_ID, (UINT32)0 );
+    return( pMUD_grp );
+}
+
+
+/*
+ *  encode_varint() - zigzag-coded differences of the bins, 7 bits to a
+ *  byte (at most 5 bytes a bin); returns the length
+ */
+static size_t
+encode_varint( UINT32* pCounts, UINT32 num, UINT8* out )
+{
+    UINT32 i, prev = 0, d, z;
+    UINT8* p = out;
+
+    for( i = 0; i < num; i++ )
+    {
+	d = pCounts[i] - prev;
+	prev = pCounts[i];
+	z = ( d << 1 ) ^ ( ( d & 0x80000000U ) ? 0xFFFFFFFFU : 0 );
+	while( z >= 0x80 )
+	{
+	    *p++ = (UINT8)( z | 0x80 );
+	    z >>= 7;
+	}
+	*p++ = (UINT8)z;
+    }
+    return( (size_t)( p - out ) );
+}
+
+
+/*
+ *  decode_varint() - the bins back; returns 0 unless in holds exactly
+ *  num of them
+ */
+static int
+decode_varint( UINT8* in, size_t len, UINT32 num, UINT32* pCounts )
+{
+    UINT8* end = in + len;
+    UINT32 i, prev = 0, z;
+    int shift;
+
+    for( i = 0; i < num; i++ )
+    {
+	z = 0;
+	for( shift = 0; ; shift += 7 )
+	{
+	    if( in == end || shift > 28 ) return( 0 );
+	    z |= (UINT32)( *in & 0x7F ) << shift;
+	    if( !( *in++ & 0x80 ) ) break;
+	}
+	prev += ( z >> 1 ) ^ ( ( z & 1 ) ? 0xFFFFFFFFU : 0 );
+	pCounts[i] = prev;
+    }
+    return( in == end );
+}
+
+
+/*
+ *  encode_chunk() - a chunk of num bins into out (5*num + 64 bytes, with
+ *  tmp as big), in the smallest coding allowed; returns the length
+ */
+static size_t
+encode_chunk( UINT32* pCounts, UINT32 num, int flags, UINT8* out, UINT8* tmp, UINT32* pCoding )
+{
+    size_t len;
+    UINT32 i;
+#ifdef MUD_ZLIB
+    uLongf zlen;
+#endif /* MUD_ZLIB */
+
+    len = encode_varint( pCounts, num, tmp );
+    *pCoding = MUDC_VARINT;
+#ifdef MUD_ZLIB
+    zlen = (uLongf)( 5*(size_t)num + 64 );
+    if( ( flags & MUD_MUDC_DEFLATE ) &&
+	compress2( out, &zlen, tmp, (uLong)len, Z_DEFAULT_COMPRESSION ) == Z_OK &&
+	zlen < len )
+    {
+	*pCoding = MUDC_DEFLATED;
+	return( (size_t)zlen );
+    }
+#endif /* MUD_ZLIB */
+    if( len < 4*(size_t)num )
+    {
+	bcopy( tmp, out, len );
+	return( len );
+    }
+
+    *pCoding = MUDC_RAW;
+    for( i = 0; i < num; i++ ) put_32( out + 4*(size_t)i, pCounts[i] );
+    return( 4*(size_t)num );
+}
+
+
+/*
+ *  decode_chunk() - read a chunk of num bins, check it and decode it;
+ *  returns 0 if it cannot be read or is damaged
+ */
+static int
+decode_chunk( MUD_MUDC* pMudc, MUD_MUDC_CHUNK* pChunk, UINT32 num, UINT32* pCounts )
+{
+    UINT32 i;
+#ifdef MUD_ZLIB
+    uLongf zlen;
+#endif /* MUD_ZLIB */
+
+    if( pChunk->size > 5*pMudc->chunkBins + 64 ) return( 0 );
+    if( mudc_seek( pMudc->fin, pChunk->offset ) != 0 ||
+	fread( pMudc->pBuf, 1, pChunk->size, pMudc->fin ) != pChunk->size ) return( 0 );
+    if( MUD_crc32c( 0, pMudc->pBuf, pChunk->size ) != pChunk->crc ) return( 0 );
+
+    switch( pChunk->coding )
+    {
+	case MUDC_RAW:
+	    if( pChunk->size != 4*num ) return( 0 );
+	    for( i = 0; i < num; i++ ) pCounts[i] = get_32( pMudc->pBuf + 4*(size_t)i );
+	    return( 1 );
+	case MUDC_VARINT:
+	    return( decode_varint( pMudc->pBuf, pChunk->size, num, pCounts ) );
+#ifdef MUD_ZLIB
+	case MUDC_DEFLATED:
+	    zlen = (uLongf)( 5*(size_t)pMudc->chunkBins + 64 );
+	    if( uncompress( pMudc->pTmp, &zlen, pMudc->pBuf, (uLong)pChunk->size ) != Z_OK )
+		return( 0 );
+	    return( decode_varint( pMudc->pTmp, (size_t)zlen, num, pCounts ) );
+#endif /* MUD_ZLIB */
+    }
+    return( 0 );
+}
+
+
+/*
+ *  MUD_mudcWriteRun() - write the run pMUD_fileGrp (as read by
+ *  MUD_readFile) as the MUD-C file outFile, with chunks of chunkBins bins
+ *  (0 for MUD_MUDC_CHUNK_BINS), emptying its histogram data on the way;
+ *  returns 1 on success, 0 on failure, -1 if MUD_MUDC_DEFLATE is asked
+ *  for without zlib.
+ */
+int
+MUD_mudcWriteRun( void* pMUD_run, char* outFile, int chunkBins, int flags )
+{
+    MUD_SEC_GRP* pMUD_fileGrp = (MUD_SEC_GRP*)pMUD_run;
+    MUD_SEC_GRP* pMUD_grp;
+    MUD_SEC_GEN_HIST_HDR* pHdr;
+    MUD_SEC_GEN_HIST_DAT* pDat;
+    UINT32** ppCounts = NULL;
+    UINT32* pNumBins = NULL;
+    UINT32* pBpb = NULL;
+    UINT8* pIndex = NULL;
+    UINT8* pOut = NULL;
+    UINT8* pTmp = NULL;
+    UINT8* pEntry;
+    UINT8 hdr[MUDC_HDR_LEN];
+    UINT32 nHists = 0, nChunks = 0, i, j, n, coding;
+    UINT64 pos, skelLen;
+    size_t len, indexLen;
+    char* tmpname = NULL;
+    FILE* fout = NULL;
+    int status = 0;
+
+#ifndef MUD_ZLIB
+    if( flags & MUD_MUDC_DEFLATE ) return( -1 );
+#endif /* MUD_ZLIB */
+    if( chunkBins <= 0 ) chunkBins = MUD_MUDC_CHUNK_BINS;
+    chunkBins = _min( chunkBins, MUDC_MAX_CHUNK );
+
+    if( pMUD_fileGrp == NULL || MUD_secID( pMUD_fileGrp ) != MUD_SEC_GRP_ID ) return( 0 );
+
+    /*
+     *  Unpack the histograms, and empty their data sections for the
+     *  skeleton
+     */
+    if( ( pMUD_grp = hist_group( pMUD_fileGrp ) ) != NULL ) nHists = pMUD_grp->num/2;
+    if( ( ppCounts = (UINT32**)zalloc( ( nHists + 1 )*sizeof( UINT32* ) ) ) == NULL ||
+	( pNumBins = (UINT32*)zalloc( ( nHists + 1 )*sizeof( UINT32 ) ) ) == NULL ||
+	( pBpb = (UINT32*)zalloc( ( nHists + 1 )*sizeof( UINT32 ) ) ) == NULL ) goto done;
+    for( i = 0; i < nHists; i++ )
+    {
+	pHdr = (MUD_SEC_GEN_HIST_HDR*)MUD_search( pMUD_grp->pMem,
+			  MUD_SEC_GEN_HIST_HDR_ID, i + 1, (UINT32)0 );
+	pDat = (MUD_SEC_GEN_HIST_DAT*)MUD_search( pMUD_grp->pMem,
+			  MUD_SEC_GEN_HIST_DAT_ID, i + 1, (UINT32)0 );
+	if( pHdr == NULL || pDat == NULL ) continue;
+	if( pHdr->bytesPerBin != 0 && pHdr->bytesPerBin != 1 &&
+	    pHdr->bytesPerBin != 2 && pHdr->bytesPerBin != 4 &&
+	    pHdr->bytesPerBin != MUD_BPB_SPARSE ) goto done;
+	if( ( ppCounts[i] = (UINT32*)zalloc( 4*(size_t)pHdr->nBins + 4 ) ) == NULL ) goto done;
+	if( pDat->pData != NULL )
+	    MUD_SEC_GEN_HIST_unpackData( pHdr->nBins, pHdr->bytesPerBin, pDat->pData, pDat->nBytes,
+				     4, ppCounts[i] );
+	pNumBins[i] = pHdr->nBins;
+	pBpb[i] = pHdr->bytesPerBin;
+	nChunks += ( pHdr->nBins + chunkBins - 1 )/chunkBins;
+	_free( pDat->pData );
+	pDat->nBytes = 0;
+    }
+
+    indexLen = (size_t)nHists*MUDC_HIST_LEN + (size_t)nChunks*MUDC_CHUNK_LEN;
+    if( ( pIndex = (UINT8*)zalloc( indexLen + 1 ) ) == NULL ||
+	( pOut = (UINT8*)malloc( 5*(size_t)chunkBins + 64 ) ) == NULL ||
+	( pTmp = (UINT8*)malloc( 5*(size_t)chunkBins + 64 ) ) == NULL ||
+	( tmpname = (char*)malloc( strlen( outFile ) + 24 ) ) == NULL ) goto done;
+    sprintf( tmpname, "%s.%lu.tmp", outFile, (unsigned long)getpid() );
+    if( ( fout = fopen( tmpname, "wb" ) ) == NULL ) goto done;
+
+    bzero( hdr, sizeof( hdr ) );
+    if( fwrite( hdr, 1, MUDC_HDR_LEN, fout ) != MUDC_HDR_LEN ||
+	!MUD_write( fout, pMUD_fileGrp, MUD_ALL ) || !MUD_writeEnd( fout ) ) goto done;
+    pos = (UINT64)ftell( fout );
+    skelLen = pos - MUDC_HDR_LEN;
+
+    /*
+     *  The chunks, and their index
+     */
+    pEntry = pIndex;
+    for( i = 0; i < nHists; i++ )
+    {
+	n = ( pNumBins[i] + chunkBins - 1 )/chunkBins;
+	put_32( pEntry, i + 1 );
+	put_32( pEntry + 4, pNumBins[i] );
+	put_32( pEntry + 8, pBpb[i] );
+	put_32( pEntry + 12, n );
+	pEntry += MUDC_HIST_LEN;
+	for( j = 0; j < n; j++ )
+	{
+	    len = encode_chunk( ppCounts[i] + (size_t)j*chunkBins,
+				_min( chunkBins, pNumBins[i] - j*chunkBins ),
+				flags, pOut, pTmp, &coding );
+	    if( fwrite( pOut, 1, len, fout ) != len ) goto done;
+	    put_64( pEntry, pos );
+	    put_32( pEntry + 8, (UINT32)len );
+	    put_32( pEntry + 12, coding );
+	    put_32( pEntry + 16, MUD_crc32c( 0, pOut, len ) );
+	    pEntry += MUDC_CHUNK_LEN;
+	    pos += len;
+	}
+    }
+    if( indexLen > 0 && fwrite( pIndex, 1, indexLen, fout ) != indexLen ) goto done;
+
+    bcopy( magic, hdr, 8 );
+    put_32( hdr + 8, MUDC_VERSION );
+    put_32( hdr + 12, (UINT32)chunkBins );
+    put_32( hdr + 16, nHists );
+    put_32( hdr + 20, (UINT32)flags );
+    put_64( hdr + 24, MUDC_HDR_LEN );
+    put_64( hdr + 32, skelLen );
+    put_64( hdr + 40, pos );
+    put_32( hdr + 48, (UINT32)indexLen );
+    put_32( hdr + 52, MUD_crc32c( 0, pIndex, indexLen ) );
+    rewind( fout );
+    status = ( fwrite( hdr, 1, MUDC_HDR_LEN, fout ) == MUDC_HDR_LEN );
+
+done:
+    if( fout != NULL )
+    {
+	if( fclose( fout ) != 0 ) status = 0;
+	if( status )
+	{
+#ifdef _WIN32
+	    remove( outFile );
+#endif /* _WIN32 */
+	    status = ( rename( tmpname, outFile ) == 0 );
+	}
+	if( !status ) remove( tmpname );
+    }
+    if( ppCounts != NULL )
+    {
+	for( i = 0; i < nHists; i++ )
+	{
+	    _free( ppCounts[i] );
+	}
+	free( ppCounts );
+    }
+    _free( pNumBins );
+    _free( pBpb );
+    _free( pIndex );
+    _free( pOut );
+    _free( pTmp );
+    _free( tmpname );
+    return( status );
+}
+
+
+/*
+ *  MUD_mudcWrite() - convert the MUD file inFile to the MUD-C file
+ *  outFile; returns as MUD_mudcWriteRun()
+ */
+int
+MUD_mudcWrite( char* inFile, char* outFile, int chunkBins, int flags )
+{
+    MUD_SEC_GRP* pMUD_fileGrp;
+    FILE* fin;
+    int status;
+
+#ifndef MUD_ZLIB
+    if( flags & MUD_MUDC_DEFLATE ) return( -1 );
+#endif /* MUD_ZLIB */
+    if( ( fin = MUD_openInput( inFile ) ) == NULL ) return( 0 );
+    pMUD_fileGrp = (MUD_SEC_GRP*)MUD_readFile( fin );
+    fclose( fin );
+    if( pMUD_fileGrp == NULL ) return( 0 );
+
+    status = MUD_mudcWriteRun( pMUD_fileGrp, outFile, chunkBins, flags );
+    MUD_free( pMUD_fileGrp );
+    return( status );
+}
+
+
+/*
+ *  read_index() - the histograms and chunks of the index b
+ */
+static int
+read_index( MUD_MUDC* pMudc, UINT8* b, size_t len )
+{
+    MUD_MUDC_HIST* pHist;
+    UINT8* end = b + len;
+    UINT32 i, j;
+
+    for( i = 0; i < pMudc->nHists; i++ )
+    {
+	if( end - b < MUDC_HIST_LEN ) return( 0 );
+	pHist = &pMudc->pHists[i];
+	pHist->num = get_32( b );
+	pHist->nBins = get_32( b + 4 );
+	pHist->bytesPerBin = get_32( b + 8 );
+	pHist->nChunks = get_32( b + 12 );
+	b += MUDC_HIST_LEN;
+	if( pHist->nChunks != ( pHist->nBins + pMudc->chunkBins - 1 )/pMudc->chunkBins ||
+	    (size_t)( end - b ) < (size_t)pHist->nChunks*MUDC_CHUNK_LEN ) return( 0 );
+	if( ( pHist->pChunks = (MUD_MUDC_CHUNK*)zalloc( ( pHist->nChunks + 1 )*
+					 sizeof( MUD_MUDC_CHUNK ) ) ) == NULL ) return( 0 );
+	for( j = 0; j < pHist->nChunks; j++ )
+	{
+	    pHist->pChunks[j].offset = get_64( b );
+	    pHist->pChunks[j].size = get_32( b + 8 );
+	    pHist->pChunks[j].coding = get_32( b + 12 );
+	    pHist->pChunks[j].crc = get_32( b + 16 );
+	    b += MUDC_CHUNK_LEN;
+	}
+    }
+    return( b == end );
+}
+
+
+/*
+ *  MUD_mudcOpen() - open a MUD-C file: its headers (the skeleton, as
+ *  pMUD_fileGrp) and the index of its chunks; NULL if it is not one
+ */
+MUD_MUDC*
+MUD_mudcOpen( char* filename )
+{
+    MUD_MUDC* pMudc;
+    UINT8 hdr[MUDC_HDR_LEN];
+    UINT8* pIndex = NULL;
+    UINT64 skelOff, indexOff;
+    size_t indexLen;
+    int status = 0;
+
+    if( ( pMudc = (MUD_MUDC*)zalloc( sizeof( MUD_MUDC ) ) ) == NULL ) return( NULL );
+    if( ( pMudc->fin = MUD_openInput( filename ) ) == NULL ) goto done;
+    if( fread( hdr, 1, MUDC_HDR_LEN, pMudc->fin ) != MUDC_HDR_LEN ||
+	memcmp( hdr, magic, 8 ) != 0 || get_32( hdr + 8 ) != MUDC_VERSION ) goto done;
+
+    pMudc->chunkBins = get_32( hdr + 12 );
+    pMudc->nHists = get_32( hdr + 16 );
+    skelOff = get_64( hdr + 24 );
+    indexOff = get_64( hdr + 40 );
+    indexLen = get_32( hdr + 48 );
+    if( pMudc->chunkBins == 0 || pMudc->chunkBins > MUDC_MAX_CHUNK ||
+	indexLen < (size_t)pMudc->nHists*MUDC_HIST_LEN ) goto done;
+
+    if( ( pIndex = (UINT8*)malloc( indexLen + 1 ) ) == NULL ||
+	mudc_seek( pMudc->fin, indexOff ) != 0 ||
+	fread( pIndex, 1, indexLen, pMudc->fin ) != indexLen ||
+	MUD_crc32c( 0, pIndex, indexLen ) != get_32( hdr + 52 ) ) goto done;
+    if( ( pMudc->pHists = (MUD_MUDC_HIST*)zalloc( ( pMudc->nHists + 1 )*
+					  sizeof( MUD_MUDC_HIST ) ) ) == NULL ||
+	!read_index( pMudc, pIndex, indexLen ) ) goto done;
+
+    if( ( pMudc->pBuf = (UINT8*)malloc( 5*(size_t)pMudc->chunkBins + 64 ) ) == NULL ||
+	( pMudc->pTmp = (UINT8*)malloc( 5*(size_t)pMudc->chunkBins + 64 ) ) == NULL ||
+	( pMudc->pChunk = (UINT32*)malloc( 4*(size_t)pMudc->chunkBins ) ) == NULL ) goto done;
+
+    if( mudc_seek( pMudc->fin, skelOff ) != 0 ) goto done;
+    pMudc->pMUD_fileGrp = (MUD_SEC_GRP*)MUD_read( pMudc->fin, MUD_ALL );
+    status = ( pMudc->pMUD_fileGrp != NULL &&
+	       MUD_secID( pMudc->pMUD_fileGrp ) == MUD_SEC_GRP_ID );
+
+done:
+    _free( pIndex );
+    if( !status )
+    {
+	MUD_mudcClose( pMudc );
+	return( NULL );
+    }
+    return( pMudc );
+}
+
+
+void
+MUD_mudcClose( MUD_MUDC* pMudc )
+{
+    UINT32 i;
+
+    if( pMudc == NULL ) return;
+    if( pMudc->fin != NULL ) fclose( pMudc->fin );
+    if( pMudc->pMUD_fileGrp != NULL ) MUD_free( pMudc->pMUD_fileGrp );
+    if( pMudc->pHists != NULL )
+    {
+	for( i = 0; i < pMudc->nHists; i++ )
+	{
+	    _free( pMudc->pHists[i].pChunks );
+	}
+	free( pMudc->pHists );
+    }
+    _free( pMudc->pBuf );
+    _free( pMudc->pTmp );
+    _free( pMudc->pChunk );
+    free( pMudc );
+}
+
+
+/*
+ *  MUD_mudcReadBins() - bins first .. first + num - 1 (from 0) of
+ *  histogram hist (from 1) into pCounts, decoding only the chunks that
+ *  cover them; returns the number of bins read (fewer past the end of
+ *  the histogram), or -1 if a chunk is damaged.
+ */
+int
+MUD_mudcReadBins( MUD_MUDC* pMudc, int hist, UINT32 first, UINT32 num, UINT32* pCounts )
+{
+    MUD_MUDC_HIST* pHist;
+    UINT32 c, n, bin, end, size;
+
+    if( hist < 1 || (UINT32)hist > pMudc->nHists ) return( -1 );
+    pHist = &pMudc->pHists[hist - 1];
+    if( first >= pHist->nBins ) return( 0 );
+    num = _min( num, pHist->nBins - first );
+
+    for( bin = first, end = first + num; bin < end; bin += n )
+    {
+	c = bin/pMudc->chunkBins;
+	size = _min( pMudc->chunkBins, pHist->nBins - c*pMudc->chunkBins );
+	n = _min( end - bin, ( c + 1 )*pMudc->chunkBins - bin );
+
+	/*
+	 *  The chunk last decoded is kept, for reads along a histogram
+	 */
+	if( pMudc->cachedHist != hist || pMudc->cachedChunk != c )
+	{
+	    pMudc->cachedHist = 0;
+	    if( !decode_chunk( pMudc, &pHist->pChunks[c], size, pMudc->pChunk ) ) return( -1 );
+	    pMudc->cachedHist = hist;
+	    pMudc->cachedChunk = c;
+	}
+	bcopy( pMudc->pChunk + ( bin - c*pMudc->chunkBins ), pCounts + ( bin - first ),
+	       n*sizeof( UINT32 ) );
+    }
+    return( (int)num );
+}
+
+
+/*
+ *  MUD_mudcReadFile() - the whole run of a MUD-C file, as MUD_readFile()
+ *  reads it from the MUD file; NULL if it cannot be read
+ */
+void*
+MUD_mudcReadFile( char* filename )
+{
+    MUD_MUDC* pMudc;
+    MUD_SEC_GRP* pMUD_fileGrp = NULL;
+    MUD_SEC_GRP* pMUD_grp;
+    MUD_SEC_GEN_HIST_HDR* pHdr;
+    MUD_SEC_GEN_HIST_DAT* pDat;
+    MUD_MUDC_HIST* pHist;
+    UINT32* pCounts;
+    UINT32 i;
+    int status = 1;
+
+    if( ( pMudc = MUD_mudcOpen( filename ) ) == NULL ) return( NULL );
+    if( ( pMUD_grp = hist_group( pMudc->pMUD_fileGrp ) ) == NULL && pMudc->nHists > 0 )
+	status = 0;
+
+    for( i = 0; i < pMudc->nHists && status; i++ )
+    {
+	pHist = &pMudc->pHists[i];
+	pHdr = (MUD_SEC_GEN_HIST_HDR*)MUD_search( pMUD_grp->pMem,
+			  MUD_SEC_GEN_HIST_HDR_ID, pHist->num, (UINT32)0 );
+	pDat = (MUD_SEC_GEN_HIST_DAT*)MUD_search( pMUD_grp->pMem,
+			  MUD_SEC_GEN_HIST_DAT_ID, pHist->num, (UINT32)0 );
+	if( pHdr == NULL || pDat == NULL || pHdr->nBins != pHist->nBins )
+	{
+	    status = 0;
+	    break;
+	}
+	if( ( pCounts = (UINT32*)malloc( 4*(size_t)pHist->nBins + 4 ) ) == NULL ||
+	    ( pDat->pData = (caddr_t)zalloc( ( pHist->bytesPerBin == MUD_BPB_SPARSE ? 8 : 4 )*
+					     (size_t)pHist->nBins + 32 ) ) == NULL )
+	{
+	    _free( pCounts );
+	    status = 0;
+	    break;
+	}
+	status = ( MUD_mudcReadBins( pMudc, (int)( i + 1 ), 0, pHist->nBins, pCounts ) ==
+		   (int)pHist->nBins );
+	if( status )
+	    pDat->nBytes = pHdr->nBytes =
+		MUD_SEC_GEN_HIST_pack( pHist->nBins, 4, pCounts, pHist->bytesPerBin,
+				       pDat->pData );
+	free( pCounts );
+    }
+
+    if( status )
+    {
+	pMUD_fileGrp = pMudc->pMUD_fileGrp;
+	pMudc->pMUD_fileGrp = NULL;
+    }
+    MUD_mudcClose( pMudc );
+    return( pMUD_fileGrp );
+}
+
+
+/*
+ *  MUD_readRunFile() - the run of a MUD or a MUD-C file, whole or (if
+ *  hdrsOnly) as MUD_readHeaders() reads it; NULL if it cannot be read
+ */
+void*
+MUD_readRunFile( char* filename, int hdrsOnly )
+{
+    MUD_SEC_GRP* pMUD_fileGrp;
+    MUD_MUDC* pMudc;
+    FILE* fin;
+
+    if( ( fin = MUD_openInput( filename ) ) == NULL ) return( NULL );
+    pMUD_fileGrp = (MUD_SEC_GRP*)( hdrsOnly ? MUD_readHeaders( fin ) : MUD_readFile( fin ) );
+    fclose( fin );
+    if( pMUD_fileGrp != NULL && MUD_secID( pMUD_fileGrp ) == MUD_SEC_GRP_ID )
+	return( pMUD_fileGrp );
+    if( pMUD_fileGrp != NULL ) MUD_free( pMUD_fileGrp );
+
+    if( !hdrsOnly ) return( MUD_mudcReadFile( filename ) );
+    if( ( pMudc = MUD_mudcOpen( filename ) ) == NULL ) return( NULL );
+    pMUD_fileGrp = pMudc->pMUD_fileGrp;
+    pMudc->pMUD_fileGrp = NULL;
+    MUD_mudcClose( pMudc );
+    return( pMUD_fileGrp );
+}
+
+
+/*
+ *  MUD_writeRunFile() - write the run pMUD_fileGrp as the MUD file
+ *  outFile, by way of a temporary file; returns 1 on success, 0 on
+ *  failure.
+ */
+int
+MUD_writeRunFile( void* pMUD_fileGrp, char* outFile )
+{
+    char* tmpname;
+    FILE* fout;
+    int status = 0;
+
+    if( ( tmpname = (char*)malloc( strlen( outFile ) + 24 ) ) == NULL ) return( 0 );
+    sprintf( tmpname, "%s.%lu.tmp", outFile, (unsigned long)getpid() );
+
+    if( ( fout = MUD_openOutput( tmpname ) ) != NULL )
+    {
+	status = MUD_writeFile( fout, pMUD_fileGrp );
+	if( fclose( fout ) != 0 ) status = 0;
+	if( status )
+	{
+#ifdef _WIN32
+	    remove( outFile );
+#endif /* _WIN32 */
+	    status = ( rename( tmpname, outFile ) == 0 );
+	}
+	if( !status ) remove( tmpname );
+    }
+    free( tmpname );
+    return( status );
+}
+
+
+/*
+ *  MUD_mudcToClassic() - convert the MUD-C file inFile to the MUD file
+ *  outFile; returns 1 on success, 0 on failure.
+ */
+int
+MUD_mudcToClassic( char* inFile, char* outFile )
+{
+    MUD_SEC_GRP* pMUD_fileGrp;
+    int status;
+
+    if( ( pMUD_fileGrp = (MUD_SEC_GRP*)MUD_mudcReadFile( inFile ) ) == NULL ) return( 0 );
+    status = MUD_writeRunFile( pMUD_fileGrp, outFile );
+    MUD_free( pMUD_fileGrp );
+    return( status );
+}
@@ -25,6 +25,8 @@
  *   v1.0c  25-Apr-1994  [TW] Added CAMP sections
  *   v1.1   21-Feb-1996  TW   Remove CAMP sections, add GEN_ARRAY
  *   v1.2a  01-Mar-2000  DA   Add handling of unidentified sections (don't quit)
+ *          18-Oct-2026       Add GEN_EVENT
+ *          18-Oct-2026       Add GEN_LIVE
  */
 
 
@@ -94,6 +96,16 @@ MUD_new( UINT32 secID, UINT32 instanceID )
 	    proc = (MUD_PROC)MUD_SEC_GEN_ARRAY_proc;
 	    sizeOf = sizeof( MUD_SEC_GEN_ARRAY );
 	    break;
+	case MUD_SEC_GEN_EVENT_ID:
+	    pMUD_new = (MUD_SEC*)zalloc( sizeof( MUD_SEC_GEN_EVENT ) );
+	    proc = (MUD_PROC)MUD_SEC_GEN_EVENT_proc;
+	    sizeOf = sizeof( MUD_SEC_GEN_EVENT );
+	    break;
+	case MUD_SEC_GEN_LIVE_ID:
+	    pMUD_new = (MUD_SEC*)zalloc( sizeof( MUD_SEC_GEN_LIVE ) );
+	    proc = (MUD_PROC)MUD_SEC_GEN_LIVE_proc;
+	    sizeOf = sizeof( MUD_SEC_GEN_LIVE );
+	    break;
 	case MUD_SEC_TRI_TI_RUN_DESC_ID:
 	    pMUD_new = (MUD_SEC*)zalloc( sizeof( MUD_SEC_TRI_TI_RUN_DESC ) );
 	    proc = (MUD_PROC)MUD_SEC_TRI_TI_RUN_DESC_proc;
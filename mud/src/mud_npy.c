@@ -0,0 +1,739 @@
+/*
+ *  mud_npy.c -- write the histograms and headers of runs as NumPy arrays
+ *               (.npy and .npz files)
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version
+ *
+ *  Description:
+ *    MUD_writeNpz() writes runs into one .npz file (a zip of .npy files,
+ *    as numpy.load reads it), with the arrays
+ *
+ *      counts        uint32 (runs, histograms, bins), zero past the end
+ *                    of shorter runs and histograms
+ *      hist_type .. n_events
+ *                    uint32 (runs, histograms), from the histogram headers
+ *      hist_title    bytes (runs, histograms)
+ *      format .. elapsed_sec
+ *                    uint32 (runs), from the run description
+ *      temperature_k, field_g
+ *                    float64 (runs), parsed (see mud_quantity.c); NaN if
+ *                    there is no number
+ *      path, title .. comment3
+ *                    bytes (runs)
+ *
+ *    Runs that cannot be read are left out.  MUD_writeNpy() writes just
+ *    the counts, as one .npy file.
+ *
+ *    The runs are read a block at a time (see mud_export.c), their
+ *    histograms unpacked straight into the buffer that is written out,
+ *    so the arrays are never in memory whole.  The .npy data start on 64-byte boundaries, and the zip
+ *    entries are stored uncompressed, so that numpy.load(mmap_mode="r")
+ *    of the .npy, or a map of the .npz at the offset of an array, reads
+ *    the counts in place.  With MUD_NPZ_DEFLATE the entries are deflated
+ *    instead, which needs the library built with zlib (make ZLIB=1).
+ *    Zip64 records are written for arrays or files past 4 GB.
+ */
+
+#include <time.h>
+#include "mud.h"
+
+#ifdef MUD_ZLIB
+#include <zlib.h>
+#endif /* MUD_ZLIB */
+
+#ifdef _WIN32
+#define npz_seek( f, off )	_fseeki64( f, (__int64)( off ), SEEK_SET )
+#else
+#define npz_seek( f, off )	fseeko( f, (off_t)( off ), SEEK_SET )
+#endif /* _WIN32 */
+
+#define NPY_ALIGN	64		/* of the data of an array */
+#define NPZ_ZIP64	0xF0000000U	/* sizes from here take zip64 records */
+#define NPZ_MAX_ENTRIES	64
+#define NPZ_ZBUF	65536
+
+static UINT32 crcTable[256] = {
+    0x00000000U, 0x77073096U, 0xEE0E612CU, 0x990951BAU,
+    0x076DC419U, 0x706AF48FU, 0xE963A535U, 0x9E6495A3U,
+    0x0EDB8832U, 0x79DCB8A4U, 0xE0D5E91EU, 0x97D2D988U,
+    0x09B64C2BU, 0x7EB17CBDU, 0xE7B82D07U, 0x90BF1D91U,
+    0x1DB71064U, 0x6AB020F2U, 0xF3B97148U, 0x84BE41DEU,
+    0x1ADAD47DU, 0x6DDDE4EBU, 0xF4D4B551U, 0x83D385C7U,
+    0x136C9856U, 0x646BA8C0U, 0xFD62F97AU, 0x8A65C9ECU,
+    0x14015C4FU, 0x63066CD9U, 0xFA0F3D63U, 0x8D080DF5U,
+    0x3B6E20C8U, 0x4C69105EU, 0xD56041E4U, 0xA2677172U,
+    0x3C03E4D1U, 0x4B04D447U, 0xD20D85FDU, 0xA50AB56BU,
+    0x35B5A8FAU, 0x42B2986CU, 0xDBBBC9D6U, 0xACBCF940U,
+    0x32D86CE3U, 0x45DF5C75U, 0xDCD60DCFU, 0xABD13D59U,
+    0x26D930ACU, 0x51DE003AU, 0xC8D75180U, 0xBFD06116U,
+    0x21B4F4B5U, 0x56B3C423U, 0xCFBA9599U, 0xB8BDA50FU,
+    0x2802B89EU, 0x5F058808U, 0xC60CD9B2U, 0xB10BE924U,
+    0x2F6F7C87U, 0x58684C11U, 0xC1611DABU, 0xB6662D3DU,
+    0x76DC4190U, 0x01DB7106U, 0x98D220BCU, 0xEFD5102AU,
+    0x71B18589U, 0x06B6B51FU, 0x9FBFE4A5U, 0xE8B8D433U,
+    0x7807C9A2U, 0x0F00F934U, 0x9609A88EU, 0xE10E9818U,
+    0x7F6A0DBBU, 0x086D3D2DU, 0x91646C97U, 0xE6635C01U,
+    0x6B6B51F4U, 0x1C6C6162U, 0x856530D8U, 0xF262004EU,
+    0x6C0695EDU, 0x1B01A57BU, 0x8208F4C1U, 0xF50FC457U,
+    0x65B0D9C6U, 0x12B7E950U, 0x8BBEB8EAU, 0xFCB9887CU,
+    0x62DD1DDFU, 0x15DA2D49U, 0x8CD37CF3U, 0xFBD44C65U,
+    0x4DB26158U, 0x3AB551CEU, 0xA3BC0074U, 0xD4BB30E2U,
+    0x4ADFA541U, 0x3DD895D7U, 0xA4D1C46DU, 0xD3D6F4FBU,
+    0x4369E96AU, 0x346ED9FCU, 0xAD678846U, 0xDA60B8D0U,
+    0x44042D73U, 0x33031DE5U, 0xAA0A4C5FU, 0xDD0D7CC9U,
+    0x5005713CU, 0x270241AAU, 0xBE0B1010U, 0xC90C2086U,
+    0x5768B525U, 0x206F85B3U, 0xB966D409U, 0xCE61E49FU,
+    0x5EDEF90EU, 0x29D9C998U, 0xB0D09822U, 0xC7D7A8B4U,
+    0x59B33D17U, 0x2EB40D81U, 0xB7BD5C3BU, 0xC0BA6CADU,
+    0xEDB88320U, 0x9ABFB3B6U, 0x03B6E20CU, 0x74B1D29AU,
+    0xEAD54739U, 0x9DD277AFU, 0x04DB2615U, 0x73DC1683U,
+    0xE3630B12U, 0x94643B84U, 0x0D6D6A3EU, 0x7A6A5AA8U,
+    0xE40ECF0BU, 0x9309FF9DU, 0x0A00AE27U, 0x7D079EB1U,
+    0xF00F9344U, 0x8708A3D2U, 0x1E01F268U, 0x6906C2FEU,
+    0xF762575DU, 0x806567CBU, 0x196C3671U, 0x6E6B06E7U,
+    0xFED41B76U, 0x89D32BE0U, 0x10DA7A5AU, 0x67DD4ACCU,
+    0xF9B9DF6FU, 0x8EBEEFF9U, 0x17B7BE43U, 0x60B08ED5U,
+    0xD6D6A3E8U, 0xA1D1937EU, 0x38D8C2C4U, 0x4FDFF252U,
+    0xD1BB67F1U, 0xA6BC5767U, 0x3FB506DDU, 0x48B2364BU,
+    0xD80D2BDAU, 0xAF0A1B4CU, 0x36034AF6U, 0x41047A60U,
+    0xDF60EFC3U, 0xA867DF55U, 0x316E8EEFU, 0x4669BE79U,
+    0xCB61B38CU, 0xBC66831AU, 0x256FD2A0U, 0x5268E236U,
+    0xCC0C7795U, 0xBB0B4703U, 0x220216B9U, 0x5505262FU,
+    0xC5BA3BBEU, 0xB2BD0B28U, 0x2BB45A92U, 0x5CB36A04U,
+    0xC2D7FFA7U, 0xB5D0CF31U, 0x2CD99E8BU, 0x5BDEAE1DU,
+    0x9B64C2B0U, 0xEC63F226U, 0x756AA39CU, 0x026D930AU,
+    0x9C0906A9U, 0xEB0E363FU, 0x72076785U, 0x05005713U,
+    0x95BF4A82U, 0xE2B87A14U, 0x7BB12BAEU, 0x0CB61B38U,
+    0x92D28E9BU, 0xE5D5BE0DU, 0x7CDCEFB7U, 0x0BDBDF21U,
+    0x86D3D2D4U, 0xF1D4E242U, 0x68DDB3F8U, 0x1FDA836EU,
+    0x81BE16CDU, 0xF6B9265BU, 0x6FB077E1U, 0x18B74777U,
+    0x88085AE6U, 0xFF0F6A70U, 0x66063BCAU, 0x11010B5CU,
+    0x8F659EFFU, 0xF862AE69U, 0x616BFFD3U, 0x166CCF45U,
+    0xA00AE278U, 0xD70DD2EEU, 0x4E048354U, 0x3903B3C2U,
+    0xA7672661U, 0xD06016F7U, 0x4969474DU, 0x3E6E77DBU,
+    0xAED16A4AU, 0xD9D65ADCU, 0x40DF0B66U, 0x37D83BF0U,
+    0xA9BCAE53U, 0xDEBB9EC5U, 0x47B2CF7FU, 0x30B5FFE9U,
+    0xBDBDF21CU, 0xCABAC28AU, 0x53B39330U, 0x24B4A3A6U,
+    0xBAD03605U, 0xCDD70693U, 0x54DE5729U, 0x23D967BFU,
+    0xB3667A2EU, 0xC4614AB8U, 0x5D681B02U, 0x2A6F2B94U,
+    0xB40BBE37U, 0xC30C8EA1U, 0x5A05DF1BU, 0x2D02EF8DU
+};
+
+typedef struct {
+    char	name[32];
+    UINT32	crc;
+    UINT64	rawSize;
+    UINT64	compSize;
+    UINT64	offset;		/* of the local header */
+    int		method;		/* 0 stored, 8 deflated */
+    int		zip64;		/* sizes in a zip64 record */
+} NPZ_ENTRY;
+
+typedef struct {
+    FILE*	fout;
+    UINT64	pos;		/* bytes written */
+    int		zip;		/* a .npz, else one .npy */
+    int		deflate;
+    int		error;
+    UINT16	dosTime;
+    UINT16	dosDate;
+    NPZ_ENTRY	entries[NPZ_MAX_ENTRIES];
+    int		nEntries;
+#ifdef MUD_ZLIB
+    z_stream	zs;
+    Bytef	zbuf[NPZ_ZBUF];
+#endif /* MUD_ZLIB */
+} NPZ_FILE;
+
+static UINT32 crc_update _ANSI_ARGS_(( UINT32 crc, UINT8* p, size_t n ));
+static void put_16 _ANSI_ARGS_(( UINT8* b, UINT32 v ));
+static void put_32 _ANSI_ARGS_(( UINT8* b, UINT32 v ));
+static void put_64 _ANSI_ARGS_(( UINT8* b, UINT64 v ));
+static void out _ANSI_ARGS_(( NPZ_FILE* pF, void* p, size_t n ));
+static int npy_header _ANSI_ARGS_(( UINT8* b, char* descr, int ndim, UINT64* shape ));
+static int npz_begin _ANSI_ARGS_(( NPZ_FILE* pF, char* name, char* descr, int ndim, UINT64* shape, UINT64 nBytes ));
+static void npz_write _ANSI_ARGS_(( NPZ_FILE* pF, void* p, size_t n ));
+static void npz_end _ANSI_ARGS_(( NPZ_FILE* pF ));
+static int npz_close _ANSI_ARGS_(( NPZ_FILE* pF ));
+static void put_array _ANSI_ARGS_(( NPZ_FILE* pF, char* name, char* descr, int ndim, UINT64* shape, void* pData, size_t size ));
+static void put_strings _ANSI_ARGS_(( NPZ_FILE* pF, char* name, int ndim, UINT64* shape, char** strs ));
+static int write_runs _ANSI_ARGS_(( NPZ_FILE* pF, int num, char** files, int nThreads ));
+
+
+static UINT32
+crc_update( UINT32 crc, UINT8* p, size_t n )
+{
+    crc = ~crc;
+    for( ; n > 0; n--, p++ )
+    {
+	crc = crcTable[( crc ^ *p ) & 0xFF] ^ ( crc >> 8 );
+    }
+    return( ~crc );
+}
+
+
+/*
+ *  put_16() .. put_64() - little-endian, for zip records and .npy headers
+ */
+static void
+put_16( UINT8* b, UINT32 v )
+{
+    b[0] = (UINT8)v;
+    b[1] = (UINT8)( v >> 8 );
+}
+
+
+static void
+put_32( UINT8* b, UINT32 v )
+{
+    put_16( b, v & 0xFFFF );
+    put_16( b + 2, v >> 16 );
+}
+
+
+static void
+put_64( UINT8* b, UINT64 v )
+{
+    put_32( b, (UINT32)v );
+    put_32( b + 4, (UINT32)( v >> 32 ) );
+}
+
+
+static void
+out( NPZ_FILE* pF, void* p, size_t n )
+{
+    if( n > 0 && fwrite( p, 1, n, pF->fout ) != n ) pF->error = 1;
+    pF->pos += n;
+}
+
+
+/*
+ *  npy_header() - the .npy header of an array into b (up to 256 bytes);
+ *  returns its length, a multiple of NPY_ALIGN
+ */
+static int
+npy_header( UINT8* b, char* descr, int ndim, UINT64* shape )
+{
+    char dims[128];
+    char* d;
+    int i, len;
+
+    dims[0] = '\0';
+    for( i = 0, d = dims; i < ndim; i++ )
+    {
+	d += sprintf( d, "%llu,%s", (unsigned long long)shape[i],
+		      ( i < ndim - 1 ) ? " " : "" );
+    }
+    if( ndim > 1 ) d[-1] = '\0';
+
+    bcopy( "\223NUMPY\001\000", b, 8 );
+    len = 10 + sprintf( (char*)b + 10, "{'descr': '%s', 'fortran_order': False, 'shape': (%s), }",
+			descr, dims );
+    while( ( len + 1 ) % NPY_ALIGN != 0 ) b[len++] = ' ';
+    b[len++] = '\n';
+    put_16( b + 8, (UINT32)( len - 10 ) );
+    return( len );
+}
+
+
+/*
+ *  npz_begin() - start an array of nBytes of data: the local header of
+ *  its zip entry (of a .npz), then its .npy header.  The entry is
+ *  aligned so that the data start on a multiple of NPY_ALIGN in the file.
+ */
+static int
+npz_begin( NPZ_FILE* pF, char* name, char* descr, int ndim, UINT64* shape, UINT64 nBytes )
+{
+    NPZ_ENTRY* pEntry;
+    UINT8 head[256];
+    UINT8 local[30 + 32 + 20 + NPY_ALIGN + 4];
+    int hlen, nlen, xlen, pad;
+
+    hlen = npy_header( head, descr, ndim, shape );
+    if( !pF->zip )
+    {
+	out( pF, head, hlen );
+	return( 1 );
+    }
+
+    if( pF->nEntries == NPZ_MAX_ENTRIES ) return( 0 );
+    pEntry = &pF->entries[pF->nEntries++];
+    sprintf( pEntry->name, "%.27s.npy", name );
+    pEntry->offset = pF->pos;
+    pEntry->method = pF->deflate ? 8 : 0;
+    pEntry->rawSize = hlen + nBytes;
+    pEntry->compSize = 0;
+    pEntry->crc = 0;
+    pEntry->zip64 = ( pEntry->rawSize >= NPZ_ZIP64 );
+
+    /*
+     *  Extra field: the zip64 sizes, if needed, then padding (an
+     *  unknown ID, which readers skip) up to the alignment
+     */
+    nlen = (int)strlen( pEntry->name );
+    xlen = pEntry->zip64 ? 20 : 0;
+    pad = (int)( ( NPY_ALIGN - ( pF->pos + 30 + nlen + xlen ) % NPY_ALIGN ) % NPY_ALIGN );
+    if( pad > 0 && pad < 4 ) pad += NPY_ALIGN;
+
+    bzero( local, sizeof( local ) );
+    put_32( local, 0x04034B50 );
+    put_16( local + 4, pEntry->zip64 ? 45 : 20 );
+    put_16( local + 8, pEntry->method );
+    put_16( local + 10, pF->dosTime );
+    put_16( local + 12, pF->dosDate );
+    put_32( local + 18, pEntry->zip64 ? 0xFFFFFFFFU : 0 );
+    put_32( local + 22, pEntry->zip64 ? 0xFFFFFFFFU : 0 );
+    put_16( local + 26, nlen );
+    put_16( local + 28, xlen + pad );
+    bcopy( pEntry->name, local + 30, nlen );
+    if( pEntry->zip64 )
+    {
+	put_16( local + 30 + nlen, 0x0001 );
+	put_16( local + 32 + nlen, 16 );
+    }
+    if( pad > 0 )
+    {
+	put_16( local + 30 + nlen + xlen, 0xA220 );
+	put_16( local + 32 + nlen + xlen, pad - 4 );
+    }
+    out( pF, local, 30 + nlen + xlen + pad );
+
+#ifdef MUD_ZLIB
+    if( pF->deflate )
+    {
+	bzero( &pF->zs, sizeof( z_stream ) );
+	if( deflateInit2( &pF->zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8,
+			  Z_DEFAULT_STRATEGY ) != Z_OK ) return( 0 );
+    }
+#endif /* MUD_ZLIB */
+    pEntry->compSize = pF->pos;
+    npz_write( pF, head, hlen );
+    return( 1 );
+}
+
+
+/*
+ *  npz_write() - data of the array begun
+ */
+static void
+npz_write( NPZ_FILE* pF, void* p, size_t n )
+{
+    NPZ_ENTRY* pEntry = &pF->entries[pF->nEntries - 1];
+#ifdef MUD_ZLIB
+    size_t chunk;
+#endif /* MUD_ZLIB */
+
+    if( !pF->zip )
+    {
+	out( pF, p, n );
+	return;
+    }
+    pEntry->crc = crc_update( pEntry->crc, (UINT8*)p, n );
+
+#ifdef MUD_ZLIB
+    if( pF->deflate )
+    {
+	for( ; n > 0; n -= chunk, p = (char*)p + chunk )
+	{
+	    chunk = _min( n, 1073741824 );
+	    pF->zs.next_in = (Bytef*)p;
+	    pF->zs.avail_in = (uInt)chunk;
+	    while( pF->zs.avail_in > 0 )
+	    {
+		pF->zs.next_out = pF->zbuf;
+		pF->zs.avail_out = NPZ_ZBUF;
+		deflate( &pF->zs, Z_NO_FLUSH );
+		out( pF, pF->zbuf, NPZ_ZBUF - pF->zs.avail_out );
+	    }
+	}
+	return;
+    }
+#endif /* MUD_ZLIB */
+    out( pF, p, n );
+}
+
+
+/*
+ *  npz_end() - finish the array begun: its sizes and CRC into the
+ *  local header
+ */
+static void
+npz_end( NPZ_FILE* pF )
+{
+    NPZ_ENTRY* pEntry;
+    UINT8 b[16];
+    UINT64 nlen;
+#ifdef MUD_ZLIB
+    int status;
+#endif /* MUD_ZLIB */
+
+    if( !pF->zip ) return;
+    pEntry = &pF->entries[pF->nEntries - 1];
+
+#ifdef MUD_ZLIB
+    if( pF->deflate )
+    {
+	do
+	{
+	    pF->zs.next_out = pF->zbuf;
+	    pF->zs.avail_out = NPZ_ZBUF;
+	    status = deflate( &pF->zs, Z_FINISH );
+	    out( pF, pF->zbuf, NPZ_ZBUF - pF->zs.avail_out );
+	} while( status == Z_OK );
+	if( status != Z_STREAM_END ) pF->error = 1;
+	deflateEnd( &pF->zs );
+    }
+#endif /* MUD_ZLIB */
+
+    pEntry->compSize = pF->pos - pEntry->compSize;
+    if( pEntry->compSize >= 0xFFFFFFFFU && !pEntry->zip64 ) pF->error = 1;
+
+    nlen = strlen( pEntry->name );
+    put_32( b, pEntry->crc );
+    if( npz_seek( pF->fout, pEntry->offset + 14 ) != 0 ) pF->error = 1;
+    if( pEntry->zip64 )
+    {
+	if( fwrite( b, 1, 4, pF->fout ) != 4 ) pF->error = 1;
+	put_64( b, pEntry->rawSize );
+	put_64( b + 8, pEntry->compSize );
+	if( npz_seek( pF->fout, pEntry->offset + 34 + nlen ) != 0 ||
+	    fwrite( b, 1, 16, pF->fout ) != 16 ) pF->error = 1;
+    }
+    else
+    {
+	put_32( b + 4, (UINT32)pEntry->compSize );
+	put_32( b + 8, (UINT32)pEntry->rawSize );
+	if( fwrite( b, 1, 12, pF->fout ) != 12 ) pF->error = 1;
+    }
+    if( npz_seek( pF->fout, pF->pos ) != 0 ) pF->error = 1;
+}
+
+
+/*
+ *  npz_close() - write the central directory of a .npz and close the
+ *  file; returns 0 if anything could not be written
+ */
+static int
+npz_close( NPZ_FILE* pF )
+{
+    NPZ_ENTRY* pEntry;
+    UINT8 b[46 + 32 + 28];
+    UINT64 cdOffset, cdSize;
+    int i, nlen, xlen, zip64;
+
+    if( pF->zip )
+    {
+	cdOffset = pF->pos;
+	for( i = 0; i < pF->nEntries; i++ )
+	{
+	    pEntry = &pF->entries[i];
+	    zip64 = pEntry->zip64 || pEntry->offset >= 0xFFFFFFFFU;
+	    nlen = (int)strlen( pEntry->name );
+	    xlen = 0;
+	    bzero( b, sizeof( b ) );
+	    put_32( b, 0x02014B50 );
+	    put_16( b + 4, ( 3 << 8 ) | ( zip64 ? 45 : 20 ) );
+	    put_16( b + 6, zip64 ? 45 : 20 );
+	    put_16( b + 10, pEntry->method );
+	    put_16( b + 12, pF->dosTime );
+	    put_16( b + 14, pF->dosDate );
+	    put_32( b + 16, pEntry->crc );
+	    put_32( b + 20, pEntry->zip64 ? 0xFFFFFFFFU : (UINT32)pEntry->compSize );
+	    put_32( b + 24, pEntry->zip64 ? 0xFFFFFFFFU : (UINT32)pEntry->rawSize );
+	    put_16( b + 28, nlen );
+	    put_32( b + 38, 0100644U << 16 );
+	    put_32( b + 42, ( pEntry->offset >= 0xFFFFFFFFU ) ? 0xFFFFFFFFU : (UINT32)pEntry->offset );
+	    bcopy( pEntry->name, b + 46, nlen );
+	    if( zip64 )
+	    {
+		xlen = 4;
+		if( pEntry->zip64 )
+		{
+		    put_64( b + 46 + nlen + xlen, pEntry->rawSize );
+		    put_64( b + 54 + nlen + xlen, pEntry->compSize );
+		    xlen += 16;
+		}
+		if( pEntry->offset >= 0xFFFFFFFFU )
+		{
+		    put_64( b + 46 + nlen + xlen, pEntry->offset );
+		    xlen += 8;
+		}
+		put_16( b + 46 + nlen, 0x0001 );
+		put_16( b + 48 + nlen, xlen - 4 );
+	    }
+	    put_16( b + 30, xlen );
+	    out( pF, b, 46 + nlen + xlen );
+	}
+	cdSize = pF->pos - cdOffset;
+
+	if( cdOffset >= 0xFFFFFFFFU || cdSize >= 0xFFFFFFFFU )
+	{
+	    /*
+	     *  Zip64 end of central directory, and its locator
+	     */
+	    bzero( b, sizeof( b ) );
+	    put_32( b, 0x06064B50 );
+	    put_64( b + 4, 44 );
+	    put_16( b + 12, ( 3 << 8 ) | 45 );
+	    put_16( b + 14, 45 );
+	    put_64( b + 24, pF->nEntries );
+	    put_64( b + 32, pF->nEntries );
+	    put_64( b + 40, cdSize );
+	    put_64( b + 48, cdOffset );
+	    put_32( b + 56, 0x07064B50 );
+	    put_64( b + 64, pF->pos );
+	    put_32( b + 72, 1 );
+	    out( pF, b, 76 );
+	}
+
+	bzero( b, sizeof( b ) );
+	put_32( b, 0x06054B50 );
+	put_16( b + 8, pF->nEntries );
+	put_16( b + 10, pF->nEntries );
+	put_32( b + 12, ( cdSize >= 0xFFFFFFFFU ) ? 0xFFFFFFFFU : (UINT32)cdSize );
+	put_32( b + 16, ( cdOffset >= 0xFFFFFFFFU ) ? 0xFFFFFFFFU : (UINT32)cdOffset );
+	out( pF, b, 22 );
+    }
+
+    if( fclose( pF->fout ) != 0 ) pF->error = 1;
+    return( !pF->error );
+}
+
+
+/*
+ *  put_array() - a whole array, from memory
+ */
+static void
+put_array( NPZ_FILE* pF, char* name, char* descr, int ndim, UINT64* shape, void* pData, size_t size )
+{
+    if( !npz_begin( pF, name, descr, ndim, shape, size ) )
+    {
+	pF->error = 1;
+	return;
+    }
+    npz_write( pF, pData, size );
+    npz_end( pF );
+}
+
+
+/*
+ *  put_strings() - an array of byte strings (NULL for none), as wide as
+ *  the longest
+ */
+static void
+put_strings( NPZ_FILE* pF, char* name, int ndim, UINT64* shape, char** strs )
+{
+    char descr[24];
+    char* buf;
+    size_t num = 1, width = 1, i, len;
+
+    for( i = 0; i < (size_t)ndim; i++ ) num *= (size_t)shape[i];
+    for( i = 0; i < num; i++ )
+    {
+	if( strs[i] != NULL && ( len = strlen( strs[i] ) ) > width ) width = len;
+    }
+    if( ( buf = (char*)zalloc( num*width + 1 ) ) == NULL )
+    {
+	pF->error = 1;
+	return;
+    }
+    for( i = 0; i < num; i++ )
+    {
+	if( strs[i] != NULL ) bcopy( strs[i], buf + i*width, strlen( strs[i] ) );
+    }
+    snprintf( descr, sizeof( descr ), "|S%lu", (unsigned long)width );
+    put_array( pF, name, descr, ndim, shape, buf, num*width );
+    free( buf );
+}
+
+
+/*
+ *  write_runs() - all arrays (just the counts of a .npy); returns the
+ *  number of runs written, or -1
+ */
+static int
+write_runs( NPZ_FILE* pF, int num, char** files, int nThreads )
+{
+    MUD_EXPORT* pExp;
+    MUD_EXPORT_RUN* pRun;
+    UINT64 shape[3];
+    char descr[8];
+    char** strs = NULL;
+    UINT32* vals = NULL;
+    UINT32* pCounts = NULL;
+    REAL64* reals = NULL;
+    size_t runBytes, nVals;
+    int block, i, j, k, h, status = -1;
+
+    if( ( pExp = MUD_exportOpen( num, files, nThreads ) ) == NULL ) return( -1 );
+
+    /*
+     *  Counts, a block of runs at a time
+     */
+#ifdef MUD_BIG_ENDIAN
+    strcpy( descr, ">u4" );
+#else
+    strcpy( descr, "<u4" );
+#endif /* MUD_BIG_ENDIAN */
+    runBytes = (size_t)pExp->maxHists*pExp->maxBins*sizeof( UINT32 );
+    block = MUD_exportBlock( pExp );
+    if( ( pCounts = (UINT32*)malloc( block*runBytes + 1 ) ) == NULL ) goto done;
+
+    shape[0] = pExp->nRuns;
+    shape[1] = pExp->maxHists;
+    shape[2] = pExp->maxBins;
+    if( !npz_begin( pF, "counts", descr, 3, shape, (UINT64)pExp->nRuns*runBytes ) ) goto done;
+    for( i = 0; i < pExp->nRuns && runBytes > 0; i += block )
+    {
+	k = _min( block, pExp->nRuns - i );
+	MUD_exportCounts( pExp, i, k, pCounts );
+	npz_write( pF, pCounts, k*runBytes );
+	if( pF->error ) goto done;
+    }
+    npz_end( pF );
+
+    if( pF->zip )
+    {
+	/*
+	 *  Histogram headers
+	 */
+	nVals = (size_t)pExp->nRuns*_max( pExp->maxHists, 1 ) + 1;
+	if( ( vals = (UINT32*)zalloc( nVals*sizeof( UINT32 ) ) ) == NULL ||
+	    ( strs = (char**)zalloc( nVals*sizeof( char* ) ) ) == NULL ||
+	    ( reals = (REAL64*)zalloc( ( pExp->nRuns + 1 )*sizeof( REAL64 ) ) ) == NULL ) goto done;
+	for( k = 0; k < MUD_EXP_NHISTVALS; k++ )
+	{
+	    for( j = 0; j < pExp->nRuns; j++ )
+	    {
+		pRun = &pExp->pRuns[j];
+		for( h = 0; h < (int)pExp->maxHists; h++ )
+		{
+		    vals[(size_t)j*pExp->maxHists + h] = ( h < (int)pRun->nHists ) ?
+			pRun->pHistVals[h*MUD_EXP_NHISTVALS + k] : 0;
+		}
+	    }
+	    put_array( pF, MUD_exportHistValName( k ), descr, 2, shape,
+		       vals, (size_t)pExp->nRuns*pExp->maxHists*sizeof( UINT32 ) );
+	}
+	for( j = 0; j < pExp->nRuns; j++ )
+	{
+	    pRun = &pExp->pRuns[j];
+	    for( h = 0; h < (int)pExp->maxHists; h++ )
+	    {
+		strs[(size_t)j*pExp->maxHists + h] = ( h < (int)pRun->nHists ) ?
+		    pRun->pHistTitles[h] : NULL;
+	    }
+	}
+	put_strings( pF, "hist_title", 2, shape, strs );
+
+	/*
+	 *  Run descriptions
+	 */
+	for( k = 0; k < MUD_EXP_NVALS; k++ )
+	{
+	    for( j = 0; j < pExp->nRuns; j++ ) vals[j] = pExp->pRuns[j].val[k];
+	    put_array( pF, MUD_exportValName( k ), descr, 1, shape,
+		       vals, pExp->nRuns*sizeof( UINT32 ) );
+	}
+#ifdef MUD_BIG_ENDIAN
+	strcpy( descr, ">f8" );
+#else
+	strcpy( descr, "<f8" );
+#endif /* MUD_BIG_ENDIAN */
+	for( j = 0; j < pExp->nRuns; j++ ) reals[j] = pExp->pRuns[j].tempK;
+	put_array( pF, "temperature_k", descr, 1, shape, reals, pExp->nRuns*sizeof( REAL64 ) );
+	for( j = 0; j < pExp->nRuns; j++ ) reals[j] = pExp->pRuns[j].fieldG;
+	put_array( pF, "field_g", descr, 1, shape, reals, pExp->nRuns*sizeof( REAL64 ) );
+	for( k = 0; k < MUD_SHM_NSTR; k++ )
+	{
+	    for( j = 0; j < pExp->nRuns; j++ ) strs[j] = pExp->pRuns[j].str[k];
+	    put_strings( pF, MUD_exportStrName( k ), 1, shape, strs );
+	}
+    }
+    if( !pF->error ) status = pExp->nRuns;
+
+done:
+    MUD_exportClose( pExp );
+    _free( pCounts );
+    _free( vals );
+    _free( strs );
+    _free( reals );
+    return( status );
+}
+
+
+/*
+ *  MUD_writeNpz() - write runs into a .npz file (see above); flags are
+ *  MUD_NPZ_DEFLATE or 0.  Returns the number of runs written, or -1 if
+ *  the file cannot be written.
+ */
+int
+MUD_writeNpz( char* filename, int num, char** files, int flags, int nThreads )
+{
+    NPZ_FILE* pF;
+    struct tm* tm;
+    time_t now;
+    int status;
+
+#ifndef MUD_ZLIB
+    if( flags & MUD_NPZ_DEFLATE ) return( -1 );
+#endif /* !MUD_ZLIB */
+    if( ( pF = (NPZ_FILE*)zalloc( sizeof( NPZ_FILE ) ) ) == NULL ) return( -1 );
+    if( ( pF->fout = fopen( filename, "wb" ) ) == NULL )
+    {
+	free( pF );
+	return( -1 );
+    }
+    pF->zip = 1;
+    pF->deflate = ( flags & MUD_NPZ_DEFLATE ) != 0;
+
+    now = time( NULL );
+    if( ( tm = localtime( &now ) ) != NULL && tm->tm_year >= 80 )
+    {
+	pF->dosTime = (UINT16)( ( tm->tm_hour << 11 ) | ( tm->tm_min << 5 ) | ( tm->tm_sec/2 ) );
+	pF->dosDate = (UINT16)( ( ( tm->tm_year - 80 ) << 9 ) | ( ( tm->tm_mon + 1 ) << 5 ) | tm->tm_mday );
+    }
+
+    status = write_runs( pF, num, files, nThreads );
+    if( !npz_close( pF ) ) status = -1;
+    free( pF );
+    if( status < 0 ) remove( filename );
+    return( status );
+}
+
+
+/*
+ *  MUD_writeNpy() - write the counts of runs, uint32 (runs, histograms,
+ *  bins), into a .npy file.  Returns the number of runs written, or -1.
+ */
+int
+MUD_writeNpy( char* filename, int num, char** files, int nThreads )
+{
+    NPZ_FILE* pF;
+    int status;
+
+    if( ( pF = (NPZ_FILE*)zalloc( sizeof( NPZ_FILE ) ) ) == NULL ) return( -1 );
+    if( ( pF->fout = fopen( filename, "wb" ) ) == NULL )
+    {
+	free( pF );
+	return( -1 );
+    }
+    status = write_runs( pF, num, files, nThreads );
+    if( !npz_close( pF ) ) status = -1;
+    free( pF );
+    if( status < 0 ) remove( filename );
+    return( status );
+}
@@ -0,0 +1,266 @@
+/*
+ *  mud_quantity.c -- parsing the temperature and field strings of a run
+ *                    description into numbers
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version
+ *
+ *  Description:
+ *    The temperature and field of a run are free-form strings, such as
+ *    "290.0K", "10.0(1)K", "50 mK", "100.5(2)G", "0.5 T" or "ZF".
+ *    MUD_parseQuantity() reads the first number in the string, an
+ *    uncertainty, either in parentheses in units of the last digit
+ *    ("10.0(1)" is 10.0 +- 0.1; "290(0.5)", with a point, is absolute)
+ *    or after "+/-" or a plus-minus sign, and a unit, and converts the
+ *    value and uncertainty to kelvin (MUD_QTY_TEMPERATURE) or gauss
+ *    (MUD_QTY_FIELD).  It returns MUD_QTY_ flags telling what was found:
+ *
+ *      MUD_QTY_VALUE     a number (else the value is 0)
+ *      MUD_QTY_ERROR     an uncertainty (else it is 0)
+ *      MUD_QTY_UNIT      a unit, which was converted
+ *      MUD_QTY_BADUNIT   a word that is not a unit of the kind; the
+ *                        value is as written
+ *      MUD_QTY_EXTRA     other text, ignored
+ *
+ *    A number with no unit is taken to be in kelvin or gauss already.
+ *    For a field, "ZF" or "zero" alone stands for 0 G.
+ */
+
+#include <ctype.h>
+#include <math.h>
+#include "mud.h"
+
+#define QTY_MAXUNIT	16
+
+typedef struct {
+    char*	name;
+    int		kind;
+    int		anyCase;	/* match the name in any case */
+    double	factor;		/* to K or G */
+    double	offset;		/* added after the factor */
+} QTY_UNIT;
+
+static QTY_UNIT units[] = {
+    { "K",		MUD_QTY_TEMPERATURE,	0,	1.0,	0.0 },
+    { "mK",		MUD_QTY_TEMPERATURE,	0,	1.0e-3,	0.0 },
+    { "uK",		MUD_QTY_TEMPERATURE,	0,	1.0e-6,	0.0 },
+    { "C",		MUD_QTY_TEMPERATURE,	0,	1.0,	273.15 },
+    { "degC",		MUD_QTY_TEMPERATURE,	1,	1.0,	273.15 },
+    { "kelvin",		MUD_QTY_TEMPERATURE,	1,	1.0,	0.0 },
+    { "G",		MUD_QTY_FIELD,		0,	1.0,	0.0 },
+    { "kG",		MUD_QTY_FIELD,		0,	1.0e3,	0.0 },
+    { "mG",		MUD_QTY_FIELD,		0,	1.0e-3,	0.0 },
+    { "T",		MUD_QTY_FIELD,		0,	1.0e4,	0.0 },
+    { "mT",		MUD_QTY_FIELD,		0,	10.0,	0.0 },
+    { "uT",		MUD_QTY_FIELD,		0,	1.0e-2,	0.0 },
+    { "Oe",		MUD_QTY_FIELD,		1,	1.0,	0.0 },
+    { "kOe",		MUD_QTY_FIELD,		1,	1.0e3,	0.0 },
+    { "gauss",		MUD_QTY_FIELD,		1,	1.0,	0.0 },
+    { "kgauss",		MUD_QTY_FIELD,		1,	1.0e3,	0.0 },
+    { "tesla",		MUD_QTY_FIELD,		1,	1.0e4,	0.0 }
+};
+
+static int number_at _ANSI_ARGS_(( char* p ));
+static char* parse_number _ANSI_ARGS_(( char* p, double* pValue, int* pNumFrac ));
+static int same_word _ANSI_ARGS_(( char* s, char* word ));
+static QTY_UNIT* find_unit _ANSI_ARGS_(( char* name, int kind ));
+
+
+/*
+ *  number_at() - whether a number starts at p
+ */
+static int
+number_at( char* p )
+{
+    if( *p == '+' || *p == '-' ) p++;
+    if( *p == '.' ) p++;
+    return( isdigit( (unsigned char)*p ) );
+}
+
+
+/*
+ *  parse_number() - digits with an optional sign and decimal point (no
+ *  exponent); *pNumFrac is the number of digits after the point.
+ *  Returns the end of the number.
+ */
+static char*
+parse_number( char* p, double* pValue, int* pNumFrac )
+{
+    char buf[64];
+    char* start = p;
+    int n;
+
+    *pNumFrac = 0;
+    if( *p == '+' || *p == '-' ) p++;
+    while( isdigit( (unsigned char)*p ) ) p++;
+    if( *p == '.' )
+    {
+	for( p++; isdigit( (unsigned char)*p ); p++ ) ( *pNumFrac )++;
+    }
+    n = _min( (int)( p - start ), (int)sizeof( buf ) - 1 );
+    bcopy( start, buf, n );
+    buf[n] = '\0';
+    *pValue = atof( buf );
+    return( p );
+}
+
+
+static int
+same_word( char* s, char* word )
+{
+    for( ; *s != '\0' && *word != '\0'; s++, word++ )
+    {
+	if( tolower( (unsigned char)*s ) != tolower( (unsigned char)*word ) ) return( 0 );
+    }
+    return( *s == '\0' && *word == '\0' );
+}
+
+
+static QTY_UNIT*
+find_unit( char* name, int kind )
+{
+    int i, n = (int)( sizeof( units )/sizeof( QTY_UNIT ) );
+
+    for( i = 0; i < n; i++ )
+    {
+	if( units[i].kind == kind && strcmp( units[i].name, name ) == 0 ) return( &units[i] );
+    }
+    for( i = 0; i < n; i++ )
+    {
+	if( units[i].kind == kind && units[i].anyCase && same_word( name, units[i].name ) )
+	    return( &units[i] );
+    }
+    return( NULL );
+}
+
+
+/*
+ *  MUD_parseQuantity() - value and uncertainty (in K or G, by kind) of a
+ *  temperature or field string; returns MUD_QTY_ flags, 0 if there is
+ *  no number.
+ */
+int
+MUD_parseQuantity( char* s, int kind, REAL64* pValue, REAL64* pError )
+{
+    QTY_UNIT* pUnit;
+    char unit[QTY_MAXUNIT+1];
+    char* p;
+    char* q;
+    char* end;
+    double value, error = 0.0, scale;
+    int status = MUD_QTY_VALUE, nFrac, nErrFrac, n;
+
+    *pValue = 0.0;
+    *pError = 0.0;
+    if( s == NULL ) return( 0 );
+
+    /*
+     *  The first number; a field may be given as zero
+     */
+    for( p = s; isspace( (unsigned char)*p ); p++ ) ;
+    for( q = p; *q != '\0' && !number_at( q ); q++ ) ;
+    if( *q == '\0' )
+    {
+	for( end = q; end > p && isspace( (unsigned char)*( end - 1 ) ); end-- ) ;
+	n = (int)( end - p );
+	if( kind == MUD_QTY_FIELD && ( ( n == 2 && strncmp( p, "ZF", 2 ) == 0 ) ||
+				       ( n == 4 && strncmp( p, "zero", 4 ) == 0 ) ||
+				       ( n == 4 && strncmp( p, "Zero", 4 ) == 0 ) ) )
+	    return( MUD_QTY_VALUE );
+	return( 0 );
+    }
+    if( q != p ) status |= MUD_QTY_EXTRA;
+    p = parse_number( q, &value, &nFrac );
+
+    /*
+     *  "(d)" in units of the last digit, or "(x.y)" absolute
+     */
+    if( *p == '(' && ( isdigit( (unsigned char)p[1] ) || p[1] == '.' ) )
+    {
+	q = parse_number( p + 1, &error, &nErrFrac );
+	if( *q == ')' )
+	{
+	    if( memchr( p + 1, '.', q - p - 1 ) == NULL ) error *= pow( 10.0, -nFrac );
+	    status |= MUD_QTY_ERROR;
+	    p = q + 1;
+	}
+	else
+	{
+	    error = 0.0;
+	}
+    }
+
+    /*
+     *  An exponent, which applies to both
+     */
+    if( ( *p == 'e' || *p == 'E' ) && ( isdigit( (unsigned char)p[1] ) ||
+	( ( p[1] == '+' || p[1] == '-' ) && isdigit( (unsigned char)p[2] ) ) ) )
+    {
+	scale = pow( 10.0, (double)strtol( p + 1, &end, 10 ) );
+	value *= scale;
+	error *= scale;
+	p = end;
+    }
+
+    /*
+     *  "+/-" or a plus-minus sign (UTF-8 or Latin-1), then a number
+     */
+    for( q = p; isspace( (unsigned char)*q ); q++ ) ;
+    n = ( strncmp( q, "+/-", 3 ) == 0 ) ? 3 :
+	( strncmp( q, "+-", 2 ) == 0 || strncmp( q, "\302\261", 2 ) == 0 ) ? 2 :
+	( (unsigned char)*q == 0xB1 ) ? 1 : 0;
+    if( n > 0 && !( status & MUD_QTY_ERROR ) )
+    {
+	for( q += n; isspace( (unsigned char)*q ); q++ ) ;
+	if( number_at( q ) )
+	{
+	    error = fabs( strtod( q, &end ) );
+	    status |= MUD_QTY_ERROR;
+	    p = end;
+	}
+    }
+
+    /*
+     *  The unit: letters, perhaps after a degree sign
+     */
+    for( ; isspace( (unsigned char)*p ); p++ ) ;
+    if( strncmp( p, "\302\260", 2 ) == 0 ) p += 2;
+    else if( (unsigned char)*p == 0xB0 ) p++;
+    for( n = 0; isalpha( (unsigned char)*p ); p++ )
+    {
+	if( n < QTY_MAXUNIT ) unit[n++] = *p;
+    }
+    unit[n] = '\0';
+    if( n > 0 )
+    {
+	if( ( pUnit = find_unit( unit, kind ) ) != NULL )
+	{
+	    value = value*pUnit->factor + pUnit->offset;
+	    error *= pUnit->factor;
+	    status |= MUD_QTY_UNIT;
+	}
+	else
+	{
+	    status |= MUD_QTY_BADUNIT;
+	}
+    }
+
+    for( ; isspace( (unsigned char)*p ); p++ ) ;
+    if( *p != '\0' ) status |= MUD_QTY_EXTRA;
+
+    *pValue = value;
+    *pError = fabs( error );
+    return( status );
+}
@@ -0,0 +1,357 @@
+/*
+ *  mud_runcache.c -- process-wide cache of decoded runs, shared by
+ *                    read-only opens of the same file
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version
+ *
+ *  Description:
+ *    The cache is off unless it is given a memory budget, by
+ *    MUD_setRunCacheSize() or the environment variable MUD_RUN_CACHE_MB.
+ *    Then MUD_openRead() keeps the decoded tree of every run it reads
+ *    (MUD_SEC_GRP, with its histogram cache if one is in use, see
+ *    mud_histcache.c), and a later MUD_openRead() of the same path just
+ *    hands out the same tree, reference counted, on a read-only fd.  A
+ *    hit costs a hash lookup and a stat() of the file.
+ *
+ *    A cached run is only used while the file still has the same
+ *    device, inode, size and modification time; otherwise it is dropped
+ *    (once no fd refers to it) and the file is read again.
+ *
+ *    Runs are charged at their file size, which is close to the memory
+ *    the decoded tree takes.  When the total exceeds the budget, the
+ *    least recently used runs that are not open are freed.  Runs that
+ *    are open are never freed, so the budget can be exceeded for a
+ *    while by many open files.
+ *
+ *    While the cache is on, fds from MUD_openRead() are read-only: the
+ *    MUD_set* routines fail, and MUD_closeWrite() and MUD_closeWriteFile()
+ *    just close the fd and return 0.  MUD_openReadWrite() is not affected.
+ *    A run taken from the cache keeps the histogram cache it was read
+ *    with, if any.
+ *
+ *    Like the rest of the friendly interface, the cache is not thread
+ *    safe.
+ */
+
+#include "mud.h"
+#include <sys/stat.h>
+
+#define RC_HASH_SIZE	1024	/* a power of 2 */
+
+static MUD_CACHED_RUN* pHash[RC_HASH_SIZE];
+static MUD_CACHED_RUN* pNewest = NULL;	/* LRU list */
+static MUD_CACHED_RUN* pOldest = NULL;
+static int budgetSet = 0;
+static size_t maxBytes = 0;
+static size_t numBytes = 0;
+static UINT32 numRuns = 0;
+static UINT32 numHits = 0;
+static UINT32 numMisses = 0;
+
+static int get_print _ANSI_ARGS_(( char* path, FILE* fin, UINT64* pPrint ));
+static UINT32 hash_path _ANSI_ARGS_(( char* path ));
+static void unlink_run _ANSI_ARGS_(( MUD_CACHED_RUN* pRun ));
+static void free_run _ANSI_ARGS_(( MUD_CACHED_RUN* pRun ));
+static void trim _ANSI_ARGS_(( void ));
+
+
+/*
+ *  MUD_setRunCacheSize() - memory budget of the cache, in bytes; 0 turns
+ *  it off (runs already cached and not open are freed).
+ */
+void
+MUD_setRunCacheSize( size_t bytes )
+{
+    maxBytes = bytes;
+    budgetSet = 1;
+    trim();
+}
+
+
+/*
+ *  MUD_getRunCacheSize() - the budget in use; the first call takes it
+ *  from MUD_RUN_CACHE_MB (megabytes), unless it has been set.
+ */
+size_t
+MUD_getRunCacheSize( void )
+{
+    char* s;
+
+    if( !budgetSet )
+    {
+	s = getenv( "MUD_RUN_CACHE_MB" );
+	maxBytes = ( s != NULL && atof( s ) > 0.0 ) ? (size_t)( atof( s )*1048576.0 ) : 0;
+	budgetSet = 1;
+    }
+    return( maxBytes );
+}
+
+
+/*
+ *  MUD_runCacheStats() - runs held, bytes charged for them, and the hits
+ *  and misses of MUD_runCacheGet() so far; any pointer may be NULL
+ */
+void
+MUD_runCacheStats( UINT32* pNum, size_t* pBytes, UINT32* pHits, UINT32* pMisses )
+{
+    if( pNum != NULL ) *pNum = numRuns;
+    if( pBytes != NULL ) *pBytes = numBytes;
+    if( pHits != NULL ) *pHits = numHits;
+    if( pMisses != NULL ) *pMisses = numMisses;
+}
+
+
+/*
+ *  get_print() - device, inode, size and modification time (ns) of a
+ *  file (of the open file fin, if not NULL); returns 0 if it cannot be
+ *  examined.
+ */
+static int
+get_print( char* path, FILE* fin, UINT64* pPrint )
+{
+    struct stat st;
+
+    if( ( fin != NULL ) ? fstat( fileno( fin ), &st ) : stat( path, &st ) ) return( 0 );
+    pPrint[0] = (UINT64)st.st_dev;
+    pPrint[1] = (UINT64)st.st_ino;
+    pPrint[2] = (UINT64)st.st_size;
+#if defined(__linux__)
+    pPrint[3] = (UINT64)st.st_mtim.tv_sec*1000000000 + (UINT64)st.st_mtim.tv_nsec;
+#else
+    pPrint[3] = (UINT64)st.st_mtime*1000000000;
+#endif /* __linux__ */
+    return( 1 );
+}
+
+
+static UINT32
+hash_path( char* path )
+{
+    UINT32 h = 2166136261U;
+
+    for( ; *path != '\0'; path++ )
+    {
+	h ^= (UINT8)*path;
+	h *= 16777619U;
+    }
+    return( h & ( RC_HASH_SIZE - 1 ) );
+}
+
+
+/*
+ *  unlink_run() - take a run out of the hash table and the LRU list,
+ *  so it can no longer be found; it is freed when no longer open.
+ */
+static void
+unlink_run( MUD_CACHED_RUN* pRun )
+{
+    MUD_CACHED_RUN** ppRun;
+
+    if( pRun->stale ) return;
+    for( ppRun = &pHash[hash_path( pRun->path )]; *ppRun != NULL; ppRun = &(*ppRun)->pNext )
+    {
+	if( *ppRun == pRun )
+	{
+	    *ppRun = pRun->pNext;
+	    break;
+	}
+    }
+    if( pRun->pNewer != NULL ) pRun->pNewer->pOlder = pRun->pOlder;
+    else pNewest = pRun->pOlder;
+    if( pRun->pOlder != NULL ) pRun->pOlder->pNewer = pRun->pNewer;
+    else pOldest = pRun->pNewer;
+    pRun->pNext = pRun->pNewer = pRun->pOlder = NULL;
+    pRun->stale = 1;
+    numBytes -= (size_t)pRun->size;
+    numRuns--;
+}
+
+
+static void
+free_run( MUD_CACHED_RUN* pRun )
+{
+    MUD_free( pRun->pMUD_fileGrp );
+    MUD_histCacheClose( pRun->pHistCache );
+    _free( pRun->path );
+    free( pRun );
+}
+
+
+/*
+ *  trim() - free the least recently used runs that are not open until
+ *  the total is within the budget
+ */
+static void
+trim( void )
+{
+    MUD_CACHED_RUN* pRun;
+    MUD_CACHED_RUN* pNewer;
+
+    for( pRun = pOldest; pRun != NULL && numBytes > MUD_getRunCacheSize(); pRun = pNewer )
+    {
+	pNewer = pRun->pNewer;
+	if( pRun->refs > 0 ) continue;
+	unlink_run( pRun );
+	free_run( pRun );
+    }
+}
+
+
+/*
+ *  MUD_runCacheGet() - the cached run of path, if it is still up to date,
+ *  with one more reference; NULL if there is none.
+ */
+MUD_CACHED_RUN*
+MUD_runCacheGet( char* path )
+{
+    MUD_CACHED_RUN* pRun;
+    UINT64 print[4];
+
+    if( numRuns == 0 )
+    {
+	numMisses++;
+	return( NULL );
+    }
+
+    for( pRun = pHash[hash_path( path )]; pRun != NULL; pRun = pRun->pNext )
+    {
+	if( strcmp( pRun->path, path ) == 0 ) break;
+    }
+    if( pRun == NULL )
+    {
+	numMisses++;
+	return( NULL );
+    }
+
+    if( !get_print( path, NULL, print ) || print[0] != pRun->dev || print[1] != pRun->ino ||
+	print[2] != pRun->size || print[3] != pRun->mtime )
+    {
+	unlink_run( pRun );
+	if( pRun->refs == 0 ) free_run( pRun );
+	numMisses++;
+	return( NULL );
+    }
+
+    /*
+     *  To the head of the LRU list
+     */
+    if( pRun != pNewest )
+    {
+	pRun->pNewer->pOlder = pRun->pOlder;
+	if( pRun->pOlder != NULL ) pRun->pOlder->pNewer = pRun->pNewer;
+	else pOldest = pRun->pNewer;
+	pRun->pOlder = pNewest;
+	pRun->pNewer = NULL;
+	pNewest->pNewer = pRun;
+	pNewest = pRun;
+    }
+
+    pRun->refs++;
+    numHits++;
+    return( pRun );
+}
+
+
+/*
+ *  MUD_runCachePut() - add the run of path, read (fully) from the open
+ *  file fin into pMUD_fileGrp, with its histogram cache pHistCache (or
+ *  NULL), and return it with one reference.  The cache then owns the
+ *  tree and the histogram cache.  Returns NULL, leaving them to the
+ *  caller, if the cache is off or the run is too big for it.
+ */
+MUD_CACHED_RUN*
+MUD_runCachePut( char* path, FILE* fin, MUD_SEC_GRP* pMUD_fileGrp, MUD_HIST_CACHE* pHistCache )
+{
+    MUD_CACHED_RUN* pRun;
+    MUD_CACHED_RUN* pOld;
+    UINT64 print[4];
+    UINT32 h;
+
+    if( MUD_getRunCacheSize() == 0 ) return( NULL );
+    if( !get_print( path, fin, print ) || print[2] > (UINT64)maxBytes ) return( NULL );
+
+    if( ( pRun = (MUD_CACHED_RUN*)zalloc( sizeof( MUD_CACHED_RUN ) ) ) == NULL ) return( NULL );
+    if( ( pRun->path = strdup( path ) ) == NULL )
+    {
+	free( pRun );
+	return( NULL );
+    }
+    pRun->dev = print[0];
+    pRun->ino = print[1];
+    pRun->size = print[2];
+    pRun->mtime = print[3];
+    pRun->pMUD_fileGrp = pMUD_fileGrp;
+    pRun->pHistCache = pHistCache;
+    pRun->refs = 1;
+
+    /*
+     *  A run of the same path is out of date
+     */
+    h = hash_path( path );
+    for( pOld = pHash[h]; pOld != NULL; pOld = pOld->pNext )
+    {
+	if( strcmp( pOld->path, path ) == 0 ) break;
+    }
+    if( pOld != NULL )
+    {
+	unlink_run( pOld );
+	if( pOld->refs == 0 ) free_run( pOld );
+    }
+
+    pRun->pNext = pHash[h];
+    pHash[h] = pRun;
+    pRun->pOlder = pNewest;
+    if( pNewest != NULL ) pNewest->pNewer = pRun;
+    else pOldest = pRun;
+    pNewest = pRun;
+    numBytes += (size_t)pRun->size;
+    numRuns++;
+
+    trim();
+    return( pRun );
+}
+
+
+/*
+ *  MUD_runCacheRelease() - drop a reference to a run from MUD_runCacheGet
+ *  or MUD_runCachePut
+ */
+void
+MUD_runCacheRelease( MUD_CACHED_RUN* pRun )
+{
+    if( pRun == NULL || --pRun->refs > 0 ) return;
+    if( pRun->stale ) free_run( pRun );
+    else trim();
+}
+
+
+/*
+ *  MUD_runCacheFlush() - free every cached run that is not open
+ */
+void
+MUD_runCacheFlush( void )
+{
+    MUD_CACHED_RUN* pRun;
+    MUD_CACHED_RUN* pNewer;
+
+    for( pRun = pOldest; pRun != NULL; pRun = pNewer )
+    {
+	pNewer = pRun->pNewer;
+	if( pRun->refs > 0 ) continue;
+	unlink_run( pRun );
+	free_run( pRun );
+    }
+}
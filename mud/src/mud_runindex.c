@@ -0,0 +1,406 @@
+/*
+ *  mud_runindex.c -- index of runs by experiment and run number, for
+ *                    finding the file of a run without scanning directories
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version
+ *
+ *  Description:
+ *    The run index is written from a run catalog (see mud_catalog.c),
+ *    which already has the experiment number, run number, start time and
+ *    path of every run, and is kept up to date there.  It is a small file
+ *    meant to be mapped into memory, and looked up by binary search:
+ *
+ *      RI_HEADER             32 bytes: "MUDRUNIX", version, byte-order
+ *                            mark, nRuns, pathBytes
+ *      nRuns x MUD_RUNINDEX_ENTRY   16 bytes each: exptNumber,
+ *                            runNumber, timeBegin, offset of the path;
+ *                            sorted by those three
+ *      nRuns x UINT32        the entries again, by run number, start time
+ *                            and experiment (for a run of any experiment,
+ *                            or of a year)
+ *      paths                 pathBytes of nul-terminated paths
+ *
+ *    The file is in the byte order of the machine that wrote it; an
+ *    index from another byte order is not read (write it again here).
+ *
+ *    A run number may be in the index more than once (the same number
+ *    in different experiments or years, or copies of a run); a lookup
+ *    gives the latest run that matches.  MUD_openRun() is MUD_openRead()
+ *    by run number, with the index named by MUD_setRunIndex() or the
+ *    environment variable MUD_RUN_INDEX, which is mapped once and kept.
+ */
+
+#include <time.h>
+#include "mud.h"
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif /* _WIN32 */
+
+#define RI_MAGIC	"MUDRUNIX"
+#define RI_VERSION	1
+#define RI_BYTE_ORDER	0x01020304
+
+typedef struct {
+    char	magic[8];
+    UINT32	version;
+    UINT32	byteOrder;	/* RI_BYTE_ORDER as written */
+    UINT32	nRuns;
+    UINT32	pathBytes;
+    UINT32	spare[2];
+} RI_HEADER;
+
+typedef struct {
+    UINT32	runNumber;
+    UINT32	timeBegin;
+    UINT32	entry;
+} RI_ORDER;
+
+static char* indexName = NULL;
+static MUD_RUNINDEX* pOpenIdx = NULL;	/* for MUD_openRun */
+
+static int cmp_entries _ANSI_ARGS_(( const void* p1, const void* p2 ));
+static int cmp_by_run _ANSI_ARGS_(( const void* p1, const void* p2 ));
+static int entry_year _ANSI_ARGS_(( MUD_RUNINDEX_ENTRY* pEntry ));
+
+
+static int
+cmp_entries( const void* p1, const void* p2 )
+{
+    MUD_RUNINDEX_ENTRY* pE1 = (MUD_RUNINDEX_ENTRY*)p1;
+    MUD_RUNINDEX_ENTRY* pE2 = (MUD_RUNINDEX_ENTRY*)p2;
+
+    if( pE1->exptNumber != pE2->exptNumber ) return( ( pE1->exptNumber < pE2->exptNumber ) ? -1 : 1 );
+    if( pE1->runNumber != pE2->runNumber ) return( ( pE1->runNumber < pE2->runNumber ) ? -1 : 1 );
+    if( pE1->timeBegin != pE2->timeBegin ) return( ( pE1->timeBegin < pE2->timeBegin ) ? -1 : 1 );
+    return( ( pE1->pathOffset < pE2->pathOffset ) ? -1 : ( pE1->pathOffset > pE2->pathOffset ) );
+}
+
+
+static int
+cmp_by_run( const void* p1, const void* p2 )
+{
+    RI_ORDER* pO1 = (RI_ORDER*)p1;
+    RI_ORDER* pO2 = (RI_ORDER*)p2;
+
+    if( pO1->runNumber != pO2->runNumber ) return( ( pO1->runNumber < pO2->runNumber ) ? -1 : 1 );
+    if( pO1->timeBegin != pO2->timeBegin ) return( ( pO1->timeBegin < pO2->timeBegin ) ? -1 : 1 );
+    return( ( pO1->entry < pO2->entry ) ? -1 : ( pO1->entry > pO2->entry ) );
+}
+
+
+/*
+ *  MUD_runIndexWrite() - write the run index of a catalog; returns the
+ *  number of runs, or -1 if the index cannot be written.
+ */
+int
+MUD_runIndexWrite( MUD_CATALOG* pCat, char* idxname )
+{
+    MUD_RUNINDEX_ENTRY* pEntries = NULL;
+    RI_ORDER* pOrder = NULL;
+    UINT32* pByRun = NULL;
+    UINT32* pPathOff = NULL;
+    RI_HEADER hdr;
+    char* tmpname = NULL;
+    char* path;
+    FILE* fout = NULL;
+    UINT32 r, s, pathBytes = 0;
+    int status = 0;
+
+    /*
+     *  Each path once, numbered as the catalog strings
+     */
+    pEntries = (MUD_RUNINDEX_ENTRY*)zalloc( ( pCat->num + 1 )*sizeof( MUD_RUNINDEX_ENTRY ) );
+    pOrder = (RI_ORDER*)zalloc( ( pCat->num + 1 )*sizeof( RI_ORDER ) );
+    pByRun = (UINT32*)zalloc( ( pCat->num + 1 )*sizeof( UINT32 ) );
+    pPathOff = (UINT32*)zalloc( ( pCat->nStrings + 1 )*sizeof( UINT32 ) );
+    if( pEntries == NULL || pOrder == NULL || pByRun == NULL || pPathOff == NULL ) goto done;
+    for( r = 0; r < pCat->num; r++ )
+    {
+	s = ((UINT32*)pCat->pCols[MUD_CAT_PATH])[r];
+	if( pPathOff[s] == 0 )
+	{
+	    pPathOff[s] = pathBytes + 1;
+	    pathBytes += strlen( MUD_catalogString( pCat, r, MUD_CAT_PATH ) ) + 1;
+	}
+	pEntries[r].exptNumber = ((UINT32*)pCat->pCols[MUD_CAT_EXPT])[r];
+	pEntries[r].runNumber = ((UINT32*)pCat->pCols[MUD_CAT_RUN])[r];
+	pEntries[r].timeBegin = ((UINT32*)pCat->pCols[MUD_CAT_TIME_BEGIN])[r];
+	pEntries[r].pathOffset = pPathOff[s] - 1;
+    }
+
+    if( pCat->num > 1 ) qsort( pEntries, pCat->num, sizeof( MUD_RUNINDEX_ENTRY ), cmp_entries );
+    for( r = 0; r < pCat->num; r++ )
+    {
+	pOrder[r].runNumber = pEntries[r].runNumber;
+	pOrder[r].timeBegin = pEntries[r].timeBegin;
+	pOrder[r].entry = r;
+    }
+    if( pCat->num > 1 ) qsort( pOrder, pCat->num, sizeof( RI_ORDER ), cmp_by_run );
+    for( r = 0; r < pCat->num; r++ ) pByRun[r] = pOrder[r].entry;
+
+    bzero( &hdr, sizeof( hdr ) );
+    bcopy( RI_MAGIC, hdr.magic, 8 );
+    hdr.version = RI_VERSION;
+    hdr.byteOrder = RI_BYTE_ORDER;
+    hdr.nRuns = pCat->num;
+    hdr.pathBytes = pathBytes;
+
+    if( ( tmpname = (char*)malloc( strlen( idxname ) + 24 ) ) == NULL ) goto done;
+    sprintf( tmpname, "%s.%lu.tmp", idxname, (unsigned long)getpid() );
+    if( ( fout = fopen( tmpname, "wb" ) ) == NULL ) goto done;
+
+    status = ( fwrite( &hdr, sizeof( hdr ), 1, fout ) == 1 &&
+	       fwrite( pEntries, sizeof( MUD_RUNINDEX_ENTRY ), pCat->num, fout ) == pCat->num &&
+	       fwrite( pByRun, sizeof( UINT32 ), pCat->num, fout ) == pCat->num );
+
+    /*
+     *  The paths, in the order they were numbered
+     */
+    bzero( pPathOff, ( pCat->nStrings + 1 )*sizeof( UINT32 ) );
+    for( r = 0; status && r < pCat->num; r++ )
+    {
+	s = ((UINT32*)pCat->pCols[MUD_CAT_PATH])[r];
+	if( pPathOff[s] != 0 ) continue;
+	pPathOff[s] = 1;
+	path = MUD_catalogString( pCat, r, MUD_CAT_PATH );
+	status = ( fwrite( path, strlen( path ) + 1, 1, fout ) == 1 );
+    }
+    if( fclose( fout ) != 0 ) status = 0;
+
+    if( status )
+    {
+#ifdef _WIN32
+	remove( idxname );
+#endif /* _WIN32 */
+	status = ( rename( tmpname, idxname ) == 0 );
+    }
+    if( !status ) remove( tmpname );
+
+done:
+    _free( tmpname );
+    _free( pPathOff );
+    _free( pByRun );
+    _free( pOrder );
+    _free( pEntries );
+    return( status ? (int)hdr.nRuns : -1 );
+}
+
+
+/*
+ *  MUD_runIndexOpen() - map the run index; NULL if it cannot be read
+ */
+MUD_RUNINDEX*
+MUD_runIndexOpen( char* idxname )
+{
+    MUD_RUNINDEX* pIdx;
+    RI_HEADER* pHdr;
+    UINT32 i;
+#ifdef _WIN32
+    FILE* fin;
+    long size;
+
+    if( ( fin = fopen( idxname, "rb" ) ) == NULL ) return( NULL );
+    if( fseek( fin, 0, SEEK_END ) != 0 || ( size = ftell( fin ) ) <= 0 )
+    {
+	fclose( fin );
+	return( NULL );
+    }
+    rewind( fin );
+    pIdx = (MUD_RUNINDEX*)zalloc( sizeof( MUD_RUNINDEX ) );
+    if( pIdx == NULL || ( pIdx->pBase = malloc( size ) ) == NULL ||
+	fread( pIdx->pBase, 1, size, fin ) != (size_t)size )
+    {
+	fclose( fin );
+	MUD_runIndexClose( pIdx );
+	return( NULL );
+    }
+    fclose( fin );
+    pIdx->size = (size_t)size;
+#else
+    struct stat st;
+    void* pBase;
+    int f;
+
+    if( ( f = open( idxname, O_RDONLY ) ) < 0 ) return( NULL );
+    if( fstat( f, &st ) != 0 || st.st_size < (off_t)sizeof( RI_HEADER ) )
+    {
+	close( f );
+	return( NULL );
+    }
+    pBase = mmap( NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, f, 0 );
+    close( f );
+    if( pBase == MAP_FAILED ) return( NULL );
+    if( ( pIdx = (MUD_RUNINDEX*)zalloc( sizeof( MUD_RUNINDEX ) ) ) == NULL )
+    {
+	munmap( pBase, (size_t)st.st_size );
+	return( NULL );
+    }
+    pIdx->pBase = pBase;
+    pIdx->size = (size_t)st.st_size;
+    pIdx->mapped = 1;
+#endif /* _WIN32 */
+
+    /*
+     *  A complete index, in this byte order
+     */
+    pHdr = (RI_HEADER*)pIdx->pBase;
+    if( pIdx->size < sizeof( RI_HEADER ) ||
+	strncmp( pHdr->magic, RI_MAGIC, 8 ) != 0 ||
+	pHdr->version != RI_VERSION ||
+	pHdr->byteOrder != RI_BYTE_ORDER ||
+	( pIdx->size - sizeof( RI_HEADER ) )/( sizeof( MUD_RUNINDEX_ENTRY ) + sizeof( UINT32 ) ) < pHdr->nRuns ||
+	pIdx->size - sizeof( RI_HEADER ) - (size_t)pHdr->nRuns*( sizeof( MUD_RUNINDEX_ENTRY ) + sizeof( UINT32 ) ) <
+	pHdr->pathBytes || ( pHdr->nRuns > 0 && pHdr->pathBytes == 0 ) )
+    {
+	MUD_runIndexClose( pIdx );
+	return( NULL );
+    }
+    pIdx->nRuns = pHdr->nRuns;
+    pIdx->pEntries = (MUD_RUNINDEX_ENTRY*)( pHdr + 1 );
+    pIdx->pByRun = (UINT32*)( pIdx->pEntries + pIdx->nRuns );
+    pIdx->pPaths = (char*)( pIdx->pByRun + pIdx->nRuns );
+    for( i = 0; i < pIdx->nRuns; i++ )
+    {
+	if( pIdx->pEntries[i].pathOffset >= pHdr->pathBytes || pIdx->pByRun[i] >= pIdx->nRuns )
+	{
+	    MUD_runIndexClose( pIdx );
+	    return( NULL );
+	}
+    }
+    if( pHdr->pathBytes > 0 && pIdx->pPaths[pHdr->pathBytes-1] != '\0' )
+    {
+	MUD_runIndexClose( pIdx );
+	return( NULL );
+    }
+    return( pIdx );
+}
+
+
+void
+MUD_runIndexClose( MUD_RUNINDEX* pIdx )
+{
+    if( pIdx == NULL ) return;
+#ifndef _WIN32
+    if( pIdx->mapped )
+    {
+	munmap( pIdx->pBase, pIdx->size );
+	pIdx->pBase = NULL;
+    }
+#endif /* !_WIN32 */
+    _free( pIdx->pBase );
+    free( pIdx );
+}
+
+
+static int
+entry_year( MUD_RUNINDEX_ENTRY* pEntry )
+{
+    time_t t = (time_t)pEntry->timeBegin;
+    struct tm* pTm;
+
+    pTm = localtime( &t );
+    return( ( pTm != NULL ) ? pTm->tm_year + 1900 : 0 );
+}
+
+
+/*
+ *  MUD_runIndexFind() - the entry of run number run of experiment expt
+ *  (0 for any) begun in year (0 for any), the latest if several; NULL
+ *  if there is none
+ */
+MUD_RUNINDEX_ENTRY*
+MUD_runIndexFind( MUD_RUNINDEX* pIdx, UINT32 expt, UINT32 run, int year )
+{
+    MUD_RUNINDEX_ENTRY* pEntry;
+    MUD_RUNINDEX_ENTRY* pFound = NULL;
+    UINT32 lo = 0, hi = pIdx->nRuns, mid;
+
+    /*
+     *  The first entry not before (expt, run), in either order
+     */
+    while( lo < hi )
+    {
+	mid = lo + ( hi - lo )/2;
+	pEntry = ( expt != 0 ) ? &pIdx->pEntries[mid] : &pIdx->pEntries[pIdx->pByRun[mid]];
+	if( ( expt != 0 && pEntry->exptNumber < expt ) ||
+	    ( ( expt == 0 || pEntry->exptNumber == expt ) && pEntry->runNumber < run ) ) lo = mid + 1;
+	else hi = mid;
+    }
+
+    /*
+     *  The matches follow, in order of start time
+     */
+    for( ; lo < pIdx->nRuns; lo++ )
+    {
+	pEntry = ( expt != 0 ) ? &pIdx->pEntries[lo] : &pIdx->pEntries[pIdx->pByRun[lo]];
+	if( ( expt != 0 && pEntry->exptNumber != expt ) || pEntry->runNumber != run ) break;
+	if( year == 0 || entry_year( pEntry ) == year ) pFound = pEntry;
+    }
+    return( pFound );
+}
+
+
+/*
+ *  MUD_runIndexPath() - the path of an entry
+ */
+char*
+MUD_runIndexPath( MUD_RUNINDEX* pIdx, MUD_RUNINDEX_ENTRY* pEntry )
+{
+    return( pIdx->pPaths + pEntry->pathOffset );
+}
+
+
+/*
+ *  MUD_setRunIndex() - the run index for MUD_openRun(); NULL goes back to
+ *  the environment variable MUD_RUN_INDEX
+ */
+void
+MUD_setRunIndex( char* idxname )
+{
+    _free( indexName );
+    if( idxname != NULL ) indexName = strdup( idxname );
+    MUD_runIndexClose( pOpenIdx );
+    pOpenIdx = NULL;
+}
+
+
+/*
+ *  MUD_openRun() - MUD_openRead() of run number run of experiment expt
+ *  (0 for any), found in the run index; -1 if it is not found or cannot
+ *  be opened
+ */
+int
+MUD_openRun( UINT32 expt, UINT32 run, UINT32* pType )
+{
+    MUD_RUNINDEX_ENTRY* pEntry;
+    char* idxname;
+
+    if( pOpenIdx == NULL )
+    {
+	idxname = ( indexName != NULL ) ? indexName : getenv( "MUD_RUN_INDEX" );
+	if( idxname == NULL || *idxname == '\0' ) return( -1 );
+	if( ( pOpenIdx = MUD_runIndexOpen( idxname ) ) == NULL ) return( -1 );
+    }
+    if( ( pEntry = MUD_runIndexFind( pOpenIdx, expt, run, 0 ) ) == NULL ) return( -1 );
+    return( MUD_openRead( MUD_runIndexPath( pOpenIdx, pEntry ), pType ) );
+}
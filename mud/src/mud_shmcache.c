@@ -0,0 +1,893 @@
+/*
+ *  mud_shmcache.c -- cache of decoded runs in POSIX shared memory, shared
+ *                    by all the processes of a machine
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version
+ *
+ *  Description:
+ *    Where many processes analyse the same runs, each decoding them again
+ *    is wasted.  This cache keeps decoded runs in a POSIX shared-memory
+ *    segment (shm_open), named by MUD_SHM_CACHE or "/mud_runs" unless
+ *    given.  One process creates it, with a size (MUD_shmCacheOpen, or
+ *    "mudshm -c"); the others attach to it.  A process that does not find
+ *    a run there reads it and publishes it (MUD_shmOpenRun), and from
+ *    then on any process gets the run with a hash lookup and a stat() of
+ *    the file, without reading or unpacking anything.
+ *
+ *    A run in the cache (MUD_SHM_RUN) holds the numbers and strings of
+ *    the run description and the headers, titles and unpacked bins (4
+ *    bytes each) of the histograms; other sections are not kept.  The
+ *    segment is mapped at different addresses in different processes, so
+ *    everything in it refers to everything else by offsets, and is read
+ *    through MUD_shmRunString() and MUD_shmRunHist().  A run is read-only,
+ *    and only used while the file has the same device, inode, size and
+ *    modification time as when it was published.
+ *
+ *    The segment is a table of slots and a ring of run data:
+ *
+ *      SHM_HEADER        magic, version, sizes, publish lock, ring head,
+ *                        counters
+ *      nSlots x SHM_SLOT state word (generation, valid bit, readers),
+ *                        hash of the path, offset and size of the run
+ *      ring              the runs, each starting on a 64-byte boundary
+ *
+ *    A run is found in one of SHM_PROBE slots from the hash of its path.
+ *    Readers take no lock: a compare-and-swap on the state word counts
+ *    them in (only while the slot is valid and of the same generation),
+ *    and an atomic decrement counts them out.  Publishers take a lock
+ *    word in the segment holding their process ID; the lock of a process
+ *    that died is taken over.  New runs go at the head of the ring,
+ *    evicting the oldest runs in the way (first in, first out), except
+ *    runs that have readers, which are stepped over.  A reader that dies
+ *    without MUD_shmReleaseRun() leaves its run pinned until the segment
+ *    is removed (MUD_shmCacheRemove, or "mudshm -r").
+ *
+ *    The segment is in the byte order and layout of the machine; all the
+ *    processes must use the same version of this library.  Not available
+ *    on Windows, where MUD_shmCacheOpen() returns NULL.
+ */
+
+#include "mud.h"
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
+#endif /* !_WIN32 */
+
+#define SHM_NAME	"/mud_runs"
+#define SHM_MAGIC	"MUDSHMC1"
+#define SHM_VERSION	1
+#define SHM_BYTE_ORDER	0x01020304
+#define SHM_ALIGN	64
+#define SHM_PROBE	16		/* slots where a run may be */
+#define SHM_RUN_BYTES	65536		/* expected size of a run, for nSlots */
+#define SHM_VALID	0x80000000ULL	/* state: the slot holds a run */
+#define SHM_REFS	0x7FFFFFFFULL	/* state: readers */
+
+#define _atomic_load(p)		__atomic_load_n( (p), __ATOMIC_ACQUIRE )
+#define _atomic_store(p,v)	__atomic_store_n( (p), (v), __ATOMIC_RELEASE )
+#define _atomic_cas(p,pOld,v)	__atomic_compare_exchange_n( (p), (pOld), (v), 0, \
+					__ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE )
+#define _atomic_add(p,v)	__atomic_fetch_add( (p), (v), __ATOMIC_ACQ_REL )
+
+typedef struct {
+    char	magic[8];
+    UINT32	version;
+    UINT32	byteOrder;	/* SHM_BYTE_ORDER as written */
+    UINT64	size;		/* of the segment */
+    UINT64	nSlots;		/* a power of 2 */
+    UINT64	dataOffset;	/* of the ring */
+    UINT64	dataSize;
+    UINT64	lock;		/* pid of the publisher, or 0 */
+    UINT64	head;		/* next run in the ring, from dataOffset */
+    UINT64	numHits;
+    UINT64	numMisses;
+    UINT64	numPublished;
+    UINT64	numEvicted;
+    UINT64	ready;		/* set when the segment is initialized */
+} SHM_HEADER;
+
+typedef struct {
+    UINT64	state;		/* generation << 32 | SHM_VALID | readers */
+    UINT64	hash;		/* of the path */
+    UINT64	offset;		/* of the run, from the start of the segment */
+    UINT64	size;
+} SHM_SLOT;
+
+#ifndef _WIN32
+
+static char* seg_name _ANSI_ARGS_(( char* name ));
+static int get_print _ANSI_ARGS_(( char* path, FILE* fin, UINT64* pPrint ));
+static UINT64 hash_path _ANSI_ARGS_(( char* path ));
+static int lock_segment _ANSI_ARGS_(( SHM_HEADER* pHdr ));
+static void unlock_segment _ANSI_ARGS_(( SHM_HEADER* pHdr ));
+static int evict _ANSI_ARGS_(( SHM_HEADER* pHdr, SHM_SLOT* pSlot ));
+static SHM_SLOT* find_slot _ANSI_ARGS_(( MUD_SHM_CACHE* pShm, char* path, UINT64 h ));
+static INT64 alloc_run _ANSI_ARGS_(( MUD_SHM_CACHE* pShm, UINT64 size ));
+static char* put_str _ANSI_ARGS_(( MUD_SHM_RUN* pRun, char* pStr, UINT32* pOffset, char* s ));
+
+
+static char*
+seg_name( char* name )
+{
+    if( name == NULL ) name = getenv( "MUD_SHM_CACHE" );
+    return( ( name != NULL && *name != '\0' ) ? name : SHM_NAME );
+}
+
+
+/*
+ *  MUD_shmCacheOpen() - attach to the segment name (NULL for the default);
+ *  if there is none and size (bytes) is not 0, create it.  Returns NULL
+ *  if there is no usable segment.
+ */
+MUD_SHM_CACHE*
+MUD_shmCacheOpen( char* name, size_t size )
+{
+    MUD_SHM_CACHE* pShm;
+    SHM_HEADER* pHdr;
+    SHM_SLOT* pSlots;
+    struct stat st;
+    void* pBase;
+    UINT64 nSlots, i;
+    long page;
+    int f, created = 0, n;
+
+    name = seg_name( name );
+    if( ( f = shm_open( name, O_RDWR, 0666 ) ) < 0 )
+    {
+	if( size == 0 || errno != ENOENT ) return( NULL );
+	if( ( f = shm_open( name, O_RDWR | O_CREAT | O_EXCL, 0666 ) ) >= 0 ) created = 1;
+	else if( errno != EEXIST || ( f = shm_open( name, O_RDWR, 0666 ) ) < 0 ) return( NULL );
+    }
+
+    if( created )
+    {
+	page = sysconf( _SC_PAGESIZE );
+	size = ( size + page - 1 )/page*page;
+	for( nSlots = 64; nSlots < 65536 && nSlots*SHM_RUN_BYTES < (UINT64)size; nSlots *= 2 ) ;
+	if( size < sizeof( SHM_HEADER ) + nSlots*sizeof( SHM_SLOT ) + 16*SHM_RUN_BYTES ||
+	    ftruncate( f, (off_t)size ) != 0 )
+	{
+	    close( f );
+	    shm_unlink( name );
+	    return( NULL );
+	}
+    }
+    else
+    {
+	/*
+	 *  Wait for the creator to size it
+	 */
+	for( n = 0; n < 1000; n++ )
+	{
+	    if( fstat( f, &st ) != 0 )
+	    {
+		close( f );
+		return( NULL );
+	    }
+	    if( st.st_size >= (off_t)sizeof( SHM_HEADER ) ) break;
+	    usleep( 1000 );
+	}
+	size = (size_t)st.st_size;
+    }
+
+    pBase = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, f, 0 );
+    close( f );
+    if( pBase == MAP_FAILED || size < sizeof( SHM_HEADER ) )
+    {
+	if( pBase != MAP_FAILED ) munmap( pBase, size );
+	return( NULL );
+    }
+    pHdr = (SHM_HEADER*)pBase;
+
+    if( created )
+    {
+	/*
+	 *  New pages are zero, so the slots are empty
+	 */
+	bcopy( SHM_MAGIC, pHdr->magic, 8 );
+	pHdr->version = SHM_VERSION;
+	pHdr->byteOrder = SHM_BYTE_ORDER;
+	pHdr->size = size;
+	pHdr->nSlots = nSlots;
+	pHdr->dataOffset = ( sizeof( SHM_HEADER ) + nSlots*sizeof( SHM_SLOT ) + SHM_ALIGN - 1 ) &
+			   ~(UINT64)( SHM_ALIGN - 1 );
+	pHdr->dataSize = ( size - pHdr->dataOffset ) & ~(UINT64)( SHM_ALIGN - 1 );
+	pSlots = (SHM_SLOT*)( pHdr + 1 );
+	for( i = 0; i < nSlots; i++ ) pSlots[i].state = 0;
+	_atomic_store( &pHdr->ready, 1 );
+    }
+    else
+    {
+	for( n = 0; n < 1000 && !_atomic_load( &pHdr->ready ); n++ ) usleep( 1000 );
+	if( !_atomic_load( &pHdr->ready ) || strncmp( pHdr->magic, SHM_MAGIC, 8 ) != 0 ||
+	    pHdr->version != SHM_VERSION || pHdr->byteOrder != SHM_BYTE_ORDER ||
+	    pHdr->size != (UINT64)size || pHdr->dataOffset + pHdr->dataSize > pHdr->size )
+	{
+	    munmap( pBase, size );
+	    return( NULL );
+	}
+    }
+
+    if( ( pShm = (MUD_SHM_CACHE*)zalloc( sizeof( MUD_SHM_CACHE ) ) ) == NULL ||
+	( pShm->name = strdup( name ) ) == NULL )
+    {
+	_free( pShm );
+	munmap( pBase, size );
+	return( NULL );
+    }
+    pShm->pBase = pBase;
+    pShm->size = size;
+    return( pShm );
+}
+
+
+/*
+ *  MUD_shmCacheClose() - detach; runs still held are released by the
+ *  caller first
+ */
+void
+MUD_shmCacheClose( MUD_SHM_CACHE* pShm )
+{
+    if( pShm == NULL ) return;
+    munmap( pShm->pBase, pShm->size );
+    _free( pShm->name );
+    free( pShm );
+}
+
+
+/*
+ *  MUD_shmCacheRemove() - remove the segment name (NULL for the default);
+ *  processes attached keep it until they detach.  Returns 1 on success.
+ */
+int
+MUD_shmCacheRemove( char* name )
+{
+    return( shm_unlink( seg_name( name ) ) == 0 );
+}
+
+
+/*
+ *  MUD_shmCacheStats() - runs held, their bytes, and the hits and misses
+ *  of MUD_shmGetRun() by all processes; any pointer may be NULL
+ */
+void
+MUD_shmCacheStats( MUD_SHM_CACHE* pShm, UINT32* pNum, size_t* pBytes, UINT64* pHits, UINT64* pMisses )
+{
+    SHM_HEADER* pHdr = (SHM_HEADER*)pShm->pBase;
+    SHM_SLOT* pSlots = (SHM_SLOT*)( pHdr + 1 );
+    UINT32 num = 0;
+    size_t bytes = 0;
+    UINT64 i;
+
+    for( i = 0; i < pHdr->nSlots; i++ )
+    {
+	if( _atomic_load( &pSlots[i].state ) & SHM_VALID )
+	{
+	    num++;
+	    bytes += (size_t)_atomic_load( &pSlots[i].size );
+	}
+    }
+    if( pNum != NULL ) *pNum = num;
+    if( pBytes != NULL ) *pBytes = bytes;
+    if( pHits != NULL ) *pHits = _atomic_load( &pHdr->numHits );
+    if( pMisses != NULL ) *pMisses = _atomic_load( &pHdr->numMisses );
+}
+
+
+/*
+ *  get_print() - device, inode, size and modification time (ns) of a
+ *  file (of the open file fin, if not NULL); returns 0 if it cannot be
+ *  examined.
+ */
+static int
+get_print( char* path, FILE* fin, UINT64* pPrint )
+{
+    struct stat st;
+
+    if( ( fin != NULL ) ? fstat( fileno( fin ), &st ) : stat( path, &st ) ) return( 0 );
+    pPrint[0] = (UINT64)st.st_dev;
+    pPrint[1] = (UINT64)st.st_ino;
+    pPrint[2] = (UINT64)st.st_size;
+#if defined(__linux__)
+    pPrint[3] = (UINT64)st.st_mtim.tv_sec*1000000000 + (UINT64)st.st_mtim.tv_nsec;
+#else
+    pPrint[3] = (UINT64)st.st_mtime*1000000000;
+#endif /* __linux__ */
+    return( 1 );
+}
+
+
+static UINT64
+hash_path( char* path )
+{
+    UINT64 h = 14695981039346656037ULL;
+
+    for( ; *path != '\0'; path++ )
+    {
+	h ^= (UINT8)*path;
+	h *= 1099511628211ULL;
+    }
+    return( h );
+}
+
+
+/*
+ *  lock_segment() - take the publish lock, or that of a process that
+ *  died holding it; returns 0 if it is not had within 10 s.
+ */
+static int
+lock_segment( SHM_HEADER* pHdr )
+{
+    UINT64 me = (UINT64)getpid();
+    UINT64 owner;
+    int n;
+
+    for( n = 0; n < 100000; n++ )
+    {
+	owner = 0;
+	if( _atomic_cas( &pHdr->lock, &owner, me ) ) return( 1 );
+	if( kill( (pid_t)owner, 0 ) != 0 && errno == ESRCH &&
+	    _atomic_cas( &pHdr->lock, &owner, me ) ) return( 1 );
+	usleep( 100 );
+    }
+    return( 0 );
+}
+
+
+static void
+unlock_segment( SHM_HEADER* pHdr )
+{
+    _atomic_store( &pHdr->lock, (UINT64)0 );
+}
+
+
+/*
+ *  evict() - empty a slot that has no readers, so that no reader can
+ *  get in; returns 0 if it has readers.
+ */
+static int
+evict( SHM_HEADER* pHdr, SHM_SLOT* pSlot )
+{
+    UINT64 state = _atomic_load( &pSlot->state );
+
+    while( state & SHM_VALID )
+    {
+	if( state & SHM_REFS ) return( 0 );
+	if( _atomic_cas( &pSlot->state, &state, ( ( state >> 32 ) + 1 ) << 32 ) )
+	{
+	    _atomic_add( &pHdr->numEvicted, (UINT64)1 );
+	    break;
+	}
+    }
+    return( 1 );
+}
+
+
+/*
+ *  find_slot() - an empty slot for path, from the slots it may be in,
+ *  evicting the same path, or else the oldest run there, if need be;
+ *  with the publish lock held.
+ */
+static SHM_SLOT*
+find_slot( MUD_SHM_CACHE* pShm, char* path, UINT64 h )
+{
+    SHM_HEADER* pHdr = (SHM_HEADER*)pShm->pBase;
+    SHM_SLOT* pSlots = (SHM_SLOT*)( pHdr + 1 );
+    SHM_SLOT* pSlot;
+    SHM_SLOT* pEmpty = NULL;
+    SHM_SLOT* pOldest = NULL;
+    MUD_SHM_RUN* pRun;
+    UINT64 age, oldest = 0;
+    int k;
+
+    for( k = 0; k < SHM_PROBE; k++ )
+    {
+	pSlot = &pSlots[( h + k ) & ( pHdr->nSlots - 1 )];
+	if( !( _atomic_load( &pSlot->state ) & SHM_VALID ) )
+	{
+	    if( pEmpty == NULL ) pEmpty = pSlot;
+	    continue;
+	}
+	if( pSlot->hash == h )
+	{
+	    pRun = (MUD_SHM_RUN*)( (char*)pShm->pBase + pSlot->offset );
+	    if( strcmp( MUD_shmRunString( pRun, MUD_SHM_PATH ), path ) == 0 &&
+		evict( pHdr, pSlot ) && pEmpty == NULL ) pEmpty = pSlot;
+	    continue;
+	}
+	age = ( pSlot->offset - pHdr->dataOffset + pHdr->dataSize - pHdr->head ) % pHdr->dataSize;
+	if( pOldest == NULL || age < oldest )
+	{
+	    pOldest = pSlot;
+	    oldest = age;
+	}
+    }
+    if( pEmpty != NULL ) return( pEmpty );
+    return( ( pOldest != NULL && evict( pHdr, pOldest ) ) ? pOldest : NULL );
+}
+
+
+/*
+ *  alloc_run() - room for size bytes at the head of the ring, evicting
+ *  the runs there; returns the offset of the room in the segment, -1
+ *  if it cannot be had.  With the publish lock held.
+ */
+static INT64
+alloc_run( MUD_SHM_CACHE* pShm, UINT64 size )
+{
+    SHM_HEADER* pHdr = (SHM_HEADER*)pShm->pBase;
+    SHM_SLOT* pSlots = (SHM_SLOT*)( pHdr + 1 );
+    UINT64 pos, start, end, blocked, i;
+    int lap;
+
+    if( size > pHdr->dataSize ) return( -1 );
+    pos = pHdr->head;
+    for( lap = 0; lap < 2; )
+    {
+	if( pos + size > pHdr->dataSize )
+	{
+	    pos = 0;
+	    lap++;
+	}
+
+	/*
+	 *  Runs in the way go, except those with readers
+	 */
+	blocked = 0;
+	for( i = 0; i < pHdr->nSlots; i++ )
+	{
+	    if( !( _atomic_load( &pSlots[i].state ) & SHM_VALID ) ) continue;
+	    start = pSlots[i].offset - pHdr->dataOffset;
+	    end = start + pSlots[i].size;
+	    if( start < pos + size && end > pos && !evict( pHdr, &pSlots[i] ) )
+		blocked = _max( blocked, end );
+	}
+	if( blocked == 0 )
+	{
+	    pHdr->head = pos + size;
+	    return( (INT64)( pHdr->dataOffset + pos ) );
+	}
+	pos = ( blocked + SHM_ALIGN - 1 ) & ~(UINT64)( SHM_ALIGN - 1 );
+    }
+    return( -1 );
+}
+
+
+static char*
+put_str( MUD_SHM_RUN* pRun, char* pStr, UINT32* pOffset, char* s )
+{
+    size_t n;
+
+    if( s == NULL ) return( pStr );
+    n = strlen( s ) + 1;
+    bcopy( s, pStr, n );
+    *pOffset = (UINT32)( pStr - (char*)pRun );
+    return( pStr + n );
+}
+
+
+/*
+ *  MUD_shmGetRun() - the run of path, if it is in the cache and up to
+ *  date, held for reading until MUD_shmReleaseRun(); NULL if not.
+ */
+MUD_SHM_RUN*
+MUD_shmGetRun( MUD_SHM_CACHE* pShm, char* path )
+{
+    SHM_HEADER* pHdr = (SHM_HEADER*)pShm->pBase;
+    SHM_SLOT* pSlots = (SHM_SLOT*)( pHdr + 1 );
+    SHM_SLOT* pSlot;
+    MUD_SHM_RUN* pRun;
+    UINT64 print[4];
+    UINT64 h, state;
+    int k;
+
+    if( !get_print( path, NULL, print ) )
+    {
+	_atomic_add( &pHdr->numMisses, (UINT64)1 );
+	return( NULL );
+    }
+    h = hash_path( path );
+
+    for( k = 0; k < SHM_PROBE; k++ )
+    {
+	pSlot = &pSlots[( h + k ) & ( pHdr->nSlots - 1 )];
+	state = _atomic_load( &pSlot->state );
+	if( !( state & SHM_VALID ) || _atomic_load( &pSlot->hash ) != h ) continue;
+
+	/*
+	 *  In as a reader, unless the slot changed meanwhile
+	 */
+	while( !_atomic_cas( &pSlot->state, &state, state + 1 ) )
+	{
+	    if( !( state & SHM_VALID ) ) break;
+	}
+	if( !( state & SHM_VALID ) || pSlot->hash != h )
+	{
+	    if( state & SHM_VALID ) _atomic_add( &pSlot->state, (UINT64)-1 );
+	    continue;
+	}
+
+	pRun = (MUD_SHM_RUN*)( (char*)pShm->pBase + pSlot->offset );
+	if( strcmp( MUD_shmRunString( pRun, MUD_SHM_PATH ), path ) == 0 &&
+	    memcmp( pRun->print, print, sizeof( print ) ) == 0 )
+	{
+	    _atomic_add( &pHdr->numHits, (UINT64)1 );
+	    return( pRun );
+	}
+	_atomic_add( &pSlot->state, (UINT64)-1 );
+    }
+    _atomic_add( &pHdr->numMisses, (UINT64)1 );
+    return( NULL );
+}
+
+
+/*
+ *  MUD_shmPutRun() - publish the run of path, read from the open file
+ *  fin (or NULL) into pMUD_fileGrp, and return it held for reading, as
+ *  MUD_shmGetRun().  Returns NULL if it does not fit in the cache, or
+ *  the slots it may go in all have readers.  The caller keeps the tree.
+ */
+MUD_SHM_RUN*
+MUD_shmPutRun( MUD_SHM_CACHE* pShm, char* path, FILE* fin, MUD_SEC_GRP* pMUD_fileGrp )
+{
+    SHM_HEADER* pHdr = (SHM_HEADER*)pShm->pBase;
+    SHM_SLOT* pSlot;
+    MUD_SHM_RUN* pRun;
+    MUD_SEC_GEN_RUN_DESC* pDesc;
+    MUD_SEC_TRI_TI_RUN_DESC* pIdesc;
+    MUD_SEC_GRP* pMUD_histGrp;
+    MUD_SEC* pSec;
+    MUD_SEC* pDatSec;
+    MUD_SEC_GEN_HIST_HDR* pHdrSec;
+    MUD_SEC_GEN_HIST_DAT* pDat;
+    MUD_SEC_GEN_HIST_HDR** ppHdrs = NULL;
+    MUD_SEC_GEN_HIST_DAT** ppDats = NULL;
+    MUD_HIST_CACHE_ENTRY* pEntries;
+    char* strs[MUD_SHM_NSTR];
+    char* pStr;
+    UINT64 print[4];
+    UINT64 h, size, state;
+    INT64 offset;
+    int i, n = 0, nSec;
+
+    if( !get_print( path, fin, print ) ) return( NULL );
+
+    pDesc = (MUD_SEC_GEN_RUN_DESC*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_GEN_RUN_DESC_ID, (UINT32)1, (UINT32)0 );
+    pIdesc = (MUD_SEC_TRI_TI_RUN_DESC*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_TRI_TI_RUN_DESC_ID, (UINT32)1, (UINT32)0 );
+    bzero( strs, sizeof( strs ) );
+    strs[MUD_SHM_PATH] = path;
+    if( pDesc != NULL )
+    {
+	strs[MUD_SHM_TITLE] = pDesc->title;
+	strs[MUD_SHM_LAB] = pDesc->lab;
+	strs[MUD_SHM_AREA] = pDesc->area;
+	strs[MUD_SHM_METHOD] = pDesc->method;
+	strs[MUD_SHM_APPARATUS] = pDesc->apparatus;
+	strs[MUD_SHM_INSERT] = pDesc->insert;
+	strs[MUD_SHM_SAMPLE] = pDesc->sample;
+	strs[MUD_SHM_ORIENT] = pDesc->orient;
+	strs[MUD_SHM_DAS] = pDesc->das;
+	strs[MUD_SHM_EXPERIMENTER] = pDesc->experimenter;
+	strs[MUD_SHM_TEMPERATURE] = pDesc->temperature;
+	strs[MUD_SHM_FIELD] = pDesc->field;
+    }
+    else if( pIdesc != NULL )
+    {
+	strs[MUD_SHM_TITLE] = pIdesc->title;
+	strs[MUD_SHM_LAB] = pIdesc->lab;
+	strs[MUD_SHM_AREA] = pIdesc->area;
+	strs[MUD_SHM_METHOD] = pIdesc->method;
+	strs[MUD_SHM_APPARATUS] = pIdesc->apparatus;
+	strs[MUD_SHM_INSERT] = pIdesc->insert;
+	strs[MUD_SHM_SAMPLE] = pIdesc->sample;
+	strs[MUD_SHM_ORIENT] = pIdesc->orient;
+	strs[MUD_SHM_DAS] = pIdesc->das;
+	strs[MUD_SHM_EXPERIMENTER] = pIdesc->experimenter;
+	strs[MUD_SHM_SUBTITLE] = pIdesc->subtitle;
+	strs[MUD_SHM_COMMENT1] = pIdesc->comment1;
+	strs[MUD_SHM_COMMENT2] = pIdesc->comment2;
+	strs[MUD_SHM_COMMENT3] = pIdesc->comment3;
+    }
+
+    /*
+     *  Pair each histogram header with its data; histograms without
+     *  data are left out
+     */
+    pMUD_histGrp = (MUD_SEC_GRP*)MUD_search( pMUD_fileGrp->pMem, MUD_SEC_GRP_ID,
+		( MUD_instanceID( pMUD_fileGrp ) == MUD_FMT_TRI_TI_ID ) ?
+		MUD_GRP_TRI_TI_HIST_ID : MUD_GRP_TRI_TD_HIST_ID, (UINT32)0 );
+    if( pMUD_histGrp != NULL )
+    {
+	for( nSec = 0, pSec = (MUD_SEC*)pMUD_histGrp->pMem; pSec != NULL; pSec = MUD_pNext( pSec ) )
+	    nSec++;
+	ppHdrs = (MUD_SEC_GEN_HIST_HDR**)zalloc( ( nSec + 1 )*sizeof( MUD_SEC_GEN_HIST_HDR* ) );
+	ppDats = (MUD_SEC_GEN_HIST_DAT**)zalloc( ( nSec + 1 )*sizeof( MUD_SEC_GEN_HIST_DAT* ) );
+	if( ppHdrs == NULL || ppDats == NULL )
+	{
+	    _free( ppHdrs );
+	    _free( ppDats );
+	    return( NULL );
+	}
+	for( pSec = (MUD_SEC*)pMUD_histGrp->pMem; pSec != NULL; pSec = MUD_pNext( pSec ) )
+	{
+	    if( MUD_secID( pSec ) != MUD_SEC_GEN_HIST_HDR_ID ) continue;
+	    pHdrSec = (MUD_SEC_GEN_HIST_HDR*)pSec;
+	    for( pDatSec = (MUD_SEC*)pMUD_histGrp->pMem; pDatSec != NULL; pDatSec = MUD_pNext( pDatSec ) )
+	    {
+		if( MUD_secID( pDatSec ) == MUD_SEC_GEN_HIST_DAT_ID &&
+		    MUD_instanceID( pDatSec ) == MUD_instanceID( pHdrSec ) ) break;
+	    }
+	    pDat = (MUD_SEC_GEN_HIST_DAT*)pDatSec;
+	    if( pDat == NULL || pDat->pData == NULL || pHdrSec->nBins == 0 ) continue;
+	    if( pHdrSec->bytesPerBin != 0 && pHdrSec->bytesPerBin != 1 &&
+		pHdrSec->bytesPerBin != 2 && pHdrSec->bytesPerBin != 4 &&
+		pHdrSec->bytesPerBin != MUD_BPB_SPARSE ) continue;
+	    ppHdrs[n] = pHdrSec;
+	    ppDats[n] = pDat;
+	    n++;
+	}
+    }
+
+    /*
+     *  The size of it all: description, entries, strings, then the bins
+     */
+    size = sizeof( MUD_SHM_RUN ) + n*sizeof( MUD_HIST_CACHE_ENTRY );
+    for( i = 0; i < MUD_SHM_NSTR; i++ )
+    {
+	if( strs[i] != NULL ) size += strlen( strs[i] ) + 1;
+    }
+    for( i = 0; i < n; i++ )
+    {
+	if( ppHdrs[i]->title != NULL ) size += strlen( ppHdrs[i]->title ) + 1;
+    }
+    for( i = 0; i < n; i++ )
+    {
+	size = ( size + SHM_ALIGN - 1 ) & ~(UINT64)( SHM_ALIGN - 1 );
+	size += (UINT64)ppHdrs[i]->nBins*sizeof( UINT32 );
+    }
+    size = ( size + SHM_ALIGN - 1 ) & ~(UINT64)( SHM_ALIGN - 1 );
+
+    pRun = NULL;
+    h = hash_path( path );
+    if( size <= 0xFFFFFFFFULL && lock_segment( pHdr ) )
+    {
+	if( ( pSlot = find_slot( pShm, path, h ) ) != NULL &&
+	    ( offset = alloc_run( pShm, size ) ) >= 0 )
+	{
+	    pRun = (MUD_SHM_RUN*)( (char*)pShm->pBase + offset );
+	    bzero( pRun, sizeof( MUD_SHM_RUN ) );
+	    pRun->size = (UINT32)size;
+	    pRun->slot = (UINT32)( pSlot - (SHM_SLOT*)( pHdr + 1 ) );
+	    bcopy( print, pRun->print, sizeof( print ) );
+	    pRun->format = MUD_instanceID( pMUD_fileGrp );
+	    if( pDesc != NULL )
+	    {
+		pRun->exptNumber = pDesc->exptNumber;
+		pRun->runNumber = pDesc->runNumber;
+		pRun->timeBegin = pDesc->timeBegin;
+		pRun->timeEnd = pDesc->timeEnd;
+		pRun->elapsedSec = pDesc->elapsedSec;
+	    }
+	    else if( pIdesc != NULL )
+	    {
+		pRun->exptNumber = pIdesc->exptNumber;
+		pRun->runNumber = pIdesc->runNumber;
+		pRun->timeBegin = pIdesc->timeBegin;
+		pRun->timeEnd = pIdesc->timeEnd;
+		pRun->elapsedSec = pIdesc->elapsedSec;
+	    }
+	    pRun->nHists = n;
+	    pRun->histOffset = sizeof( MUD_SHM_RUN );
+
+	    pEntries = (MUD_HIST_CACHE_ENTRY*)( pRun + 1 );
+	    pStr = (char*)( pEntries + n );
+	    for( i = 0; i < MUD_SHM_NSTR; i++ )
+		pStr = put_str( pRun, pStr, &pRun->str[i], strs[i] );
+	    for( i = 0; i < n; i++ )
+	    {
+		bzero( &pEntries[i], sizeof( MUD_HIST_CACHE_ENTRY ) );
+		pStr = put_str( pRun, pStr, &pEntries[i].title, ppHdrs[i]->title );
+	    }
+
+	    offset = pStr - (char*)pRun;
+	    for( i = 0; i < n; i++ )
+	    {
+		pHdrSec = ppHdrs[i];
+		offset = ( offset + SHM_ALIGN - 1 ) & ~(INT64)( SHM_ALIGN - 1 );
+		pEntries[i].num = MUD_instanceID( pHdrSec );
+		pEntries[i].histType = pHdrSec->histType;
+		pEntries[i].nBytes = pHdrSec->nBytes;
+		pEntries[i].nBins = pHdrSec->nBins;
+		pEntries[i].bytesPerBin = pHdrSec->bytesPerBin;
+		pEntries[i].fsPerBin = pHdrSec->fsPerBin;
+		pEntries[i].t0_ps = pHdrSec->t0_ps;
+		pEntries[i].t0_bin = pHdrSec->t0_bin;
+		pEntries[i].goodBin1 = pHdrSec->goodBin1;
+		pEntries[i].goodBin2 = pHdrSec->goodBin2;
+		pEntries[i].bkgd1 = pHdrSec->bkgd1;
+		pEntries[i].bkgd2 = pHdrSec->bkgd2;
+		pEntries[i].nEvents = pHdrSec->nEvents;
+		pEntries[i].offset = (UINT64)offset;
+		MUD_SEC_GEN_HIST_unpackData( pHdrSec->nBins, pHdrSec->bytesPerBin, ppDats[i]->pData, ppDats[i]->nBytes,
+					 4, (char*)pRun + offset );
+		offset += (INT64)pHdrSec->nBins*sizeof( UINT32 );
+	    }
+
+	    /*
+	     *  Out to the readers, with this one in
+	     */
+	    pSlot->hash = h;
+	    pSlot->offset = (UINT64)( (char*)pRun - (char*)pShm->pBase );
+	    pSlot->size = size;
+	    state = _atomic_load( &pSlot->state );
+	    _atomic_store( &pSlot->state, ( state & ~SHM_REFS ) | SHM_VALID | 1 );
+	    _atomic_add( &pHdr->numPublished, (UINT64)1 );
+	}
+	unlock_segment( pHdr );
+    }
+
+    _free( ppHdrs );
+    _free( ppDats );
+    return( pRun );
+}
+
+
+/*
+ *  MUD_shmOpenRun() - the run of path from the cache, or else read from
+ *  the file and published; NULL if the file cannot be read, or the run
+ *  cannot be published.  Release it with MUD_shmReleaseRun().
+ */
+MUD_SHM_RUN*
+MUD_shmOpenRun( MUD_SHM_CACHE* pShm, char* path )
+{
+    MUD_SHM_RUN* pRun;
+    MUD_SEC_GRP* pMUD_fileGrp;
+    FILE* fin;
+
+    if( ( pRun = MUD_shmGetRun( pShm, path ) ) != NULL ) return( pRun );
+
+    if( ( fin = MUD_openInput( path ) ) == NULL ) return( NULL );
+    pMUD_fileGrp = MUD_readFile( fin );
+    if( pMUD_fileGrp != NULL )
+    {
+	pRun = MUD_shmPutRun( pShm, path, fin, pMUD_fileGrp );
+	MUD_free( pMUD_fileGrp );
+    }
+    fclose( fin );
+    return( pRun );
+}
+
+
+/*
+ *  MUD_shmReleaseRun() - done reading a run from MUD_shmGetRun(),
+ *  MUD_shmPutRun() or MUD_shmOpenRun()
+ */
+void
+MUD_shmReleaseRun( MUD_SHM_CACHE* pShm, MUD_SHM_RUN* pRun )
+{
+    SHM_HEADER* pHdr;
+    SHM_SLOT* pSlots;
+
+    if( pShm == NULL || pRun == NULL ) return;
+    pHdr = (SHM_HEADER*)pShm->pBase;
+    pSlots = (SHM_SLOT*)( pHdr + 1 );
+    _atomic_add( &pSlots[pRun->slot].state, (UINT64)-1 );
+}
+
+#else
+
+MUD_SHM_CACHE*
+MUD_shmCacheOpen( char* name, size_t size )
+{
+    return( NULL );
+}
+
+void
+MUD_shmCacheClose( MUD_SHM_CACHE* pShm )
+{
+}
+
+int
+MUD_shmCacheRemove( char* name )
+{
+    return( 0 );
+}
+
+void
+MUD_shmCacheStats( MUD_SHM_CACHE* pShm, UINT32* pNum, size_t* pBytes, UINT64* pHits, UINT64* pMisses )
+{
+}
+
+MUD_SHM_RUN*
+MUD_shmGetRun( MUD_SHM_CACHE* pShm, char* path )
+{
+    return( NULL );
+}
+
+MUD_SHM_RUN*
+MUD_shmPutRun( MUD_SHM_CACHE* pShm, char* path, FILE* fin, MUD_SEC_GRP* pMUD_fileGrp )
+{
+    return( NULL );
+}
+
+MUD_SHM_RUN*
+MUD_shmOpenRun( MUD_SHM_CACHE* pShm, char* path )
+{
+    return( NULL );
+}
+
+void
+MUD_shmReleaseRun( MUD_SHM_CACHE* pShm, MUD_SHM_RUN* pRun )
+{
+}
+
+#endif /* !_WIN32 */
+
+
+/*
+ *  MUD_shmRunString() - a string (MUD_SHM_PATH, MUD_SHM_TITLE, ...) of a
+ *  run from the cache; "" if the run has none
+ */
+char*
+MUD_shmRunString( MUD_SHM_RUN* pRun, int which )
+{
+    if( which < 0 || which >= MUD_SHM_NSTR || pRun->str[which] == 0 ) return( "" );
+    return( (char*)pRun + pRun->str[which] );
+}
+
+
+/*
+ *  MUD_shmRunHist() - the bins (4 bytes each, read-only) of histogram num
+ *  of a run from the cache, and its header fields in *ppEntry if not
+ *  NULL; NULL if the run has no such histogram
+ */
+UINT32*
+MUD_shmRunHist( MUD_SHM_RUN* pRun, int num, MUD_HIST_CACHE_ENTRY** ppEntry )
+{
+    MUD_HIST_CACHE_ENTRY* pEntries = (MUD_HIST_CACHE_ENTRY*)( (char*)pRun + pRun->histOffset );
+    UINT32 i;
+
+    for( i = 0; i < pRun->nHists; i++ )
+    {
+	if( pEntries[i].num == (UINT32)num )
+	{
+	    if( ppEntry != NULL ) *ppEntry = &pEntries[i];
+	    return( (UINT32*)( (char*)pRun + pEntries[i].offset ) );
+	}
+    }
+    return( NULL );
+}
+
+
+/*
+ *  MUD_shmRunHistTitle() - the title of histogram num, "" if none
+ */
+char*
+MUD_shmRunHistTitle( MUD_SHM_RUN* pRun, int num )
+{
+    MUD_HIST_CACHE_ENTRY* pEntry;
+
+    if( MUD_shmRunHist( pRun, num, &pEntry ) == NULL || pEntry->title == 0 ) return( "" );
+    return( (char*)pRun + pEntry->title );
+}
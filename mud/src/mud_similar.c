@@ -0,0 +1,691 @@
+/*
+ *  mud_similar.c -- run signatures and a nearest-neighbour index for
+ *                   finding similar runs in an archive
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version
+ *          18-Oct-2026      Mapped index with LSH bucket tables (version 2)
+ *
+ *  Description:
+ *    The signature of a run is the shape of its first MUD_SIM_HISTS
+ *    histograms: each is background-subtracted over its good bins,
+ *    corrected for the muon lifetime (when the time range is that of a
+ *    muSR run), rebinned to MUD_SIM_BINS bins and divided by its mean,
+ *    less one -- roughly the asymmetry seen by that counter.  The whole
+ *    vector is then scaled to unit length, so the similarity of two runs
+ *    is the dot product of their vectors (cosine similarity).  Along with
+ *    it go a few header values and a 64-bit hash: bit j is the sign of
+ *    the projection of the vector on the j'th of a fixed set of random
+ *    +-1 hyperplanes, so similar runs have hashes a small Hamming
+ *    distance apart.
+ *
+ *    The index file holds all the signatures, tables of them by parts of
+ *    their hashes, and the file paths.  It is meant to be mapped into
+ *    memory and used in place:
+ *
+ *      SIM_HEADER            32 bytes: "MUDSIMIX", version, byte-order
+ *                            mark, num, pathBytes, size of a signature,
+ *                            nBands
+ *      num x MUD_SIM_SIG     the signatures
+ *      num x UINT32          offset of each path in the paths
+ *      nBands x 257 UINT32   for each band, the start of each bucket in
+ *                            its rows (and the end of the last)
+ *      nBands x num UINT32   for each band, the rows by bucket
+ *      pathBytes             nul-terminated paths
+ *
+ *    Band b is bits 8b..8b+7 of the hash, so each band sorts the runs
+ *    into SIM_BUCKETS buckets.  The file is in the byte order of the
+ *    machine that wrote it; an index from another byte order (or an
+ *    older version) is not read (build it again here).
+ *
+ *    A query scans all vectors (with AVX2 when available), or with LSH
+ *    compares in full only the runs that share a bucket with the query
+ *    in some band, adding the buckets one bit away in each band when
+ *    that gives too few; the rest of the index is never touched.
+ */
+
+#include <math.h>
+#include "mud.h"
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif /* _WIN32 */
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif /* __AVX2__ */
+
+#define SIM_MAGIC		"MUDSIMIX"
+#define SIM_VERSION		2
+#define SIM_BYTE_ORDER		0x01020304
+#define SIM_BANDS		8	/* of 8 bits of the hash */
+#define SIM_BUCKETS		256
+#define SIM_TAU_MU_US		2.1969811
+#define SIM_MAX_SPAN_US		100.0	/* longer runs are not lifetime-corrected */
+#define SIM_LSH_FACTOR		20	/* LSH candidates per requested match */
+#define SIM_LSH_MIN		256
+
+typedef struct {
+    char	magic[8];
+    UINT32	version;
+    UINT32	byteOrder;	/* SIM_BYTE_ORDER as written */
+    UINT32	num;
+    UINT32	pathBytes;
+    UINT32	sigSize;	/* sizeof( MUD_SIM_SIG ) */
+    UINT32	nBands;
+} SIM_HEADER;
+
+typedef struct {
+    char**	filenames;
+    MUD_SIM_SIG* pSigs;
+    int*	pOK;
+} SIM_BATCH;
+
+static UINT64 splitmix64 _ANSI_ARGS_(( UINT64 x ));
+static UINT64 sig_hash _ANSI_ARGS_(( REAL32* pVec ));
+static REAL32 dot _ANSI_ARGS_(( REAL32* a, REAL32* b ));
+static int hist_shape _ANSI_ARGS_(( MUD_SEC_GRP* pMUD_histGrp, UINT32 num, REAL32* pVec, MUD_SIM_SIG* pSig ));
+static void sig_task _ANSI_ARGS_(( int task, int thread, void* pArg ));
+static int cmp_rows _ANSI_ARGS_(( const void* p1, const void* p2 ));
+static int add_bucket _ANSI_ARGS_(( MUD_SIM_INDEX* pIndex, int band, int bucket, UINT32** ppCand, UINT32* pN, UINT32* pMax ));
+static UINT32 lsh_candidates _ANSI_ARGS_(( MUD_SIM_INDEX* pIndex, UINT64 hash, UINT32 nWant, UINT32** ppCand ));
+static void top_insert _ANSI_ARGS_(( MUD_SIM_MATCH* pTop, int* pN, int k, UINT32 row, REAL32 score ));
+
+
+static UINT64
+splitmix64( UINT64 x )
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = ( x ^ ( x >> 30 ) )*0xBF58476D1CE4E5B9ULL;
+    x = ( x ^ ( x >> 27 ) )*0x94D049BB133111EBULL;
+    return( x ^ ( x >> 31 ) );
+}
+
+
+/*
+ *  Bit j: sign of the projection on hyperplane j, whose components are
+ *  +-1 from the bits of splitmix64(j*MUD_SIM_DIM + i)
+ */
+static UINT64
+sig_hash( REAL32* pVec )
+{
+    UINT64 hash = 0;
+    REAL64 p;
+    int i, j;
+
+    for( j = 0; j < 64; j++ )
+    {
+	for( i = 0, p = 0.0; i < MUD_SIM_DIM; i++ )
+	{
+	    if( splitmix64( (UINT64)j*MUD_SIM_DIM + i ) & 1 )
+		p += pVec[i];
+	    else
+		p -= pVec[i];
+	}
+	if( p > 0.0 ) hash |= (UINT64)1 << j;
+    }
+    return( hash );
+}
+
+
+static REAL32
+dot( REAL32* a, REAL32* b )
+{
+    int i = 0;
+    REAL32 s = 0.0;
+#ifdef __AVX2__
+    __m256 acc = _mm256_setzero_ps();
+    REAL32 lanes[8];
+
+    for( ; i + 8 <= MUD_SIM_DIM; i += 8 )
+    {
+	acc = _mm256_add_ps( acc, _mm256_mul_ps( _mm256_loadu_ps( &a[i] ),
+						 _mm256_loadu_ps( &b[i] ) ) );
+    }
+    _mm256_storeu_ps( lanes, acc );
+    s = ( lanes[0] + lanes[1] ) + ( lanes[2] + lanes[3] ) +
+	( lanes[4] + lanes[5] ) + ( lanes[6] + lanes[7] );
+#endif /* __AVX2__ */
+
+    for( ; i < MUD_SIM_DIM; i++ )
+    {
+	s += a[i]*b[i];
+    }
+    return( s );
+}
+
+
+/*
+ *  Shape of histogram num into pVec[0..MUD_SIM_BINS-1]
+ */
+static int
+hist_shape( MUD_SEC_GRP* pMUD_histGrp, UINT32 num, REAL32* pVec, MUD_SIM_SIG* pSig )
+{
+    MUD_SEC_GEN_HIST_HDR* pHdr;
+    MUD_SEC_GEN_HIST_DAT* pDat;
+    UINT32* pData;
+    UINT32 lo, hi, i, b;
+    REAL64 sums[MUD_SIM_BINS];
+    REAL64 bkgd, usPerBin, width, mean;
+    int lifetime;
+
+    pHdr = (MUD_SEC_GEN_HIST_HDR*)MUD_search( pMUD_histGrp->pMem,
+			  MUD_SEC_GEN_HIST_HDR_ID, num, (UINT32)0 );
+    pDat = (MUD_SEC_GEN_HIST_DAT*)MUD_search( pMUD_histGrp->pMem,
+			  MUD_SEC_GEN_HIST_DAT_ID, num, (UINT32)0 );
+    if( pHdr == NULL || pDat == NULL || pDat->pData == NULL || pHdr->nBins < 2 )
+	return( 0 );
+    if( num == 1 )
+    {
+	pSig->nBins = pHdr->nBins;
+	pSig->fsPerBin = pHdr->fsPerBin;
+    }
+
+    pData = (UINT32*)malloc( pHdr->nBins*sizeof( UINT32 ) );
+    if( pData == NULL ) return( 0 );
+    MUD_SEC_GEN_HIST_unpackData( pHdr->nBins, pHdr->bytesPerBin, pDat->pData, pDat->nBytes, 4, pData );
+
+    if( pHdr->goodBin2 > pHdr->goodBin1 && pHdr->goodBin2 < pHdr->nBins )
+    {
+	lo = pHdr->goodBin1;
+	hi = pHdr->goodBin2;
+    }
+    else
+    {
+	lo = _min( pHdr->t0_bin, pHdr->nBins - 2 );
+	hi = pHdr->nBins - 1;
+    }
+
+    bkgd = 0.0;
+    if( pHdr->bkgd2 > pHdr->bkgd1 && pHdr->bkgd2 < pHdr->nBins )
+    {
+	for( i = pHdr->bkgd1; i <= pHdr->bkgd2; i++ ) bkgd += pData[i];
+	bkgd /= ( pHdr->bkgd2 - pHdr->bkgd1 + 1 );
+    }
+
+    usPerBin = pHdr->fsPerBin*1.0e-9;
+    lifetime = ( usPerBin > 0.0 && ( hi - lo + 1 )*usPerBin <= SIM_MAX_SPAN_US );
+
+    bzero( sums, sizeof( sums ) );
+    width = (REAL64)( hi - lo + 1 )/MUD_SIM_BINS;
+    for( i = lo; i <= hi; i++ )
+    {
+	b = (UINT32)( ( i - lo )/width );
+	if( b >= MUD_SIM_BINS ) b = MUD_SIM_BINS - 1;
+	sums[b] += ( lifetime ?
+		     ( pData[i] - bkgd )*exp( ( (REAL64)i - pHdr->t0_bin )*usPerBin/SIM_TAU_MU_US ) :
+		     pData[i] - bkgd );
+    }
+    free( pData );
+
+    for( b = 0, mean = 0.0; b < MUD_SIM_BINS; b++ ) mean += sums[b];
+    mean /= MUD_SIM_BINS;
+    if( mean <= 0.0 ) return( 0 );
+
+    for( b = 0; b < MUD_SIM_BINS; b++ )
+	pVec[b] = (REAL32)( sums[b]/mean - 1.0 );
+    return( 1 );
+}
+
+
+/*
+ *  MUD_simSignature() - signature of a run (as read by MUD_readFile).
+ *  Returns 1 if at least one histogram contributed.
+ */
+int
+MUD_simSignature( MUD_SEC_GRP* pMUD_fileGrp, MUD_SIM_SIG* pSig )
+{
+    MUD_SEC_GEN_RUN_DESC* pDesc;
+    MUD_SEC_TRI_TI_RUN_DESC* pIdesc;
+    MUD_SEC_GRP* pMUD_histGrp;
+    REAL64 norm;
+    UINT32 h;
+    int i, nGood = 0;
+
+    bzero( pSig, sizeof( MUD_SIM_SIG ) );
+    if( pMUD_fileGrp == NULL ) return( 0 );
+
+    pDesc = (MUD_SEC_GEN_RUN_DESC*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_GEN_RUN_DESC_ID, (UINT32)1, (UINT32)0 );
+    pIdesc = (MUD_SEC_TRI_TI_RUN_DESC*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_TRI_TI_RUN_DESC_ID, (UINT32)1, (UINT32)0 );
+    if( pDesc != NULL )
+    {
+	pSig->runNumber = pDesc->runNumber;
+	pSig->exptNumber = pDesc->exptNumber;
+	pSig->timeBegin = pDesc->timeBegin;
+	if( pDesc->apparatus ) strncpy( pSig->apparatus, pDesc->apparatus, sizeof( pSig->apparatus ) - 1 );
+	if( pDesc->sample ) strncpy( pSig->sample, pDesc->sample, sizeof( pSig->sample ) - 1 );
+    }
+    else if( pIdesc != NULL )
+    {
+	pSig->runNumber = pIdesc->runNumber;
+	pSig->exptNumber = pIdesc->exptNumber;
+	pSig->timeBegin = pIdesc->timeBegin;
+	if( pIdesc->apparatus ) strncpy( pSig->apparatus, pIdesc->apparatus, sizeof( pSig->apparatus ) - 1 );
+	if( pIdesc->sample ) strncpy( pSig->sample, pIdesc->sample, sizeof( pSig->sample ) - 1 );
+    }
+
+    pMUD_histGrp = (MUD_SEC_GRP*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_GRP_ID, MUD_GRP_TRI_TD_HIST_ID, (UINT32)0 );
+    if( pMUD_histGrp == NULL )
+	pMUD_histGrp = (MUD_SEC_GRP*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_GRP_ID, MUD_GRP_TRI_TI_HIST_ID, (UINT32)0 );
+    if( pMUD_histGrp == NULL ) return( 0 );
+
+    pSig->nHists = pMUD_histGrp->num/2;
+    for( h = 0; h < _min( pSig->nHists, MUD_SIM_HISTS ); h++ )
+    {
+	nGood += hist_shape( pMUD_histGrp, h+1, &pSig->vec[h*MUD_SIM_BINS], pSig );
+    }
+    if( nGood == 0 ) return( 0 );
+
+    for( i = 0, norm = 0.0; i < MUD_SIM_DIM; i++ ) norm += (REAL64)pSig->vec[i]*pSig->vec[i];
+    if( norm > 0.0 )
+    {
+	norm = 1.0/sqrt( norm );
+	for( i = 0; i < MUD_SIM_DIM; i++ ) pSig->vec[i] *= (REAL32)norm;
+    }
+    pSig->hash = sig_hash( pSig->vec );
+    return( 1 );
+}
+
+
+static void
+sig_task( int task, int thread, void* pArg )
+{
+    SIM_BATCH* pB = (SIM_BATCH*)pArg;
+    MUD_SEC_GRP* pMUD_fileGrp;
+    FILE* fin;
+
+    pB->pOK[task] = 0;
+    if( ( fin = MUD_openInput( pB->filenames[task] ) ) == NULL ) return;
+    pMUD_fileGrp = (MUD_SEC_GRP*)MUD_readFile( fin );
+    fclose( fin );
+    if( pMUD_fileGrp == NULL ) return;
+
+    pB->pOK[task] = MUD_simSignature( pMUD_fileGrp, &pB->pSigs[task] );
+    MUD_free( pMUD_fileGrp );
+}
+
+
+/*
+ *  MUD_simIndexBuild() - compute the signatures of num files on nThreads
+ *  threads (0 for the default) and write the index.  Files that cannot
+ *  be read or have no histograms are left out.  Returns the number of
+ *  runs indexed, or -1 if the index cannot be written.
+ */
+int
+MUD_simIndexBuild( int num, char** filenames, char* indexname, int nThreads )
+{
+    SIM_BATCH batch;
+    SIM_HEADER hdr;
+    FILE* fout;
+    UINT32* pSel = NULL;
+    UINT32* pStarts = NULL;
+    UINT32* pRows = NULL;
+    UINT32* pNext = NULL;
+    UINT32 n, off, q;
+    int i, b, status = 0;
+
+    batch.filenames = filenames;
+    batch.pSigs = (MUD_SIM_SIG*)zalloc( ( num + 1 )*sizeof( MUD_SIM_SIG ) );
+    batch.pOK = (int*)zalloc( ( num + 1 )*sizeof( int ) );
+    if( batch.pSigs == NULL || batch.pOK == NULL ) goto done;
+
+    MUD_parallelFor( num, nThreads, sig_task, &batch );
+
+    bzero( &hdr, sizeof( hdr ) );
+    bcopy( SIM_MAGIC, hdr.magic, 8 );
+    hdr.version = SIM_VERSION;
+    hdr.byteOrder = SIM_BYTE_ORDER;
+    hdr.sigSize = sizeof( MUD_SIM_SIG );
+    hdr.nBands = SIM_BANDS;
+    if( ( pSel = (UINT32*)malloc( ( num + 1 )*sizeof( UINT32 ) ) ) == NULL ) goto done;
+    for( i = 0, n = 0; i < num; i++ )
+    {
+	if( !batch.pOK[i] ) continue;
+	pSel[n++] = (UINT32)i;
+	hdr.pathBytes += strlen( filenames[i] ) + 1;
+    }
+    hdr.num = n;
+
+    /*
+     *  The rows of each band by bucket, by counting
+     */
+    pStarts = (UINT32*)zalloc( SIM_BANDS*( SIM_BUCKETS + 1 )*sizeof( UINT32 ) );
+    pRows = (UINT32*)malloc( ( (size_t)SIM_BANDS*n + 1 )*sizeof( UINT32 ) );
+    pNext = (UINT32*)malloc( SIM_BUCKETS*sizeof( UINT32 ) );
+    if( pStarts == NULL || pRows == NULL || pNext == NULL ) goto done;
+    for( b = 0; b < SIM_BANDS; b++ )
+    {
+	for( q = 0; q < n; q++ )
+	    pStarts[b*( SIM_BUCKETS + 1 ) + 1 + ( ( batch.pSigs[pSel[q]].hash >> 8*b ) & 0xFF )]++;
+	for( i = 0; i < SIM_BUCKETS; i++ )
+	{
+	    pStarts[b*( SIM_BUCKETS + 1 ) + i + 1] += pStarts[b*( SIM_BUCKETS + 1 ) + i];
+	    pNext[i] = pStarts[b*( SIM_BUCKETS + 1 ) + i];
+	}
+	for( q = 0; q < n; q++ )
+	    pRows[(size_t)b*n + pNext[( batch.pSigs[pSel[q]].hash >> 8*b ) & 0xFF]++] = q;
+    }
+
+    if( ( fout = fopen( indexname, "wb" ) ) == NULL ) goto done;
+    status = ( fwrite( &hdr, sizeof( hdr ), 1, fout ) == 1 );
+    for( q = 0; q < n && status; q++ )
+	status = ( fwrite( &batch.pSigs[pSel[q]], sizeof( MUD_SIM_SIG ), 1, fout ) == 1 );
+    for( q = 0, off = 0; q < n && status; q++ )
+    {
+	status = ( fwrite( &off, sizeof( UINT32 ), 1, fout ) == 1 );
+	off += strlen( filenames[pSel[q]] ) + 1;
+    }
+    if( status )
+	status = ( fwrite( pStarts, sizeof( UINT32 ), SIM_BANDS*( SIM_BUCKETS + 1 ), fout ) ==
+		   SIM_BANDS*( SIM_BUCKETS + 1 ) );
+    if( status && n > 0 )
+	status = ( fwrite( pRows, sizeof( UINT32 ), (size_t)SIM_BANDS*n, fout ) == (size_t)SIM_BANDS*n );
+    for( q = 0; q < n && status; q++ )
+	status = ( fwrite( filenames[pSel[q]], strlen( filenames[pSel[q]] ) + 1, 1, fout ) == 1 );
+    if( fclose( fout ) != 0 ) status = 0;
+
+done:
+    _free( batch.pSigs );
+    _free( batch.pOK );
+    _free( pSel );
+    _free( pStarts );
+    _free( pRows );
+    _free( pNext );
+    return( status ? (int)n : -1 );
+}
+
+
+/*
+ *  MUD_simIndexLoad() - map an index (read it, on Windows); NULL if it
+ *  cannot be read.
+ */
+MUD_SIM_INDEX*
+MUD_simIndexLoad( char* indexname )
+{
+    MUD_SIM_INDEX* pIndex;
+    SIM_HEADER* pHdr;
+    size_t need;
+    UINT32 i, b;
+#ifdef _WIN32
+    FILE* fin;
+    long size;
+
+    if( ( fin = fopen( indexname, "rb" ) ) == NULL ) return( NULL );
+    if( fseek( fin, 0, SEEK_END ) != 0 || ( size = ftell( fin ) ) <= 0 )
+    {
+	fclose( fin );
+	return( NULL );
+    }
+    rewind( fin );
+    pIndex = (MUD_SIM_INDEX*)zalloc( sizeof( MUD_SIM_INDEX ) );
+    if( pIndex == NULL || ( pIndex->pBase = malloc( size ) ) == NULL ||
+	fread( pIndex->pBase, 1, size, fin ) != (size_t)size )
+    {
+	fclose( fin );
+	MUD_simIndexFree( pIndex );
+	return( NULL );
+    }
+    fclose( fin );
+    pIndex->size = (size_t)size;
+#else
+    struct stat st;
+    void* pBase;
+    int f;
+
+    if( ( f = open( indexname, O_RDONLY ) ) < 0 ) return( NULL );
+    if( fstat( f, &st ) != 0 || st.st_size < (off_t)sizeof( SIM_HEADER ) )
+    {
+	close( f );
+	return( NULL );
+    }
+    pBase = mmap( NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, f, 0 );
+    close( f );
+    if( pBase == MAP_FAILED ) return( NULL );
+    if( ( pIndex = (MUD_SIM_INDEX*)zalloc( sizeof( MUD_SIM_INDEX ) ) ) == NULL )
+    {
+	munmap( pBase, (size_t)st.st_size );
+	return( NULL );
+    }
+    pIndex->pBase = pBase;
+    pIndex->size = (size_t)st.st_size;
+    pIndex->mapped = 1;
+#endif /* _WIN32 */
+
+    /*
+     *  A complete index, of this version and byte order
+     */
+    pHdr = (SIM_HEADER*)pIndex->pBase;
+    if( pIndex->size < sizeof( SIM_HEADER ) ||
+	strncmp( pHdr->magic, SIM_MAGIC, 8 ) != 0 ||
+	pHdr->version != SIM_VERSION ||
+	pHdr->byteOrder != SIM_BYTE_ORDER ||
+	pHdr->sigSize != sizeof( MUD_SIM_SIG ) ||
+	pHdr->nBands != SIM_BANDS ) goto fail;
+    need = sizeof( SIM_HEADER ) + (size_t)pHdr->num*( sizeof( MUD_SIM_SIG ) + sizeof( UINT32 ) ) +
+	SIM_BANDS*( SIM_BUCKETS + 1 )*sizeof( UINT32 ) +
+	(size_t)SIM_BANDS*pHdr->num*sizeof( UINT32 ) + pHdr->pathBytes;
+    if( pHdr->num > ( pIndex->size - sizeof( SIM_HEADER ) )/sizeof( MUD_SIM_SIG ) ||
+	need != pIndex->size || ( pHdr->num > 0 && pHdr->pathBytes == 0 ) ) goto fail;
+
+    pIndex->num = pHdr->num;
+    pIndex->nBands = pHdr->nBands;
+    pIndex->pSigs = (MUD_SIM_SIG*)( pHdr + 1 );
+    pIndex->pPathOff = (UINT32*)( pIndex->pSigs + pIndex->num );
+    pIndex->pBucketStarts = pIndex->pPathOff + pIndex->num;
+    pIndex->pBucketRows = pIndex->pBucketStarts + SIM_BANDS*( SIM_BUCKETS + 1 );
+    pIndex->pPaths = (char*)( pIndex->pBucketRows + (size_t)SIM_BANDS*pIndex->num );
+
+    for( i = 0; i < pIndex->num; i++ )
+    {
+	if( pIndex->pPathOff[i] >= pHdr->pathBytes ||
+	    pIndex->pSigs[i].apparatus[15] != '\0' ||
+	    pIndex->pSigs[i].sample[31] != '\0' ) goto fail;
+    }
+    for( b = 0; b < SIM_BANDS; b++ )
+    {
+	if( pIndex->pBucketStarts[b*( SIM_BUCKETS + 1 )] != 0 ||
+	    pIndex->pBucketStarts[b*( SIM_BUCKETS + 1 ) + SIM_BUCKETS] != pIndex->num ) goto fail;
+	for( i = 0; i < SIM_BUCKETS; i++ )
+	{
+	    if( pIndex->pBucketStarts[b*( SIM_BUCKETS + 1 ) + i] >
+		pIndex->pBucketStarts[b*( SIM_BUCKETS + 1 ) + i + 1] ) goto fail;
+	}
+    }
+    for( i = 0; i < SIM_BANDS*pIndex->num; i++ )
+    {
+	if( pIndex->pBucketRows[i] >= pIndex->num ) goto fail;
+    }
+    if( pHdr->pathBytes > 0 && pIndex->pPaths[pHdr->pathBytes-1] != '\0' ) goto fail;
+    return( pIndex );
+
+fail:
+    MUD_simIndexFree( pIndex );
+    return( NULL );
+}
+
+
+void
+MUD_simIndexFree( MUD_SIM_INDEX* pIndex )
+{
+    if( pIndex == NULL ) return;
+#ifndef _WIN32
+    if( pIndex->mapped )
+    {
+	munmap( pIndex->pBase, pIndex->size );
+	pIndex->pBase = NULL;
+    }
+#endif /* !_WIN32 */
+    _free( pIndex->pBase );
+    free( pIndex );
+}
+
+
+/*
+ *  MUD_simFindRun() - row of a run in the index (apparatus may be NULL
+ *  to match any), or -1.
+ */
+int
+MUD_simFindRun( MUD_SIM_INDEX* pIndex, UINT32 runNumber, char* apparatus )
+{
+    UINT32 i;
+
+    for( i = 0; i < pIndex->num; i++ )
+    {
+	if( pIndex->pSigs[i].runNumber == runNumber &&
+	    ( apparatus == NULL || strcmp( pIndex->pSigs[i].apparatus, apparatus ) == 0 ) )
+	    return( (int)i );
+    }
+    return( -1 );
+}
+
+
+/*
+ *  Keep the k best matches, best first
+ */
+static void
+top_insert( MUD_SIM_MATCH* pTop, int* pN, int k, UINT32 row, REAL32 score )
+{
+    int i;
+
+    if( *pN == k && score <= pTop[k-1].score ) return;
+    i = ( *pN < k ) ? (*pN)++ : k - 1;
+    for( ; i > 0 && pTop[i-1].score < score; i-- ) pTop[i] = pTop[i-1];
+    pTop[i].row = row;
+    pTop[i].score = score;
+}
+
+
+static int
+cmp_rows( const void* p1, const void* p2 )
+{
+    UINT32 r1 = *(UINT32*)p1;
+    UINT32 r2 = *(UINT32*)p2;
+
+    return( ( r1 < r2 ) ? -1 : ( r1 > r2 ) );
+}
+
+
+/*
+ *  add_bucket() - append the rows of a bucket of a band to the candidates
+ */
+static int
+add_bucket( MUD_SIM_INDEX* pIndex, int band, int bucket, UINT32** ppCand, UINT32* pN, UINT32* pMax )
+{
+    UINT32* pStarts = pIndex->pBucketStarts + band*( SIM_BUCKETS + 1 );
+    UINT32* pCand;
+    UINT32 first, len;
+
+    first = pStarts[bucket];
+    len = pStarts[bucket+1] - first;
+    if( *pN + len > *pMax )
+    {
+	*pMax = _max( 2*( *pMax ), *pN + len );
+	if( ( pCand = (UINT32*)realloc( *ppCand, ( *pMax + 1 )*sizeof( UINT32 ) ) ) == NULL )
+	    return( 0 );
+	*ppCand = pCand;
+    }
+    bcopy( pIndex->pBucketRows + (size_t)band*pIndex->num + first, *ppCand + *pN,
+	   len*sizeof( UINT32 ) );
+    *pN += len;
+    return( 1 );
+}
+
+
+/*
+ *  lsh_candidates() - the rows (sorted, each once) that share a bucket
+ *  with hash in some band; if fewer than nWant, those one bit away too.
+ *  Returns the number in *ppCand (to be freed), or (UINT32)-1 if out of
+ *  memory.
+ */
+static UINT32
+lsh_candidates( MUD_SIM_INDEX* pIndex, UINT64 hash, UINT32 nWant, UINT32** ppCand )
+{
+    UINT32 n = 0, max = 0, i, u;
+    int b, q, j, level;
+
+    *ppCand = NULL;
+    for( level = 0; level < 2; level++ )
+    {
+	for( b = 0; b < (int)pIndex->nBands; b++ )
+	{
+	    q = (int)( ( hash >> 8*b ) & 0xFF );
+	    for( j = ( level == 0 ) ? -1 : 0; j < ( ( level == 0 ) ? 0 : 8 ); j++ )
+	    {
+		if( !add_bucket( pIndex, b, ( j < 0 ) ? q : q ^ ( 1 << j ), ppCand, &n, &max ) )
+		{
+		    _free( *ppCand );
+		    return( (UINT32)-1 );
+		}
+	    }
+	}
+	if( n == 0 ) continue;
+	qsort( *ppCand, n, sizeof( UINT32 ), cmp_rows );
+	for( i = 1, u = 1; i < n; i++ )
+	{
+	    if( (*ppCand)[i] != (*ppCand)[u-1] ) (*ppCand)[u++] = (*ppCand)[i];
+	}
+	n = u;
+	if( n >= nWant ) break;
+    }
+    return( n );
+}
+
+
+/*
+ *  MUD_simQuery() - the k runs of the index most similar to pSig, best
+ *  first, in pMatches[k].  Only runs of the given apparatus are
+ *  considered unless it is NULL, and row skipRow (e.g. the query run
+ *  itself) is skipped.  With useLsh, only the runs found by the bucket
+ *  tables of the hash are compared in full.  Returns the number of
+ *  matches found.
+ */
+int
+MUD_simQuery( MUD_SIM_INDEX* pIndex, MUD_SIM_SIG* pSig, char* apparatus, int skipRow,
+	      int useLsh, int k, MUD_SIM_MATCH* pMatches )
+{
+    UINT32* pCand = NULL;
+    UINT32 i, row, nCand;
+    int n = 0;
+
+    if( k <= 0 ) return( 0 );
+
+    nCand = pIndex->num;
+    if( useLsh )
+    {
+	nCand = lsh_candidates( pIndex, pSig->hash,
+				_max( (UINT32)k*SIM_LSH_FACTOR, SIM_LSH_MIN ), &pCand );
+	if( nCand == (UINT32)-1 ) nCand = pIndex->num;
+    }
+
+    for( i = 0; i < nCand; i++ )
+    {
+	row = ( pCand != NULL ) ? pCand[i] : i;
+	if( (int)row == skipRow ) continue;
+	if( apparatus != NULL && strcmp( pIndex->pSigs[row].apparatus, apparatus ) != 0 )
+	    continue;
+	top_insert( pMatches, &n, k, row, dot( pIndex->pSigs[row].vec, pSig->vec ) );
+    }
+
+    _free( pCand );
+    return( n );
+}
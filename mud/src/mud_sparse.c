@@ -0,0 +1,386 @@
+/*
+ *  mud_sparse.c -- sparse histograms: the nonzero bins only, as
+ *                  index/count pairs
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version
+ *          18-Oct-2026      Check the size of sparse data before unpacking
+ *
+ *  Description:
+ *    A histogram with bytesPerBin MUD_BPB_SPARSE keeps only its nonzero
+ *    bins.  Its data section is
+ *
+ *      UINT32  nPairs
+ *      UINT8   idxSize      bytes of an index: 1, 2 or 4, by nBins
+ *      UINT8   valSize      bytes of a count: 1, 2 or 4, by the largest
+ *      UINT8   0, 0
+ *      nPairs indices, idxSize bytes each, ascending, from bin 0
+ *      nPairs counts, valSize bytes each
+ *
+ *    all in the byte order of the file.  A histogram with few counts in
+ *    many bins (long time ranges, a scan of which most points saw
+ *    nothing) takes a few bytes per count rather than per bin.  Older
+ *    versions of the library read such a file, but not the counts.
+ *
+ *    MUD_SEC_GEN_HIST_pack() and MUD_SEC_GEN_HIST_unpack() (so MUD_pack,
+ *    MUD_unpack, MUD_getHistData and MUD_setHistData) go between dense
+ *    bins of 1, 2 or 4 bytes and the sparse form by way of
+ *    MUD_sparsePack() and MUD_sparseUnpack(); unpacking clears the bins
+ *    and then sets only the nonzero ones, after checking that the pairs
+ *    fit in the bytes of the data section (MUD_SEC_GEN_HIST_unpackData
+ *    passes them on; MUD_unpack, given no size, trusts the data).  MUD_sparseSize() tells how
+ *    many bytes the sparse form would take, to choose it only when it is
+ *    smaller.
+ *
+ *    MUD_sparseIterInit() and MUD_sparseNext() go through the nonzero
+ *    bins of a histogram as stored, in any form, without unpacking it:
+ *    sparse data gives its pairs; packed (variable-bin) data passes over
+ *    the runs of zero bins whole; other data is scanned bin by bin.
+ */
+
+#include "mud.h"
+
+#define SPARSE_HDR_LEN	8
+
+static int n_bytes _ANSI_ARGS_(( UINT32 val ));
+static UINT32 get_dense _ANSI_ARGS_(( void* pHist, int binSize, UINT32 i ));
+static void put_dense _ANSI_ARGS_(( void* pHist, int binSize, UINT32 i, UINT32 val ));
+static UINT32 get_stored _ANSI_ARGS_(( UINT8* p, int size ));
+static void put_stored _ANSI_ARGS_(( UINT8* p, int size, UINT32 val ));
+static int scan _ANSI_ARGS_(( int num, int inBinSize, void* inHist, UINT32* pMax ));
+
+
+/*
+ *  n_bytes() - of 1, 2 or 4, the fewest that hold val
+ */
+static int
+n_bytes( UINT32 val )
+{
+    if( val & 0xFFFF0000 ) return( 4 );
+    else if( val & 0x0000FF00 ) return( 2 );
+    else return( 1 );
+}
+
+
+static UINT32
+get_dense( void* pHist, int binSize, UINT32 i )
+{
+    switch( binSize )
+    {
+	case 1:
+	    return( ((UINT8*)pHist)[i] );
+	case 2:
+	    return( ((UINT16*)pHist)[i] );
+	default:
+	    return( ((UINT32*)pHist)[i] );
+    }
+}
+
+
+static void
+put_dense( void* pHist, int binSize, UINT32 i, UINT32 val )
+{
+    switch( binSize )
+    {
+	case 1:
+	    ((UINT8*)pHist)[i] = (UINT8)val;
+	    break;
+	case 2:
+	    ((UINT16*)pHist)[i] = (UINT16)val;
+	    break;
+	default:
+	    ((UINT32*)pHist)[i] = val;
+	    break;
+    }
+}
+
+
+/*
+ *  get_stored() - a value of size bytes, in the byte order of the file
+ */
+static UINT32
+get_stored( UINT8* p, int size )
+{
+    UINT8 c;
+    UINT16 s;
+    UINT32 l;
+
+    switch( size )
+    {
+	case 1:
+	    bdecode_1( p, &c );
+	    return( c );
+	case 2:
+	    bdecode_2( p, &s );
+	    return( s );
+	default:
+	    bdecode_4( p, &l );
+	    return( l );
+    }
+}
+
+
+static void
+put_stored( UINT8* p, int size, UINT32 val )
+{
+    UINT8 c;
+    UINT16 s;
+
+    switch( size )
+    {
+	case 1:
+	    c = (UINT8)val;
+	    bencode_1( p, &c );
+	    break;
+	case 2:
+	    s = (UINT16)val;
+	    bencode_2( p, &s );
+	    break;
+	default:
+	    bencode_4( p, &val );
+	    break;
+    }
+}
+
+
+/*
+ *  scan() - the number of nonzero bins, and the largest count
+ */
+static int
+scan( int num, int inBinSize, void* inHist, UINT32* pMax )
+{
+    UINT32 i, val;
+    int n = 0;
+
+    *pMax = 0;
+    for( i = 0; i < (UINT32)num; i++ )
+    {
+	if( ( val = get_dense( inHist, inBinSize, i ) ) == 0 ) continue;
+	if( val > *pMax ) *pMax = val;
+	n++;
+    }
+    return( n );
+}
+
+
+/*
+ *  MUD_sparseSize() - bytes of the sparse form of num bins of inBinSize
+ *  (1, 2 or 4) bytes each
+ */
+int
+MUD_sparseSize( int num, int inBinSize, void* inHist )
+{
+    UINT32 max;
+    int n;
+
+    n = scan( num, inBinSize, inHist, &max );
+    return( SPARSE_HDR_LEN + n*( n_bytes( num > 0 ? num - 1 : 0 ) + n_bytes( max ) ) );
+}
+
+
+/*
+ *  MUD_sparsePack() - num bins of inBinSize (1, 2 or 4) bytes each into
+ *  the sparse form at outSparse, which must hold MUD_sparseSize() bytes
+ *  (8 + 8*num at most).  Returns the bytes written.
+ */
+int
+MUD_sparsePack( int num, int inBinSize, void* inHist, void* outSparse )
+{
+    UINT8* pOut = (UINT8*)outSparse;
+    UINT8* pIdx;
+    UINT8* pVal;
+    UINT32 i, val, max, nPairs;
+    int idxSize, valSize;
+
+    nPairs = (UINT32)scan( num, inBinSize, inHist, &max );
+    idxSize = n_bytes( num > 0 ? num - 1 : 0 );
+    valSize = n_bytes( max );
+
+    bencode_4( pOut, &nPairs );
+    pOut[4] = (UINT8)idxSize;
+    pOut[5] = (UINT8)valSize;
+    pOut[6] = pOut[7] = 0;
+
+    pIdx = pOut + SPARSE_HDR_LEN;
+    pVal = pIdx + nPairs*idxSize;
+    for( i = 0; i < (UINT32)num; i++ )
+    {
+	if( ( val = get_dense( inHist, inBinSize, i ) ) == 0 ) continue;
+	put_stored( pIdx, idxSize, i );
+	put_stored( pVal, valSize, val );
+	pIdx += idxSize;
+	pVal += valSize;
+    }
+    return( (int)( pVal - pOut ) );
+}
+
+
+/*
+ *  MUD_sparseUnpack() - the sparse form, nBytes at inSparse, into num
+ *  bins of outBinSize (1, 2 or 4) bytes each: all are cleared, then the
+ *  nonzero ones set.  Indices beyond num are passed over.  Returns the
+ *  bytes written, or 0 (the bins cleared) if the data is not a whole
+ *  sparse form within nBytes.
+ */
+int
+MUD_sparseUnpack( int num, void* inSparse, UINT32 nBytes, int outBinSize, void* outHist )
+{
+    UINT8* pIn = (UINT8*)inSparse;
+    UINT8* pIdx;
+    UINT8* pVal;
+    UINT32 i, idx, nPairs;
+    int idxSize, valSize;
+
+    bzero( outHist, num*outBinSize );
+
+    if( pIn == NULL || nBytes < SPARSE_HDR_LEN ) return( 0 );
+    bdecode_4( pIn, &nPairs );
+    idxSize = pIn[4];
+    valSize = pIn[5];
+    if( ( idxSize != 1 && idxSize != 2 && idxSize != 4 ) ||
+	( valSize != 1 && valSize != 2 && valSize != 4 ) ) return( 0 );
+    if( SPARSE_HDR_LEN + (UINT64)nPairs*( idxSize + valSize ) > nBytes ) return( 0 );
+
+    pIdx = pIn + SPARSE_HDR_LEN;
+    pVal = pIdx + nPairs*idxSize;
+    for( i = 0; i < nPairs; i++ )
+    {
+	idx = get_stored( pIdx, idxSize );
+	if( idx < (UINT32)num )
+	    put_dense( outHist, outBinSize, idx, get_stored( pVal, valSize ) );
+	pIdx += idxSize;
+	pVal += valSize;
+    }
+    return( num*outBinSize );
+}
+
+
+/*
+ *  MUD_sparseIterInit() - to go through the nonzero bins of nBins as
+ *  stored, nBytes at pData, at bytesPerBin (0, 1, 2, 4 or
+ *  MUD_BPB_SPARSE).  Returns 0 if the data cannot be read so.
+ */
+int
+MUD_sparseIterInit( MUD_SPARSE_ITER* pIter, UINT32 nBins, UINT32 bytesPerBin,
+		    void* pData, UINT32 nBytes )
+{
+    UINT8* p = (UINT8*)pData;
+
+    bzero( pIter, sizeof( MUD_SPARSE_ITER ) );
+    pIter->pData = p;
+    pIter->nBytes = nBytes;
+    pIter->nBins = nBins;
+    pIter->bytesPerBin = (int)bytesPerBin;
+
+    switch( bytesPerBin )
+    {
+	case 0:
+	    return( 1 );
+	case 1:
+	case 2:
+	case 4:
+	    return( (UINT64)nBins*bytesPerBin <= nBytes );
+	case MUD_BPB_SPARSE:
+	    if( p == NULL || nBytes < SPARSE_HDR_LEN ) return( 0 );
+	    bdecode_4( p, &pIter->nPairs );
+	    pIter->idxSize = p[4];
+	    pIter->valSize = p[5];
+	    if( ( pIter->idxSize != 1 && pIter->idxSize != 2 && pIter->idxSize != 4 ) ||
+		( pIter->valSize != 1 && pIter->valSize != 2 && pIter->valSize != 4 ) ) return( 0 );
+	    if( SPARSE_HDR_LEN + (UINT64)pIter->nPairs*( pIter->idxSize + pIter->valSize ) > nBytes )
+		return( 0 );
+	    pIter->pos = SPARSE_HDR_LEN;
+	    return( 1 );
+	default:
+	    return( 0 );
+    }
+}
+
+
+/*
+ *  MUD_sparseNext() - the next nonzero bin (from 0) and its count.
+ *  Returns 0 when there are no more.
+ */
+int
+MUD_sparseNext( MUD_SPARSE_ITER* pIter, UINT32* pBin, UINT32* pCount )
+{
+    UINT8* p = pIter->pData;
+    MUD_VAR_BIN_LEN_TYPE runLen;
+    UINT32 val;
+
+    switch( pIter->bytesPerBin )
+    {
+	case MUD_BPB_SPARSE:
+	    while( pIter->bin < pIter->nPairs )
+	    {
+		*pBin = get_stored( p + pIter->pos + pIter->bin*pIter->idxSize, pIter->idxSize );
+		*pCount = get_stored( p + pIter->pos + pIter->nPairs*pIter->idxSize +
+				      pIter->bin*pIter->valSize, pIter->valSize );
+		pIter->bin++;
+		if( *pBin < pIter->nBins && *pCount != 0 ) return( 1 );
+	    }
+	    return( 0 );
+
+	case 0:
+	    /*
+	     *  Runs of bins: 2 bytes of length, 1 of bin size, then the
+	     *  bins (none for a run of zeros)
+	     */
+	    while( pIter->bin < pIter->nBins )
+	    {
+		if( pIter->runLeft == 0 )
+		{
+		    if( pIter->pos + 3 > pIter->nBytes ) return( 0 );
+		    bdecode_2( p + pIter->pos, &runLen );
+		    pIter->runSize = p[pIter->pos+2];
+		    pIter->pos += 3;
+		    if( runLen == 0 ) return( 0 );
+		    if( pIter->runSize == 0 )
+		    {
+			pIter->bin += runLen;
+			continue;
+		    }
+		    if( ( pIter->runSize != 1 && pIter->runSize != 2 && pIter->runSize != 4 ) ||
+			pIter->pos + (UINT64)runLen*pIter->runSize > pIter->nBytes ) return( 0 );
+		    pIter->runLeft = runLen;
+		}
+		val = get_stored( p + pIter->pos, pIter->runSize );
+		pIter->pos += pIter->runSize;
+		pIter->runLeft--;
+		if( val != 0 )
+		{
+		    *pBin = pIter->bin++;
+		    *pCount = val;
+		    return( 1 );
+		}
+		pIter->bin++;
+	    }
+	    return( 0 );
+
+	default:
+	    while( pIter->bin < pIter->nBins )
+	    {
+		val = get_stored( p + pIter->bin*pIter->bytesPerBin, pIter->bytesPerBin );
+		if( val != 0 )
+		{
+		    *pBin = pIter->bin++;
+		    *pCount = val;
+		    return( 1 );
+		}
+		pIter->bin++;
+	    }
+	    return( 0 );
+    }
+}
@@ -0,0 +1,349 @@
+/*
+ *  mud_t0.c -- automatic time-zero (t0) determination for histograms,
+ *              and in-place correction of t0 in histogram headers
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026  DJA Initial version
+ *          18-Oct-2026  DJA As many histograms per run as it has
+ *
+ *  Description:
+ *    MUD_findT0() looks at one unpacked (4 bytes per bin) histogram.
+ *    The highest bin is found (with AVX2 when compiled for it) and its
+ *    position refined by a parabola through the logs of it and its
+ *    neighbours.  The rising edge is where the counts first reach half
+ *    way from the pre-t0 baseline to the maximum, interpolated between
+ *    bins.  If the maximum stands well above the counts shortly after
+ *    it, it is a prompt peak and t0 is taken at the peak; otherwise t0
+ *    is the edge.
+ *
+ *    MUD_patchT0() rewrites t0_bin and t0_ps of the histogram headers
+ *    of a file in place, without decoding or rewriting anything else:
+ *    the sections are walked using the size in each section core, and
+ *    only the two words are overwritten.
+ */
+
+#include <math.h>
+#include "mud.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif /* __AVX2__ */
+
+#define T0_PLATEAU_GAP	10	/* bins after the peak before the plateau */
+#define T0_PLATEAU_LEN	50	/* bins of plateau averaged */
+#define T0_PEAK_RATIO	1.5	/* peak/plateau (above baseline) for a prompt peak */
+
+/* Offsets in a MUD_SEC_GEN_HIST_HDR section as written in a file */
+#define HDR_OFF_FSPERBIN	28
+#define HDR_OFF_T0_PS		32
+#define HDR_OFF_T0_BIN		36
+
+typedef struct {
+    char**	filenames;
+    MUD_T0_RUN*	pRuns;
+    int		patch;
+} T0_BATCH;
+
+static UINT32 max_bin _ANSI_ARGS_(( UINT32* pData, UINT32 nBins, UINT32* pMax ));
+static void t0_task _ANSI_ARGS_(( int task, int thread, void* pArg ));
+
+
+/*
+ *  Index of the first highest bin
+ */
+static UINT32
+max_bin( UINT32* pData, UINT32 nBins, UINT32* pMax )
+{
+    UINT32 i = 0;
+    UINT32 max = 0;
+#ifdef __AVX2__
+    __m256i vmax, v;
+    UINT32 lanes[8];
+    int j, mask;
+
+    if( nBins >= 8 )
+    {
+	vmax = _mm256_setzero_si256();
+	for( ; i + 8 <= nBins; i += 8 )
+	{
+	    vmax = _mm256_max_epu32( vmax, _mm256_loadu_si256( (__m256i*)&pData[i] ) );
+	}
+	_mm256_storeu_si256( (__m256i*)lanes, vmax );
+	for( j = 0; j < 8; j++ ) max = _max( max, lanes[j] );
+    }
+#endif /* __AVX2__ */
+
+    for( ; i < nBins; i++ ) max = _max( max, pData[i] );
+    *pMax = max;
+
+    i = 0;
+#ifdef __AVX2__
+    vmax = _mm256_set1_epi32( (int)max );
+    for( ; i + 8 <= nBins; i += 8 )
+    {
+	v = _mm256_cmpeq_epi32( vmax, _mm256_loadu_si256( (__m256i*)&pData[i] ) );
+	mask = _mm256_movemask_ps( _mm256_castsi256_ps( v ) );
+	if( mask != 0 )
+	{
+	    for( j = 0; !( mask & ( 1 << j ) ); j++ ) ;
+	    return( i + j );
+	}
+    }
+#endif /* __AVX2__ */
+
+    for( ; i < nBins; i++ )
+    {
+	if( pData[i] == max ) break;
+    }
+    return( i );
+}
+
+
+/*
+ *  MUD_findT0() - find t0 of one histogram of nBins 4-byte bins.
+ *  Returns 1 if found, 0 if the histogram is empty or too short.
+ */
+int
+MUD_findT0( UINT32* pData, UINT32 nBins, MUD_T0* pT0 )
+{
+    UINT32 iPeak, iLo, i, n;
+    REAL64 base, level, plateau, ym, y0, yp, d;
+
+    bzero( pT0, sizeof( MUD_T0 ) );
+    if( nBins < 3 ) return( 0 );
+
+    iPeak = max_bin( pData, nBins, &pT0->peakCounts );
+    if( pT0->peakCounts == 0 ) return( 0 );
+
+    /*
+     *  Peak position: parabola through the logs of the highest bin and
+     *  its neighbours (exact for a Gaussian peak)
+     */
+    pT0->peak = iPeak;
+    if( iPeak > 0 && iPeak < nBins - 1 && pData[iPeak-1] > 0 && pData[iPeak+1] > 0 )
+    {
+	ym = log( (REAL64)pData[iPeak-1] );
+	y0 = log( (REAL64)pData[iPeak] );
+	yp = log( (REAL64)pData[iPeak+1] );
+	d = ym - 2.0*y0 + yp;
+	if( d < 0.0 ) pT0->peak += 0.5*( ym - yp )/d;
+    }
+
+    /*
+     *  Baseline from the first half of the bins before the peak
+     */
+    base = 0.0;
+    n = iPeak/2;
+    for( i = 0; i < n; i++ ) base += pData[i];
+    if( n > 0 ) base /= n;
+
+    /*
+     *  Rising edge: last bin before the peak below half height
+     */
+    level = base + 0.5*( pT0->peakCounts - base );
+    for( iLo = iPeak; iLo > 0 && pData[iLo-1] >= level; iLo-- ) ;
+    if( iLo == 0 )
+    {
+	pT0->edge = 0.0;
+    }
+    else
+    {
+	d = (REAL64)pData[iLo] - (REAL64)pData[iLo-1];
+	pT0->edge = ( iLo - 1 ) + ( ( d > 0.0 ) ? ( level - pData[iLo-1] )/d : 0.0 );
+    }
+
+    /*
+     *  A prompt peak stands out above the counts that follow it
+     */
+    plateau = 0.0;
+    n = 0;
+    for( i = iPeak + T0_PLATEAU_GAP; i < nBins && n < T0_PLATEAU_LEN; i++, n++ )
+	plateau += pData[i];
+    if( n > 0 )
+    {
+	plateau /= n;
+	pT0->hasPeak = ( pT0->peakCounts - base > T0_PEAK_RATIO*( plateau - base ) );
+    }
+
+    pT0->t0 = pT0->hasPeak ? pT0->peak : pT0->edge;
+    pT0->status = 1;
+    return( 1 );
+}
+
+
+/*
+ *  MUD_patchT0() - set t0 of histograms 1..num of a MUD file in place:
+ *  t0_bin to pT0[n-1] rounded, and t0_ps to pT0[n-1] bins in ps.
+ *  Histograms with negative pT0 are left alone.  Returns the number of
+ *  headers rewritten.
+ */
+int
+MUD_patchT0( char* filename, int num, REAL64* pT0 )
+{
+    FILE* fio;
+    char core[12];
+    char word[4];
+    UINT32 size, secID, instanceID, fsPerBin, t0_ps, t0_bin;
+    long pos;
+    int nPatched = 0;
+
+    if( ( fio = fopen( filename, "r+b" ) ) == NULL ) return( 0 );
+
+    for( pos = 0; ; pos += size )
+    {
+	if( fseek( fio, pos, SEEK_SET ) != 0 || fread( core, 12, 1, fio ) != 1 ) break;
+	bdecode_4( core, &size );
+	bdecode_4( core + 4, &secID );
+	bdecode_4( core + 8, &instanceID );
+	if( size < 12 ) break;
+
+	if( secID != MUD_SEC_GEN_HIST_HDR_ID || instanceID < 1 ||
+	    instanceID > num || pT0[instanceID-1] < 0.0 ) continue;
+
+	if( fseek( fio, pos + HDR_OFF_FSPERBIN, SEEK_SET ) != 0 ||
+	    fread( word, 4, 1, fio ) != 1 ) break;
+	bdecode_4( word, &fsPerBin );
+
+	t0_bin = (UINT32)floor( pT0[instanceID-1] + 0.5 );
+	t0_ps = (UINT32)floor( pT0[instanceID-1]*fsPerBin/1000.0 + 0.5 );
+
+	if( fseek( fio, pos + HDR_OFF_T0_PS, SEEK_SET ) != 0 ) break;
+	bencode_4( word, &t0_ps );
+	if( fwrite( word, 4, 1, fio ) != 1 ) break;
+	bencode_4( word, &t0_bin );
+	if( fwrite( word, 4, 1, fio ) != 1 ) break;
+	nPatched++;
+    }
+
+    if( fclose( fio ) != 0 ) nPatched = 0;
+    return( nPatched );
+}
+
+
+static void
+t0_task( int task, int thread, void* pArg )
+{
+    T0_BATCH* pB = (T0_BATCH*)pArg;
+    MUD_T0_RUN* pRun = &pB->pRuns[task];
+    MUD_SEC_GRP* pMUD_fileGrp;
+    MUD_SEC_GRP* pMUD_histGrp;
+    MUD_SEC_GEN_RUN_DESC* pDesc;
+    MUD_SEC_GEN_HIST_HDR* pHdr;
+    MUD_SEC_GEN_HIST_DAT* pDat;
+    UINT32* pData;
+    REAL64* t0;
+    FILE* fin;
+    int i, nFound = 0;
+
+    bzero( pRun, sizeof( MUD_T0_RUN ) );
+    if( ( fin = MUD_openInput( pB->filenames[task] ) ) == NULL ) return;
+    pMUD_fileGrp = (MUD_SEC_GRP*)MUD_readFile( fin );
+    fclose( fin );
+    if( pMUD_fileGrp == NULL ) return;
+
+    pDesc = (MUD_SEC_GEN_RUN_DESC*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_GEN_RUN_DESC_ID, (UINT32)1, (UINT32)0 );
+    if( pDesc != NULL ) pRun->runNumber = pDesc->runNumber;
+
+    pMUD_histGrp = (MUD_SEC_GRP*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_GRP_ID, MUD_GRP_TRI_TD_HIST_ID, (UINT32)0 );
+    if( pMUD_histGrp == NULL )
+	pMUD_histGrp = (MUD_SEC_GRP*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_GRP_ID, MUD_GRP_TRI_TI_HIST_ID, (UINT32)0 );
+    if( pMUD_histGrp == NULL )
+    {
+	MUD_free( pMUD_fileGrp );
+	return;
+    }
+
+    pRun->nHists = pMUD_histGrp->num/2;
+    pRun->hist = (MUD_T0*)zalloc( ( pRun->nHists + 1 )*sizeof( MUD_T0 ) );
+    t0 = (REAL64*)malloc( ( pRun->nHists + 1 )*sizeof( REAL64 ) );
+    if( pRun->hist == NULL || t0 == NULL )
+    {
+	_free( pRun->hist );
+	_free( t0 );
+	pRun->nHists = 0;
+	MUD_free( pMUD_fileGrp );
+	return;
+    }
+    for( i = 0; i < pRun->nHists; i++ )
+    {
+	t0[i] = -1.0;
+	pHdr = (MUD_SEC_GEN_HIST_HDR*)MUD_search( pMUD_histGrp->pMem,
+			  MUD_SEC_GEN_HIST_HDR_ID, (UINT32)(i+1), (UINT32)0 );
+	pDat = (MUD_SEC_GEN_HIST_DAT*)MUD_search( pMUD_histGrp->pMem,
+			  MUD_SEC_GEN_HIST_DAT_ID, (UINT32)(i+1), (UINT32)0 );
+	if( pHdr == NULL || pDat == NULL || pDat->pData == NULL ) continue;
+
+	pData = (UINT32*)malloc( _max( pHdr->nBins, 1 )*sizeof( UINT32 ) );
+	if( pData == NULL ) continue;
+	MUD_SEC_GEN_HIST_unpackData( pHdr->nBins, pHdr->bytesPerBin, pDat->pData, pDat->nBytes, 4, pData );
+	if( MUD_findT0( pData, pHdr->nBins, &pRun->hist[i] ) )
+	{
+	    t0[i] = pRun->hist[i].t0;
+	    nFound++;
+	}
+	free( pData );
+    }
+    MUD_free( pMUD_fileGrp );
+
+    pRun->status = ( nFound == pRun->nHists && nFound > 0 );
+    if( pB->patch && nFound > 0 )
+	pRun->patched = ( MUD_patchT0( pB->filenames[task], pRun->nHists, t0 ) == nFound );
+    free( t0 );
+}
+
+
+/*
+ *  MUD_t0Batch() - find t0 of every histogram of num runs on nThreads
+ *  threads (0 for the default; see MUD_numThreads), and if patch is set
+ *  write the values found back into each file.  The results of each run
+ *  are for all its histograms, and are freed with MUD_t0Free.  Returns
+ *  the number of runs in which t0 was found for every histogram.
+ */
+int
+MUD_t0Batch( int num, char** filenames, MUD_T0_RUN* pRuns, int patch, int nThreads )
+{
+    T0_BATCH batch;
+    int i, nGood;
+
+    batch.filenames = filenames;
+    batch.pRuns = pRuns;
+    batch.patch = patch;
+    MUD_parallelFor( num, nThreads, t0_task, &batch );
+
+    for( i = 0, nGood = 0; i < num; i++ )
+    {
+	if( pRuns[i].status ) nGood++;
+    }
+    return( nGood );
+}
+
+
+/*
+ *  MUD_t0Free() - free the histograms of the results of MUD_t0Batch
+ */
+void
+MUD_t0Free( int num, MUD_T0_RUN* pRuns )
+{
+    int i;
+
+    for( i = 0; i < num; i++ )
+    {
+	_free( pRuns[i].hist );
+	pRuns[i].nHists = 0;
+    }
+}
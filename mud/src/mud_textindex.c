@@ -0,0 +1,1309 @@
+/*
+ *  mud_textindex.c -- full-text index of the run descriptions and
+ *                     comments in directories of MUD files
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026  DJA Initial version
+ *          18-Oct-2026  DJA Check the posting lists when reading an index;
+ *                       fail an update that runs out of memory
+ *
+ *  Description:
+ *    The index has one document per run file.  Its text is the string
+ *    fields of the run description (MUD_SEC_GEN_RUN_DESC or
+ *    MUD_SEC_TRI_TI_RUN_DESC) and the author, title and body of each
+ *    comment (MUD_SEC_CMT).  The tokens are the runs of letters and
+ *    digits (and of bytes above 127, so UTF-8 words survive), folded to
+ *    lower case and cut at TXT_MAXTOK bytes.  Each token has a position
+ *    in its document; the fields are TXT_FIELD_GAP positions apart, so
+ *    a phrase never spans two fields.
+ *
+ *    Each term keeps a posting list of the documents containing it, in
+ *    increasing order, each as
+ *
+ *      varint  doc delta     (the first is the document number itself)
+ *      varint  nPos          number of positions in the document
+ *      nPos x varint         position deltas (the first absolute)
+ *
+ *    where a varint is 7 bits per byte, low bits first, with the top bit
+ *    set on all but the last byte.  New documents always get the highest
+ *    numbers, so adding a file only appends to the lists of its terms.
+ *    An update (MUD_textIndexUpdate) drops the documents of files that
+ *    are gone or whose size or modification time changed, renumbering
+ *    the rest in place (the deltas only shrink), and then reads just the
+ *    new and changed files.
+ *
+ *    A query is a list of words and "quoted phrases", all of which must
+ *    be found in a document.  A word is found from the term hash table
+ *    and its list decoded; a phrase walks the lists of its words in step
+ *    and compares positions only in the documents they share.
+ *
+ *    The index file holds (all integers little-endian):
+ *
+ *      char    magic[8]      "MUDTXIDX"
+ *      UINT32  version       1
+ *      UINT32  nDocs
+ *      UINT32  nTerms
+ *      UINT32  reserved[3]
+ *      nDocs x { UINT32 len, char path[len], UINT64 size, UINT64 mtime }
+ *      nTerms x { UINT32 len, char term[len], UINT32 nDocs,
+ *                 UINT32 lastDoc, UINT32 postLen, UINT8 post[postLen] }
+ *
+ *    Reading an index walks every posting list once, so that a damaged
+ *    file (documents out of order or beyond nDocs, a count of documents
+ *    other than nDocs of the term, a varint running off the end) is
+ *    turned down rather than trusted by the searches and updates.
+ */
+
+#include <ctype.h>
+#include "mud.h"
+#include <sys/stat.h>
+
+#define TXT_MAGIC		"MUDTXIDX"
+#define TXT_VERSION		1
+#define TXT_HDR_SIZE		32
+#define TXT_BATCH_SIZE		4096	/* files read per parallel batch */
+#define TXT_MAXTOK		32	/* longest token, in bytes */
+#define TXT_FIELD_GAP		8	/* positions between fields */
+#define TXT_MAXPATH		65536
+
+#define is_tok_char( c )	( isalnum( c ) || (c) >= 0x80 )
+
+typedef struct {
+    char	tok[TXT_MAXTOK+1];
+    UINT32	pos;
+} TXT_TOKEN;
+
+/* One file as read, before its tokens are added to the index */
+typedef struct {
+    int		ok;
+    UINT64	print[2];	/* size, mtime */
+    int		nTok;
+    int		tokAlloc;
+    TXT_TOKEN*	pTok;		/* sorted by token, then position */
+} TXT_DOC;
+
+typedef struct {
+    char**	files;
+    TXT_DOC*	pDocs;
+    UINT64*	pPrints;	/* 2 per file, for print_task */
+} TXT_BATCH;
+
+typedef struct {
+    char*	path;
+    UINT32	doc;
+} TXT_PATHREF;
+
+/* Position in a posting list */
+typedef struct {
+    UINT8*	p;		/* next entry */
+    UINT32	left;		/* entries not yet read */
+    UINT32	doc;
+    UINT32	nPos;
+    UINT8*	pPos;		/* positions of doc */
+} TXT_CURSOR;
+
+static int put_varint _ANSI_ARGS_(( UINT8* p, UINT32 v ));
+static UINT32 get_varint _ANSI_ARGS_(( UINT8** pp ));
+static int check_varint _ANSI_ARGS_(( UINT8** pp, UINT8* pEnd, UINT32* pV ));
+static int check_postings _ANSI_ARGS_(( MUD_TEXT_TERM* pTerm, UINT32 nDocs ));
+static int next_token _ANSI_ARGS_(( char** pp, char* tok ));
+static UINT32 hash_term _ANSI_ARGS_(( char* s ));
+static int rehash _ANSI_ARGS_(( MUD_TEXTINDEX* pIdx, UINT32 size ));
+static int find_term _ANSI_ARGS_(( MUD_TEXTINDEX* pIdx, char* s, UINT32* pNum, UINT32* pSlot ));
+static int add_term _ANSI_ARGS_(( MUD_TEXTINDEX* pIdx, char* s, UINT32* pNum ));
+static int add_posting _ANSI_ARGS_(( MUD_TEXT_TERM* pTerm, UINT32 doc, TXT_TOKEN* pTok, int n ));
+static int add_doc _ANSI_ARGS_(( MUD_TEXTINDEX* pIdx, char* path, TXT_DOC* pDoc ));
+static int compact _ANSI_ARGS_(( MUD_TEXTINDEX* pIdx, char* pKeep ));
+static int add_field _ANSI_ARGS_(( TXT_DOC* pDoc, char* s, UINT32* pPos ));
+static int cmp_tokens _ANSI_ARGS_(( const void* p1, const void* p2 ));
+static int cmp_pathrefs _ANSI_ARGS_(( const void* p1, const void* p2 ));
+static int read_doc _ANSI_ARGS_(( MUD_SEC_GRP* pMUD_fileGrp, TXT_DOC* pDoc ));
+static int get_print _ANSI_ARGS_(( char* path, FILE* fin, UINT64* pPrint ));
+static void print_task _ANSI_ARGS_(( int task, int thread, void* pArg ));
+static void doc_task _ANSI_ARGS_(( int task, int thread, void* pArg ));
+static void cursor_init _ANSI_ARGS_(( TXT_CURSOR* pC, MUD_TEXT_TERM* pTerm ));
+static int cursor_next _ANSI_ARGS_(( TXT_CURSOR* pC ));
+static int phrase_at _ANSI_ARGS_(( TXT_CURSOR* pC, int nTerms, UINT32* pPos ));
+static int find_phrase _ANSI_ARGS_(( MUD_TEXTINDEX* pIdx, UINT32* pTermNums, int nTerms, int* pOut ));
+static int write_4 _ANSI_ARGS_(( FILE* fout, UINT32 u ));
+static int read_4 _ANSI_ARGS_(( FILE* fin, UINT32* pU ));
+
+
+/*
+ *  MUD_textIndexNew() - an empty index; NULL if out of memory.
+ */
+MUD_TEXTINDEX*
+MUD_textIndexNew( void )
+{
+    MUD_TEXTINDEX* pIdx;
+
+    if( ( pIdx = (MUD_TEXTINDEX*)zalloc( sizeof( MUD_TEXTINDEX ) ) ) == NULL )
+	return( NULL );
+    if( !rehash( pIdx, 1024 ) )
+    {
+	free( pIdx );
+	return( NULL );
+    }
+    return( pIdx );
+}
+
+
+void
+MUD_textIndexFree( MUD_TEXTINDEX* pIdx )
+{
+    UINT32 i;
+
+    if( pIdx == NULL ) return;
+    for( i = 0; i < pIdx->nDocs; i++ )
+    {
+	_free( pIdx->paths[i] );
+    }
+    for( i = 0; i < pIdx->nTerms; i++ )
+    {
+	_free( pIdx->pTerms[i].term );
+	_free( pIdx->pTerms[i].pPost );
+    }
+    _free( pIdx->paths );
+    _free( pIdx->pSize );
+    _free( pIdx->pMtime );
+    _free( pIdx->pTerms );
+    _free( pIdx->pHash );
+    free( pIdx );
+}
+
+
+char*
+MUD_textDocPath( MUD_TEXTINDEX* pIdx, int doc )
+{
+    if( doc < 0 || (UINT32)doc >= pIdx->nDocs ) return( NULL );
+    return( pIdx->paths[doc] );
+}
+
+
+/*
+ *  Varints: 7 bits per byte, low bits first
+ */
+static int
+put_varint( UINT8* p, UINT32 v )
+{
+    int n = 0;
+
+    while( v >= 0x80 )
+    {
+	p[n++] = (UINT8)( v | 0x80 );
+	v >>= 7;
+    }
+    p[n++] = (UINT8)v;
+    return( n );
+}
+
+
+static UINT32
+get_varint( UINT8** pp )
+{
+    UINT8* p = *pp;
+    UINT32 v = 0;
+    int shift = 0;
+
+    while( *p & 0x80 )
+    {
+	v |= (UINT32)( *p++ & 0x7F ) << shift;
+	shift += 7;
+    }
+    v |= (UINT32)*p++ << shift;
+    *pp = p;
+    return( v );
+}
+
+
+/*
+ *  check_varint() - get_varint(), for data not yet trusted: returns 0 if
+ *  the varint runs past pEnd or is longer than a UINT32 needs
+ */
+static int
+check_varint( UINT8** pp, UINT8* pEnd, UINT32* pV )
+{
+    UINT8* p = *pp;
+    int n;
+
+    for( n = 0; p + n < pEnd && n < 5; n++ )
+    {
+	if( !( p[n] & 0x80 ) )
+	{
+	    *pV = get_varint( pp );
+	    return( 1 );
+	}
+    }
+    return( 0 );
+}
+
+
+/*
+ *  check_postings() - whether the posting list of a term, as read, is
+ *  nDocs of the term in increasing order below nDocs, ending with
+ *  lastDoc at the end of the list
+ */
+static int
+check_postings( MUD_TEXT_TERM* pTerm, UINT32 nDocs )
+{
+    UINT8* p = pTerm->pPost;
+    UINT8* pEnd = pTerm->pPost + pTerm->len;
+    UINT32 doc = 0, delta, nPos, pos, i, n;
+
+    for( n = 0; n < pTerm->nDocs; n++ )
+    {
+	if( !check_varint( &p, pEnd, &delta ) || ( n > 0 && delta == 0 ) ||
+	    delta >= nDocs - doc ) return( 0 );
+	doc += delta;
+	if( !check_varint( &p, pEnd, &nPos ) || nPos == 0 ||
+	    nPos > (UINT32)( pEnd - p ) ) return( 0 );
+	for( i = 0; i < nPos; i++ )
+	{
+	    if( !check_varint( &p, pEnd, &pos ) ) return( 0 );
+	}
+    }
+    return( p == pEnd && doc == pTerm->lastDoc );
+}
+
+
+/*
+ *  next_token() - the next token at or after *pp, lower case, into tok
+ *  (TXT_MAXTOK+1 bytes); returns 0 if there is none.
+ */
+static int
+next_token( char** pp, char* tok )
+{
+    unsigned char* p = (unsigned char*)*pp;
+    int n = 0;
+
+    while( *p != '\0' && !is_tok_char( *p ) ) p++;
+    for( ; *p != '\0' && is_tok_char( *p ); p++ )
+    {
+	if( n < TXT_MAXTOK ) tok[n++] = (char)tolower( *p );
+    }
+    tok[n] = '\0';
+    *pp = (char*)p;
+    return( n > 0 );
+}
+
+
+/*
+ *  hash_term() - FNV-1a hash of a term
+ */
+static UINT32
+hash_term( char* s )
+{
+    UINT32 h = 2166136261U;
+
+    for( ; *s != '\0'; s++ )
+    {
+	h ^= (unsigned char)*s;
+	h *= 16777619U;
+    }
+    return( h );
+}
+
+
+/*
+ *  rehash() - rebuild the term hash table with size (a power of 2) slots
+ */
+static int
+rehash( MUD_TEXTINDEX* pIdx, UINT32 size )
+{
+    UINT32* pHash;
+    UINT32 h, n;
+
+    if( ( pHash = (UINT32*)zalloc( size*sizeof( UINT32 ) ) ) == NULL ) return( 0 );
+    for( n = 0; n < pIdx->nTerms; n++ )
+    {
+	h = hash_term( pIdx->pTerms[n].term ) & ( size - 1 );
+	while( pHash[h] != 0 ) h = ( h + 1 ) & ( size - 1 );
+	pHash[h] = n + 1;
+    }
+    _free( pIdx->pHash );
+    pIdx->pHash = pHash;
+    pIdx->hashSize = size;
+    return( 1 );
+}
+
+
+/*
+ *  find_term() - look up a term; returns 1 and its number if it is in
+ *  the index, else 0 and the empty hash slot where it would go.
+ */
+static int
+find_term( MUD_TEXTINDEX* pIdx, char* s, UINT32* pNum, UINT32* pSlot )
+{
+    UINT32 h;
+
+    h = hash_term( s ) & ( pIdx->hashSize - 1 );
+    while( pIdx->pHash[h] != 0 )
+    {
+	if( strcmp( pIdx->pTerms[pIdx->pHash[h]-1].term, s ) == 0 )
+	{
+	    *pNum = pIdx->pHash[h] - 1;
+	    return( 1 );
+	}
+	h = ( h + 1 ) & ( pIdx->hashSize - 1 );
+    }
+    *pSlot = h;
+    return( 0 );
+}
+
+
+/*
+ *  add_term() - the number of a term, adding it if it is new; returns 0
+ *  if out of memory.
+ */
+static int
+add_term( MUD_TEXTINDEX* pIdx, char* s, UINT32* pNum )
+{
+    MUD_TEXT_TERM* pTerms;
+    UINT32 slot, n;
+
+    if( find_term( pIdx, s, pNum, &slot ) ) return( 1 );
+
+    if( pIdx->nTerms == pIdx->termAlloc )
+    {
+	n = _max( 1024, 2*pIdx->termAlloc );
+	pTerms = (MUD_TEXT_TERM*)realloc( pIdx->pTerms, n*sizeof( MUD_TEXT_TERM ) );
+	if( pTerms == NULL ) return( 0 );
+	pIdx->pTerms = pTerms;
+	pIdx->termAlloc = n;
+    }
+    bzero( &pIdx->pTerms[pIdx->nTerms], sizeof( MUD_TEXT_TERM ) );
+    if( ( pIdx->pTerms[pIdx->nTerms].term = strdup( s ) ) == NULL ) return( 0 );
+    *pNum = pIdx->nTerms++;
+    pIdx->pHash[slot] = *pNum + 1;
+
+    /*
+     *  Keep the table at most half full
+     */
+    if( 2*pIdx->nTerms > pIdx->hashSize && !rehash( pIdx, 2*pIdx->hashSize ) )
+	return( 0 );
+    return( 1 );
+}
+
+
+/*
+ *  add_posting() - append document doc, with the positions of its n
+ *  tokens, to the postings of a term
+ */
+static int
+add_posting( MUD_TEXT_TERM* pTerm, UINT32 doc, TXT_TOKEN* pTok, int n )
+{
+    UINT8* pPost;
+    UINT32 need, alloc, last;
+    int i;
+
+    need = 5*( n + 2 );
+    if( pTerm->len + need > pTerm->alloc )
+    {
+	alloc = _max( 16, 2*pTerm->alloc );
+	while( alloc < pTerm->len + need ) alloc *= 2;
+	if( ( pPost = (UINT8*)realloc( pTerm->pPost, alloc ) ) == NULL ) return( 0 );
+	pTerm->pPost = pPost;
+	pTerm->alloc = alloc;
+    }
+
+    pPost = pTerm->pPost + pTerm->len;
+    pPost += put_varint( pPost, ( pTerm->nDocs > 0 ) ? doc - pTerm->lastDoc : doc );
+    pPost += put_varint( pPost, (UINT32)n );
+    for( i = 0, last = 0; i < n; i++ )
+    {
+	pPost += put_varint( pPost, pTok[i].pos - last );
+	last = pTok[i].pos;
+    }
+    pTerm->len = (UINT32)( pPost - pTerm->pPost );
+    pTerm->lastDoc = doc;
+    pTerm->nDocs++;
+    return( 1 );
+}
+
+
+/*
+ *  add_doc() - add a file as read as the next document
+ */
+static int
+add_doc( MUD_TEXTINDEX* pIdx, char* path, TXT_DOC* pDoc )
+{
+    char** paths;
+    UINT64* pSize;
+    UINT64* pMtime;
+    UINT32 doc, n, term;
+    int i, j;
+
+    if( pIdx->nDocs == pIdx->docAlloc )
+    {
+	n = _max( 1024, 2*pIdx->docAlloc );
+	paths = (char**)realloc( pIdx->paths, n*sizeof( char* ) );
+	if( paths != NULL ) pIdx->paths = paths;
+	pSize = (UINT64*)realloc( pIdx->pSize, n*sizeof( UINT64 ) );
+	if( pSize != NULL ) pIdx->pSize = pSize;
+	pMtime = (UINT64*)realloc( pIdx->pMtime, n*sizeof( UINT64 ) );
+	if( pMtime != NULL ) pIdx->pMtime = pMtime;
+	if( paths == NULL || pSize == NULL || pMtime == NULL ) return( 0 );
+	pIdx->docAlloc = n;
+    }
+    doc = pIdx->nDocs;
+    if( ( pIdx->paths[doc] = strdup( path ) ) == NULL ) return( 0 );
+    pIdx->pSize[doc] = pDoc->print[0];
+    pIdx->pMtime[doc] = pDoc->print[1];
+    pIdx->nDocs++;
+
+    for( i = 0; i < pDoc->nTok; i = j )
+    {
+	for( j = i + 1; j < pDoc->nTok &&
+		 strcmp( pDoc->pTok[j].tok, pDoc->pTok[i].tok ) == 0; j++ ) ;
+	if( !add_term( pIdx, pDoc->pTok[i].tok, &term ) ||
+	    !add_posting( &pIdx->pTerms[term], doc, &pDoc->pTok[i], j - i ) ) return( 0 );
+    }
+    return( 1 );
+}
+
+
+/*
+ *  compact() - drop the documents not marked in pKeep, renumbering the
+ *  rest in order, and the terms left with no documents.  Renumbering
+ *  only shrinks the doc deltas, so each posting list is rewritten in
+ *  place.  Returns 0, or -1 (the index unchanged) if out of memory.
+ */
+static int
+compact( MUD_TEXTINDEX* pIdx, char* pKeep )
+{
+    MUD_TEXT_TERM* pTerm;
+    UINT32* pNew;
+    UINT8* pIn;
+    UINT8* pOut;
+    UINT8* pEnd;
+    UINT8* pPos;
+    UINT32 doc, nDocs, d, nPos, i, t, nTerms;
+
+    for( d = 0; d < pIdx->nDocs && pKeep[d]; d++ ) ;
+    if( d == pIdx->nDocs ) return( 0 );
+    if( ( pNew = (UINT32*)malloc( ( pIdx->nDocs + 1 )*sizeof( UINT32 ) ) ) == NULL )
+	return( -1 );
+
+    for( d = 0, nDocs = 0; d < pIdx->nDocs; d++ )
+    {
+	if( pKeep[d] )
+	{
+	    pNew[d] = nDocs;
+	    pIdx->paths[nDocs] = pIdx->paths[d];
+	    pIdx->pSize[nDocs] = pIdx->pSize[d];
+	    pIdx->pMtime[nDocs] = pIdx->pMtime[d];
+	    nDocs++;
+	}
+	else
+	{
+	    free( pIdx->paths[d] );
+	}
+    }
+    pIdx->nDocs = nDocs;
+
+    for( t = 0, nTerms = 0; t < pIdx->nTerms; t++ )
+    {
+	pTerm = &pIdx->pTerms[t];
+	pIn = pOut = pTerm->pPost;
+	pEnd = pTerm->pPost + pTerm->len;
+	doc = 0;
+	nDocs = 0;
+	while( pIn < pEnd )
+	{
+	    doc += get_varint( &pIn );
+	    nPos = get_varint( &pIn );
+	    pPos = pIn;
+	    for( i = 0; i < nPos; i++ ) get_varint( &pIn );
+	    if( !pKeep[doc] ) continue;
+
+	    pOut += put_varint( pOut, ( nDocs > 0 ) ? pNew[doc] - pTerm->lastDoc : pNew[doc] );
+	    pOut += put_varint( pOut, nPos );
+	    memmove( pOut, pPos, pIn - pPos );
+	    pOut += pIn - pPos;
+	    pTerm->lastDoc = pNew[doc];
+	    nDocs++;
+	}
+	pTerm->len = (UINT32)( pOut - pTerm->pPost );
+	pTerm->nDocs = nDocs;
+
+	if( nDocs == 0 )
+	{
+	    _free( pTerm->term );
+	    _free( pTerm->pPost );
+	    continue;
+	}
+	pIdx->pTerms[nTerms++] = *pTerm;
+    }
+    free( pNew );
+
+    if( nTerms != pIdx->nTerms )
+    {
+	pIdx->nTerms = nTerms;
+	rehash( pIdx, pIdx->hashSize );
+    }
+    return( 0 );
+}
+
+
+/*
+ *  add_field() - tokenize a string into the document, from position *pPos
+ */
+static int
+add_field( TXT_DOC* pDoc, char* s, UINT32* pPos )
+{
+    TXT_TOKEN* pTok;
+    char tok[TXT_MAXTOK+1];
+    int n;
+
+    if( s == NULL ) return( 1 );
+    while( next_token( &s, tok ) )
+    {
+	if( pDoc->nTok == pDoc->tokAlloc )
+	{
+	    n = _max( 64, 2*pDoc->tokAlloc );
+	    if( ( pTok = (TXT_TOKEN*)realloc( pDoc->pTok, n*sizeof( TXT_TOKEN ) ) ) == NULL )
+		return( 0 );
+	    pDoc->pTok = pTok;
+	    pDoc->tokAlloc = n;
+	}
+	strcpy( pDoc->pTok[pDoc->nTok].tok, tok );
+	pDoc->pTok[pDoc->nTok++].pos = (*pPos)++;
+    }
+    *pPos += TXT_FIELD_GAP;
+    return( 1 );
+}
+
+
+static int
+cmp_tokens( const void* p1, const void* p2 )
+{
+    TXT_TOKEN* pT1 = (TXT_TOKEN*)p1;
+    TXT_TOKEN* pT2 = (TXT_TOKEN*)p2;
+    int c;
+
+    if( ( c = strcmp( pT1->tok, pT2->tok ) ) != 0 ) return( c );
+    return( ( pT1->pos > pT2->pos ) - ( pT1->pos < pT2->pos ) );
+}
+
+
+static int
+cmp_pathrefs( const void* p1, const void* p2 )
+{
+    return( strcmp( ((TXT_PATHREF*)p1)->path, ((TXT_PATHREF*)p2)->path ) );
+}
+
+
+/*
+ *  read_doc() - the tokens of the run description and comments
+ */
+static int
+read_doc( MUD_SEC_GRP* pMUD_fileGrp, TXT_DOC* pDoc )
+{
+    MUD_SEC_GEN_RUN_DESC* pDesc;
+    MUD_SEC_TRI_TI_RUN_DESC* pIdesc;
+    MUD_SEC_GRP* pMUD_cmtGrp;
+    MUD_SEC* pSec;
+    MUD_SEC_CMT* pCmt;
+    char* fields[16];
+    UINT32 pos = 0;
+    int i, n = 0;
+
+    pDesc = (MUD_SEC_GEN_RUN_DESC*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_GEN_RUN_DESC_ID, (UINT32)1, (UINT32)0 );
+    pIdesc = (MUD_SEC_TRI_TI_RUN_DESC*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_TRI_TI_RUN_DESC_ID, (UINT32)1, (UINT32)0 );
+    if( pDesc != NULL )
+    {
+	fields[n++] = pDesc->title;
+	fields[n++] = pDesc->lab;
+	fields[n++] = pDesc->area;
+	fields[n++] = pDesc->method;
+	fields[n++] = pDesc->apparatus;
+	fields[n++] = pDesc->insert;
+	fields[n++] = pDesc->sample;
+	fields[n++] = pDesc->orient;
+	fields[n++] = pDesc->das;
+	fields[n++] = pDesc->experimenter;
+	fields[n++] = pDesc->temperature;
+	fields[n++] = pDesc->field;
+    }
+    else if( pIdesc != NULL )
+    {
+	fields[n++] = pIdesc->title;
+	fields[n++] = pIdesc->lab;
+	fields[n++] = pIdesc->area;
+	fields[n++] = pIdesc->method;
+	fields[n++] = pIdesc->apparatus;
+	fields[n++] = pIdesc->insert;
+	fields[n++] = pIdesc->sample;
+	fields[n++] = pIdesc->orient;
+	fields[n++] = pIdesc->das;
+	fields[n++] = pIdesc->experimenter;
+	fields[n++] = pIdesc->subtitle;
+	fields[n++] = pIdesc->comment1;
+	fields[n++] = pIdesc->comment2;
+	fields[n++] = pIdesc->comment3;
+    }
+    for( i = 0; i < n; i++ )
+    {
+	if( !add_field( pDoc, fields[i], &pos ) ) return( 0 );
+    }
+
+    pMUD_cmtGrp = (MUD_SEC_GRP*)MUD_search( pMUD_fileGrp->pMem,
+			  MUD_SEC_GRP_ID, MUD_GRP_CMT_ID, (UINT32)0 );
+    if( pMUD_cmtGrp != NULL )
+    {
+	for( pSec = (MUD_SEC*)pMUD_cmtGrp->pMem; pSec != NULL; pSec = MUD_pNext( pSec ) )
+	{
+	    if( MUD_secID( pSec ) != MUD_SEC_CMT_ID ) continue;
+	    pCmt = (MUD_SEC_CMT*)pSec;
+	    if( !add_field( pDoc, pCmt->author, &pos ) ||
+		!add_field( pDoc, pCmt->title, &pos ) ||
+		!add_field( pDoc, pCmt->comment, &pos ) ) return( 0 );
+	}
+    }
+
+    if( pDoc->nTok > 1 )
+	qsort( pDoc->pTok, pDoc->nTok, sizeof( TXT_TOKEN ), cmp_tokens );
+    return( 1 );
+}
+
+
+/*
+ *  get_print() - size and modification time (ns) of a file (of the open
+ *  file fin, if not NULL); returns 0 if it cannot be examined.
+ */
+static int
+get_print( char* path, FILE* fin, UINT64* pPrint )
+{
+    struct stat st;
+
+    if( ( fin != NULL ) ? fstat( fileno( fin ), &st ) : stat( path, &st ) ) return( 0 );
+    pPrint[0] = (UINT64)st.st_size;
+#if defined(__linux__)
+    pPrint[1] = (UINT64)st.st_mtim.tv_sec*1000000000 + (UINT64)st.st_mtim.tv_nsec;
+#else
+    pPrint[1] = (UINT64)st.st_mtime*1000000000;
+#endif /* __linux__ */
+    return( 1 );
+}
+
+
+static void
+print_task( int task, int thread, void* pArg )
+{
+    TXT_BATCH* pB = (TXT_BATCH*)pArg;
+
+    if( !get_print( pB->files[task], NULL, &pB->pPrints[2*task] ) )
+	bzero( &pB->pPrints[2*task], 2*sizeof( UINT64 ) );
+}
+
+
+static void
+doc_task( int task, int thread, void* pArg )
+{
+    TXT_BATCH* pB = (TXT_BATCH*)pArg;
+    TXT_DOC* pDoc = &pB->pDocs[task];
+    MUD_SEC_GRP* pMUD_fileGrp;
+    FILE* fin;
+
+    if( ( fin = MUD_openInput( pB->files[task] ) ) == NULL ) return;
+    if( !get_print( pB->files[task], fin, pDoc->print ) ||
+	( pMUD_fileGrp = (MUD_SEC_GRP*)MUD_readHeaders( fin ) ) == NULL )
+    {
+	fclose( fin );
+	return;
+    }
+    fclose( fin );
+
+    if( MUD_secID( pMUD_fileGrp ) == MUD_SEC_GRP_ID )
+	pDoc->ok = read_doc( pMUD_fileGrp, pDoc );
+    MUD_free( pMUD_fileGrp );
+}
+
+
+/*
+ *  MUD_textIndexUpdate() - bring the index up to date with the files:
+ *  drop the documents of files not in the list or changed since they
+ *  were indexed, then index (on nThreads threads; 0 = all processors)
+ *  the new and changed ones.  Returns the number of files indexed, or
+ *  -1 if out of memory.
+ */
+int
+MUD_textIndexUpdate( MUD_TEXTINDEX* pIdx, int num, char** files, int nThreads )
+{
+    TXT_BATCH batch;
+    TXT_PATHREF* pRefs = NULL;
+    TXT_PATHREF key;
+    TXT_PATHREF* pRef;
+    char** readFiles = NULL;
+    char* pKeep = NULL;
+    UINT32 d;
+    int first, count, i, nRead = 0, added = 0;
+
+    bzero( &batch, sizeof( TXT_BATCH ) );
+    batch.files = files;
+    batch.pPrints = (UINT64*)zalloc( ( num + 1 )*2*sizeof( UINT64 ) );
+    pRefs = (TXT_PATHREF*)malloc( ( pIdx->nDocs + 1 )*sizeof( TXT_PATHREF ) );
+    readFiles = (char**)malloc( ( num + 1 )*sizeof( char* ) );
+    pKeep = (char*)zalloc( pIdx->nDocs + 1 );
+    if( batch.pPrints == NULL || pRefs == NULL || readFiles == NULL || pKeep == NULL )
+    {
+	added = -1;
+	goto done;
+    }
+
+    /*
+     *  Keep the documents of the files unchanged since they were indexed
+     */
+    for( d = 0; d < pIdx->nDocs; d++ )
+    {
+	pRefs[d].path = pIdx->paths[d];
+	pRefs[d].doc = d;
+    }
+    qsort( pRefs, pIdx->nDocs, sizeof( TXT_PATHREF ), cmp_pathrefs );
+    MUD_parallelFor( num, nThreads, print_task, &batch );
+
+    for( i = 0; i < num; i++ )
+    {
+	key.path = files[i];
+	pRef = (TXT_PATHREF*)bsearch( &key, pRefs, pIdx->nDocs, sizeof( TXT_PATHREF ),
+				      cmp_pathrefs );
+	if( pRef != NULL )
+	{
+	    if( pKeep[pRef->doc] ) continue;	/* listed twice */
+	    if( batch.pPrints[2*i+1] != 0 &&
+		pIdx->pSize[pRef->doc] == batch.pPrints[2*i] &&
+		pIdx->pMtime[pRef->doc] == batch.pPrints[2*i+1] )
+	    {
+		pKeep[pRef->doc] = 1;
+		continue;
+	    }
+	}
+	readFiles[nRead++] = files[i];
+    }
+
+    /*
+     *  Without dropping the changed files, adding them would index them
+     *  twice
+     */
+    if( compact( pIdx, pKeep ) < 0 )
+    {
+	added = -1;
+	goto done;
+    }
+
+    /*
+     *  Index the rest, adding the documents in file order
+     */
+    batch.pDocs = (TXT_DOC*)zalloc( TXT_BATCH_SIZE*sizeof( TXT_DOC ) );
+    if( batch.pDocs == NULL )
+    {
+	added = -1;
+	goto done;
+    }
+    for( first = 0; first < nRead; first += TXT_BATCH_SIZE )
+    {
+	count = _min( nRead - first, TXT_BATCH_SIZE );
+	batch.files = &readFiles[first];
+	MUD_parallelFor( count, nThreads, doc_task, &batch );
+
+	for( i = 0; i < count; i++ )
+	{
+	    if( added >= 0 && batch.pDocs[i].ok )
+	    {
+		if( add_doc( pIdx, readFiles[first+i], &batch.pDocs[i] ) )
+		    added++;
+		else
+		    added = -1;
+	    }
+	    _free( batch.pDocs[i].pTok );
+	    bzero( &batch.pDocs[i], sizeof( TXT_DOC ) );
+	}
+	if( added < 0 ) break;
+    }
+
+done:
+    _free( batch.pPrints );
+    _free( batch.pDocs );
+    _free( pRefs );
+    _free( readFiles );
+    _free( pKeep );
+    return( added );
+}
+
+
+/*
+ *  Posting-list cursors
+ */
+static void
+cursor_init( TXT_CURSOR* pC, MUD_TEXT_TERM* pTerm )
+{
+    pC->p = pTerm->pPost;
+    pC->left = pTerm->nDocs;
+    pC->doc = 0;
+    pC->nPos = 0;
+    pC->pPos = NULL;
+}
+
+
+static int
+cursor_next( TXT_CURSOR* pC )
+{
+    UINT32 i;
+
+    if( pC->left == 0 ) return( 0 );
+    pC->doc += get_varint( &pC->p );
+    pC->nPos = get_varint( &pC->p );
+    pC->pPos = pC->p;
+    for( i = 0; i < pC->nPos; i++ )
+    {
+	while( *pC->p++ & 0x80 ) ;
+    }
+    pC->left--;
+    return( 1 );
+}
+
+
+/*
+ *  phrase_at() - whether the nTerms cursors, all at the same document,
+ *  have consecutive positions there.  pPos is scratch space for the
+ *  positions of the first term.
+ */
+static int
+phrase_at( TXT_CURSOR* pC, int nTerms, UINT32* pPos )
+{
+    UINT8* p;
+    UINT32 i, j, pos, want;
+    int k, found;
+
+    p = pC[0].pPos;
+    for( i = 0, pos = 0; i < pC[0].nPos; i++ )
+    {
+	pos += get_varint( &p );
+	pPos[i] = pos;
+    }
+
+    for( i = 0; i < pC[0].nPos; i++ )
+    {
+	for( k = 1; k < nTerms; k++ )
+	{
+	    /*
+	     *  Positions are increasing, so stop at the first past want
+	     */
+	    want = pPos[i] + k;
+	    p = pC[k].pPos;
+	    for( j = 0, pos = 0, found = 0; j < pC[k].nPos; j++ )
+	    {
+		pos += get_varint( &p );
+		if( pos >= want )
+		{
+		    found = ( pos == want );
+		    break;
+		}
+	    }
+	    if( !found ) break;
+	}
+	if( k == nTerms ) return( 1 );
+    }
+    return( 0 );
+}
+
+
+/*
+ *  find_phrase() - the documents (in order) containing the terms in
+ *  consecutive positions; returns the number found, or -1 if out of
+ *  memory.
+ */
+static int
+find_phrase( MUD_TEXTINDEX* pIdx, UINT32* pTermNums, int nTerms, int* pOut )
+{
+    TXT_CURSOR* pC;
+    UINT32* pPos = NULL;
+    UINT32 maxPos = 0, target;
+    int k, n = 0, done = 0;
+
+    if( ( pC = (TXT_CURSOR*)malloc( nTerms*sizeof( TXT_CURSOR ) ) ) == NULL ) return( -1 );
+    for( k = 0; k < nTerms; k++ )
+    {
+	cursor_init( &pC[k], &pIdx->pTerms[pTermNums[k]] );
+	if( !cursor_next( &pC[k] ) ) done = 1;
+    }
+
+    while( !done )
+    {
+	/*
+	 *  Bring all the cursors to the highest of their documents
+	 */
+	target = pC[0].doc;
+	for( k = 1; k < nTerms; k++ ) target = _max( target, pC[k].doc );
+	for( k = 0; k < nTerms && !done; k++ )
+	{
+	    while( pC[k].doc < target && !done ) done = !cursor_next( &pC[k] );
+	}
+	if( done ) break;
+	for( k = 0; k < nTerms && pC[k].doc == target; k++ ) ;
+	if( k < nTerms ) continue;
+
+	if( nTerms > 1 )
+	{
+	    if( pC[0].nPos > maxPos )
+	    {
+		_free( pPos );
+		maxPos = pC[0].nPos;
+		if( ( pPos = (UINT32*)malloc( maxPos*sizeof( UINT32 ) ) ) == NULL )
+		{
+		    free( pC );
+		    return( -1 );
+		}
+	    }
+	    if( phrase_at( pC, nTerms, pPos ) ) pOut[n++] = (int)target;
+	}
+	else
+	{
+	    pOut[n++] = (int)target;
+	}
+	done = !cursor_next( &pC[0] );
+    }
+
+    _free( pPos );
+    free( pC );
+    return( n );
+}
+
+
+/*
+ *  MUD_textSearch() - the documents matching a query: words and "quoted
+ *  phrases", all of which must be found.  *ppDocs is set to a malloc'd
+ *  array of the document numbers, in order.  Returns the number found,
+ *  -1 if the query has no words or an unclosed quote, or -2 if out of
+ *  memory.
+ */
+int
+MUD_textSearch( MUD_TEXTINDEX* pIdx, char* query, int** ppDocs )
+{
+    char tok[TXT_MAXTOK+1];
+    char* p = query;
+    char* end;
+    char* s;
+    char* phrase = NULL;
+    UINT32* pTermNums = NULL;
+    int* pDocs;
+    int* pFound;
+    UINT32 slot;
+    int nTerms, nClauses = 0, nDocs = 0, n, i, j, k;
+
+    *ppDocs = NULL;
+    pDocs = (int*)malloc( ( pIdx->nDocs + 1 )*sizeof( int ) );
+    pFound = (int*)malloc( ( pIdx->nDocs + 1 )*sizeof( int ) );
+    pTermNums = (UINT32*)malloc( ( strlen( query )/2 + 1 )*sizeof( UINT32 ) );
+    if( pDocs == NULL || pFound == NULL || pTermNums == NULL )
+    {
+	nDocs = -2;
+	goto done;
+    }
+
+    for( ;; )
+    {
+	while( *p != '\0' && *p != '"' && !is_tok_char( (unsigned char)*p ) ) p++;
+	if( *p == '\0' ) break;
+
+	/*
+	 *  The terms of a word or phrase; a term not in the index matches
+	 *  nothing, but the rest of the query is still checked.
+	 */
+	nTerms = 0;
+	if( *p == '"' )
+	{
+	    if( ( end = strchr( p + 1, '"' ) ) == NULL )
+	    {
+		nDocs = -1;
+		goto done;
+	    }
+	    if( ( phrase = (char*)malloc( end - p ) ) == NULL )
+	    {
+		nDocs = -2;
+		goto done;
+	    }
+	    bcopy( p + 1, phrase, end - p - 1 );
+	    phrase[end-p-1] = '\0';
+	    for( s = phrase; next_token( &s, tok ); nTerms++ )
+	    {
+		if( !find_term( pIdx, tok, &pTermNums[nTerms], &slot ) ) pTermNums[nTerms] = pIdx->nTerms;
+	    }
+	    free( phrase );
+	    phrase = NULL;
+	    p = end + 1;
+	}
+	else
+	{
+	    next_token( &p, tok );
+	    if( !find_term( pIdx, tok, &pTermNums[0], &slot ) ) pTermNums[0] = pIdx->nTerms;
+	    nTerms = 1;
+	}
+	if( nTerms == 0 ) continue;
+
+	for( k = 0; k < nTerms && pTermNums[k] < pIdx->nTerms; k++ ) ;
+	if( k < nTerms )
+	    n = 0;
+	else if( ( n = find_phrase( pIdx, pTermNums, nTerms, pFound ) ) < 0 )
+	{
+	    nDocs = -2;
+	    goto done;
+	}
+
+	/*
+	 *  Intersect with the documents found so far
+	 */
+	if( nClauses++ == 0 )
+	{
+	    bcopy( pFound, pDocs, n*sizeof( int ) );
+	    nDocs = n;
+	    continue;
+	}
+	for( i = 0, j = 0, k = 0; i < nDocs && j < n; )
+	{
+	    if( pDocs[i] < pFound[j] ) i++;
+	    else if( pDocs[i] > pFound[j] ) j++;
+	    else
+	    {
+		pDocs[k++] = pDocs[i++];
+		j++;
+	    }
+	}
+	nDocs = k;
+    }
+    if( nClauses == 0 ) nDocs = -1;
+
+done:
+    _free( pFound );
+    _free( pTermNums );
+    if( nDocs < 0 )
+    {
+	_free( pDocs );
+    }
+    else
+    {
+	*ppDocs = pDocs;
+    }
+    return( nDocs );
+}
+
+
+static int
+write_4( FILE* fout, UINT32 u )
+{
+    char b[4];
+
+    bencode_4( b, &u );
+    return( fwrite( b, 4, 1, fout ) == 1 );
+}
+
+
+static int
+read_4( FILE* fin, UINT32* pU )
+{
+    char b[4];
+
+    if( fread( b, 4, 1, fin ) != 1 ) return( 0 );
+    bdecode_4( b, pU );
+    return( 1 );
+}
+
+
+/*
+ *  MUD_textIndexWrite() - write the index file; returns 1 on success.
+ *  The file is written under a temporary name and then renamed, so
+ *  readers never see a partial index.
+ */
+int
+MUD_textIndexWrite( MUD_TEXTINDEX* pIdx, char* idxname )
+{
+    FILE* fout;
+    MUD_TEXT_TERM* pTerm;
+    char hdr[TXT_HDR_SIZE];
+    char* tmpname;
+    UINT32 u, i;
+    int status;
+
+    if( ( tmpname = (char*)malloc( strlen( idxname ) + 5 ) ) == NULL ) return( 0 );
+    sprintf( tmpname, "%s.tmp", idxname );
+    if( ( fout = fopen( tmpname, "wb" ) ) == NULL )
+    {
+	free( tmpname );
+	return( 0 );
+    }
+
+    bzero( hdr, TXT_HDR_SIZE );
+    bcopy( TXT_MAGIC, hdr, 8 );
+    u = TXT_VERSION;
+    bencode_4( hdr + 8, &u );
+    bencode_4( hdr + 12, &pIdx->nDocs );
+    bencode_4( hdr + 16, &pIdx->nTerms );
+    status = ( fwrite( hdr, TXT_HDR_SIZE, 1, fout ) == 1 );
+
+    for( i = 0; i < pIdx->nDocs && status; i++ )
+    {
+	u = (UINT32)strlen( pIdx->paths[i] );
+	status = write_4( fout, u ) &&
+		 fwrite( pIdx->paths[i], 1, u, fout ) == u &&
+		 write_4( fout, (UINT32)pIdx->pSize[i] ) &&
+		 write_4( fout, (UINT32)( pIdx->pSize[i] >> 32 ) ) &&
+		 write_4( fout, (UINT32)pIdx->pMtime[i] ) &&
+		 write_4( fout, (UINT32)( pIdx->pMtime[i] >> 32 ) );
+    }
+    for( i = 0; i < pIdx->nTerms && status; i++ )
+    {
+	pTerm = &pIdx->pTerms[i];
+	u = (UINT32)strlen( pTerm->term );
+	status = write_4( fout, u ) &&
+		 fwrite( pTerm->term, 1, u, fout ) == u &&
+		 write_4( fout, pTerm->nDocs ) &&
+		 write_4( fout, pTerm->lastDoc ) &&
+		 write_4( fout, pTerm->len ) &&
+		 fwrite( pTerm->pPost, 1, pTerm->len, fout ) == pTerm->len;
+    }
+
+    if( fclose( fout ) != 0 ) status = 0;
+    if( status ) status = ( rename( tmpname, idxname ) == 0 );
+    if( !status ) remove( tmpname );
+    free( tmpname );
+    return( status );
+}
+
+
+/*
+ *  MUD_textIndexRead() - read an index file into memory; NULL on failure.
+ */
+MUD_TEXTINDEX*
+MUD_textIndexRead( char* idxname )
+{
+    FILE* fin;
+    MUD_TEXTINDEX* pIdx;
+    MUD_TEXT_TERM* pTerm;
+    char hdr[TXT_HDR_SIZE];
+    UINT32 version, nDocs, nTerms, len, lo, hi, i;
+    long size;
+
+    if( ( fin = fopen( idxname, "rb" ) ) == NULL ) return( NULL );
+    if( fseek( fin, 0, SEEK_END ) != 0 || ( size = ftell( fin ) ) < TXT_HDR_SIZE ||
+	fseek( fin, 0, SEEK_SET ) != 0 ||
+	fread( hdr, TXT_HDR_SIZE, 1, fin ) != 1 || strncmp( hdr, TXT_MAGIC, 8 ) != 0 )
+    {
+	fclose( fin );
+	return( NULL );
+    }
+    bdecode_4( hdr + 8, &version );
+    bdecode_4( hdr + 12, &nDocs );
+    bdecode_4( hdr + 16, &nTerms );
+
+    /*
+     *  A document takes at least 20 bytes of the file, a term 19
+     */
+    if( version != TXT_VERSION ||
+	nDocs > (UINT32)_min( ( size - TXT_HDR_SIZE )/20, 0x7FFFFFFF ) ||
+	nTerms > (UINT32)_min( ( size - TXT_HDR_SIZE )/19, 0x7FFFFFFF ) ||
+	( pIdx = MUD_textIndexNew() ) == NULL )
+    {
+	fclose( fin );
+	return( NULL );
+    }
+
+    pIdx->paths = (char**)zalloc( ( nDocs + 1 )*sizeof( char* ) );
+    pIdx->pSize = (UINT64*)malloc( ( nDocs + 1 )*sizeof( UINT64 ) );
+    pIdx->pMtime = (UINT64*)malloc( ( nDocs + 1 )*sizeof( UINT64 ) );
+    pIdx->pTerms = (MUD_TEXT_TERM*)zalloc( ( nTerms + 1 )*sizeof( MUD_TEXT_TERM ) );
+    if( pIdx->paths == NULL || pIdx->pSize == NULL || pIdx->pMtime == NULL ||
+	pIdx->pTerms == NULL ) goto fail;
+    pIdx->docAlloc = nDocs + 1;
+    pIdx->termAlloc = nTerms + 1;
+
+    for( i = 0; i < nDocs; i++ )
+    {
+	if( !read_4( fin, &len ) || len >= TXT_MAXPATH ||
+	    ( pIdx->paths[i] = (char*)malloc( len + 1 ) ) == NULL ) goto fail;
+	pIdx->nDocs++;
+	if( fread( pIdx->paths[i], 1, len, fin ) != len ) goto fail;
+	pIdx->paths[i][len] = '\0';
+	if( !read_4( fin, &lo ) || !read_4( fin, &hi ) ) goto fail;
+	pIdx->pSize[i] = ( (UINT64)hi << 32 ) | lo;
+	if( !read_4( fin, &lo ) || !read_4( fin, &hi ) ) goto fail;
+	pIdx->pMtime[i] = ( (UINT64)hi << 32 ) | lo;
+    }
+
+    for( i = 0; i < nTerms; i++ )
+    {
+	pTerm = &pIdx->pTerms[i];
+	if( !read_4( fin, &len ) || len == 0 || len > TXT_MAXTOK ||
+	    ( pTerm->term = (char*)malloc( len + 1 ) ) == NULL ) goto fail;
+	pIdx->nTerms++;
+	if( fread( pTerm->term, 1, len, fin ) != len ) goto fail;
+	pTerm->term[len] = '\0';
+	if( !read_4( fin, &pTerm->nDocs ) || !read_4( fin, &pTerm->lastDoc ) ||
+	    !read_4( fin, &pTerm->len ) ) goto fail;
+	if( pTerm->nDocs == 0 || pTerm->lastDoc >= nDocs ||
+	    pTerm->len < 2*pTerm->nDocs ) goto fail;
+	if( ( pTerm->pPost = (UINT8*)malloc( pTerm->len ) ) == NULL ) goto fail;
+	pTerm->alloc = pTerm->len;
+	if( fread( pTerm->pPost, 1, pTerm->len, fin ) != pTerm->len ) goto fail;
+
+	/*
+	 *  Searches and updates decode the list without checking it
+	 */
+	if( !check_postings( pTerm, nDocs ) ) goto fail;
+    }
+    fclose( fin );
+
+    for( len = 1024; len < 2*( nTerms + 1 ); len *= 2 ) ;
+    if( !rehash( pIdx, len ) )
+    {
+	MUD_textIndexFree( pIdx );
+	return( NULL );
+    }
+    return( pIdx );
+
+fail:
+    fclose( fin );
+    MUD_textIndexFree( pIdx );
+    return( NULL );
+}
+
+
+/*
+ *  MUD_textIndexRefresh() - update the index file for the run files in
+ *  and under the directories, creating it if need be; *pNumRead (if not
+ *  NULL) is set to the number of files indexed.  Returns the number of
+ *  documents in the index, or -1 on failure.
+ */
+int
+MUD_textIndexRefresh( char* idxname, int nDirs, char** dirs, int nThreads, int* pNumRead )
+{
+    MUD_TEXTINDEX* pIdx;
+    char** files;
+    int num, n;
+
+    if( ( pIdx = MUD_textIndexRead( idxname ) ) == NULL &&
+	( pIdx = MUD_textIndexNew() ) == NULL ) return( -1 );
+    files = MUD_catalogFindFiles( nDirs, dirs, &num );
+    n = MUD_textIndexUpdate( pIdx, num, files, nThreads );
+    MUD_catalogFreeFiles( files, num );
+    if( pNumRead != NULL ) *pNumRead = n;
+    if( n < 0 || !MUD_textIndexWrite( pIdx, idxname ) )
+	n = -1;
+    else
+	n = (int)pIdx->nDocs;
+    MUD_textIndexFree( pIdx );
+    return( n );
+}
@@ -0,0 +1,254 @@
+/*
+ *  mud_thread.c -- worker threads for the bulk (many-run, many-bin) routines
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version (for event histogramming)
+ *          18-Oct-2026      Work-stealing task ranges in MUD_parallelFor
+ *
+ *  Description:
+ *    Threads are only used when the library is compiled with MUD_THREADS
+ *    defined ("make THREADS=1"), which needs POSIX threads.  Otherwise
+ *    every routine here runs the work serially in the calling thread, so
+ *    callers never need to care which build they are linked against.
+ *
+ *    MUD_parallelFor( nTasks, nThreads, proc, pArg ) calls
+ *    proc( task, thread, pArg ) once for every task in 0..nTasks-1.
+ *    The thread argument is always less than the (effective) nThreads,
+ *    so callers can keep per-thread scratch space (e.g. histograms)
+ *    indexed by it, and merge them afterwards.
+ *
+ *    Each thread starts with its own contiguous range of tasks, which it
+ *    takes from the bottom, so neighbouring tasks (e.g. files in the same
+ *    directory) tend to run on the same thread.  A thread that runs out
+ *    steals the top half of the range of another thread, so uneven tasks
+ *    still balance themselves.
+ */
+
+#include "mud.h"
+
+#ifdef MUD_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif /* MUD_THREADS */
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif /* __AVX2__ */
+
+#define MUD_MAX_THREADS 256
+
+#ifdef MUD_THREADS
+typedef struct {
+    pthread_mutex_t lock;
+    int		lo;		/* tasks lo..hi-1 are still to be run */
+    int		hi;
+} MUD_RANGE;
+
+typedef struct {
+    int		nThreads;
+    int		thread;
+    MUD_TASK_PROC proc;
+    void*	pArg;
+    MUD_RANGE*	pRanges;	/* one per thread */
+} MUD_WORKER;
+
+static int next_task _ANSI_ARGS_(( MUD_WORKER* pWorker ));
+static void* worker _ANSI_ARGS_(( void* pW ));
+#endif /* MUD_THREADS */
+
+
+/*
+ *  MUD_numThreads() - number of threads to use for a request of nThreads.
+ *  nThreads <= 0 means "as many as useful": the value of the environment
+ *  variable MUD_NUM_THREADS, else the number of online processors.
+ *  Always 1 when the library is built without MUD_THREADS.
+ */
+int
+MUD_numThreads( int nThreads )
+{
+#ifdef MUD_THREADS
+    char* s;
+    long n;
+
+    if( nThreads <= 0 )
+    {
+	if( ( s = getenv( "MUD_NUM_THREADS" ) ) != NULL && ( n = atol( s ) ) > 0 )
+	{
+	    nThreads = (int)n;
+	}
+	else
+	{
+#ifdef _SC_NPROCESSORS_ONLN
+	    n = sysconf( _SC_NPROCESSORS_ONLN );
+	    nThreads = ( n > 0 ) ? (int)n : 1;
+#else
+	    nThreads = 1;
+#endif /* _SC_NPROCESSORS_ONLN */
+	}
+    }
+    return( _min( nThreads, MUD_MAX_THREADS ) );
+#else
+    return( 1 );
+#endif /* MUD_THREADS */
+}
+
+
+#ifdef MUD_THREADS
+/*
+ *  next_task() - the next task for a worker: from its own range if it
+ *  has any left, else stolen from another.  Returns -1 when all tasks
+ *  have been taken.
+ */
+static int
+next_task( MUD_WORKER* pWorker )
+{
+    MUD_RANGE* pOwn = &pWorker->pRanges[pWorker->thread];
+    MUD_RANGE* pVictim;
+    int task = -1;
+    int i, lo, hi, n;
+
+    pthread_mutex_lock( &pOwn->lock );
+    if( pOwn->lo < pOwn->hi ) task = pOwn->lo++;
+    pthread_mutex_unlock( &pOwn->lock );
+    if( task >= 0 ) return( task );
+
+    for( i = 1; i < pWorker->nThreads; i++ )
+    {
+	pVictim = &pWorker->pRanges[( pWorker->thread + i ) % pWorker->nThreads];
+
+	pthread_mutex_lock( &pVictim->lock );
+	n = pVictim->hi - pVictim->lo;
+	hi = pVictim->hi;
+	lo = hi - ( n + 1 )/2;
+	if( n > 0 ) pVictim->hi = lo;
+	pthread_mutex_unlock( &pVictim->lock );
+	if( n <= 0 ) continue;
+
+	/*
+	 *  Run the first stolen task now, keep the rest as our own range
+	 */
+	pthread_mutex_lock( &pOwn->lock );
+	pOwn->lo = lo + 1;
+	pOwn->hi = hi;
+	pthread_mutex_unlock( &pOwn->lock );
+	return( lo );
+    }
+    return( -1 );
+}
+
+
+static void*
+worker( void* pW )
+{
+    MUD_WORKER* pWorker = (MUD_WORKER*)pW;
+    int task;
+
+    while( ( task = next_task( pWorker ) ) >= 0 )
+    {
+	(*pWorker->proc)( task, pWorker->thread, pWorker->pArg );
+    }
+    return( NULL );
+}
+#endif /* MUD_THREADS */
+
+
+/*
+ *  MUD_parallelFor() - run proc for every task; returns the number of
+ *  threads that actually took part (1 when built without MUD_THREADS).
+ */
+int
+MUD_parallelFor( int nTasks, int nThreads, MUD_TASK_PROC proc, void* pArg )
+{
+#ifdef MUD_THREADS
+    pthread_t tid[MUD_MAX_THREADS];
+    MUD_WORKER workers[MUD_MAX_THREADS];
+    MUD_RANGE ranges[MUD_MAX_THREADS];
+    int nStarted;
+    int i;
+#else
+    int task;
+#endif /* MUD_THREADS */
+
+    if( nTasks <= 0 ) return( 0 );
+
+#ifdef MUD_THREADS
+    nThreads = _min( MUD_numThreads( nThreads ), nTasks );
+
+    for( i = 0; i < nThreads; i++ )
+    {
+	pthread_mutex_init( &ranges[i].lock, NULL );
+	ranges[i].lo = (int)( (INT64)nTasks*i/nThreads );
+	ranges[i].hi = (int)( (INT64)nTasks*( i + 1 )/nThreads );
+	workers[i].nThreads = nThreads;
+	workers[i].thread = i;
+	workers[i].proc = proc;
+	workers[i].pArg = pArg;
+	workers[i].pRanges = ranges;
+    }
+
+    /*
+     *  The calling thread is worker 0.  If a thread cannot be created
+     *  the others simply steal its share.
+     */
+    for( nStarted = 1; nStarted < nThreads; nStarted++ )
+    {
+	if( pthread_create( &tid[nStarted], NULL, worker, &workers[nStarted] ) != 0 )
+	    break;
+    }
+    worker( &workers[0] );
+    for( i = 1; i < nStarted; i++ )
+    {
+	pthread_join( tid[i], NULL );
+    }
+    for( i = 0; i < nThreads; i++ )
+    {
+	pthread_mutex_destroy( &ranges[i].lock );
+    }
+    return( nStarted );
+#else
+    for( task = 0; task < nTasks; task++ )
+    {
+	(*proc)( task, 0, pArg );
+    }
+    return( 1 );
+#endif /* MUD_THREADS */
+}
+
+
+/*
+ *  MUD_addHist32() - pSum[i] += pAdd[i] for 32-bit histogram bins;
+ *  used to merge per-thread histograms.
+ */
+void
+MUD_addHist32( UINT32* pSum, UINT32* pAdd, int num )
+{
+    int i = 0;
+
+#ifdef __AVX2__
+    __m256i a, b;
+
+    for( ; i + 8 <= num; i += 8 )
+    {
+	a = _mm256_loadu_si256( (__m256i*)&pSum[i] );
+	b = _mm256_loadu_si256( (__m256i*)&pAdd[i] );
+	_mm256_storeu_si256( (__m256i*)&pSum[i], _mm256_add_epi32( a, b ) );
+    }
+#endif /* __AVX2__ */
+
+    for( ; i < num; i++ )
+    {
+	pSum[i] += pAdd[i];
+    }
+}
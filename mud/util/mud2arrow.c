@@ -0,0 +1,73 @@
+/*
+ *  mud2arrow.c -- write the histograms and headers of runs as an Arrow IPC
+ *                 (Feather) file
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version
+ *
+ *  Usage:
+ *    mud2arrow [-t threads] out.arrow dir|file ...
+ *
+ *    Runs are taken in order of path, one row each (see mud_arrow.c for
+ *    the columns), e.g.
+ *      mud2arrow runs.arrow /data/2019
+ *    and in Python
+ *      t = pyarrow.feather.read_table("runs.arrow")
+ *    or in DuckDB (with the arrow extension)
+ *      SELECT run_number, temperature_k FROM 'runs.arrow' WHERE field_g > 100;
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "mud.h"
+
+static void usage _ANSI_ARGS_(( void ));
+
+
+static void
+usage( void )
+{
+    fprintf( stderr, "usage: mud2arrow [-t threads] out.arrow dir|file.msr ...\n" );
+    exit( 1 );
+}
+
+
+int
+main( int argc, char* argv[] )
+{
+    char** files;
+    char* outname;
+    int nThreads = 0;
+    int i, num, n;
+
+    for( i = 1; i < argc && argv[i][0] == '-'; i++ )
+    {
+	if( strcmp( argv[i], "-t" ) == 0 && i + 1 < argc ) nThreads = atoi( argv[++i] );
+	else usage();
+    }
+    if( argc - i < 2 ) usage();
+
+    outname = argv[i++];
+    files = MUD_catalogFindFiles( argc - i, &argv[i], &num );
+    if( ( n = MUD_writeArrow( outname, num, files, nThreads ) ) < 0 )
+    {
+	fprintf( stderr, "mud2arrow: cannot write %s\n", outname );
+	return( 1 );
+    }
+
+    printf( "%d of %d runs written\n", n, num );
+    MUD_catalogFreeFiles( files, num );
+    return( n < num );
+}
@@ -0,0 +1,70 @@
+/*
+ *  mud2dat.c -- write runs as text (.dat) files, one per run
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version
+ *
+ *  Usage:
+ *    mud2dat [-t threads] [-d dir] dir|file ...
+ *
+ *    Each run is written as text (see mud_dat.c for the layout) to its
+ *    name with ".dat" for its extension, in dir or else beside the run,
+ *    e.g.
+ *      mud2dat 040123.msr                 writes 040123.dat
+ *      mud2dat -d /tmp/dat /data/2019
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "mud.h"
+
+static void usage _ANSI_ARGS_(( void ));
+
+
+static void
+usage( void )
+{
+    fprintf( stderr, "usage: mud2dat [-t threads] [-d dir] dir|file.msr ...\n" );
+    exit( 1 );
+}
+
+
+int
+main( int argc, char* argv[] )
+{
+    char** files;
+    char* dir = NULL;
+    int nThreads = 0;
+    int i, num, n;
+
+    for( i = 1; i < argc && argv[i][0] == '-'; i++ )
+    {
+	if( strcmp( argv[i], "-t" ) == 0 && i + 1 < argc ) nThreads = atoi( argv[++i] );
+	else if( strcmp( argv[i], "-d" ) == 0 && i + 1 < argc ) dir = argv[++i];
+	else usage();
+    }
+    if( argc - i < 1 ) usage();
+
+    files = MUD_catalogFindFiles( argc - i, &argv[i], &num );
+    if( ( n = MUD_writeDat( num, files, dir, nThreads, NULL ) ) < 0 )
+    {
+	fprintf( stderr, "mud2dat: out of memory\n" );
+	return( 1 );
+    }
+
+    printf( "%d of %d runs written\n", n, num );
+    MUD_catalogFreeFiles( files, num );
+    return( n < num );
+}
@@ -0,0 +1,84 @@
+/*
+ *  mud2npz.c -- write the histograms and headers of runs as NumPy arrays
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version
+ *
+ *  Usage:
+ *    mud2npz [-z] [-t threads] out.npz dir|file ...   counts and headers
+ *    mud2npz [-t threads] out.npy dir|file ...        counts only
+ *
+ *    Runs are taken in order of path (see mud_npy.c for the arrays), e.g.
+ *      mud2npz runs.npz /data/2019
+ *    and in Python
+ *      d = numpy.load("runs.npz"); d["counts"][d["run_number"] == 40123]
+ *    -z deflates the arrays, if the library was built with zlib.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "mud.h"
+
+static void usage _ANSI_ARGS_(( void ));
+
+
+static void
+usage( void )
+{
+    fprintf( stderr, "usage: mud2npz [-z] [-t threads] out.npz|out.npy dir|file.msr ...\n" );
+    exit( 1 );
+}
+
+
+int
+main( int argc, char* argv[] )
+{
+    char** files;
+    char* outname;
+    size_t len;
+    int flags = 0, nThreads = 0;
+    int i, num, n;
+
+    for( i = 1; i < argc && argv[i][0] == '-'; i++ )
+    {
+	if( strcmp( argv[i], "-z" ) == 0 ) flags |= MUD_NPZ_DEFLATE;
+	else if( strcmp( argv[i], "-t" ) == 0 && i + 1 < argc ) nThreads = atoi( argv[++i] );
+	else usage();
+    }
+    if( argc - i < 2 ) usage();
+
+    outname = argv[i++];
+    files = MUD_catalogFindFiles( argc - i, &argv[i], &num );
+    len = strlen( outname );
+    if( len > 4 && strcmp( outname + len - 4, ".npy" ) == 0 )
+    {
+	if( flags ) usage();
+	n = MUD_writeNpy( outname, num, files, nThreads );
+    }
+    else
+    {
+	n = MUD_writeNpz( outname, num, files, flags, nThreads );
+    }
+    if( n < 0 )
+    {
+	fprintf( stderr, "mud2npz: cannot write %s%s\n", outname,
+		 ( flags & MUD_NPZ_DEFLATE ) ? " (library built without zlib?)" : "" );
+	return( 1 );
+    }
+
+    printf( "%d of %d runs written\n", n, num );
+    MUD_catalogFreeFiles( files, num );
+    return( n < num );
+}
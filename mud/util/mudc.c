@@ -0,0 +1,154 @@
+/*
+ *  mudc.c -- convert runs to and from MUD-C chunked files, and read bins
+ *            from them
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version
+ *
+ *  Usage:
+ *    mudc [-z] [-c bins] in.msr out.mudc    convert to MUD-C (see mud_mudc.c)
+ *    mudc -x in.mudc out.msr                convert back to MUD
+ *    mudc -l file.mudc                      list the histograms and chunks
+ *    mudc -r file.mudc hist first num       print bins of a histogram
+ *
+ *    -z deflates the chunks (needs the library built with zlib), and -c
+ *    sets the bins to a chunk (4096 by default).
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "mud.h"
+
+static void usage _ANSI_ARGS_(( void ));
+static int list _ANSI_ARGS_(( char* filename ));
+static int print_bins _ANSI_ARGS_(( char* filename, int hist, UINT32 first, UINT32 num ));
+
+
+static void
+usage( void )
+{
+    fprintf( stderr, "usage: mudc [-z] [-c bins] in.msr out.mudc\n" );
+    fprintf( stderr, "       mudc -x in.mudc out.msr\n" );
+    fprintf( stderr, "       mudc -l file.mudc\n" );
+    fprintf( stderr, "       mudc -r file.mudc hist first num\n" );
+    exit( 1 );
+}
+
+
+static int
+list( char* filename )
+{
+    MUD_MUDC* pMudc;
+    MUD_MUDC_HIST* pHist;
+    UINT64 stored;
+    UINT32 i, j;
+
+    if( ( pMudc = MUD_mudcOpen( filename ) ) == NULL )
+    {
+	fprintf( stderr, "mudc: cannot read %s\n", filename );
+	return( 1 );
+    }
+    printf( "%lu histograms, %lu bins to a chunk\n",
+	    (unsigned long)pMudc->nHists, (unsigned long)pMudc->chunkBins );
+    for( i = 0; i < pMudc->nHists; i++ )
+    {
+	pHist = &pMudc->pHists[i];
+	for( stored = 0, j = 0; j < pHist->nChunks; j++ ) stored += pHist->pChunks[j].size;
+	printf( "%3lu  %8lu bins  %5lu chunks  %10lu bytes  (%.2f per bin)\n",
+		(unsigned long)pHist->num, (unsigned long)pHist->nBins,
+		(unsigned long)pHist->nChunks, (unsigned long)stored,
+		pHist->nBins ? (double)stored/pHist->nBins : 0.0 );
+    }
+    MUD_mudcClose( pMudc );
+    return( 0 );
+}
+
+
+static int
+print_bins( char* filename, int hist, UINT32 first, UINT32 num )
+{
+    MUD_MUDC* pMudc;
+    UINT32* pCounts;
+    int i, n;
+
+    if( ( pMudc = MUD_mudcOpen( filename ) ) == NULL )
+    {
+	fprintf( stderr, "mudc: cannot read %s\n", filename );
+	return( 1 );
+    }
+    if( ( pCounts = (UINT32*)malloc( (size_t)num*sizeof( UINT32 ) + 4 ) ) == NULL ||
+	( n = MUD_mudcReadBins( pMudc, hist, first, num, pCounts ) ) < 0 )
+    {
+	fprintf( stderr, "mudc: cannot read histogram %d of %s\n", hist, filename );
+	MUD_mudcClose( pMudc );
+	return( 1 );
+    }
+    for( i = 0; i < n; i++ )
+    {
+	printf( "%lu\t%lu\n", (unsigned long)( first + i ), (unsigned long)pCounts[i] );
+    }
+    free( pCounts );
+    MUD_mudcClose( pMudc );
+    return( 0 );
+}
+
+
+int
+main( int argc, char* argv[] )
+{
+    int flags = 0, chunkBins = 0, op = 0;
+    int i, status;
+
+    for( i = 1; i < argc && argv[i][0] == '-'; i++ )
+    {
+	if( strcmp( argv[i], "-z" ) == 0 ) flags |= MUD_MUDC_DEFLATE;
+	else if( strcmp( argv[i], "-c" ) == 0 && i + 1 < argc ) chunkBins = atoi( argv[++i] );
+	else if( strcmp( argv[i], "-x" ) == 0 || strcmp( argv[i], "-l" ) == 0 ||
+		 strcmp( argv[i], "-r" ) == 0 ) op = argv[i][1];
+	else usage();
+    }
+
+    switch( op )
+    {
+	case 'l':
+	    if( argc - i != 1 ) usage();
+	    return( list( argv[i] ) );
+	case 'r':
+	    if( argc - i != 4 ) usage();
+	    return( print_bins( argv[i], atoi( argv[i+1] ),
+				(UINT32)strtoul( argv[i+2], NULL, 10 ),
+				(UINT32)strtoul( argv[i+3], NULL, 10 ) ) );
+	case 'x':
+	    if( argc - i != 2 ) usage();
+	    status = MUD_mudcToClassic( argv[i], argv[i+1] );
+	    break;
+	default:
+	    if( argc - i != 2 ) usage();
+	    status = MUD_mudcWrite( argv[i], argv[i+1], chunkBins, flags );
+	    if( status < 0 )
+	    {
+		fprintf( stderr, "mudc: -z needs the library built with zlib\n" );
+		return( 1 );
+	    }
+	    break;
+    }
+
+    if( !status )
+    {
+	fprintf( stderr, "mudc: cannot convert %s to %s\n", argv[i], argv[i+1] );
+	return( 1 );
+    }
+    return( 0 );
+}
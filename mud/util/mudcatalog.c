@@ -0,0 +1,151 @@
+/*
+ *  mudcatalog.c -- build a catalog of the runs in directories of MUD
+ *                  files, and list it
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version
+ *          18-Oct-2026      Add -r (refresh) and -h (hash headers)
+ *          18-Oct-2026      Add -q (query)
+ *          18-Oct-2026      List REAL64 columns
+ *
+ *  Usage:
+ *    mudcatalog [-t threads] catalog dir|file ...   catalog the runs
+ *    mudcatalog -r [-h] [-t threads] catalog dir|file ...
+ *                                                   refresh the catalog
+ *    mudcatalog -l [-q query] catalog [column ...]  list the catalog
+ *
+ *    A refresh reads only the files that are new or changed (by device,
+ *    inode, size and modification time; with -h also by a hash of the
+ *    file headers) since the catalog was last written.
+ *
+ *    The default columns listed are run, expt, apparatus, sample,
+ *    temperature, field and path.  With -q only the rows matching the
+ *    query are listed, e.g.
+ *      -q "tempK BETWEEN 5 AND 10 AND sample LIKE 'YBCO%'"
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "mud.h"
+
+static void usage _ANSI_ARGS_(( void ));
+
+static char* defCols[] = {
+    "run", "expt", "apparatus", "sample", "temperature", "field", "path"
+};
+
+
+static void
+usage( void )
+{
+    fprintf( stderr, "usage: mudcatalog [-r [-h]] [-t threads] catalog dir|file.msr ...\n" );
+    fprintf( stderr, "       mudcatalog -l [-q query] catalog [column ...]\n" );
+    exit( 1 );
+}
+
+
+int
+main( int argc, char* argv[] )
+{
+    MUD_CATALOG* pCat;
+    char** names;
+    char* query = NULL;
+    int* pRows = NULL;
+    int cols[MUD_CAT_NCOLS];
+    int list = 0, refresh = 0, hashHead = 0, nThreads = 0;
+    int i, n, nRead, nCols, nRows, row;
+
+    for( i = 1; i < argc && argv[i][0] == '-'; i++ )
+    {
+	if( strcmp( argv[i], "-l" ) == 0 ) list = 1;
+	else if( strcmp( argv[i], "-r" ) == 0 ) refresh = 1;
+	else if( strcmp( argv[i], "-h" ) == 0 ) hashHead = 1;
+	else if( strcmp( argv[i], "-q" ) == 0 && i + 1 < argc ) query = argv[++i];
+	else if( strcmp( argv[i], "-t" ) == 0 && i + 1 < argc ) nThreads = atoi( argv[++i] );
+	else usage();
+    }
+    if( argc - i < ( list ? 1 : 2 ) ) usage();
+
+    if( !list && refresh )
+    {
+	n = MUD_catalogRefresh( argv[i], argc - i - 1, &argv[i+1], hashHead, nThreads, &nRead );
+	if( n < 0 )
+	{
+	    fprintf( stderr, "mudcatalog: cannot write %s\n", argv[i] );
+	    return( 1 );
+	}
+	printf( "%d runs catalogued (%d read)\n", n, nRead );
+	return( 0 );
+    }
+    if( !list )
+    {
+	n = MUD_catalogBuild( argc - i - 1, &argv[i+1], argv[i], nThreads );
+	if( n < 0 )
+	{
+	    fprintf( stderr, "mudcatalog: cannot write %s\n", argv[i] );
+	    return( 1 );
+	}
+	printf( "%d runs catalogued\n", n );
+	return( 0 );
+    }
+
+    if( ( pCat = MUD_catalogRead( argv[i] ) ) == NULL )
+    {
+	fprintf( stderr, "mudcatalog: cannot read catalog %s\n", argv[i] );
+	return( 1 );
+    }
+
+    names = ( argc - i > 1 ) ? &argv[i+1] : defCols;
+    nCols = ( argc - i > 1 ) ? argc - i - 1 : (int)( sizeof( defCols )/sizeof( char* ) );
+    if( nCols > MUD_CAT_NCOLS ) nCols = MUD_CAT_NCOLS;
+    for( n = 0; n < nCols; n++ )
+    {
+	if( ( cols[n] = MUD_catalogColumn( names[n] ) ) < 0 )
+	{
+	    fprintf( stderr, "mudcatalog: no column %s\n", names[n] );
+	    return( 1 );
+	}
+    }
+
+    nRows = (int)pCat->num;
+    if( query != NULL )
+    {
+	if( ( nRows = MUD_catalogSelect( pCat, query, &pRows ) ) < 0 )
+	{
+	    fprintf( stderr, "mudcatalog: bad query \"%s\"\n", query );
+	    return( 1 );
+	}
+    }
+
+    for( i = 0; i < nRows; i++ )
+    {
+	row = pRows ? pRows[i] : i;
+	for( n = 0; n < nCols; n++ )
+	{
+	    if( MUD_catalogColumnType( cols[n] ) == MUD_CAT_STRING )
+		printf( "%s%s", n ? "\t" : "", MUD_catalogString( pCat, row, cols[n] ) );
+	    else if( MUD_catalogColumnType( cols[n] ) == MUD_CAT_REAL64 )
+		printf( "%s%.10g", n ? "\t" : "", MUD_catalogReal( pCat, row, cols[n] ) );
+	    else
+		printf( "%s%llu", n ? "\t" : "",
+			(unsigned long long)MUD_catalogValue( pCat, row, cols[n] ) );
+	}
+	printf( "\n" );
+    }
+
+    if( pRows ) free( pRows );
+    MUD_catalogFree( pCat );
+    return( 0 );
+}
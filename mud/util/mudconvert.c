@@ -0,0 +1,417 @@
+/*
+ *  mudconvert.c -- convert many runs between MUD, MUD-C, text, NumPy and
+ *                  Arrow files
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version
+ *          18-Oct-2026      Make out for dat, and list the runs not converted
+ *          18-Oct-2026  DJA MUD-C files in the directories; .npz files named
+ *
+ *  Usage:
+ *    mudconvert [-t threads] [-z] [-c bins] -f format -o out dir|file ...
+ *
+ *    The runs (MUD and MUD-C files, in and under the directories, or MUD,
+ *    MUD-C or .npz files named) are converted to format:
+ *      mud     MUD files .msr, under the directory out
+ *      mudc    MUD-C files .mudc, under the directory out (-z deflates
+ *              the chunks, -c sets the bins to a chunk; see mud_mudc.c)
+ *      dat     text files .dat, in the directory out (see mud_dat.c)
+ *      npz     the NumPy archive out (-z deflates it; see mud_npy.c)
+ *      npy     the counts only, as the NumPy array out
+ *      arrow   the Arrow IPC file out (see mud_arrow.c)
+ *    e.g. to archive a beamtime, and to take its runs to Arrow again:
+ *      mudconvert -z -f mudc -o /archive/2019 /data/2019
+ *      mudconvert -f arrow -o 2019.arrow `ls /archive/2019/0401*.mudc`
+ *
+ *    MUD and MUD-C files keep the subdirectories of the runs under the
+ *    directories given; out (for dat too) and these are made as needed.
+ *
+ *    The runs of a .npz file (laid out as mud2npz writes them) are first
+ *    written as MUD files (MUD_importNpz; see mud_import.c) into a
+ *    temporary directory beside out, which is removed at the end; they
+ *    are converted from there as the runs of a directory given.
+ *
+ *    Runs go to the threads as in MUD_parallelFor (mud_thread.c), each
+ *    run read, decoded, encoded and written by one thread before it
+ *    takes the next, so at most one run per thread is in memory (a block
+ *    of runs for dat, npz, npy and arrow; see mud_export.c).  Runs that
+ *    cannot be converted are passed over (and listed, for mud, mudc and
+ *    dat); the exit status is 1 if there were any.  The rate of conversion is given at
+ *    the end.
+ */
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "mud.h"
+
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#define mkdir( path, mode )	_mkdir( path )
+#define rmdir( path )		_rmdir( path )
+#else
+#include <unistd.h>
+#endif /* _WIN32 */
+
+#define CONV_MUD	0		/* formats */
+#define CONV_MUDC	1
+#define CONV_DAT	2
+#define CONV_NPZ	3
+#define CONV_NPY	4
+#define CONV_ARROW	5
+
+static char* formats[] = { "mud", "mudc", "dat", "npz", "npy", "arrow", NULL };
+
+typedef struct {
+    char**	files;
+    int		nArgs;		/* the directories or files given */
+    char**	args;
+    int		format;
+    char*	dir;
+    int		chunkBins;
+    int		flags;
+    char*	pDone;		/* by run */
+    UINT64*	pBytesOut;	/* by run */
+} CONV_BATCH;
+
+static void usage _ANSI_ARGS_(( void ));
+static double now _ANSI_ARGS_(( void ));
+static UINT64 file_size _ANSI_ARGS_(( char* filename ));
+static char* rel_path _ANSI_ARGS_(( int nArgs, char** args, char* path ));
+static char* out_name _ANSI_ARGS_(( char* dir, char* path, char* ext ));
+static int is_npz _ANSI_ARGS_(( char* name ));
+static char* make_tmpdir _ANSI_ARGS_(( char* out ));
+static void convert_task _ANSI_ARGS_(( int task, int thread, void* pArg ));
+
+
+static void
+usage( void )
+{
+    fprintf( stderr, "usage: mudconvert [-t threads] [-z] [-c bins] -f format -o out dir|file ...\n" );
+    fprintf( stderr, "       format: mud, mudc, dat (out a directory); npz, npy, arrow (out a file)\n" );
+    fprintf( stderr, "       file: .msr, .mud, .mudc, or .npz (its runs imported first)\n" );
+    exit( 1 );
+}
+
+
+static double
+now( void )
+{
+#ifdef CLOCK_MONOTONIC
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return( ts.tv_sec + 1e-9*ts.tv_nsec );
+#else
+    return( (double)time( NULL ) );
+#endif /* CLOCK_MONOTONIC */
+}
+
+
+static UINT64
+file_size( char* filename )
+{
+    struct stat st;
+
+    return( stat( filename, &st ) == 0 ? (UINT64)st.st_size : 0 );
+}
+
+
+/*
+ *  rel_path() - path from the directory given that it was found in, or
+ *  else its name
+ */
+static char*
+rel_path( int nArgs, char** args, char* path )
+{
+    char* base;
+    int i, len;
+
+    for( i = 0; i < nArgs; i++ )
+    {
+	for( len = (int)strlen( args[i] ); len > 0 && args[i][len-1] == '/'; len-- ) ;
+	if( len > 0 && strncmp( path, args[i], len ) == 0 && path[len] == '/' )
+	{
+	    for( path += len; *path == '/'; path++ ) ;
+	    return( path );
+	}
+    }
+    return( ( base = strrchr( path, '/' ) ) != NULL ? base + 1 : path );
+}
+
+
+/*
+ *  out_name() - dir/ path, with ext for its extension, making the
+ *  directories on the way
+ */
+static char*
+out_name( char* dir, char* path, char* ext )
+{
+    char* p;
+    char* name;
+
+    if( ( name = (char*)malloc( strlen( dir ) + strlen( path ) + strlen( ext ) + 2 ) ) == NULL )
+	return( NULL );
+    sprintf( name, "%s/%s", dir, path );
+    for( p = name + strlen( dir ) + 1; ( p = strchr( p, '/' ) ) != NULL; p++ )
+    {
+	*p = '\0';
+	mkdir( name, 0777 );
+	*p = '/';
+    }
+    if( ( p = strrchr( name + strlen( dir ) + 1, '/' ) ) == NULL ) p = name + strlen( dir ) + 1;
+    if( ( p = strrchr( p, '.' ) ) != NULL ) *p = '\0';
+    strcat( name, ext );
+    return( name );
+}
+
+
+/*
+ *  is_npz() - whether the file is named .npz
+ */
+static int
+is_npz( char* name )
+{
+    int len = strlen( name );
+
+    return( len >= 5 && name[len-4] == '.' &&
+	    tolower( (unsigned char)name[len-3] ) == 'n' &&
+	    tolower( (unsigned char)name[len-2] ) == 'p' &&
+	    tolower( (unsigned char)name[len-1] ) == 'z' );
+}
+
+
+/*
+ *  make_tmpdir() - a new directory beside out, for the runs of the .npz
+ *  files; NULL if it cannot be made
+ */
+static char*
+make_tmpdir( char* out )
+{
+    char* dir;
+    int len;
+
+    for( len = (int)strlen( out ); len > 1 && out[len-1] == '/'; len-- ) ;
+    if( ( dir = (char*)malloc( len + 12 ) ) == NULL ) return( NULL );
+    sprintf( dir, "%.*s.npzXXXXXX", len, out );
+#ifdef _WIN32
+    if( _mktemp( dir ) == NULL || _mkdir( dir ) != 0 )
+#else
+    if( mkdtemp( dir ) == NULL )
+#endif /* _WIN32 */
+    {
+	free( dir );
+	return( NULL );
+    }
+    return( dir );
+}
+
+
+/*
+ *  convert_task() - a run to MUD or MUD-C
+ */
+static void
+convert_task( int task, int thread, void* pArg )
+{
+    CONV_BATCH* pB = (CONV_BATCH*)pArg;
+    void* pMUD_fileGrp;
+    char* outname;
+
+    if( ( pMUD_fileGrp = MUD_readRunFile( pB->files[task], 0 ) ) == NULL ) return;
+    outname = out_name( pB->dir, rel_path( pB->nArgs, pB->args, pB->files[task] ),
+			pB->format == CONV_MUDC ? ".mudc" : ".msr" );
+    if( outname != NULL )
+    {
+	if( pB->format == CONV_MUDC )
+	    pB->pDone[task] = ( MUD_mudcWriteRun( pMUD_fileGrp, outname, pB->chunkBins,
+						  pB->flags ) == 1 );
+	else
+	    pB->pDone[task] = (char)MUD_writeRunFile( pMUD_fileGrp, outname );
+	if( pB->pDone[task] ) pB->pBytesOut[task] = file_size( outname );
+	free( outname );
+    }
+    MUD_free( pMUD_fileGrp );
+}
+
+
+int
+main( int argc, char* argv[] )
+{
+    CONV_BATCH batch;
+    char** files;
+    char** args;
+    char* out = NULL;
+    char* tmpdir = NULL;
+    UINT64 bytesIn = 0, bytesOut = 0;
+    double t0, secs;
+    int nThreads = 0, format = -1, deflate = 0, chunkBins = 0;
+    int i, j, num, nArgs, nBad = 0, n = 0;
+
+    for( i = 1; i < argc && argv[i][0] == '-'; i++ )
+    {
+	if( strcmp( argv[i], "-t" ) == 0 && i + 1 < argc ) nThreads = atoi( argv[++i] );
+	else if( strcmp( argv[i], "-c" ) == 0 && i + 1 < argc ) chunkBins = atoi( argv[++i] );
+	else if( strcmp( argv[i], "-o" ) == 0 && i + 1 < argc ) out = argv[++i];
+	else if( strcmp( argv[i], "-z" ) == 0 ) deflate = 1;
+	else if( strcmp( argv[i], "-f" ) == 0 && i + 1 < argc )
+	{
+	    for( format = 0; formats[format] != NULL; format++ )
+	    {
+		if( strcmp( argv[i+1], formats[format] ) == 0 ) break;
+	    }
+	    if( formats[format] == NULL ) usage();
+	    i++;
+	}
+	else usage();
+    }
+    if( argc - i < 1 || out == NULL || format < 0 ) usage();
+    nArgs = argc - i;
+    if( ( args = (char**)zalloc( ( nArgs + 1 )*sizeof( char* ) ) ) == NULL ) return( 1 );
+    t0 = now();
+
+    /*
+     *  Each .npz file is replaced by a directory of its runs
+     */
+    for( j = 0; j < nArgs; j++ )
+    {
+	args[j] = argv[i+j];
+	if( !is_npz( args[j] ) ) continue;
+	if( tmpdir == NULL && ( tmpdir = make_tmpdir( out ) ) == NULL )
+	{
+	    fprintf( stderr, "mudconvert: cannot make a directory beside %s\n", out );
+	    return( 1 );
+	}
+	if( ( args[j] = (char*)malloc( strlen( tmpdir ) + 16 ) ) == NULL ) return( 1 );
+	sprintf( args[j], "%s/%d", tmpdir, j + 1 );
+	mkdir( args[j], 0777 );
+	if( MUD_importNpz( argv[i+j], args[j], MUD_IMPORT_BPB_AUTO, nThreads ) < 0 )
+	{
+	    fprintf( stderr, "mudconvert: cannot read %s\n", argv[i+j] );
+	    nBad++;
+	}
+    }
+    files = MUD_catalogFindRunFiles( nArgs, args, &num );
+
+    bzero( &batch, sizeof( batch ) );
+    switch( format )
+    {
+	case CONV_MUD:
+	case CONV_MUDC:
+	    batch.files = files;
+	    batch.nArgs = nArgs;
+	    batch.args = args;
+	    batch.format = format;
+	    batch.dir = out;
+	    batch.chunkBins = chunkBins;
+	    batch.flags = deflate ? MUD_MUDC_DEFLATE : 0;
+	    mkdir( out, 0777 );
+
+	    /*
+	     *  Without zlib, MUD_mudcWriteRun() turns down -z before
+	     *  looking at the run
+	     */
+	    if( format == CONV_MUDC && MUD_mudcWriteRun( NULL, out, 0, batch.flags ) < 0 )
+	    {
+		fprintf( stderr, "mudconvert: -z needs the library built with zlib\n" );
+		return( 1 );
+	    }
+	    if( ( batch.pDone = (char*)zalloc( num + 1 ) ) == NULL ||
+		( batch.pBytesOut = (UINT64*)zalloc( ( num + 1 )*sizeof( UINT64 ) ) ) == NULL )
+	    {
+		n = -1;
+		break;
+	    }
+	    MUD_parallelFor( num, nThreads, convert_task, &batch );
+	    for( i = 0; i < num; i++ )
+	    {
+		if( batch.pDone[i] )
+		{
+		    n++;
+		    bytesOut += batch.pBytesOut[i];
+		}
+		else
+		{
+		    fprintf( stderr, "mudconvert: cannot convert %s\n", files[i] );
+		}
+	    }
+	    break;
+	case CONV_DAT:
+	    mkdir( out, 0777 );
+	    if( ( batch.pDone = (char*)zalloc( num + 1 ) ) == NULL ||
+		( n = MUD_writeDat( num, files, out, nThreads, batch.pDone ) ) < 0 )
+	    {
+		n = -1;
+		break;
+	    }
+	    for( i = 0; i < num; i++ )
+	    {
+		if( !batch.pDone[i] )
+		    fprintf( stderr, "mudconvert: cannot convert %s\n", files[i] );
+	    }
+	    break;
+	case CONV_NPZ:
+	    n = MUD_writeNpz( out, num, files, deflate ? MUD_NPZ_DEFLATE : 0, nThreads );
+	    break;
+	case CONV_NPY:
+	    n = MUD_writeNpy( out, num, files, nThreads );
+	    break;
+	case CONV_ARROW:
+	    n = MUD_writeArrow( out, num, files, nThreads );
+	    break;
+    }
+    secs = now() - t0;
+
+    for( i = 0; i < num; i++ ) bytesIn += file_size( files[i] );
+    if( tmpdir != NULL )
+    {
+	j = strlen( tmpdir );
+	for( i = 0; i < num; i++ )
+	{
+	    if( strncmp( files[i], tmpdir, j ) == 0 && files[i][j] == '/' ) remove( files[i] );
+	}
+	for( i = 0; i < nArgs; i++ )
+	{
+	    if( args[i] != argv[argc-nArgs+i] )
+	    {
+		rmdir( args[i] );
+		free( args[i] );
+	    }
+	}
+	rmdir( tmpdir );
+	free( tmpdir );
+    }
+    free( args );
+
+    if( n < 0 )
+    {
+	fprintf( stderr, "mudconvert: cannot write %s\n", out );
+	return( 1 );
+    }
+    if( format >= CONV_NPZ ) bytesOut = file_size( out );
+
+    printf( "%d of %d runs converted in %.2f s: %.1f runs/s, %.1f MB/s read",
+	    n, num, secs, secs > 0 ? n/secs : 0.0, secs > 0 ? bytesIn/1e6/secs : 0.0 );
+    if( bytesOut > 0 )
+	printf( ", %.1f MB written", bytesOut/1e6 );
+    printf( "\n" );
+
+    _free( batch.pDone );
+    _free( batch.pBytesOut );
+    MUD_catalogFreeFiles( files, num );
+    return( n < num || nBad > 0 );
+}
@@ -0,0 +1,145 @@
+/*
+ *  muddedup.c -- find copies of the same run in directories of MUD files,
+ *                and optionally replace them by hard links
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version
+ *
+ *  Usage:
+ *    muddedup [-t threads] dir|file ...       list hash, path and first copy
+ *    muddedup -u [-t threads] dir|file ...    list one path per run
+ *    muddedup -l [-t threads] dir|file ...    hard-link the copies
+ *
+ *    Files are taken in order of path, and the first file holding a run
+ *    stands for its copies.  The list (the dedup map) has one line per
+ *    file: the content hash (see mud_dedup.c), the path, and the path of
+ *    the first copy of the run, e.g. to feed batch jobs with
+ *      muddedup -u /data/archive | xargs ...
+ *    With -l each copy on the same file system as its first is replaced
+ *    by a hard link to it.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif /* !_WIN32 */
+#include "mud.h"
+
+static void usage _ANSI_ARGS_(( void ));
+static int link_copy _ANSI_ARGS_(( char* first, char* copy ));
+
+
+static void
+usage( void )
+{
+    fprintf( stderr, "usage: muddedup [-u|-l] [-t threads] dir|file.msr ...\n" );
+    exit( 1 );
+}
+
+
+/*
+ *  link_copy() - replace copy by a hard link to first; returns 1 if
+ *  linked, 0 if on another file system or already linked, -1 on error
+ */
+static int
+link_copy( char* first, char* copy )
+{
+#ifdef _WIN32
+    return( -1 );
+#else
+    struct stat st1, st2;
+    char* tmpname;
+    int status;
+
+    if( stat( first, &st1 ) != 0 || stat( copy, &st2 ) != 0 ) return( -1 );
+    if( st1.st_dev != st2.st_dev || st1.st_ino == st2.st_ino ) return( 0 );
+
+    if( ( tmpname = (char*)malloc( strlen( copy ) + 24 ) ) == NULL ) return( -1 );
+    sprintf( tmpname, "%s.%lu.tmp", copy, (unsigned long)getpid() );
+    status = ( link( first, tmpname ) == 0 && rename( tmpname, copy ) == 0 ) ? 1 : -1;
+    if( status < 0 ) remove( tmpname );
+    free( tmpname );
+    return( status );
+#endif /* _WIN32 */
+}
+
+
+int
+main( int argc, char* argv[] )
+{
+    char** files;
+    UINT64* pHashes;
+    int* pFirst;
+    int unique = 0, doLink = 0, nThreads = 0;
+    int i, num, nRuns, nLinked = 0, status = 0;
+
+    for( i = 1; i < argc && argv[i][0] == '-'; i++ )
+    {
+	if( strcmp( argv[i], "-u" ) == 0 ) unique = 1;
+	else if( strcmp( argv[i], "-l" ) == 0 ) doLink = 1;
+	else if( strcmp( argv[i], "-t" ) == 0 && i + 1 < argc ) nThreads = atoi( argv[++i] );
+	else usage();
+    }
+    if( i >= argc || ( unique && doLink ) ) usage();
+
+    files = MUD_catalogFindFiles( argc - i, &argv[i], &num );
+    pHashes = (UINT64*)zalloc( ( num + 1 )*sizeof( UINT64 ) );
+    pFirst = (int*)zalloc( ( num + 1 )*sizeof( int ) );
+    if( pHashes == NULL || pFirst == NULL ||
+	( nRuns = MUD_dedupRuns( num, files, nThreads, pHashes, pFirst ) ) < 0 )
+    {
+	fprintf( stderr, "muddedup: out of memory\n" );
+	return( 1 );
+    }
+
+    for( i = 0; i < num; i++ )
+    {
+	if( pFirst[i] < 0 )
+	{
+	    fprintf( stderr, "muddedup: cannot read %s\n", files[i] );
+	    status = 1;
+	}
+	else if( unique )
+	{
+	    if( pFirst[i] == i ) printf( "%s\n", files[i] );
+	}
+	else if( doLink )
+	{
+	    if( pFirst[i] == i ) continue;
+	    switch( link_copy( files[pFirst[i]], files[i] ) )
+	    {
+	    case 1:
+		nLinked++;
+		break;
+	    case -1:
+		fprintf( stderr, "muddedup: cannot link %s\n", files[i] );
+		status = 1;
+		break;
+	    }
+	}
+	else
+	{
+	    printf( "%016llx %s %s\n", (unsigned long long)pHashes[i], files[i], files[pFirst[i]] );
+	}
+    }
+    if( doLink ) printf( "%d files, %d runs, %d copies linked\n", num, nRuns, nLinked );
+
+    free( pFirst );
+    free( pHashes );
+    MUD_catalogFreeFiles( files, num );
+    return( status );
+}
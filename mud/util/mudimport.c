@@ -0,0 +1,82 @@
+/*
+ *  mudimport.c -- write the runs of NumPy (.npz) files as MUD files
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026  DJA Initial version
+ *
+ *  Usage:
+ *    mudimport [-t threads] [-b bytes] [-o dir] file.npz ...
+ *
+ *    Each run of the .npz files (laid out as mud2npz writes them; see
+ *    mud_import.c) is written into dir (by default the current one) as
+ *    the name of the path it came from, else its run number, with
+ *    ".msr".  -b sets the bytes per bin, 1, 2 or 4, or 0 for packed, or
+ *    s for sparse (the nonzero bins only; see mud_sparse.c); by default
+ *    the fewest that hold the counts of each histogram.  e.g.
+ *    from Python
+ *      numpy.savez("sim.npz", counts=c, run_number=r, title=t, field_g=b)
+ *    then
+ *      mudimport -o /data/sim sim.npz
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "mud.h"
+
+static void usage _ANSI_ARGS_(( void ));
+
+
+static void
+usage( void )
+{
+    fprintf( stderr, "usage: mudimport [-t threads] [-b bytes] [-o dir] file.npz ...\n" );
+    exit( 1 );
+}
+
+
+int
+main( int argc, char* argv[] )
+{
+    char* dir = ".";
+    int bytesPerBin = MUD_IMPORT_BPB_AUTO, nThreads = 0;
+    int i, n, status = 0;
+
+    for( i = 1; i < argc && argv[i][0] == '-'; i++ )
+    {
+	if( strcmp( argv[i], "-t" ) == 0 && i + 1 < argc ) nThreads = atoi( argv[++i] );
+	else if( strcmp( argv[i], "-b" ) == 0 && i + 1 < argc )
+	{
+	    i++;
+	    bytesPerBin = ( strcmp( argv[i], "s" ) == 0 ) ? MUD_BPB_SPARSE : atoi( argv[i] );
+	}
+	else if( strcmp( argv[i], "-o" ) == 0 && i + 1 < argc ) dir = argv[++i];
+	else usage();
+    }
+    if( argc - i < 1 ) usage();
+    if( bytesPerBin != MUD_IMPORT_BPB_AUTO && bytesPerBin != 0 && bytesPerBin != 1 &&
+	bytesPerBin != 2 && bytesPerBin != 4 && bytesPerBin != MUD_BPB_SPARSE ) usage();
+
+    for( ; i < argc; i++ )
+    {
+	if( ( n = MUD_importNpz( argv[i], dir, bytesPerBin, nThreads ) ) < 0 )
+	{
+	    fprintf( stderr, "mudimport: cannot read %s\n", argv[i] );
+	    status = 1;
+	    continue;
+	}
+	printf( "%s: %d runs written\n", argv[i], n );
+    }
+    return( status );
+}
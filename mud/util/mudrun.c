@@ -0,0 +1,113 @@
+/*
+ *  mudrun.c -- write the run index of a catalog, and find the files of
+ *              runs by number
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version
+ *
+ *  Usage:
+ *    mudrun -w index catalog                  write the index (see mudcatalog)
+ *    mudrun [-y year] index [expt:]run ...    list the files of the runs
+ *
+ *    A run is given by number, of any experiment (the latest run of that
+ *    number), or as expt:run; -y takes only runs begun in that year, e.g.
+ *      mudrun -y 2019 runs.idx 40123 40124 1234:40200
+ *    Runs not in the index are listed as "-".
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "mud.h"
+
+static void usage _ANSI_ARGS_(( void ));
+
+
+static void
+usage( void )
+{
+    fprintf( stderr, "usage: mudrun -w index catalog\n" );
+    fprintf( stderr, "       mudrun [-y year] index [expt:]run ...\n" );
+    exit( 1 );
+}
+
+
+int
+main( int argc, char* argv[] )
+{
+    MUD_CATALOG* pCat;
+    MUD_RUNINDEX* pIdx;
+    MUD_RUNINDEX_ENTRY* pEntry;
+    char* p;
+    UINT32 expt, run;
+    int write = 0, year = 0;
+    int i, n, status = 0;
+
+    for( i = 1; i < argc && argv[i][0] == '-'; i++ )
+    {
+	if( strcmp( argv[i], "-w" ) == 0 ) write = 1;
+	else if( strcmp( argv[i], "-y" ) == 0 && i + 1 < argc ) year = atoi( argv[++i] );
+	else usage();
+    }
+
+    if( write )
+    {
+	if( argc - i != 2 ) usage();
+	if( ( pCat = MUD_catalogRead( argv[i+1] ) ) == NULL )
+	{
+	    fprintf( stderr, "mudrun: cannot read catalog %s\n", argv[i+1] );
+	    return( 1 );
+	}
+	if( ( n = MUD_runIndexWrite( pCat, argv[i] ) ) < 0 )
+	{
+	    fprintf( stderr, "mudrun: cannot write %s\n", argv[i] );
+	    return( 1 );
+	}
+	printf( "%d runs indexed\n", n );
+	MUD_catalogFree( pCat );
+	return( 0 );
+    }
+
+    if( argc - i < 2 ) usage();
+    if( ( pIdx = MUD_runIndexOpen( argv[i] ) ) == NULL )
+    {
+	fprintf( stderr, "mudrun: cannot read index %s\n", argv[i] );
+	return( 1 );
+    }
+    for( i++; i < argc; i++ )
+    {
+	if( ( p = strchr( argv[i], ':' ) ) != NULL )
+	{
+	    expt = (UINT32)strtoul( argv[i], NULL, 10 );
+	    run = (UINT32)strtoul( p + 1, NULL, 10 );
+	}
+	else
+	{
+	    expt = 0;
+	    run = (UINT32)strtoul( argv[i], NULL, 10 );
+	}
+	if( ( pEntry = MUD_runIndexFind( pIdx, expt, run, year ) ) != NULL )
+	{
+	    printf( "%s\n", MUD_runIndexPath( pIdx, pEntry ) );
+	}
+	else
+	{
+	    printf( "-\n" );
+	    status = 1;
+	}
+    }
+
+    MUD_runIndexClose( pIdx );
+    return( status );
+}
@@ -0,0 +1,109 @@
+/*
+ *  mudsearch.c -- index the run descriptions and comments in directories
+ *                 of MUD files, and search them
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026  DJA Initial version
+ *
+ *  Usage:
+ *    mudsearch -u [-t threads] index dir|file ...   create or update the index
+ *    mudsearch index word|"phrase" ...              list the matching files
+ *
+ *    An update reads only the files that are new or changed (by size and
+ *    modification time) since the index was last written.  A search
+ *    lists the files whose run description or comments contain all of
+ *    the words and phrases, case ignored, e.g.
+ *      mudsearch runs.idx ybco '"field cooled"'
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "mud.h"
+
+static void usage _ANSI_ARGS_(( void ));
+
+
+static void
+usage( void )
+{
+    fprintf( stderr, "usage: mudsearch -u [-t threads] index dir|file.msr ...\n" );
+    fprintf( stderr, "       mudsearch index word|\"phrase\" ...\n" );
+    exit( 1 );
+}
+
+
+int
+main( int argc, char* argv[] )
+{
+    MUD_TEXTINDEX* pIdx;
+    char* query;
+    int* pDocs;
+    int update = 0, nThreads = 0;
+    int i, j, n, nRead;
+    size_t len;
+
+    for( i = 1; i < argc && argv[i][0] == '-'; i++ )
+    {
+	if( strcmp( argv[i], "-u" ) == 0 ) update = 1;
+	else if( strcmp( argv[i], "-t" ) == 0 && i + 1 < argc ) nThreads = atoi( argv[++i] );
+	else usage();
+    }
+    if( argc - i < 2 ) usage();
+
+    if( update )
+    {
+	n = MUD_textIndexRefresh( argv[i], argc - i - 1, &argv[i+1], nThreads, &nRead );
+	if( n < 0 )
+	{
+	    fprintf( stderr, "mudsearch: cannot write %s\n", argv[i] );
+	    return( 1 );
+	}
+	printf( "%d runs indexed (%d read)\n", n, nRead );
+	return( 0 );
+    }
+
+    if( ( pIdx = MUD_textIndexRead( argv[i] ) ) == NULL )
+    {
+	fprintf( stderr, "mudsearch: cannot read index %s\n", argv[i] );
+	return( 1 );
+    }
+
+    /*
+     *  The words and phrases make one query
+     */
+    for( j = i + 1, len = 1; j < argc; j++ ) len += strlen( argv[j] ) + 1;
+    if( ( query = (char*)malloc( len ) ) == NULL ) return( 1 );
+    query[0] = '\0';
+    for( j = i + 1; j < argc; j++ )
+    {
+	strcat( query, argv[j] );
+	strcat( query, " " );
+    }
+
+    if( ( n = MUD_textSearch( pIdx, query, &pDocs ) ) < 0 )
+    {
+	fprintf( stderr, "mudsearch: bad query %s\n", query );
+	return( 1 );
+    }
+    for( j = 0; j < n; j++ )
+    {
+	printf( "%s\n", MUD_textDocPath( pIdx, pDocs[j] ) );
+    }
+
+    free( pDocs );
+    free( query );
+    MUD_textIndexFree( pIdx );
+    return( 0 );
+}
@@ -0,0 +1,101 @@
+/*
+ *  mudshm.c -- create, fill, examine and remove the shared-memory cache
+ *              of decoded runs
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version
+ *
+ *  Usage:
+ *    mudshm [-n name] -c megabytes [file.msr ...]   create the segment
+ *    mudshm [-n name] [file.msr ...]                 show it, or load runs
+ *    mudshm [-n name] -r                             remove it
+ *
+ *    The segment is named by -n, else MUD_SHM_CACHE, else "/mud_runs".
+ *    Files given are read and published, if not in the cache already.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "mud.h"
+
+static void usage _ANSI_ARGS_(( void ));
+
+
+static void
+usage( void )
+{
+    fprintf( stderr, "usage: mudshm [-n name] -c megabytes [file.msr ...]\n" );
+    fprintf( stderr, "       mudshm [-n name] [file.msr ...]\n" );
+    fprintf( stderr, "       mudshm [-n name] -r\n" );
+    exit( 1 );
+}
+
+
+int
+main( int argc, char* argv[] )
+{
+    MUD_SHM_CACHE* pShm;
+    MUD_SHM_RUN* pRun;
+    char* name = NULL;
+    size_t size = 0, bytes;
+    UINT64 hits, misses;
+    UINT32 num;
+    int i, remove = 0, status = 0;
+
+    for( i = 1; i < argc && argv[i][0] == '-'; i++ )
+    {
+	if( strcmp( argv[i], "-n" ) == 0 && i + 1 < argc ) name = argv[++i];
+	else if( strcmp( argv[i], "-c" ) == 0 && i + 1 < argc )
+	    size = (size_t)( atof( argv[++i] )*1048576.0 );
+	else if( strcmp( argv[i], "-r" ) == 0 ) remove = 1;
+	else usage();
+    }
+
+    if( remove )
+    {
+	if( i < argc || size > 0 ) usage();
+	if( !MUD_shmCacheRemove( name ) )
+	{
+	    fprintf( stderr, "mudshm: cannot remove the segment\n" );
+	    return( 1 );
+	}
+	return( 0 );
+    }
+
+    if( ( pShm = MUD_shmCacheOpen( name, size ) ) == NULL )
+    {
+	fprintf( stderr, "mudshm: cannot %s the segment\n", ( size > 0 ) ? "create" : "attach to" );
+	return( 1 );
+    }
+
+    for( ; i < argc; i++ )
+    {
+	if( ( pRun = MUD_shmOpenRun( pShm, argv[i] ) ) == NULL )
+	{
+	    fprintf( stderr, "mudshm: cannot load %s\n", argv[i] );
+	    status = 1;
+	    continue;
+	}
+	MUD_shmReleaseRun( pShm, pRun );
+    }
+
+    MUD_shmCacheStats( pShm, &num, &bytes, &hits, &misses );
+    printf( "%s: %lu MB, %lu runs in %lu kB, %llu hits, %llu misses\n", pShm->name,
+	    (unsigned long)( pShm->size/1048576 ), (unsigned long)num,
+	    (unsigned long)( bytes/1024 ), (unsigned long long)hits, (unsigned long long)misses );
+
+    MUD_shmCacheClose( pShm );
+    return( status );
+}
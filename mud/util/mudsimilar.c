@@ -0,0 +1,135 @@
+/*
+ *  mudsimilar.c -- build a run-similarity index of MUD files, and find
+ *                  the runs most like a given one
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *          18-Oct-2026      Initial version
+ *
+ *  Usage:
+ *    mudsimilar -b index file.msr ...     build the index from the files
+ *    mudsimilar [options] index run       runs most similar to a run in the index
+ *    mudsimilar [options] index file.msr  runs most similar to a file
+ *
+ *    -n num      number of matches to list (default 10)
+ *    -a          only runs on the same apparatus
+ *    -l          locality-sensitive hashing (faster for large indexes)
+ *    -t threads  threads for building (default: all processors)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "mud.h"
+
+static void usage _ANSI_ARGS_(( void ));
+
+
+static void
+usage( void )
+{
+    fprintf( stderr, "usage: mudsimilar -b index file.msr ...\n" );
+    fprintf( stderr, "       mudsimilar [-n num] [-a] [-l] index run|file.msr\n" );
+    exit( 1 );
+}
+
+
+int
+main( int argc, char* argv[] )
+{
+    MUD_SIM_INDEX* pIndex;
+    MUD_SIM_SIG sig;
+    MUD_SIM_MATCH* pMatches;
+    MUD_SEC_GRP* pMUD_fileGrp;
+    FILE* fin;
+    char* target;
+    int build = 0, sameApp = 0, useLsh = 0;
+    int num = 10, nThreads = 0;
+    int i, n, row;
+
+    for( i = 1; i < argc && argv[i][0] == '-'; i++ )
+    {
+	if( strcmp( argv[i], "-b" ) == 0 ) build = 1;
+	else if( strcmp( argv[i], "-a" ) == 0 ) sameApp = 1;
+	else if( strcmp( argv[i], "-l" ) == 0 ) useLsh = 1;
+	else if( strcmp( argv[i], "-n" ) == 0 && i + 1 < argc ) num = atoi( argv[++i] );
+	else if( strcmp( argv[i], "-t" ) == 0 && i + 1 < argc ) nThreads = atoi( argv[++i] );
+	else usage();
+    }
+    if( argc - i < 2 || num <= 0 ) usage();
+
+    if( build )
+    {
+	n = MUD_simIndexBuild( argc - i - 1, &argv[i+1], argv[i], nThreads );
+	if( n < 0 )
+	{
+	    fprintf( stderr, "mudsimilar: cannot write %s\n", argv[i] );
+	    return( 1 );
+	}
+	printf( "%d of %d runs indexed\n", n, argc - i - 1 );
+	return( 0 );
+    }
+
+    if( ( pIndex = MUD_simIndexLoad( argv[i] ) ) == NULL )
+    {
+	fprintf( stderr, "mudsimilar: cannot read index %s\n", argv[i] );
+	return( 1 );
+    }
+    target = argv[i+1];
+
+    /*
+     *  A run number in the index, or else a file
+     */
+    row = -1;
+    for( n = 0; isdigit( (unsigned char)target[n] ); n++ ) ;
+    if( n > 0 && target[n] == '\0' )
+    {
+	if( ( row = MUD_simFindRun( pIndex, (UINT32)atol( target ), NULL ) ) < 0 )
+	{
+	    fprintf( stderr, "mudsimilar: run %s is not in the index\n", target );
+	    return( 1 );
+	}
+	sig = pIndex->pSigs[row];
+    }
+    else
+    {
+	if( ( fin = MUD_openInput( target ) ) == NULL ||
+	    ( pMUD_fileGrp = (MUD_SEC_GRP*)MUD_readFile( fin ) ) == NULL ||
+	    !MUD_simSignature( pMUD_fileGrp, &sig ) )
+	{
+	    fprintf( stderr, "mudsimilar: cannot read histograms of %s\n", target );
+	    return( 1 );
+	}
+	fclose( fin );
+	MUD_free( pMUD_fileGrp );
+    }
+
+    pMatches = (MUD_SIM_MATCH*)zalloc( num*sizeof( MUD_SIM_MATCH ) );
+    if( pMatches == NULL ) return( 1 );
+    n = MUD_simQuery( pIndex, &sig, sameApp ? sig.apparatus : NULL, row, useLsh,
+		      num, pMatches );
+
+    for( i = 0; i < n; i++ )
+    {
+	printf( "%3d  %8.5f  %6lu  %-8s  %-20s  %s\n", i + 1, pMatches[i].score,
+		(unsigned long)pIndex->pSigs[pMatches[i].row].runNumber,
+		pIndex->pSigs[pMatches[i].row].apparatus,
+		pIndex->pSigs[pMatches[i].row].sample,
+		&pIndex->pPaths[pIndex->pPathOff[pMatches[i].row]] );
+    }
+
+    free( pMatches );
+    MUD_simIndexFree( pIndex );
+    return( 0 );
+}